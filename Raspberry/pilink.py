@@ -0,0 +1,147 @@
+"""Cliente del mapa de registros que expone el STM32 como esclavo I2C (src/pilink.h).
+
+Lee el snapshot completo de estado y telemetría en una sola transacción
+(escritura del puntero + START repetido + lectura en bloque) y permite medir
+el throughput alcanzable:
+
+    python3 pilink.py                 # imprime un snapshot
+    python3 pilink.py --ping          # envía un PING por el buzón de comandos
+    python3 pilink.py --trace-dump    # pide el volcado de la traza por USART2 (TRACE=1)
+    python3 pilink.py --bench 500     # benchmark de lecturas en bloque
+"""
+import argparse
+import struct
+import time
+
+from smbus2 import SMBus, i2c_msg
+
+PILINK_ADDRESS = 0x08
+
+# Mapa de registros (ver src/pilink.h)
+REG_STATUS = 0x00
+REG_TELEMETRY = 0x08
+REG_COMMAND = 0x58
+MAP_SIZE = 0x60
+
+PILINK_MAGIC = 0xF5
+CMD_PING = 0x01
+CMD_TRACE_DUMP = 0x02
+CMD_LATENCY_RESET = 0x03
+
+STATUS_FMT = "<BBBBHBB"
+TELEMETRY_FMT = "<I4I4I4I3H22x"
+STREAMS = ("hk", "gps", "log", "payload")
+# Con LOW_POWER=1 la transacción que despierta al STM32 del modo STOP recibe NACK
+WAKEUP_RETRIES = 1
+
+
+class PiLink:
+    def __init__(self, bus=1, address=PILINK_ADDRESS):
+        self.bus = SMBus(bus)
+        self.address = address
+        self.cmd_seq = 0
+
+    def transfer(self, *msgs):
+        for attempt in range(WAKEUP_RETRIES + 1):
+            try:
+                self.bus.i2c_rdwr(*msgs)
+                return
+            except OSError:
+                if attempt == WAKEUP_RETRIES:
+                    raise
+
+    def read_block(self, reg, length):
+        """Escribe el puntero y lee length bytes con START repetido."""
+        write = i2c_msg.write(self.address, [reg])
+        read = i2c_msg.read(self.address, length)
+        self.transfer(write, read)
+        return bytes(read)
+
+    def read_again(self, length):
+        """Repite la lectura desde el último puntero escrito (sin escribirlo de nuevo)."""
+        read = i2c_msg.read(self.address, length)
+        self.transfer(read)
+        return bytes(read)
+
+    def snapshot(self):
+        return decode(self.read_block(REG_STATUS, MAP_SIZE))
+
+    def command(self, cmd_id, args=b"", timeout=1.0):
+        """Escribe un comando en el buzón y espera el ack en el bloque de estado."""
+        self.cmd_seq = (self.cmd_seq + 1) & 0xFF
+        payload = bytes([REG_COMMAND, self.cmd_seq, cmd_id]) + bytes(args).ljust(6, b"\0")
+        self.transfer(i2c_msg.write(self.address, payload))
+
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            status = self.snapshot()["status"]
+            if status["cmd_ack"] == self.cmd_seq:
+                return status["cmd_result"]
+            time.sleep(0.005)
+        return None
+
+
+def decode(raw):
+    magic, version, flags, _, seq, cmd_result, cmd_ack = struct.unpack_from(STATUS_FMT, raw, REG_STATUS)
+    if magic != PILINK_MAGIC:
+        raise ValueError(f"magic inválido: 0x{magic:02x}")
+
+    fields = struct.unpack_from(TELEMETRY_FMT, raw, REG_TELEMETRY)
+    uptime_ms = fields[0]
+    queued, sent, dropped = fields[1:5], fields[5:9], fields[9:13]
+    pbuf_free, pbuf_min_free, pbuf_exhausted = fields[13:16]
+    return {
+        "status": {"version": version, "flags": flags, "seq": seq,
+                   "cmd_ack": cmd_ack, "cmd_result": cmd_result},
+        "uptime_ms": uptime_ms,
+        "downlink": {name: {"queued": queued[i], "sent": sent[i], "dropped": dropped[i]}
+                     for i, name in enumerate(STREAMS)},
+        "pbuf": {"free": pbuf_free, "min_free": pbuf_min_free, "exhausted": pbuf_exhausted},
+    }
+
+
+def bench(link, iterations):
+    """Mide snapshots por segundo con puntero explícito y repitiendo el puntero."""
+    for label, read in (("puntero + lectura", lambda: link.read_block(REG_STATUS, MAP_SIZE)),
+                        ("solo lectura", lambda: link.read_again(MAP_SIZE))):
+        link.read_block(REG_STATUS, MAP_SIZE)
+        errors = 0
+        start = time.perf_counter()
+        for _ in range(iterations):
+            try:
+                raw = read()
+                if raw[0] != PILINK_MAGIC:
+                    errors += 1
+            except OSError:
+                errors += 1
+        elapsed = time.perf_counter() - start
+        ok = iterations - errors
+        print(f"{label:18s}: {ok / elapsed:8.1f} snapshots/s, {ok * MAP_SIZE / elapsed:9.1f} bytes/s, "
+              f"{elapsed / iterations * 1e3:6.2f} ms/transacción, {errors} errores")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--bus", type=int, default=1)
+    parser.add_argument("--ping", action="store_true")
+    parser.add_argument("--trace-dump", action="store_true")
+    parser.add_argument("--latency-reset", action="store_true")
+    parser.add_argument("--bench", type=int, metavar="N")
+    args = parser.parse_args()
+
+    link = PiLink(args.bus)
+    if args.ping:
+        result = link.command(CMD_PING)
+        print("PING sin respuesta" if result is None else f"PING resultado: 0x{result:02x}")
+    elif args.trace_dump:
+        # El volcado sale por USART2: capturarlo y convertirlo con tools/trace2perfetto.py
+        result = link.command(CMD_TRACE_DUMP)
+        print("TRACE_DUMP sin respuesta" if result is None else f"TRACE_DUMP resultado: 0x{result:02x}")
+    elif args.latency_reset:
+        # Empieza una corrida limpia para tools/latency_report.py
+        result = link.command(CMD_LATENCY_RESET)
+        print("LATENCY_RESET sin respuesta" if result is None else f"LATENCY_RESET resultado: 0x{result:02x}")
+    elif args.bench:
+        bench(link, args.bench)
+    else:
+        print(link.snapshot())
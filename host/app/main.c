@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "sim.h"
+#include "downlink.h"
+#include "pbuf.h"
+#include "cpustats.h"
+#include "heapstats.h"
+#include "uartbench.h"
+
+#include <libopencm3/stm32/usart.h>
+
+// Firmware completo (src/main.c y sus tareas) sobre el port POSIX y los periféricos
+// simulados. Las UARTs se conectan con archivos del host:
+//
+//   -g ARCHIVO   sentencias NMEA que llegan por RX de USART1 (GPS)
+//   -G MS        pausa entre sentencias del GPS (por defecto 0: al ritmo de la UART)
+//   -o ARCHIVO   lo que sale por USART3 (enlace de bajada), para los scripts de tools/
+//   -i ARCHIVO   lo que llega por RX de USART3 (taskUART3_receive lo devuelve por el enlace)
+//   Lo que sale por USART2 (volcado de la traza) va a la salida estándar
+//   -d SEGUNDOS  duración de la corrida (por defecto 5)
+//   -v           tiempo virtual (sim.h): corre más rápido que el tiempo real y dos corridas
+//                con las mismas entradas dan la misma salida
+//   -l           USART1 y USART2 en loopback, para el benchmark de UART (build/uart_bench,
+//                compilado con UARTBENCH_ENABLED). Sin -o el enlace de bajada va a la
+//                salida estándar y el proceso sale con el resultado del benchmark
+//
+// Al terminar imprime los contadores del enlace de bajada, del pool de pbuf, del heap y
+// de las UARTs simuladas. Sale con 1 si el firmware no arrancó o si se pasó una entrada
+// del GPS y nada llegó al enlace de bajada, y con SIM_IWDG_EXIT_STATUS si el supervisor
+// dejó vencer el IWDG.
+
+#define HOST_STOP_PRIORITY (configMAX_PRIORITIES - 1)
+
+// src/main.c compilado con otro nombre (ver el Makefile)
+int firmware_main(void);
+
+static const char *const stream_names[DOWNLINK_STREAM_COUNT] = { "HK", "GPS", "Log", "Payload" };
+
+static uint32_t duration_s = 5;
+static FILE *gps_in;
+static int loopback;
+static struct timespec host_start;
+
+static void print_usart(const char *name, uint32_t usart) {
+    sim_usart_stats_t stats;
+    sim_usart_get_stats(usart, &stats);
+    fprintf(stderr, "  %-7s %10u %10u %10u\n", name, stats.tx_bytes, stats.rx_bytes, stats.overruns);
+}
+
+// Fin del benchmark de UART (src/uartbench.h): el proceso sale con su resultado
+void UARTBENCH_done(BaseType_t result) {
+    fflush(NULL);
+    exit(result == pdPASS ? 0 : 1);
+}
+
+static void taskHostStop(void *args) {
+    (void)args;
+    // En ticks y no con pdMS_TO_TICKS(), que desborda pasada una hora
+    vTaskDelay((TickType_t)duration_s * configTICK_RATE_HZ);
+
+    if (loopback) {
+        fprintf(stderr, "\nFALLÓ: el benchmark de UART no terminó en %u s\n", duration_s);
+        fflush(NULL);
+        exit(1);
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double host_s = (now.tv_sec - host_start.tv_sec) + (now.tv_nsec - host_start.tv_nsec) / 1e9;
+
+    downlink_counters_t gps = { 0 };
+    fprintf(stderr, "\nEnlace de bajada tras %u s (%.1f s del host) (bytes):\n", duration_s, host_s);
+    fprintf(stderr, "  %-7s %10s %10s %10s\n", "stream", "encolados", "enviados", "descartados");
+    for (uint8_t i = 0; i < DOWNLINK_STREAM_COUNT; i++) {
+        downlink_counters_t counters;
+        DOWNLINK_get_counters(i, &counters);
+        if (i == DOWNLINK_STREAM_GPS) gps = counters;
+        fprintf(stderr, "  %-7s %10u %10u %10u\n", stream_names[i], counters.queued, counters.sent, counters.dropped);
+    }
+
+    pbuf_stats_t pool;
+    PBUF_get_stats(&pool);
+    fprintf(stderr, "\nPool de pbuf: %u libres, mínimo %u, %u entregados, %u pedidos sin bloques\n",
+            pool.free, pool.min_free, pool.allocated, pool.exhausted);
+
+    fprintf(stderr, "Heap: %zu B libres, mínimo %zu B, %u fallas\n",
+            xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize(), HEAPSTATS_get_failures());
+
+    cpustats_load_t load;
+    CPUSTATS_get_load(&load);
+    fprintf(stderr, "CPU (reloj del simulador): ISRs %.1f%%, idle %.1f%%\n", load.isr_long / 10.0, load.idle_long / 10.0);
+
+    fprintf(stderr, "\nUARTs simuladas (bytes):\n");
+    fprintf(stderr, "  %-7s %10s %10s %10s\n", "", "TX", "RX", "perdidos");
+    print_usart("USART1", USART1);
+    print_usart("USART2", USART2);
+    print_usart("USART3", USART3);
+
+    int failed = gps_in != NULL && gps.sent == 0;
+    if (failed) fprintf(stderr, "\nFALLÓ: ninguna sentencia del GPS llegó al enlace de bajada\n");
+    fflush(NULL);
+    exit(failed);
+}
+
+static FILE *open_file(const char *path, const char *mode) {
+    FILE *f = fopen(path, mode);
+    if (f == NULL) {
+        perror(path);
+        exit(2);
+    }
+    return f;
+}
+
+int main(int argc, char **argv) {
+    FILE *downlink_out = NULL;
+    FILE *uart3_in = NULL;
+    uint64_t gps_gap_ms = 0;
+    int virtual_time = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "g:G:o:i:d:vl")) != -1) {
+        switch (opt) {
+            case 'g': gps_in = open_file(optarg, "rb"); break;
+            case 'G': gps_gap_ms = strtoull(optarg, NULL, 10); break;
+            case 'o': downlink_out = open_file(optarg, "wb"); break;
+            case 'i': uart3_in = open_file(optarg, "rb"); break;
+            case 'd': duration_s = strtoul(optarg, NULL, 10); break;
+            case 'v': virtual_time = 1; break;
+            case 'l': loopback = 1; break;
+            default:
+                fprintf(stderr, "uso: %s [-g nmea] [-G ms] [-o downlink.bin] [-i uart3] [-d segundos] [-v] [-l]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &host_start);
+    if (virtual_time) sim_use_virtual_time();
+    sim_init();
+    sim_usart_attach(USART1, gps_in, NULL, gps_gap_ms * 1000000ull);
+    sim_usart_attach(USART2, NULL, stdout, 0);
+    sim_usart_attach(USART3, uart3_in, downlink_out, 0);
+    if (loopback) {
+        sim_usart_attach(USART2, NULL, NULL, 0);
+        sim_usart_loopback(USART1);
+        sim_usart_loopback(USART2);
+        if (downlink_out == NULL) sim_usart_attach(USART3, uart3_in, stdout, 0);
+    }
+
+    xTaskCreate(taskHostStop, "HostStop", configMINIMAL_STACK_SIZE, NULL, HOST_STOP_PRIORITY, NULL);
+
+    // Solo vuelve si falla la configuración de algún periférico
+    int status = firmware_main();
+    fprintf(stderr, "el firmware terminó con %d antes de arrancar el scheduler\n", status);
+    return 1;
+}
@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "sim.h"
+
+// Benchmark de heap_4 contra el heap TLSF (src/heap_tlsf.c) sobre las mismas secuencias de
+// operaciones: dos sintéticas y las grabadas en el firmware con HEAP_TRACE=1 que se pasen
+// como argumento (exportadas con tools/heap_replay.py --export). Los dos heaps se compilan
+// con los nombres cambiados (ver el Makefile) para correr en el mismo proceso; el kernel
+// usa un tercer heap_4 propio.
+//
+// Cada secuencia se repite BENCH_REPEAT veces y de cada operación se toma el menor tiempo:
+// las señales del tick y el planificador de Linux solo agregan tiempo, así que el mínimo
+// es el costo de la operación. De esos mínimos se informa el medio y el peor.
+//
+// Los heaps no suspenden el scheduler (ver el Makefile): solo la tarea del benchmark los usa.
+//
+// Además verifica los bloques: cada uno se llena con un patrón que se revisa al liberarlo.
+
+#define BENCH_REPEAT   15
+#define BENCH_MAX_OPS  40000
+#define BENCH_SLOTS    4096
+
+// Nombres de los heaps compilados para el benchmark
+void *heap4_malloc(size_t size);
+void heap4_free(void *pv);
+void heap4_stats(HeapStats_t *stats);
+void *tlsf_malloc(size_t size);
+void tlsf_free(void *pv);
+void tlsf_stats(HeapStats_t *stats);
+
+// Reemplazan a vTaskSuspendAll y xTaskResumeAll en los heaps del benchmark
+void bench_suspend_all(void);
+BaseType_t bench_resume_all(void);
+
+void bench_suspend_all(void) {
+}
+
+BaseType_t bench_resume_all(void) {
+    return pdFALSE;
+}
+
+typedef struct {
+    const char *name;
+    void *(*malloc)(size_t size);
+    void (*free)(void *pv);
+    void (*stats)(HeapStats_t *stats);
+} bench_heap_t;
+
+static const bench_heap_t heaps[] = {
+    { "heap_4", heap4_malloc, heap4_free, heap4_stats },
+    { "tlsf",   tlsf_malloc,  tlsf_free,  tlsf_stats },
+};
+
+#define BENCH_HEAPS (sizeof(heaps) / sizeof(heaps[0]))
+
+// Una operación: pedir size bytes para el slot o liberar el bloque del slot
+typedef struct {
+    uint8_t free;
+    uint16_t slot;
+    uint32_t size;
+} bench_op_t;
+
+typedef struct {
+    char name[64];
+    bench_op_t ops[BENCH_MAX_OPS];
+    uint32_t count;
+} bench_trace_t;
+
+static bench_trace_t trace;
+static void *blocks[BENCH_SLOTS];
+static uint32_t sizes[BENCH_SLOTS];
+static uint32_t best[BENCH_MAX_OPS];
+static uint64_t overhead_ns;
+static char **trace_files;
+static int trace_file_count;
+static int failed;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void add_op(uint8_t free_op, uint16_t slot, uint32_t size) {
+    if (trace.count < BENCH_MAX_OPS) trace.ops[trace.count++] = (bench_op_t){ free_op, slot, size };
+}
+
+// Tamaños chicos casi siempre, como los buffers del firmware, y a veces uno grande
+static void trace_random(void) {
+    uint16_t live[256];
+    uint16_t free_slots[256];
+    uint16_t nlive = 0, nfree = 256;
+    for (uint16_t i = 0; i < 256; i++) free_slots[i] = i;
+
+    snprintf(trace.name, sizeof(trace.name), "aleatoria");
+    trace.count = 0;
+    while (trace.count < 20000) {
+        if (nlive == 0 || (nfree > 0 && rng() % 100 < 55)) {
+            uint16_t slot = free_slots[--nfree];
+            uint32_t size = rng() % 100 < 90 ? 8 + rng() % 120 : 256 + rng() % 768;
+            add_op(0, slot, size);
+            live[nlive++] = slot;
+        } else {
+            uint16_t i = (uint16_t)(rng() % nlive);
+            add_op(1, live[i], 0);
+            free_slots[nfree++] = live[i];
+            live[i] = live[--nlive];
+        }
+    }
+    while (nlive > 0) add_op(1, live[--nlive], 0);
+}
+
+// Peor caso de heap_4: muchos huecos chicos antes del único bloque que sirve
+static void trace_fragmented(void) {
+    snprintf(trace.name, sizeof(trace.name), "fragmentada");
+    trace.count = 0;
+    for (uint16_t i = 0; i < 1500; i++) add_op(0, i, 24);
+    for (uint16_t i = 0; i < 1500; i += 2) add_op(1, i, 0);
+    for (uint16_t i = 0; i < 2000; i++) {
+        add_op(0, 1500, 400 + (i % 8) * 16);
+        add_op(1, 1500, 0);
+    }
+    for (uint16_t i = 1; i < 1500; i += 2) add_op(1, i, 0);
+}
+
+// Formato de tools/heap_replay.py --export: "m <slot> <tamaño>" o "f <slot>" por línea
+static int trace_load(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("no se pudo abrir %s\n", path);
+        return 0;
+    }
+    snprintf(trace.name, sizeof(trace.name), "%s", path);
+    trace.count = 0;
+
+    char op;
+    unsigned slot, size = 0;
+    int fields;
+    while ((fields = fscanf(f, " %c %u", &op, &slot)) == 2) {
+        if (op == 'm' && fscanf(f, "%u", &size) != 1) break;
+        if ((op != 'm' && op != 'f') || slot >= BENCH_SLOTS) break;
+        add_op(op == 'f', (uint16_t)slot, size);
+    }
+    int ok = fields == EOF && trace.count < BENCH_MAX_OPS;
+    fclose(f);
+    if (!ok) printf("%s: formato inválido o más de %u operaciones\n", path, BENCH_MAX_OPS);
+    return ok;
+}
+
+static uint8_t pattern(uint16_t slot) {
+    return (uint8_t)(slot * 31 + 7);
+}
+
+static int check_block(uint16_t slot) {
+    const uint8_t *data = blocks[slot];
+    for (uint32_t i = 0; i < sizes[slot]; i++)
+        if (data[i] != pattern(slot)) return 0;
+    return 1;
+}
+
+// Corre la secuencia una vez; guarda el mínimo de cada operación en best
+static uint32_t run_once(const bench_heap_t *heap) {
+    uint32_t failures = 0;
+    for (uint32_t i = 0; i < trace.count; i++) {
+        const bench_op_t *op = &trace.ops[i];
+        uint64_t start, elapsed;
+
+        if (op->free) {
+            if (blocks[op->slot] == NULL) {
+                best[i] = 0;
+                continue;
+            }
+            if (!check_block(op->slot)) {
+                printf("  %s: bloque del slot %u corrompido\n", heap->name, op->slot);
+                failed = 1;
+            }
+            start = now_ns();
+            heap->free(blocks[op->slot]);
+            elapsed = now_ns() - start;
+            blocks[op->slot] = NULL;
+        } else {
+            start = now_ns();
+            void *block = heap->malloc(op->size);
+            elapsed = now_ns() - start;
+            if (block == NULL) {
+                failures++;
+            } else {
+                if (blocks[op->slot] != NULL) heap->free(blocks[op->slot]);
+                memset(block, pattern(op->slot), op->size);
+                blocks[op->slot] = block;
+                sizes[op->slot] = op->size;
+            }
+        }
+        elapsed = elapsed > overhead_ns ? elapsed - overhead_ns : 0;
+        if (elapsed < best[i]) best[i] = (uint32_t)elapsed;
+    }
+
+    // La secuencia puede terminar con bloques vivos: se liberan sin medir
+    for (uint16_t slot = 0; slot < BENCH_SLOTS; slot++) {
+        if (blocks[slot] != NULL) {
+            heap->free(blocks[slot]);
+            blocks[slot] = NULL;
+        }
+    }
+    return failures;
+}
+
+static void bench_trace(void) {
+    uint32_t mallocs = 0;
+    for (uint32_t i = 0; i < trace.count; i++) mallocs += !trace.ops[i].free;
+    printf("\nSecuencia %s: %u malloc, %u free\n", trace.name, mallocs, trace.count - mallocs);
+    printf("  %-8s %12s %12s %12s %12s %7s\n", "heap", "malloc medio", "malloc peor", "free medio", "free peor", "fallas");
+
+    for (uint32_t h = 0; h < BENCH_HEAPS; h++) {
+        const bench_heap_t *heap = &heaps[h];
+        HeapStats_t before, after;
+        heap->stats(&before);
+
+        uint32_t failures = 0;
+        for (uint32_t i = 0; i < trace.count; i++) best[i] = UINT32_MAX;
+        for (uint32_t r = 0; r < BENCH_REPEAT; r++) failures = run_once(heap);
+
+        uint64_t sum[2] = { 0 };
+        uint32_t worst[2] = { 0 }, count[2] = { 0 };
+        for (uint32_t i = 0; i < trace.count; i++) {
+            uint8_t kind = trace.ops[i].free;
+            if (kind && best[i] == 0) continue;     // Free de un malloc que falló
+            sum[kind] += best[i];
+            count[kind]++;
+            if (best[i] > worst[kind]) worst[kind] = best[i];
+        }
+        printf("  %-8s %9.0f ns %9u ns %9.0f ns %9u ns %7u\n", heap->name,
+               count[0] ? (double)sum[0] / count[0] : 0.0, worst[0],
+               count[1] ? (double)sum[1] / count[1] : 0.0, worst[1], failures);
+
+        // Después de liberar todo el heap tiene que volver a estar como antes
+        heap->stats(&after);
+        if (before.xAvailableHeapSpaceInBytes != 0 &&
+            after.xAvailableHeapSpaceInBytes != before.xAvailableHeapSpaceInBytes) {
+            printf("  %s: quedaron %zu B sin liberar\n", heap->name,
+                   before.xAvailableHeapSpaceInBytes - after.xAvailableHeapSpaceInBytes);
+            failed = 1;
+        }
+    }
+}
+
+static void taskBench(void *args) {
+    (void)args;
+
+    // Costo de leer el reloj, que se descuenta de cada medición
+    overhead_ns = UINT64_MAX;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t start = now_ns();
+        uint64_t elapsed = now_ns() - start;
+        if (elapsed < overhead_ns) overhead_ns = elapsed;
+    }
+
+    // Inicializa los heaps para que la primera muestra de estadísticas sea válida
+    for (uint32_t h = 0; h < BENCH_HEAPS; h++) heaps[h].free(heaps[h].malloc(1));
+
+    printf("Heap de %u B, %u repeticiones, %u ns de costo del reloj descontados\n",
+           (unsigned)configTOTAL_HEAP_SIZE, BENCH_REPEAT, (unsigned)overhead_ns);
+
+    trace_random();
+    bench_trace();
+    trace_fragmented();
+    bench_trace();
+    for (int i = 0; i < trace_file_count; i++) {
+        if (trace_load(trace_files[i])) bench_trace();
+        else failed = 1;
+    }
+
+    printf(failed ? "FALLÓ\n" : "OK\n");
+    vTaskEndScheduler();
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    (void)xTask;
+    fprintf(stderr, "stack overflow en %s\n", pcTaskName);
+    abort();
+}
+
+int main(int argc, char **argv) {
+    trace_files = argv + 1;
+    trace_file_count = argc - 1;
+    sim_init();
+
+    xTaskCreate(taskBench, "Bench", 1024, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return failed;
+}
@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "kbench.h"
+#include "sim.h"
+
+// Benchmarks de las primitivas del kernel de src/kbench.c sobre el port POSIX. Los ciclos
+// son tiempo del host llevado a 72 MHz: sirven para comparar primitivas entre sí y para
+// ver que las mediciones corren, no como estimación del costo en el target.
+
+static int failed = 1;
+
+static void print_line(const char *line) {
+    puts(line);
+}
+
+static void finished(BaseType_t result) {
+    failed = result != pdPASS;
+    vTaskEndScheduler();
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    (void)xTask;
+    fprintf(stderr, "stack overflow en %s\n", pcTaskName);
+    abort();
+}
+
+int main(void) {
+    sim_init();
+
+    if (KBENCH_start(print_line, finished) != pdPASS) {
+        printf("FALLÓ\n");
+        return 1;
+    }
+    vTaskStartScheduler();
+    return failed;
+}
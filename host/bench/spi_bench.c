@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "spi.h"
+#include "nor.h"
+#include "sim.h"
+#include "sim_nor.h"
+
+// Benchmark del driver SPI contra una W25Q16 simulada en SPI1 a 18 MHz. Mide el throughput
+// sostenido de lectura, programación y lecturas cortas de status, y lo compara con la
+// velocidad del bus.
+
+#define BENCH_FLASH_SIZE   (2 * 1024 * 1024)
+#define BENCH_JEDEC_ID     0xEF4015
+#define BENCH_READ_BYTES   (512 * 1024)
+#define BENCH_WRITE_BYTES  (64 * 1024)
+#define BENCH_STATUS_READS 5000
+
+static const spi_device_t flash = {
+    .spi = SPI1,
+    .cs_port = GPIOA,
+    .cs_pin = GPIO4,
+    .baudrate = SPI_CR1_BAUDRATE_FPCLK_DIV_4,
+    .mode = 0,
+};
+
+static sim_nor_t *nor;
+static uint8_t buffer[4096];
+static uint8_t pattern[BENCH_WRITE_BYTES];
+static int failed;
+
+static double elapsed_s(uint64_t start) {
+    return (sim_time_ns() - start) / 1e9;
+}
+
+static void bench_read(uint16_t chunk) {
+    uint64_t start = sim_time_ns();
+    for (uint32_t addr = 0; addr < BENCH_READ_BYTES; addr += chunk) {
+        if (NOR_read(&flash, addr, buffer, chunk) != pdPASS) {
+            printf("  lectura: error en 0x%06x\n", addr);
+            failed = 1;
+            return;
+        }
+    }
+    double s = elapsed_s(start);
+    printf("  lectura de a %4u B: %6.3f MB/s (%u transacciones/s)\n", chunk,
+           BENCH_READ_BYTES / s / 1e6, (unsigned)(BENCH_READ_BYTES / chunk / s));
+}
+
+static void bench_write(void) {
+    for (uint32_t i = 0; i < sizeof(pattern); i++) pattern[i] = (uint8_t)(i * 7 + (i >> 8));
+
+    uint64_t start = sim_time_ns();
+    for (uint32_t addr = 0; addr < BENCH_WRITE_BYTES; addr += NOR_SECTOR_SIZE) {
+        if (NOR_erase_sector(&flash, addr) != pdPASS) {
+            printf("  borrado: error en 0x%06x\n", addr);
+            failed = 1;
+            return;
+        }
+    }
+    double erase_s = elapsed_s(start);
+
+    start = sim_time_ns();
+    if (NOR_program(&flash, 0, pattern, sizeof(pattern)) != pdPASS) {
+        printf("  programación: error\n");
+        failed = 1;
+        return;
+    }
+    double program_s = elapsed_s(start);
+
+    for (uint32_t addr = 0; addr < BENCH_WRITE_BYTES; addr += sizeof(buffer)) {
+        NOR_read(&flash, addr, buffer, sizeof(buffer));
+        if (memcmp(buffer, &pattern[addr], sizeof(buffer)) != 0) {
+            printf("  verificación: error en el bloque 0x%06x\n", addr);
+            failed = 1;
+            return;
+        }
+    }
+
+    printf("  borrado:       %6.3f MB/s (%u sectores, %.1f ms c/u)\n",
+           BENCH_WRITE_BYTES / erase_s / 1e6, BENCH_WRITE_BYTES / NOR_SECTOR_SIZE,
+           erase_s * 1e3 / (BENCH_WRITE_BYTES / NOR_SECTOR_SIZE));
+    printf("  programación:  %6.3f MB/s (%u páginas, %.0f us c/u, verificado)\n",
+           BENCH_WRITE_BYTES / program_s / 1e6, BENCH_WRITE_BYTES / NOR_PAGE_SIZE,
+           program_s * 1e6 / (BENCH_WRITE_BYTES / NOR_PAGE_SIZE));
+}
+
+static void bench_status(void) {
+    static const uint8_t cmd = 0x05;
+    uint8_t status;
+
+    uint64_t start = sim_time_ns();
+    for (uint32_t i = 0; i < BENCH_STATUS_READS; i++) {
+        spi_transaction_t txn = { .dev = &flash, .cmd = &cmd, .cmd_len = 1, .rx = &status, .len = 1 };
+        if (SPI_transfer(&txn, portMAX_DELAY) != SPI_OK) {
+            printf("  status: error\n");
+            failed = 1;
+            return;
+        }
+    }
+    double s = elapsed_s(start);
+    printf("  lectura de status (2 B): %.0f transacciones/s\n", BENCH_STATUS_READS / s);
+}
+
+static void taskBench(void *args) {
+    (void)args;
+
+    uint32_t id = 0;
+    NOR_read_id(&flash, &id);
+    printf("JEDEC ID: 0x%06x\n", id);
+    if (id != BENCH_JEDEC_ID) failed = 1;
+
+    uint32_t sck = rcc_apb2_frequency / 4;
+    printf("SPI1 a %u MHz, velocidad del bus: %.3f MB/s\n", sck / 1000000, sck / 8 / 1e6);
+
+    if (!failed) bench_write();
+    if (!failed) bench_read(4096);
+    if (!failed) bench_read(256);
+    if (!failed) bench_read(16);
+    if (!failed) bench_status();
+
+    const sim_nor_stats_t *stats = sim_nor_get_stats(nor);
+    printf("Memoria: %u B leídos, %u B programados, %u páginas, %u sectores borrados\n",
+           stats->read_bytes, stats->programmed_bytes, stats->page_programs, stats->sector_erases);
+    printf("Bus: %u B transferidos\n", SPI_get_bytes(SPI1));
+    printf(failed ? "FALLÓ\n" : "OK\n");
+
+    vTaskEndScheduler();
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    (void)xTask;
+    fprintf(stderr, "stack overflow en %s\n", pcTaskName);
+    abort();
+}
+
+int main(void) {
+    sim_init();
+
+    nor = sim_nor_create(BENCH_FLASH_SIZE, BENCH_JEDEC_ID);
+    sim_nor_attach(nor, SPI1, GPIOA, GPIO4);
+
+    SPI_setup(SPI1);
+    SPI_add_device(&flash);
+
+    xTaskCreate((TaskFunction_t)taskSPI, "SPI1", 256, (void *)SPI1, 3, NULL);
+    xTaskCreate(taskBench, "Bench", 512, NULL, 2, NULL);
+
+    vTaskStartScheduler();
+    return failed;
+}
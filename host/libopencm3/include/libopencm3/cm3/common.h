@@ -0,0 +1,33 @@
+#ifndef LIBOPENCM3_CM3_COMMON_H
+#define LIBOPENCM3_CM3_COMMON_H
+
+// libopencm3 simulada: los registros de los periféricos son memoria del simulador
+// (host/sim). Las funciones con efectos sobre el hardware avisan al modelo del periférico.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+volatile uint8_t *sim_mmio(uint32_t addr);
+
+#define MMIO8(addr)  (*(volatile uint8_t *)sim_mmio(addr))
+#define MMIO16(addr) (*(volatile uint16_t *)sim_mmio(addr))
+#define MMIO32(addr) (*(volatile uint32_t *)sim_mmio(addr))
+
+#define BIT0  (1 << 0)
+#define BIT1  (1 << 1)
+#define BIT2  (1 << 2)
+#define BIT3  (1 << 3)
+#define BIT4  (1 << 4)
+#define BIT5  (1 << 5)
+#define BIT6  (1 << 6)
+#define BIT7  (1 << 7)
+#define BIT8  (1 << 8)
+#define BIT9  (1 << 9)
+#define BIT10 (1 << 10)
+#define BIT11 (1 << 11)
+#define BIT12 (1 << 12)
+#define BIT13 (1 << 13)
+#define BIT14 (1 << 14)
+#define BIT15 (1 << 15)
+
+#endif
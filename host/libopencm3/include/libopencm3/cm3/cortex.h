@@ -0,0 +1,15 @@
+#ifndef LIBOPENCM3_CORTEX_H
+#define LIBOPENCM3_CORTEX_H
+
+#include <libopencm3/cm3/common.h>
+
+// PRIMASK del hilo que corre: en el port POSIX son las señales de interrupción bloqueadas
+
+void cm_enable_interrupts(void);
+void cm_disable_interrupts(void);
+bool cm_is_masked_interrupts(void);
+
+// Enmascara (mask = 1) o desenmascara las interrupciones y devuelve el estado anterior
+uint32_t cm_mask_interrupts(uint32_t mask);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef LIBOPENCM3_DWT_H
+#define LIBOPENCM3_DWT_H
+
+#include <libopencm3/cm3/common.h>
+
+// El contador de ciclos sale del reloj del simulador, a la frecuencia del core (72 MHz)
+uint32_t sim_dwt_cyccnt(void);
+
+#define DWT_CYCCNT sim_dwt_cyccnt()
+
+extern uint32_t sim_dwt_ctrl;
+
+#define DWT_CTRL sim_dwt_ctrl
+#define DWT_CTRL_CYCCNTENA (1 << 0)
+
+bool dwt_enable_cycle_counter(void);
+
+#endif
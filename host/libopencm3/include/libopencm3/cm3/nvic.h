@@ -0,0 +1,107 @@
+#ifndef LIBOPENCM3_NVIC_H
+#define LIBOPENCM3_NVIC_H
+
+#include <libopencm3/cm3/common.h>
+
+// Interrupciones del STM32F103 (posición en la tabla de vectores)
+#define NVIC_WWDG_IRQ           0
+#define NVIC_PVD_IRQ            1
+#define NVIC_TAMPER_IRQ         2
+#define NVIC_RTC_IRQ            3
+#define NVIC_FLASH_IRQ          4
+#define NVIC_RCC_IRQ            5
+#define NVIC_EXTI0_IRQ          6
+#define NVIC_EXTI1_IRQ          7
+#define NVIC_EXTI2_IRQ          8
+#define NVIC_EXTI3_IRQ          9
+#define NVIC_EXTI4_IRQ          10
+#define NVIC_DMA1_CHANNEL1_IRQ  11
+#define NVIC_DMA1_CHANNEL2_IRQ  12
+#define NVIC_DMA1_CHANNEL3_IRQ  13
+#define NVIC_DMA1_CHANNEL4_IRQ  14
+#define NVIC_DMA1_CHANNEL5_IRQ  15
+#define NVIC_DMA1_CHANNEL6_IRQ  16
+#define NVIC_DMA1_CHANNEL7_IRQ  17
+#define NVIC_ADC1_2_IRQ         18
+#define NVIC_USB_HP_CAN_TX_IRQ  19
+#define NVIC_USB_LP_CAN_RX0_IRQ 20
+#define NVIC_CAN_RX1_IRQ        21
+#define NVIC_CAN_SCE_IRQ        22
+#define NVIC_EXTI9_5_IRQ        23
+#define NVIC_TIM1_BRK_IRQ       24
+#define NVIC_TIM1_UP_IRQ        25
+#define NVIC_TIM1_TRG_COM_IRQ   26
+#define NVIC_TIM1_CC_IRQ        27
+#define NVIC_TIM2_IRQ           28
+#define NVIC_TIM3_IRQ           29
+#define NVIC_TIM4_IRQ           30
+#define NVIC_I2C1_EV_IRQ        31
+#define NVIC_I2C1_ER_IRQ        32
+#define NVIC_I2C2_EV_IRQ        33
+#define NVIC_I2C2_ER_IRQ        34
+#define NVIC_SPI1_IRQ           35
+#define NVIC_SPI2_IRQ           36
+#define NVIC_USART1_IRQ         37
+#define NVIC_USART2_IRQ         38
+#define NVIC_USART3_IRQ         39
+#define NVIC_EXTI15_10_IRQ      40
+#define NVIC_RTC_ALARM_IRQ      41
+#define NVIC_USB_WAKEUP_IRQ     42
+#define NVIC_IRQ_COUNT          43
+
+// En el simulador las prioridades se guardan pero no hay anidamiento: una interrupción
+// no interrumpe a otra
+void nvic_enable_irq(uint8_t irqn);
+void nvic_disable_irq(uint8_t irqn);
+uint8_t nvic_get_pending_irq(uint8_t irqn);
+void nvic_set_pending_irq(uint8_t irqn);
+void nvic_clear_pending_irq(uint8_t irqn);
+uint8_t nvic_get_irq_enabled(uint8_t irqn);
+void nvic_set_priority(uint8_t irqn, uint8_t priority);
+
+// Rutinas de interrupción. Las que no define el firmware no hacen nada
+void wwdg_isr(void);
+void pvd_isr(void);
+void tamper_isr(void);
+void rtc_isr(void);
+void flash_isr(void);
+void rcc_isr(void);
+void exti0_isr(void);
+void exti1_isr(void);
+void exti2_isr(void);
+void exti3_isr(void);
+void exti4_isr(void);
+void dma1_channel1_isr(void);
+void dma1_channel2_isr(void);
+void dma1_channel3_isr(void);
+void dma1_channel4_isr(void);
+void dma1_channel5_isr(void);
+void dma1_channel6_isr(void);
+void dma1_channel7_isr(void);
+void adc1_2_isr(void);
+void usb_hp_can_tx_isr(void);
+void usb_lp_can_rx0_isr(void);
+void can_rx1_isr(void);
+void can_sce_isr(void);
+void exti9_5_isr(void);
+void tim1_brk_isr(void);
+void tim1_up_isr(void);
+void tim1_trg_com_isr(void);
+void tim1_cc_isr(void);
+void tim2_isr(void);
+void tim3_isr(void);
+void tim4_isr(void);
+void i2c1_ev_isr(void);
+void i2c1_er_isr(void);
+void i2c2_ev_isr(void);
+void i2c2_er_isr(void);
+void spi1_isr(void);
+void spi2_isr(void);
+void usart1_isr(void);
+void usart2_isr(void);
+void usart3_isr(void);
+void exti15_10_isr(void);
+void rtc_alarm_isr(void);
+void usb_wakeup_isr(void);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef LIBOPENCM3_DBGMCU_H
+#define LIBOPENCM3_DBGMCU_H
+
+#include <libopencm3/cm3/common.h>
+
+// Sin debugger en el host: el registro existe pero no tiene efecto
+#define DBGMCU_BASE (0xE0042000U)
+#define DBGMCU_CR   MMIO32(DBGMCU_BASE + 0x04)
+
+// DBGMCU_CR
+#define DBGMCU_CR_IWDG_STOP (1 << 8)
+#define DBGMCU_CR_WWDG_STOP (1 << 9)
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef LIBOPENCM3_GPIO_H
+#define LIBOPENCM3_GPIO_H
+
+#include <libopencm3/cm3/common.h>
+#include <libopencm3/stm32/memorymap.h>
+
+#define GPIOA GPIO_PORT_A_BASE
+#define GPIOB GPIO_PORT_B_BASE
+#define GPIOC GPIO_PORT_C_BASE
+
+#define GPIO0  (1 << 0)
+#define GPIO1  (1 << 1)
+#define GPIO2  (1 << 2)
+#define GPIO3  (1 << 3)
+#define GPIO4  (1 << 4)
+#define GPIO5  (1 << 5)
+#define GPIO6  (1 << 6)
+#define GPIO7  (1 << 7)
+#define GPIO8  (1 << 8)
+#define GPIO9  (1 << 9)
+#define GPIO10 (1 << 10)
+#define GPIO11 (1 << 11)
+#define GPIO12 (1 << 12)
+#define GPIO13 (1 << 13)
+#define GPIO14 (1 << 14)
+#define GPIO15 (1 << 15)
+#define GPIO_ALL 0xffff
+
+// Registros
+#define GPIO_CRL(port)  MMIO32((port) + 0x00)
+#define GPIO_CRH(port)  MMIO32((port) + 0x04)
+#define GPIO_IDR(port)  MMIO32((port) + 0x08)
+#define GPIO_ODR(port)  MMIO32((port) + 0x0c)
+#define GPIO_BSRR(port) MMIO32((port) + 0x10)
+#define GPIO_BRR(port)  MMIO32((port) + 0x14)
+
+// Modos y configuraciones
+#define GPIO_MODE_INPUT         0x00
+#define GPIO_MODE_OUTPUT_10_MHZ 0x01
+#define GPIO_MODE_OUTPUT_2_MHZ  0x02
+#define GPIO_MODE_OUTPUT_50_MHZ 0x03
+
+#define GPIO_CNF_INPUT_ANALOG   0x00
+#define GPIO_CNF_INPUT_FLOAT    0x01
+#define GPIO_CNF_INPUT_PULL_UPDOWN 0x02
+
+#define GPIO_CNF_OUTPUT_PUSHPULL        0x00
+#define GPIO_CNF_OUTPUT_OPENDRAIN       0x01
+#define GPIO_CNF_OUTPUT_ALTFN_PUSHPULL  0x02
+#define GPIO_CNF_OUTPUT_ALTFN_OPENDRAIN 0x03
+
+// Pines de los periféricos sin remapeo
+#define GPIO_USART1_TX  GPIO9   // PA9
+#define GPIO_USART1_RX  GPIO10  // PA10
+#define GPIO_USART2_TX  GPIO2   // PA2
+#define GPIO_USART2_RX  GPIO3   // PA3
+#define GPIO_USART3_TX  GPIO10  // PB10
+#define GPIO_USART3_RX  GPIO11  // PB11
+#define GPIO_I2C1_SCL   GPIO6   // PB6
+#define GPIO_I2C1_SDA   GPIO7   // PB7
+#define GPIO_I2C2_SCL   GPIO10  // PB10
+#define GPIO_I2C2_SDA   GPIO11  // PB11
+#define GPIO_SPI1_NSS   GPIO4   // PA4
+#define GPIO_SPI1_SCK   GPIO5   // PA5
+#define GPIO_SPI1_MISO  GPIO6   // PA6
+#define GPIO_SPI1_MOSI  GPIO7   // PA7
+#define GPIO_SPI2_NSS   GPIO12  // PB12
+#define GPIO_SPI2_SCK   GPIO13  // PB13
+#define GPIO_SPI2_MISO  GPIO14  // PB14
+#define GPIO_SPI2_MOSI  GPIO15  // PB15
+
+#define GPIO_BANK_USART1_TX GPIOA
+#define GPIO_BANK_USART1_RX GPIOA
+#define GPIO_BANK_USART2_TX GPIOA
+#define GPIO_BANK_USART2_RX GPIOA
+#define GPIO_BANK_USART3_TX GPIOB
+#define GPIO_BANK_USART3_RX GPIOB
+
+void gpio_set_mode(uint32_t gpioport, uint8_t mode, uint8_t cnf, uint16_t gpios);
+void gpio_set(uint32_t gpioport, uint16_t gpios);
+void gpio_clear(uint32_t gpioport, uint16_t gpios);
+uint16_t gpio_get(uint32_t gpioport, uint16_t gpios);
+void gpio_toggle(uint32_t gpioport, uint16_t gpios);
+uint16_t gpio_port_read(uint32_t gpioport);
+void gpio_port_write(uint32_t gpioport, uint16_t data);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef LIBOPENCM3_I2C_H
+#define LIBOPENCM3_I2C_H
+
+#include <libopencm3/cm3/common.h>
+#include <libopencm3/stm32/memorymap.h>
+
+// Solo los registros: no hay modelo de bus I2C, así que los periféricos quedan
+// configurados pero ningún master ni esclavo genera eventos
+
+#define I2C1 I2C1_BASE
+#define I2C2 I2C2_BASE
+
+// Registros
+#define I2C_CR1(i2c)   MMIO32((i2c) + 0x00)
+#define I2C_CR2(i2c)   MMIO32((i2c) + 0x04)
+#define I2C_OAR1(i2c)  MMIO32((i2c) + 0x08)
+#define I2C_OAR2(i2c)  MMIO32((i2c) + 0x0c)
+#define I2C_DR(i2c)    MMIO32((i2c) + 0x10)
+#define I2C_SR1(i2c)   MMIO32((i2c) + 0x14)
+#define I2C_SR2(i2c)   MMIO32((i2c) + 0x18)
+#define I2C_CCR(i2c)   MMIO32((i2c) + 0x1c)
+#define I2C_TRISE(i2c) MMIO32((i2c) + 0x20)
+
+// I2C_CR1
+#define I2C_CR1_SWRST (1 << 15)
+#define I2C_CR1_POS   (1 << 11)
+#define I2C_CR1_ACK   (1 << 10)
+#define I2C_CR1_STOP  (1 << 9)
+#define I2C_CR1_START (1 << 8)
+#define I2C_CR1_PE    (1 << 0)
+
+// I2C_CR2
+#define I2C_CR2_LAST    (1 << 12)
+#define I2C_CR2_DMAEN   (1 << 11)
+#define I2C_CR2_ITBUFEN (1 << 10)
+#define I2C_CR2_ITEVTEN (1 << 9)
+#define I2C_CR2_ITERREN (1 << 8)
+
+// I2C_OAR1
+#define I2C_OAR1_ADDMODE (1 << 15)
+
+// I2C_SR1
+#define I2C_SR1_TIMEOUT (1 << 14)
+#define I2C_SR1_PECERR  (1 << 12)
+#define I2C_SR1_OVR     (1 << 11)
+#define I2C_SR1_AF      (1 << 10)
+#define I2C_SR1_ARLO    (1 << 9)
+#define I2C_SR1_BERR    (1 << 8)
+#define I2C_SR1_TxE     (1 << 7)
+#define I2C_SR1_RxNE    (1 << 6)
+#define I2C_SR1_STOPF   (1 << 4)
+#define I2C_SR1_ADD10   (1 << 3)
+#define I2C_SR1_BTF     (1 << 2)
+#define I2C_SR1_ADDR    (1 << 1)
+#define I2C_SR1_SB      (1 << 0)
+
+// I2C_SR2
+#define I2C_SR2_TRA  (1 << 2)
+#define I2C_SR2_BUSY (1 << 1)
+#define I2C_SR2_MSL  (1 << 0)
+
+enum i2c_speeds {
+    i2c_speed_sm_100k,
+    i2c_speed_fm_400k,
+    i2c_speed_fmp_1m,
+    i2c_speed_unknown
+};
+
+void i2c_peripheral_enable(uint32_t i2c);
+void i2c_peripheral_disable(uint32_t i2c);
+void i2c_set_own_7bit_slave_address(uint32_t i2c, uint8_t slave);
+void i2c_set_speed(uint32_t i2c, enum i2c_speeds speed, uint32_t clock_megahz);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef LIBOPENCM3_IWDG_H
+#define LIBOPENCM3_IWDG_H
+
+#include <libopencm3/cm3/common.h>
+#include <libopencm3/stm32/memorymap.h>
+
+// Registros
+#define IWDG_KR  MMIO32(IWDG_BASE + 0x00)
+#define IWDG_PR  MMIO32(IWDG_BASE + 0x04)
+#define IWDG_RLR MMIO32(IWDG_BASE + 0x08)
+#define IWDG_SR  MMIO32(IWDG_BASE + 0x0c)
+
+// IWDG_KR
+#define IWDG_KR_RESET  0xaaaa
+#define IWDG_KR_UNLOCK 0x5555
+#define IWDG_KR_START  0xcccc
+
+// IWDG_SR
+#define IWDG_SR_RVU (1 << 1)
+#define IWDG_SR_PVU (1 << 0)
+
+void iwdg_start(void);
+void iwdg_set_period_ms(uint32_t period);
+bool iwdg_reload_busy(void);
+bool iwdg_prescaler_busy(void);
+void iwdg_reset(void);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef LIBOPENCM3_MEMORYMAP_H
+#define LIBOPENCM3_MEMORYMAP_H
+
+// Mapa de memoria del STM32F1 (mismas direcciones que el hardware)
+
+#define PERIPH_BASE         (0x40000000U)
+#define PERIPH_BASE_APB1    (PERIPH_BASE + 0x00000)
+#define PERIPH_BASE_APB2    (PERIPH_BASE + 0x10000)
+#define PERIPH_BASE_AHB     (PERIPH_BASE + 0x18000)
+
+// APB1
+#define TIM2_BASE           (PERIPH_BASE_APB1 + 0x0000)
+#define TIM3_BASE           (PERIPH_BASE_APB1 + 0x0400)
+#define TIM4_BASE           (PERIPH_BASE_APB1 + 0x0800)
+#define RTC_BASE            (PERIPH_BASE_APB1 + 0x2800)
+#define WWDG_BASE           (PERIPH_BASE_APB1 + 0x2c00)
+#define IWDG_BASE           (PERIPH_BASE_APB1 + 0x3000)
+#define SPI2_BASE           (PERIPH_BASE_APB1 + 0x3800)
+#define USART2_BASE         (PERIPH_BASE_APB1 + 0x4400)
+#define USART3_BASE         (PERIPH_BASE_APB1 + 0x4800)
+#define I2C1_BASE           (PERIPH_BASE_APB1 + 0x5400)
+#define I2C2_BASE           (PERIPH_BASE_APB1 + 0x5800)
+#define BACKUP_REGS_BASE    (PERIPH_BASE_APB1 + 0x6c00)
+#define POWER_CONTROL_BASE  (PERIPH_BASE_APB1 + 0x7000)
+
+// APB2
+#define AFIO_BASE           (PERIPH_BASE_APB2 + 0x0000)
+#define EXTI_BASE           (PERIPH_BASE_APB2 + 0x0400)
+#define GPIO_PORT_A_BASE    (PERIPH_BASE_APB2 + 0x0800)
+#define GPIO_PORT_B_BASE    (PERIPH_BASE_APB2 + 0x0c00)
+#define GPIO_PORT_C_BASE    (PERIPH_BASE_APB2 + 0x1000)
+#define ADC1_BASE           (PERIPH_BASE_APB2 + 0x2400)
+#define TIM1_BASE           (PERIPH_BASE_APB2 + 0x2c00)
+#define SPI1_BASE           (PERIPH_BASE_APB2 + 0x3000)
+#define USART1_BASE         (PERIPH_BASE_APB2 + 0x3800)
+
+// AHB
+#define DMA1_BASE           (PERIPH_BASE_AHB + 0x08000)
+#define RCC_BASE            (PERIPH_BASE_AHB + 0x09000)
+#define FLASH_MEM_INTERFACE_BASE (PERIPH_BASE_AHB + 0x0a000)
+#define CRC_BASE            (PERIPH_BASE_AHB + 0x0b000)
+
+// Periféricos del Cortex-M3
+#define PPBI_BASE           (0xE0000000U)
+#define DWT_BASE            (PPBI_BASE + 0x1000)
+#define SCS_BASE            (PPBI_BASE + 0xE000)
+#define SYS_TICK_BASE       (SCS_BASE + 0x0010)
+#define NVIC_BASE           (SCS_BASE + 0x0100)
+#define SCB_BASE            (SCS_BASE + 0x0D00)
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef LIBOPENCM3_RCC_H
+#define LIBOPENCM3_RCC_H
+
+#include <libopencm3/cm3/common.h>
+#include <libopencm3/stm32/memorymap.h>
+
+// Clocks de los periféricos. En el simulador habilitar un clock no tiene efecto
+enum rcc_periph_clken {
+    RCC_AFIO,
+    RCC_GPIOA,
+    RCC_GPIOB,
+    RCC_GPIOC,
+    RCC_ADC1,
+    RCC_TIM1,
+    RCC_SPI1,
+    RCC_USART1,
+    RCC_TIM2,
+    RCC_TIM3,
+    RCC_TIM4,
+    RCC_WWDG,
+    RCC_SPI2,
+    RCC_USART2,
+    RCC_USART3,
+    RCC_I2C1,
+    RCC_I2C2,
+    RCC_BKP,
+    RCC_PWR,
+    RCC_DMA1,
+    RCC_CRC,
+};
+
+enum rcc_periph_rst {
+    RST_AFIO,
+    RST_GPIOA,
+    RST_GPIOB,
+    RST_GPIOC,
+    RST_ADC1,
+    RST_TIM1,
+    RST_SPI1,
+    RST_USART1,
+    RST_TIM2,
+    RST_TIM3,
+    RST_TIM4,
+    RST_WWDG,
+    RST_SPI2,
+    RST_USART2,
+    RST_USART3,
+    RST_I2C1,
+    RST_I2C2,
+    RST_BKP,
+    RST_PWR,
+};
+
+#define RCC_CSR MMIO32(RCC_BASE + 0x24)
+
+// RCC_CSR: causa del último reset. Se borran escribiendo RMVF
+#define RCC_CSR_LPWRRSTF (1 << 31)
+#define RCC_CSR_WWDGRSTF (1 << 30)
+#define RCC_CSR_IWDGRSTF (1 << 29)
+#define RCC_CSR_SFTRSTF  (1 << 28)
+#define RCC_CSR_PORRSTF  (1 << 27)
+#define RCC_CSR_PINRSTF  (1 << 26)
+#define RCC_CSR_RMVF     (1 << 24)
+
+extern uint32_t rcc_ahb_frequency;
+extern uint32_t rcc_apb1_frequency;
+extern uint32_t rcc_apb2_frequency;
+
+void rcc_periph_clock_enable(enum rcc_periph_clken clken);
+void rcc_periph_clock_disable(enum rcc_periph_clken clken);
+void rcc_periph_reset_pulse(enum rcc_periph_rst rst);
+void rcc_clock_setup_in_hse_8mhz_out_72mhz(void);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef LIBOPENCM3_USART_H
+#define LIBOPENCM3_USART_H
+
+#include <libopencm3/cm3/common.h>
+#include <libopencm3/stm32/memorymap.h>
+
+#define USART1 USART1_BASE
+#define USART2 USART2_BASE
+#define USART3 USART3_BASE
+
+// Registros
+#define USART_SR(usart)  MMIO32((usart) + 0x00)
+#define USART_DR(usart)  MMIO32((usart) + 0x04)
+#define USART_BRR(usart) MMIO32((usart) + 0x08)
+#define USART_CR1(usart) MMIO32((usart) + 0x0c)
+#define USART_CR2(usart) MMIO32((usart) + 0x10)
+#define USART_CR3(usart) MMIO32((usart) + 0x14)
+
+// USART_SR
+#define USART_SR_TXE  (1 << 7)
+#define USART_SR_TC   (1 << 6)
+#define USART_SR_RXNE (1 << 5)
+#define USART_SR_IDLE (1 << 4)
+#define USART_SR_ORE  (1 << 3)
+#define USART_SR_NE   (1 << 2)
+#define USART_SR_FE   (1 << 1)
+#define USART_SR_PE   (1 << 0)
+
+// USART_CR1
+#define USART_CR1_UE     (1 << 13)
+#define USART_CR1_M      (1 << 12)
+#define USART_CR1_PCE    (1 << 10)
+#define USART_CR1_PS     (1 << 9)
+#define USART_CR1_TXEIE  (1 << 7)
+#define USART_CR1_TCIE   (1 << 6)
+#define USART_CR1_RXNEIE (1 << 5)
+#define USART_CR1_TE     (1 << 3)
+#define USART_CR1_RE     (1 << 2)
+
+// USART_CR2
+#define USART_CR2_STOPBITS_MASK (3 << 12)
+
+// USART_CR3
+#define USART_CR3_CTSE (1 << 9)
+#define USART_CR3_RTSE (1 << 8)
+
+// Parámetros
+#define USART_STOPBITS_1      (0x00 << 12)
+#define USART_STOPBITS_0_5    (0x01 << 12)
+#define USART_STOPBITS_2      (0x02 << 12)
+#define USART_STOPBITS_1_5    (0x03 << 12)
+
+#define USART_MODE_RX         USART_CR1_RE
+#define USART_MODE_TX         USART_CR1_TE
+#define USART_MODE_TX_RX      (USART_CR1_RE | USART_CR1_TE)
+#define USART_MODE_MASK       (USART_CR1_RE | USART_CR1_TE)
+
+#define USART_PARITY_NONE     0x00
+#define USART_PARITY_EVEN     USART_CR1_PCE
+#define USART_PARITY_ODD      (USART_CR1_PS | USART_CR1_PCE)
+#define USART_PARITY_MASK     (USART_CR1_PS | USART_CR1_PCE)
+
+#define USART_FLOWCONTROL_NONE    0x00
+#define USART_FLOWCONTROL_RTS_CTS (USART_CR3_RTSE | USART_CR3_CTSE)
+#define USART_FLOWCONTROL_MASK    (USART_CR3_RTSE | USART_CR3_CTSE)
+
+void usart_set_baudrate(uint32_t usart, uint32_t baud);
+void usart_set_databits(uint32_t usart, uint32_t bits);
+void usart_set_stopbits(uint32_t usart, uint32_t stopbits);
+void usart_set_parity(uint32_t usart, uint32_t parity);
+void usart_set_mode(uint32_t usart, uint32_t mode);
+void usart_set_flow_control(uint32_t usart, uint32_t flowcontrol);
+void usart_enable(uint32_t usart);
+void usart_disable(uint32_t usart);
+void usart_send(uint32_t usart, uint16_t data);
+uint16_t usart_recv(uint32_t usart);
+void usart_send_blocking(uint32_t usart, uint16_t data);
+uint16_t usart_recv_blocking(uint32_t usart);
+void usart_enable_rx_interrupt(uint32_t usart);
+void usart_disable_rx_interrupt(uint32_t usart);
+void usart_enable_tx_interrupt(uint32_t usart);
+void usart_disable_tx_interrupt(uint32_t usart);
+bool usart_get_flag(uint32_t usart, uint32_t flag);
+
+#endif
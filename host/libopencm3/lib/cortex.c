@@ -0,0 +1,37 @@
+#include "FreeRTOS.h"
+
+#include <libopencm3/cm3/cortex.h>
+#include <libopencm3/cm3/dwt.h>
+
+#include "sim.h"
+
+void cm_enable_interrupts(void) {
+    vPortEnableInterrupts();
+}
+
+void cm_disable_interrupts(void) {
+    vPortDisableInterrupts();
+}
+
+bool cm_is_masked_interrupts(void) {
+    UBaseType_t masked = xPortSetInterruptMask();
+    vPortClearInterruptMask(masked);
+    return masked != 0;
+}
+
+uint32_t cm_mask_interrupts(uint32_t mask) {
+    UBaseType_t masked = xPortSetInterruptMask();
+    if (!mask) vPortClearInterruptMask(0);
+    return masked != 0;
+}
+
+uint32_t sim_dwt_cyccnt(void) {
+    return (uint32_t)(sim_time_ns() * 72 / 1000);
+}
+
+uint32_t sim_dwt_ctrl;
+
+bool dwt_enable_cycle_counter(void) {
+    sim_dwt_ctrl |= DWT_CTRL_CYCCNTENA;
+    return true;
+}
@@ -0,0 +1,122 @@
+#include <libopencm3/stm32/dma.h>
+
+#include "sim.h"
+
+// Mismo comportamiento que libopencm3 sobre los registros. Habilitar o deshabilitar un
+// canal se avisa al simulador, que arranca o aborta la transferencia del periférico
+
+static void dma_modify_ccr(uint32_t dma, uint8_t channel, uint32_t set, uint32_t clear) {
+    sim_lock();
+    DMA_CCR(dma, channel) = (DMA_CCR(dma, channel) & ~clear) | set;
+    sim_dma_update(dma, channel);
+    sim_unlock();
+}
+
+void dma_channel_reset(uint32_t dma, uint8_t channel) {
+    sim_lock();
+    DMA_CCR(dma, channel) = 0;
+    DMA_CNDTR(dma, channel) = 0;
+    DMA_CPAR(dma, channel) = 0;
+    DMA_CMAR(dma, channel) = 0;
+    DMA_ISR(dma) &= ~(DMA_FLAGS << DMA_FLAG_OFFSET(channel));
+    sim_dma_update(dma, channel);
+    sim_unlock();
+}
+
+void dma_clear_interrupt_flags(uint32_t dma, uint8_t channel, uint32_t interrupts) {
+    sim_lock();
+    DMA_ISR(dma) &= ~(interrupts << DMA_FLAG_OFFSET(channel));
+    sim_unlock();
+}
+
+bool dma_get_interrupt_flag(uint32_t dma, uint8_t channel, uint32_t interrupts) {
+    return (DMA_ISR(dma) & (interrupts << DMA_FLAG_OFFSET(channel))) != 0;
+}
+
+void dma_set_priority(uint32_t dma, uint8_t channel, uint32_t prio) {
+    dma_modify_ccr(dma, channel, prio, DMA_CCR_PL_MASK);
+}
+
+void dma_set_memory_size(uint32_t dma, uint8_t channel, uint32_t mem_size) {
+    dma_modify_ccr(dma, channel, mem_size, DMA_CCR_MSIZE_MASK);
+}
+
+void dma_set_peripheral_size(uint32_t dma, uint8_t channel, uint32_t peripheral_size) {
+    dma_modify_ccr(dma, channel, peripheral_size, DMA_CCR_PSIZE_MASK);
+}
+
+void dma_enable_memory_increment_mode(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, DMA_CCR_MINC, 0);
+}
+
+void dma_disable_memory_increment_mode(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, 0, DMA_CCR_MINC);
+}
+
+void dma_enable_peripheral_increment_mode(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, DMA_CCR_PINC, 0);
+}
+
+void dma_disable_peripheral_increment_mode(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, 0, DMA_CCR_PINC);
+}
+
+void dma_enable_circular_mode(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, DMA_CCR_CIRC, 0);
+}
+
+void dma_set_read_from_peripheral(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, 0, DMA_CCR_DIR);
+}
+
+void dma_set_read_from_memory(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, DMA_CCR_DIR, 0);
+}
+
+void dma_enable_transfer_complete_interrupt(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, DMA_CCR_TCIE, 0);
+}
+
+void dma_disable_transfer_complete_interrupt(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, 0, DMA_CCR_TCIE);
+}
+
+void dma_enable_half_transfer_interrupt(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, DMA_CCR_HTIE, 0);
+}
+
+void dma_disable_half_transfer_interrupt(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, 0, DMA_CCR_HTIE);
+}
+
+void dma_enable_transfer_error_interrupt(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, DMA_CCR_TEIE, 0);
+}
+
+void dma_disable_transfer_error_interrupt(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, 0, DMA_CCR_TEIE);
+}
+
+void dma_enable_channel(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, DMA_CCR_EN, 0);
+}
+
+void dma_disable_channel(uint32_t dma, uint8_t channel) {
+    dma_modify_ccr(dma, channel, 0, DMA_CCR_EN);
+}
+
+void dma_set_peripheral_address(uint32_t dma, uint8_t channel, uint32_t address) {
+    DMA_CPAR(dma, channel) = address;
+}
+
+void dma_set_memory_address(uint32_t dma, uint8_t channel, uint32_t address) {
+    DMA_CMAR(dma, channel) = address;
+}
+
+void dma_set_number_of_data(uint32_t dma, uint8_t channel, uint16_t number) {
+    DMA_CNDTR(dma, channel) = number;
+}
+
+uint16_t dma_get_number_of_data(uint32_t dma, uint8_t channel) {
+    return DMA_CNDTR(dma, channel);
+}
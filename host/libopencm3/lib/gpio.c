@@ -0,0 +1,56 @@
+#include <libopencm3/stm32/gpio.h>
+
+#include "sim.h"
+
+// Los pines de salida se reflejan en IDR. Los cambios de ODR se avisan al simulador, que
+// los usa, por ejemplo, como chip select de los dispositivos SPI
+
+static void gpio_write_odr(uint32_t gpioport, uint16_t value) {
+    sim_lock();
+    uint16_t old = GPIO_ODR(gpioport);
+    GPIO_ODR(gpioport) = value;
+    GPIO_IDR(gpioport) = value;
+    if (old != value) sim_gpio_write(gpioport, old, value);
+    sim_unlock();
+}
+
+void gpio_set_mode(uint32_t gpioport, uint8_t mode, uint8_t cnf, uint16_t gpios) {
+    sim_lock();
+    for (uint8_t i = 0; i < 16; i++) {
+        if (!(gpios & (1 << i))) continue;
+        volatile uint32_t *cr = i < 8 ? &GPIO_CRL(gpioport) : &GPIO_CRH(gpioport);
+        uint8_t shift = (i % 8) * 4;
+        *cr = (*cr & ~(0xfu << shift)) | ((uint32_t)((cnf << 2) | mode) << shift);
+    }
+    sim_unlock();
+}
+
+void gpio_set(uint32_t gpioport, uint16_t gpios) {
+    sim_lock();
+    gpio_write_odr(gpioport, GPIO_ODR(gpioport) | gpios);
+    sim_unlock();
+}
+
+void gpio_clear(uint32_t gpioport, uint16_t gpios) {
+    sim_lock();
+    gpio_write_odr(gpioport, GPIO_ODR(gpioport) & ~gpios);
+    sim_unlock();
+}
+
+uint16_t gpio_get(uint32_t gpioport, uint16_t gpios) {
+    return GPIO_IDR(gpioport) & gpios;
+}
+
+void gpio_toggle(uint32_t gpioport, uint16_t gpios) {
+    sim_lock();
+    gpio_write_odr(gpioport, GPIO_ODR(gpioport) ^ gpios);
+    sim_unlock();
+}
+
+uint16_t gpio_port_read(uint32_t gpioport) {
+    return GPIO_IDR(gpioport);
+}
+
+void gpio_port_write(uint32_t gpioport, uint16_t data) {
+    gpio_write_odr(gpioport, data);
+}
@@ -0,0 +1,28 @@
+#include <libopencm3/stm32/i2c.h>
+
+// Mismo comportamiento que libopencm3 sobre los registros
+
+void i2c_peripheral_enable(uint32_t i2c) {
+    I2C_CR1(i2c) |= I2C_CR1_PE;
+}
+
+void i2c_peripheral_disable(uint32_t i2c) {
+    I2C_CR1(i2c) &= ~I2C_CR1_PE;
+}
+
+void i2c_set_own_7bit_slave_address(uint32_t i2c, uint8_t slave) {
+    I2C_OAR1(i2c) = (uint32_t)slave << 1;
+    I2C_OAR1(i2c) &= ~I2C_OAR1_ADDMODE;
+    I2C_OAR1(i2c) |= (1 << 14);     // Tiene que quedar en 1 (RM0008)
+}
+
+void i2c_set_speed(uint32_t i2c, enum i2c_speeds speed, uint32_t clock_megahz) {
+    I2C_CR2(i2c) = (I2C_CR2(i2c) & ~0x3f) | clock_megahz;
+    if (speed == i2c_speed_sm_100k) {
+        I2C_CCR(i2c) = clock_megahz * 5;
+        I2C_TRISE(i2c) = clock_megahz + 1;
+    } else {
+        I2C_CCR(i2c) = (1 << 15) | ((clock_megahz * 10 + 12) / 12);
+        I2C_TRISE(i2c) = clock_megahz * 3 / 10 + 1;
+    }
+}
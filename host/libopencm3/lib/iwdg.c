@@ -0,0 +1,48 @@
+#include <libopencm3/stm32/iwdg.h>
+
+#include "sim.h"
+
+// Mismo cálculo que libopencm3: el contador baja a la frecuencia del LSI (40 kHz) dividida
+// por el prescaler. El modelo lee las claves que se escriben en KR
+
+#define LSI_FREQUENCY 40000
+#define COUNT_MAX     0xfff
+
+static void iwdg_write_key(uint32_t key) {
+    sim_lock();
+    IWDG_KR = key;
+    sim_iwdg_update();
+    sim_unlock();
+}
+
+void iwdg_start(void) {
+    iwdg_write_key(IWDG_KR_START);
+}
+
+void iwdg_set_period_ms(uint32_t period) {
+    // Prescaler de 4 << pr: el menor con el que la cuenta entra en 12 bits
+    uint32_t count = period * (LSI_FREQUENCY / 1000);
+    uint8_t pr = 0;
+    while (pr < 6 && (count >> (pr + 2)) > COUNT_MAX) pr++;
+    count >>= pr + 2;
+    if (count > COUNT_MAX) count = COUNT_MAX;
+
+    iwdg_write_key(IWDG_KR_UNLOCK);
+    sim_lock();
+    IWDG_PR = pr;
+    IWDG_RLR = count > 0 ? count - 1 : 0;
+    sim_iwdg_update();
+    sim_unlock();
+}
+
+bool iwdg_reload_busy(void) {
+    return IWDG_SR & IWDG_SR_RVU;
+}
+
+bool iwdg_prescaler_busy(void) {
+    return IWDG_SR & IWDG_SR_PVU;
+}
+
+void iwdg_reset(void) {
+    iwdg_write_key(IWDG_KR_RESET);
+}
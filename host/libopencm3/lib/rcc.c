@@ -0,0 +1,25 @@
+#include <libopencm3/stm32/rcc.h>
+
+// Frecuencias después de rcc_clock_setup_in_hse_8mhz_out_72mhz(), que es lo que usa el
+// firmware. Se inicializan así para que los drivers funcionen aunque no se llame
+uint32_t rcc_ahb_frequency = 72000000;
+uint32_t rcc_apb1_frequency = 36000000;
+uint32_t rcc_apb2_frequency = 72000000;
+
+void rcc_periph_clock_enable(enum rcc_periph_clken clken) {
+    (void)clken;
+}
+
+void rcc_periph_clock_disable(enum rcc_periph_clken clken) {
+    (void)clken;
+}
+
+void rcc_periph_reset_pulse(enum rcc_periph_rst rst) {
+    (void)rst;
+}
+
+void rcc_clock_setup_in_hse_8mhz_out_72mhz(void) {
+    rcc_ahb_frequency = 72000000;
+    rcc_apb1_frequency = 36000000;
+    rcc_apb2_frequency = 72000000;
+}
@@ -0,0 +1,91 @@
+#include <libopencm3/stm32/spi.h>
+
+#include "sim.h"
+
+// Mismo comportamiento que libopencm3 sobre los registros. Habilitar el periférico o los
+// pedidos de DMA se avisa al modelo del bus, que arranca la transferencia
+
+static void spi_modify(uint32_t spi, volatile uint32_t *reg, uint32_t set, uint32_t clear) {
+    sim_lock();
+    *reg = (*reg & ~clear) | set;
+    sim_spi_update(spi);
+    sim_unlock();
+}
+
+void spi_reset(uint32_t spi_peripheral) {
+    sim_lock();
+    SPI_CR1(spi_peripheral) = 0;
+    SPI_CR2(spi_peripheral) = 0;
+    SPI_SR(spi_peripheral) = SPI_SR_TXE;
+    sim_spi_update(spi_peripheral);
+    sim_unlock();
+}
+
+int spi_init_master(uint32_t spi, uint32_t br, uint32_t cpol, uint32_t cpha, uint32_t dff, uint32_t lsbfirst) {
+    sim_lock();
+    uint32_t reg32 = SPI_CR1(spi);
+    reg32 &= SPI_CR1_SPE | SPI_CR1_CRCEN | SPI_CR1_CRCNEXT;
+    reg32 |= SPI_CR1_MSTR | br | cpol | cpha | dff | lsbfirst;
+    SPI_CR2(spi) |= SPI_CR2_SSOE;
+    SPI_CR1(spi) = reg32;
+    sim_spi_update(spi);
+    sim_unlock();
+    return 0;
+}
+
+void spi_enable(uint32_t spi) {
+    spi_modify(spi, &SPI_CR1(spi), SPI_CR1_SPE, 0);
+}
+
+void spi_disable(uint32_t spi) {
+    spi_modify(spi, &SPI_CR1(spi), 0, SPI_CR1_SPE);
+}
+
+uint16_t spi_xfer(uint32_t spi, uint16_t data) {
+    return sim_spi_xfer(spi, (uint8_t)data);
+}
+
+void spi_send(uint32_t spi, uint16_t data) {
+    sim_spi_xfer(spi, (uint8_t)data);
+}
+
+uint16_t spi_read(uint32_t spi) {
+    return SPI_DR(spi);
+}
+
+void spi_set_baudrate_prescaler(uint32_t spi, uint8_t baudrate) {
+    if (baudrate > 7) return;
+    spi_modify(spi, &SPI_CR1(spi), (uint32_t)baudrate << 3, 0x7 << 3);
+}
+
+void spi_enable_software_slave_management(uint32_t spi) {
+    spi_modify(spi, &SPI_CR1(spi), SPI_CR1_SSM, 0);
+}
+
+void spi_disable_software_slave_management(uint32_t spi) {
+    spi_modify(spi, &SPI_CR1(spi), 0, SPI_CR1_SSM);
+}
+
+void spi_set_nss_high(uint32_t spi) {
+    spi_modify(spi, &SPI_CR1(spi), SPI_CR1_SSI, 0);
+}
+
+void spi_set_nss_low(uint32_t spi) {
+    spi_modify(spi, &SPI_CR1(spi), 0, SPI_CR1_SSI);
+}
+
+void spi_enable_tx_dma(uint32_t spi) {
+    spi_modify(spi, &SPI_CR2(spi), SPI_CR2_TXDMAEN, 0);
+}
+
+void spi_disable_tx_dma(uint32_t spi) {
+    spi_modify(spi, &SPI_CR2(spi), 0, SPI_CR2_TXDMAEN);
+}
+
+void spi_enable_rx_dma(uint32_t spi) {
+    spi_modify(spi, &SPI_CR2(spi), SPI_CR2_RXDMAEN, 0);
+}
+
+void spi_disable_rx_dma(uint32_t spi) {
+    spi_modify(spi, &SPI_CR2(spi), 0, SPI_CR2_RXDMAEN);
+}
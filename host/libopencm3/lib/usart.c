@@ -0,0 +1,94 @@
+#include <libopencm3/stm32/usart.h>
+#include <libopencm3/stm32/rcc.h>
+
+#include "sim.h"
+
+// Mismo comportamiento que libopencm3 sobre los registros. Los cambios de configuración se
+// avisan al modelo (arranca la recepción, genera interrupciones pendientes) y escribir DR
+// le pasa el byte a transmitir
+
+static void usart_modify(uint32_t usart, volatile uint32_t *reg, uint32_t set, uint32_t clear) {
+    sim_lock();
+    *reg = (*reg & ~clear) | set;
+    sim_usart_update(usart);
+    sim_unlock();
+}
+
+void usart_set_baudrate(uint32_t usart, uint32_t baud) {
+    uint32_t clock = usart == USART1 ? rcc_apb2_frequency : rcc_apb1_frequency;
+    sim_lock();
+    USART_BRR(usart) = (clock + baud / 2) / baud;
+    sim_usart_update(usart);
+    sim_unlock();
+}
+
+void usart_set_databits(uint32_t usart, uint32_t bits) {
+    usart_modify(usart, &USART_CR1(usart), bits == 8 ? 0 : USART_CR1_M, USART_CR1_M);
+}
+
+void usart_set_stopbits(uint32_t usart, uint32_t stopbits) {
+    usart_modify(usart, &USART_CR2(usart), stopbits, USART_CR2_STOPBITS_MASK);
+}
+
+void usart_set_parity(uint32_t usart, uint32_t parity) {
+    usart_modify(usart, &USART_CR1(usart), parity, USART_PARITY_MASK);
+}
+
+void usart_set_mode(uint32_t usart, uint32_t mode) {
+    usart_modify(usart, &USART_CR1(usart), mode, USART_MODE_MASK);
+}
+
+void usart_set_flow_control(uint32_t usart, uint32_t flowcontrol) {
+    usart_modify(usart, &USART_CR3(usart), flowcontrol, USART_FLOWCONTROL_MASK);
+}
+
+void usart_enable(uint32_t usart) {
+    usart_modify(usart, &USART_CR1(usart), USART_CR1_UE, 0);
+}
+
+void usart_disable(uint32_t usart) {
+    usart_modify(usart, &USART_CR1(usart), 0, USART_CR1_UE);
+}
+
+void usart_send(uint32_t usart, uint16_t data) {
+    sim_usart_send(usart, data);
+}
+
+// Leer DR baja RXNE y ORE, como la secuencia de lectura de SR y DR del hardware
+uint16_t usart_recv(uint32_t usart) {
+    sim_lock();
+    uint16_t data = USART_DR(usart) & 0x1FF;
+    USART_SR(usart) &= ~(USART_SR_RXNE | USART_SR_ORE);
+    sim_unlock();
+    return data;
+}
+
+void usart_send_blocking(uint32_t usart, uint16_t data) {
+    while (!usart_get_flag(usart, USART_SR_TXE)) sim_poll();
+    usart_send(usart, data);
+}
+
+uint16_t usart_recv_blocking(uint32_t usart) {
+    while (!usart_get_flag(usart, USART_SR_RXNE)) sim_poll();
+    return usart_recv(usart);
+}
+
+void usart_enable_rx_interrupt(uint32_t usart) {
+    usart_modify(usart, &USART_CR1(usart), USART_CR1_RXNEIE, 0);
+}
+
+void usart_disable_rx_interrupt(uint32_t usart) {
+    usart_modify(usart, &USART_CR1(usart), 0, USART_CR1_RXNEIE);
+}
+
+void usart_enable_tx_interrupt(uint32_t usart) {
+    usart_modify(usart, &USART_CR1(usart), USART_CR1_TXEIE, 0);
+}
+
+void usart_disable_tx_interrupt(uint32_t usart) {
+    usart_modify(usart, &USART_CR1(usart), 0, USART_CR1_TXEIE);
+}
+
+bool usart_get_flag(uint32_t usart, uint32_t flag) {
+    return (USART_SR(usart) & flag) != 0;
+}
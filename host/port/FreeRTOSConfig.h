@@ -0,0 +1,35 @@
+#ifndef HOST_FREERTOS_CONFIG_H
+#define HOST_FREERTOS_CONFIG_H
+
+// Configuración de FreeRTOS para el build en el host. Se incluye antes que cualquier
+// fuente (-include en el Makefile): FreeRTOS.h busca FreeRTOSConfig.h y portmacro.h
+// primero en lib/rtos, donde están los del Cortex-M3. Se toma la configuración del
+// firmware, se ajusta lo que depende del port y se define el port POSIX antes de que
+// FreeRTOS.h llegue a incluir los de lib/rtos.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../lib/rtos/FreeRTOSConfig.h"
+
+// Las pilas de FreeRTOS tienen palabras de 64 bits y solo guardan el estado del hilo
+// (ver port.c), así que el heap se agranda para las mismas profundidades de pila
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE ( ( size_t ) ( 256 * 1024 ) )
+
+// Mismo motivo para el presupuesto del manifiesto (src/manifest.h): las pilas y los
+// punteros ocupan el doble
+#define MANIFEST_RAM_BUDGET (64 * 1024)
+
+// La tarea idle duerme el hilo hasta la próxima señal en lugar de girar
+#undef configUSE_IDLE_HOOK
+#define configUSE_IDLE_HOOK 1
+
+// Con tiempo virtual (sim.h) el reloj saltea los ticks en que todas las tareas están
+// bloqueadas. Con tiempo real el tickless idle no hace nada
+#undef configUSE_TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE 1
+
+#include "portmacro.h"
+
+#endif
@@ -0,0 +1,358 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Port POSIX de FreeRTOS. Cada tarea corre en un hilo propio y un hilo solo avanza cuando
+// su tarea es la actual; el resto espera en su evento. El cambio de contexto despierta
+// al hilo de la nueva tarea y duerme al de la anterior.
+//
+// El firmware guarda punteros en registros de 32 bits (direcciones de DMA, por ejemplo),
+// así que todo lo que pueda terminar ahí tiene que estar en los primeros 4 GB: el binario
+// se enlaza sin PIE y las pilas de los hilos se reservan con MAP_32BIT.
+
+#define portTHREAD_STACK_SIZE (256 * 1024)
+#define portSIGNAL_TICK SIGALRM
+#define portSIGNAL_IRQ  SIGUSR1
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int set;
+} Event_t;
+
+// Estado del hilo de una tarea. Se guarda en el tope de la pila de FreeRTOS, que el port
+// no usa: pxTopOfStack, el primer campo del TCB, apunta siempre a esta estructura
+typedef struct {
+    pthread_t thread;
+    TaskFunction_t pxCode;
+    void *pvParams;
+    void *pvStack;
+    volatile BaseType_t xDying;
+    Event_t xEvent;
+} Thread_t;
+
+static sigset_t xIrqSignals;                  // Señales que hacen de interrupciones
+static pthread_once_t xInitOnce = PTHREAD_ONCE_INIT;
+static Event_t xSchedulerEnd;
+static volatile BaseType_t xInHandler;        // Corriendo el manejador de una señal
+static volatile BaseType_t xSwitchPending;    // Cambio de contexto pedido desde una ISR
+static void (*volatile pxIrqHandler)(void);
+static const PortVirtualTime_t *pxVirtualTime; // NULL: tiempo real
+static volatile BaseType_t xSchedulerStarted;
+
+static void prvEventInit(Event_t *pxEvent) {
+    pthread_mutex_init(&pxEvent->mutex, NULL);
+    pthread_cond_init(&pxEvent->cond, NULL);
+    pxEvent->set = 0;
+}
+
+static void prvEventDestroy(Event_t *pxEvent) {
+    pthread_cond_destroy(&pxEvent->cond);
+    pthread_mutex_destroy(&pxEvent->mutex);
+}
+
+static void prvEventSignal(Event_t *pxEvent) {
+    pthread_mutex_lock(&pxEvent->mutex);
+    pxEvent->set = 1;
+    pthread_cond_signal(&pxEvent->cond);
+    pthread_mutex_unlock(&pxEvent->mutex);
+}
+
+static void prvEventWait(Event_t *pxEvent) {
+    pthread_mutex_lock(&pxEvent->mutex);
+    while (!pxEvent->set)
+        pthread_cond_wait(&pxEvent->cond, &pxEvent->mutex);
+    pxEvent->set = 0;
+    pthread_mutex_unlock(&pxEvent->mutex);
+}
+
+static void prvInit(void) {
+    sigemptyset(&xIrqSignals);
+    sigaddset(&xIrqSignals, portSIGNAL_TICK);
+    sigaddset(&xIrqSignals, portSIGNAL_IRQ);
+    prvEventInit(&xSchedulerEnd);
+}
+
+static Thread_t *prvGetThread(void *pvTask) {
+    return (Thread_t *)*(StackType_t **)pvTask;
+}
+
+static Thread_t *prvCurrentThread(void) {
+    return prvGetThread(xTaskGetCurrentTaskHandle());
+}
+
+// Espera a que el planificador elija de nuevo a la tarea. Si mientras tanto otra tarea
+// la borró, el hilo termina
+static void prvSuspendSelf(Thread_t *pxThread) {
+    prvEventWait(&pxThread->xEvent);
+    if (pxThread->xDying) pthread_exit(NULL);
+}
+
+static void prvSwitchThread(Thread_t *pxTo, Thread_t *pxFrom) {
+    if (pxTo == pxFrom) return;
+    prvEventSignal(&pxTo->xEvent);
+
+    // La tarea se borró a sí misma: su hilo no vuelve a correr
+    if (pxFrom->xDying) pthread_exit(NULL);
+    prvSuspendSelf(pxFrom);
+}
+
+static void *prvThreadStart(void *pvParams) {
+    Thread_t *pxThread = pvParams;
+
+    prvSuspendSelf(pxThread);
+
+    // Las tareas arrancan con las interrupciones habilitadas
+    pthread_sigmask(SIG_UNBLOCK, &xIrqSignals, NULL);
+    pxThread->pxCode(pxThread->pvParams);
+
+    // Una tarea no debería retornar
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters) {
+    pthread_once(&xInitOnce, prvInit);
+
+    uintptr_t xTop = (uintptr_t)(pxTopOfStack + 1) - sizeof(Thread_t);
+    Thread_t *pxThread = (Thread_t *)(xTop & ~(uintptr_t)portBYTE_ALIGNMENT_MASK);
+
+    memset(pxThread, 0, sizeof(*pxThread));
+    pxThread->pxCode = pxCode;
+    pxThread->pvParams = pvParameters;
+    prvEventInit(&pxThread->xEvent);
+
+    pxThread->pvStack = mmap(NULL, portTHREAD_STACK_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_32BIT, -1, 0);
+    if (pxThread->pvStack == MAP_FAILED) {
+        perror("port: mmap");
+        abort();
+    }
+
+    pthread_attr_t xAttr;
+    pthread_attr_init(&xAttr);
+    pthread_attr_setstack(&xAttr, pxThread->pvStack, portTHREAD_STACK_SIZE);
+
+    // El hilo hereda la máscara: nace con las interrupciones bloqueadas
+    sigset_t xOld;
+    pthread_sigmask(SIG_BLOCK, &xIrqSignals, &xOld);
+    int iError = pthread_create(&pxThread->thread, &xAttr, prvThreadStart, pxThread);
+    pthread_sigmask(SIG_SETMASK, &xOld, NULL);
+    pthread_attr_destroy(&xAttr);
+
+    if (iError != 0) {
+        fprintf(stderr, "port: pthread_create: %s\n", strerror(iError));
+        abort();
+    }
+    return (StackType_t *)pxThread;
+}
+
+// Cambio de contexto desde el manejador de una señal, al terminar la "interrupción"
+static void prvSwitchFromHandler(void) {
+    Thread_t *pxFrom = prvCurrentThread();
+    vTaskSwitchContext();
+    prvSwitchThread(prvCurrentThread(), pxFrom);
+}
+
+static void prvEndHandler(void) {
+    xInHandler = pdFALSE;
+    if (xSwitchPending) {
+        xSwitchPending = pdFALSE;
+        prvSwitchFromHandler();
+    }
+}
+
+static void prvTickHandler(int iSignal) {
+    (void)iSignal;
+    xInHandler = pdTRUE;
+    if (xTaskIncrementTick() != pdFALSE) xSwitchPending = pdTRUE;
+    prvEndHandler();
+}
+
+static void prvIrqHandler(int iSignal) {
+    (void)iSignal;
+    xInHandler = pdTRUE;
+    if (pxIrqHandler != NULL) pxIrqHandler();
+    prvEndHandler();
+}
+
+BaseType_t xPortStartScheduler(void) {
+    pthread_once(&xInitOnce, prvInit);
+
+    // Este hilo no ejecuta tareas: no debe recibir interrupciones
+    pthread_sigmask(SIG_BLOCK, &xIrqSignals, NULL);
+
+    struct sigaction xAction;
+    memset(&xAction, 0, sizeof(xAction));
+    xAction.sa_mask = xIrqSignals;
+    xAction.sa_flags = SA_RESTART;
+    xAction.sa_handler = prvTickHandler;
+    sigaction(portSIGNAL_TICK, &xAction, NULL);
+    xAction.sa_handler = prvIrqHandler;
+    sigaction(portSIGNAL_IRQ, &xAction, NULL);
+    xSchedulerStarted = pdTRUE;
+
+    // Con tiempo virtual el tick lo genera el simulador
+    if (pxVirtualTime == NULL) {
+        struct itimerval xTimer;
+        xTimer.it_interval.tv_sec = 0;
+        xTimer.it_interval.tv_usec = 1000000 / configTICK_RATE_HZ;
+        xTimer.it_value = xTimer.it_interval;
+        setitimer(ITIMER_REAL, &xTimer, NULL);
+    }
+
+    // Arrancar la primera tarea y esperar a que alguna termine el planificador
+    prvEventSignal(&prvCurrentThread()->xEvent);
+    prvEventWait(&xSchedulerEnd);
+    return 0;
+}
+
+void vPortEndScheduler(void) {
+    struct itimerval xTimer;
+    memset(&xTimer, 0, sizeof(xTimer));
+    setitimer(ITIMER_REAL, &xTimer, NULL);
+
+    // La tarea que termina el planificador no vuelve a correr
+    Thread_t *pxThread = prvCurrentThread();
+    prvEventSignal(&xSchedulerEnd);
+    for (;;) prvEventWait(&pxThread->xEvent);
+}
+
+void vPortYield(void) {
+    sigset_t xOld;
+    pthread_sigmask(SIG_BLOCK, &xIrqSignals, &xOld);
+
+    Thread_t *pxFrom = prvCurrentThread();
+    vTaskSwitchContext();
+    Thread_t *pxTo = prvCurrentThread();
+
+    // Cedió la CPU sin que hubiera otra tarea lista: está esperando activamente
+    if (pxTo == pxFrom && pxVirtualTime != NULL) pxVirtualTime->pxSpin();
+    prvSwitchThread(pxTo, pxFrom);
+
+    pthread_sigmask(SIG_SETMASK, &xOld, NULL);
+}
+
+void vPortYieldFromISR(void) {
+    if (xInHandler)
+        xSwitchPending = pdTRUE;
+    else
+        vPortYield();
+}
+
+void vPortDisableInterrupts(void) {
+    pthread_sigmask(SIG_BLOCK, &xIrqSignals, NULL);
+}
+
+void vPortEnableInterrupts(void) {
+    pthread_sigmask(SIG_UNBLOCK, &xIrqSignals, NULL);
+}
+
+UBaseType_t xPortSetInterruptMask(void) {
+    sigset_t xOld;
+    pthread_sigmask(SIG_BLOCK, &xIrqSignals, &xOld);
+    return sigismember(&xOld, portSIGNAL_TICK);
+}
+
+void vPortClearInterruptMask(UBaseType_t uxMask) {
+    if (!uxMask) pthread_sigmask(SIG_UNBLOCK, &xIrqSignals, NULL);
+}
+
+void vPortMarkThreadDying(void *pvTaskToDelete) {
+    prvGetThread(pvTaskToDelete)->xDying = pdTRUE;
+}
+
+void vPortCleanUpTCB(void *pvTCB) {
+    Thread_t *pxThread = prvGetThread(pvTCB);
+
+    // Borrada por otra tarea: se despierta el hilo para que termine
+    if (!pxThread->xDying) {
+        pxThread->xDying = pdTRUE;
+        prvEventSignal(&pxThread->xEvent);
+    }
+
+    pthread_join(pxThread->thread, NULL);
+    munmap(pxThread->pvStack, portTHREAD_STACK_SIZE);
+    prvEventDestroy(&pxThread->xEvent);
+}
+
+void vPortSetIrqHandler(void (*pxHandler)(void)) {
+    pxIrqHandler = pxHandler;
+}
+
+void vPortGenerateIrq(void) {
+    kill(getpid(), portSIGNAL_IRQ);
+}
+
+void vPortSetVirtualTime(const PortVirtualTime_t *pxHooks) {
+    pxVirtualTime = pxHooks;
+}
+
+// Antes de arrancar el planificador no hay manejador del tick: se pierden, como con el
+// SysTick apagado
+void vPortGenerateTick(void) {
+    if (xSchedulerStarted) kill(getpid(), portSIGNAL_TICK);
+}
+
+// Sin tareas listas el hilo de la tarea idle duerme hasta la próxima señal (tick o
+// interrupción) en lugar de ocupar un núcleo del host. Las señales se bloquean antes de
+// avisar al simulador para que una que llegue en el medio despierte a sigsuspend()
+void vApplicationIdleHook(void) {
+    sigset_t xMask;
+    pthread_sigmask(SIG_BLOCK, &xIrqSignals, &xMask);
+    if (pxVirtualTime != NULL) pxVirtualTime->pxIdle();
+    sigsuspend(&xMask);
+    pthread_sigmask(SIG_SETMASK, &xMask, NULL);
+}
+
+// Corre en la tarea idle con el planificador suspendido. El último tick del período se
+// deja para el simulador: lo atiende el manejador del tick y despierta a la tarea
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+    if (pxVirtualTime == NULL) return;
+
+    sigset_t xMask;
+    pthread_sigmask(SIG_BLOCK, &xIrqSignals, &xMask);
+    if (eTaskConfirmSleepModeStatus() != eAbortSleep) {
+        TickType_t xSkipped = pxVirtualTime->pxSleep(xExpectedIdleTime - 1);
+        if (xSkipped > 0) vTaskStepTick(xSkipped);
+    }
+    pthread_sigmask(SIG_SETMASK, &xMask, NULL);
+}
+
+// Memoria de las tareas idle y de timers (configSUPPORT_STATIC_ALLOCATION). Son weak:
+// un programa que enlaza src/manifest.c usa las del firmware
+__attribute__((weak)) void vApplicationGetIdleTaskMemory(StaticTask_t **ppxTCB, StackType_t **ppxStack,
+                                                         uint32_t *pulStackSize) {
+    static StaticTask_t xTCB;
+    static StackType_t uxStack[configMINIMAL_STACK_SIZE];
+    *ppxTCB = &xTCB;
+    *ppxStack = uxStack;
+    *pulStackSize = configMINIMAL_STACK_SIZE;
+}
+
+__attribute__((weak)) void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTCB, StackType_t **ppxStack,
+                                                          uint32_t *pulStackSize) {
+    static StaticTask_t xTCB;
+    static StackType_t uxStack[configTIMER_TASK_STACK_DEPTH];
+    *ppxTCB = &xTCB;
+    *ppxStack = uxStack;
+    *pulStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+// Sin memoria en el heap. Weak como las anteriores: src/heapstats.c cuenta las fallas
+__attribute__((weak)) void vApplicationMallocFailedHook(void) {
+}
+
+// Tick (configUSE_TICK_HOOK). src/periodic.c marca el ciclo de cada tick
+__attribute__((weak)) void vApplicationTickHook(void) {
+}
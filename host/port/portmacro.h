@@ -0,0 +1,97 @@
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+// Port POSIX de FreeRTOS: cada tarea es un hilo y solo corre el de la tarea actual. Las
+// interrupciones son señales: SIGALRM es el tick y SIGUSR1 las interrupciones de los
+// periféricos simulados. Deshabilitar interrupciones es bloquear esas señales en el hilo.
+
+#include <stdint.h>
+
+// Tipos
+#define portCHAR          char
+#define portFLOAT         float
+#define portDOUBLE        double
+#define portLONG          long
+#define portSHORT         short
+#define portSTACK_TYPE    unsigned long
+#define portBASE_TYPE     long
+#define portPOINTER_SIZE_TYPE uintptr_t
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if ( configUSE_16_BIT_TICKS == 1 )
+    typedef uint16_t TickType_t;
+    #define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+    typedef uint32_t TickType_t;
+    #define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+    #define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+// Arquitectura
+#define portSTACK_GROWTH      ( -1 )
+#define portTICK_PERIOD_MS    ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT    8
+#define portNOP()
+#define portMEMORY_BARRIER()  __sync_synchronize()
+
+// Planificador
+void vPortYield(void);
+void vPortYieldFromISR(void);
+#define portYIELD()                        vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired ) do { if( xSwitchRequired ) vPortYieldFromISR(); } while( 0 )
+#define portYIELD_FROM_ISR( x )            portEND_SWITCHING_ISR( x )
+
+// Secciones críticas: el anidamiento se guarda en el TCB de cada tarea y la máscara de
+// señales es propia de cada hilo, así que cada tarea recupera su estado al volver a correr
+void vPortDisableInterrupts(void);
+void vPortEnableInterrupts(void);
+UBaseType_t xPortSetInterruptMask(void);
+void vPortClearInterruptMask(UBaseType_t uxMask);
+void vTaskEnterCritical(void);
+void vTaskExitCritical(void);
+
+#define portCRITICAL_NESTING_IN_TCB 1
+#define portDISABLE_INTERRUPTS()            vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()             vPortEnableInterrupts()
+#define portENTER_CRITICAL()                vTaskEnterCritical()
+#define portEXIT_CRITICAL()                 vTaskExitCritical()
+#define portSET_INTERRUPT_MASK_FROM_ISR()   xPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x ) vPortClearInterruptMask( x )
+
+// Borrado de tareas: el hilo termina al salir de la CPU y se espera en la limpieza del TCB
+void vPortMarkThreadDying(void *pvTaskToDelete);
+void vPortCleanUpTCB(void *pvTCB);
+#define portPRE_TASK_DELETE_HOOK( pvTaskToDelete, pxYieldPending ) vPortMarkThreadDying( pvTaskToDelete )
+#define portCLEAN_UP_TCB( pxTCB )          vPortCleanUpTCB( pxTCB )
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void * pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters )       void vFunction( void * pvParameters )
+
+// Interrupciones simuladas: handler se ejecuta en el contexto de interrupción (el manejador
+// de SIGUSR1, sobre el hilo de la tarea que esté corriendo) cada vez que se genera una
+void vPortSetIrqHandler(void (*pxHandler)(void));
+void vPortGenerateIrq(void);
+
+// Tiempo virtual (sim.h): el tick lo genera el simulador con vPortGenerateTick() en lugar
+// de un timer del host, y el port le avisa cuándo la CPU espera. pxIdle corre en la tarea
+// idle antes de dormir hasta la próxima interrupción, pxSpin cuando una tarea cede la CPU
+// y se vuelve a elegir a sí misma (espera activa) y pxSleep en el tickless idle: duerme
+// hasta xMaxTicks ticks o hasta una interrupción y devuelve los ticks salteados. Todos
+// corren con las interrupciones bloqueadas
+typedef struct {
+    void (*pxIdle)(void);
+    void (*pxSpin)(void);
+    TickType_t (*pxSleep)(TickType_t xMaxTicks);
+} PortVirtualTime_t;
+
+void vPortSetVirtualTime(const PortVirtualTime_t *pxHooks);
+void vPortGenerateTick(void);
+
+// Tickless idle (configUSE_TICKLESS_IDLE): solo saltea ticks con tiempo virtual
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+
+#endif
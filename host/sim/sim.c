@@ -0,0 +1,383 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "sim.h"
+
+#include <libopencm3/stm32/memorymap.h>
+#include <libopencm3/cm3/nvic.h>
+
+#define SIM_MAX_EVENTS 64
+
+// Memoria de los registros: periféricos del STM32 y periféricos del Cortex-M3
+#define SIM_PERIPH_SIZE 0x24000
+#define SIM_PPB_SIZE    0x100000
+
+static uint8_t periph_regs[SIM_PERIPH_SIZE] __attribute__((aligned(4)));
+static uint8_t ppb_regs[SIM_PPB_SIZE] __attribute__((aligned(4)));
+
+typedef struct {
+    uint64_t time;
+    sim_event_fn fn;
+    void *arg;
+} sim_event_t;
+
+static pthread_mutex_t sim_mutex;
+static pthread_cond_t sim_cond;
+static pthread_t sim_thread;
+static sim_event_t events[SIM_MAX_EVENTS];  // Ordenados por tiempo
+static uint8_t event_count;
+static struct timespec start;
+
+// Tiempo virtual: no hay hilo del simulador. Cuando la CPU espera, el hilo de la tarea
+// que espera corre los eventos con el lock tomado y las interrupciones bloqueadas, y el
+// reloj salta al tiempo de cada uno
+#define SIM_TICK_NS (1000000000ull / configTICK_RATE_HZ)
+
+typedef struct {
+    uint8_t enabled;
+    uint64_t now;
+    uint8_t awake;              // Se generó una interrupción desde que la CPU espera
+    uint8_t sleeping;           // Tickless idle: saltea hasta sleep_max ticks
+    TickType_t sleep_max;
+    TickType_t sleep_ticks;
+} sim_virtual_t;
+
+static sim_virtual_t virtual;
+
+// Máscara de señales previa al primer sim_lock() del hilo
+static __thread sigset_t saved_mask;
+static __thread uint32_t lock_depth;
+
+volatile uint8_t *sim_mmio(uint32_t addr) {
+    if (addr >= PERIPH_BASE && addr < PERIPH_BASE + SIM_PERIPH_SIZE)
+        return &periph_regs[addr - PERIPH_BASE];
+    if (addr >= PPBI_BASE && addr < PPBI_BASE + SIM_PPB_SIZE)
+        return &ppb_regs[addr - PPBI_BASE];
+
+    fprintf(stderr, "sim: acceso a dirección no mapeada 0x%08x\n", addr);
+    abort();
+}
+
+uint64_t sim_time_ns(void) {
+    if (virtual.enabled) return __atomic_load_n(&virtual.now, __ATOMIC_SEQ_CST);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000000ull + now.tv_nsec - start.tv_nsec;
+}
+
+static void stall_until(uint64_t time);
+
+void sim_spin_ns(uint64_t ns) {
+    uint64_t end = sim_time_ns() + ns;
+    if (virtual.enabled) {
+        sim_lock();
+        stall_until(end);
+        sim_unlock();
+        return;
+    }
+    while (sim_time_ns() < end);
+}
+
+void sim_lock(void) {
+    // Con el lock ya tomado las señales ya están bloqueadas
+    if (lock_depth++ == 0) {
+        sigset_t all;
+        sigfillset(&all);
+        pthread_sigmask(SIG_BLOCK, &all, &saved_mask);
+    }
+    pthread_mutex_lock(&sim_mutex);
+}
+
+void sim_unlock(void) {
+    pthread_mutex_unlock(&sim_mutex);
+    if (--lock_depth == 0) pthread_sigmask(SIG_SETMASK, &saved_mask, NULL);
+}
+
+void sim_schedule(uint64_t delay_ns, sim_event_fn fn, void *arg) {
+    sim_lock();
+    if (event_count == SIM_MAX_EVENTS) {
+        fprintf(stderr, "sim: cola de eventos llena\n");
+        abort();
+    }
+
+    uint64_t time = sim_time_ns() + delay_ns;
+    uint8_t i = event_count++;
+    while (i > 0 && events[i - 1].time > time) {
+        events[i] = events[i - 1];
+        i--;
+    }
+    events[i] = (sim_event_t){ time, fn, arg };
+
+    pthread_cond_signal(&sim_cond);
+    sim_unlock();
+}
+
+static void run_next_event(void) {
+    sim_event_t event = events[0];
+    event_count--;
+    memmove(&events[0], &events[1], event_count * sizeof(events[0]));
+    if (virtual.enabled && event.time > virtual.now)
+        __atomic_store_n(&virtual.now, event.time, __ATOMIC_SEQ_CST);
+    event.fn(event.arg);
+}
+
+// Tiempo virtual
+
+// La interrupción queda pendiente hasta que la CPU deje de esperar
+static void cpu_wake(void) {
+    virtual.awake = 1;
+}
+
+static void generate_irq(void) {
+    if (virtual.enabled) cpu_wake();
+    vPortGenerateIrq();
+}
+
+static void virtual_tick(void *arg) {
+    sim_schedule(SIM_TICK_NS, virtual_tick, arg);
+    if (virtual.sleeping && virtual.sleep_ticks < virtual.sleep_max) {
+        virtual.sleep_ticks++;
+        return;
+    }
+    cpu_wake();
+    vPortGenerateTick();
+}
+
+// Espera activa: corre los eventos hasta time
+static void stall_until(uint64_t time) {
+    while (event_count > 0 && events[0].time <= time)
+        run_next_event();
+    if (virtual.now < time) __atomic_store_n(&virtual.now, time, __ATOMIC_SEQ_CST);
+}
+
+void sim_poll(void) {
+    if (!virtual.enabled) return;
+    sim_lock();
+    // Sin eventos pendientes el hardware no va a cambiar
+    if (event_count > 0) stall_until(events[0].time);
+    sim_unlock();
+}
+
+// Corre eventos hasta que alguno genere una interrupción. Siempre hay al menos uno: el tick
+static void run_until_wake(void) {
+    virtual.awake = 0;
+    while (!virtual.awake && event_count > 0)
+        run_next_event();
+}
+
+static void virtual_idle(void) {
+    sim_lock();
+    run_until_wake();
+    sim_unlock();
+}
+
+static TickType_t virtual_sleep(TickType_t max_ticks) {
+    sim_lock();
+    virtual.sleep_max = max_ticks;
+    virtual.sleep_ticks = 0;
+    virtual.sleeping = 1;
+    run_until_wake();
+    virtual.sleeping = 0;
+    TickType_t ticks = virtual.sleep_ticks;
+    sim_unlock();
+    return ticks;
+}
+
+static const PortVirtualTime_t virtual_hooks = {
+    .pxIdle = virtual_idle,
+    .pxSpin = sim_poll,
+    .pxSleep = virtual_sleep,
+};
+
+static void *sim_thread_main(void *arg) {
+    (void)arg;
+    sim_lock();
+    for (;;) {
+        if (event_count == 0) {
+            pthread_cond_wait(&sim_cond, &sim_mutex);
+            continue;
+        }
+
+        uint64_t now = sim_time_ns();
+        if (events[0].time > now) {
+            uint64_t wake = events[0].time;
+            struct timespec deadline = {
+                .tv_sec = start.tv_sec + (time_t)(wake / 1000000000ull),
+                .tv_nsec = start.tv_nsec + (long)(wake % 1000000000ull),
+            };
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&sim_cond, &sim_mutex, &deadline);
+            continue;
+        }
+
+        run_next_event();
+    }
+    return NULL;
+}
+
+// NVIC
+
+static void (*const vectors[NVIC_IRQ_COUNT])(void) = {
+    wwdg_isr, pvd_isr, tamper_isr, rtc_isr, flash_isr, rcc_isr,
+    exti0_isr, exti1_isr, exti2_isr, exti3_isr, exti4_isr,
+    dma1_channel1_isr, dma1_channel2_isr, dma1_channel3_isr, dma1_channel4_isr,
+    dma1_channel5_isr, dma1_channel6_isr, dma1_channel7_isr,
+    adc1_2_isr, usb_hp_can_tx_isr, usb_lp_can_rx0_isr, can_rx1_isr, can_sce_isr,
+    exti9_5_isr, tim1_brk_isr, tim1_up_isr, tim1_trg_com_isr, tim1_cc_isr,
+    tim2_isr, tim3_isr, tim4_isr,
+    i2c1_ev_isr, i2c1_er_isr, i2c2_ev_isr, i2c2_er_isr,
+    spi1_isr, spi2_isr, usart1_isr, usart2_isr, usart3_isr,
+    exti15_10_isr, rtc_alarm_isr, usb_wakeup_isr,
+};
+
+static uint64_t irq_enabled;
+static uint64_t irq_pending;
+static uint8_t irq_priority[NVIC_IRQ_COUNT];
+
+// Corre en el manejador de la señal de interrupción, sobre el hilo de la tarea actual
+static void sim_dispatch_irqs(void) {
+    for (;;) {
+        uint64_t ready = __atomic_load_n(&irq_pending, __ATOMIC_SEQ_CST) &
+                         __atomic_load_n(&irq_enabled, __ATOMIC_SEQ_CST);
+        if (ready == 0) return;
+
+        uint8_t irq = __builtin_ctzll(ready);
+        __atomic_and_fetch(&irq_pending, ~(1ull << irq), __ATOMIC_SEQ_CST);
+        vectors[irq]();
+    }
+}
+
+void sim_irq_raise(uint8_t irq) {
+    if (irq >= NVIC_IRQ_COUNT) return;
+    __atomic_or_fetch(&irq_pending, 1ull << irq, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&irq_enabled, __ATOMIC_SEQ_CST) & (1ull << irq))
+        generate_irq();
+}
+
+void nvic_enable_irq(uint8_t irqn) {
+    if (irqn >= NVIC_IRQ_COUNT) return;
+    __atomic_or_fetch(&irq_enabled, 1ull << irqn, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&irq_pending, __ATOMIC_SEQ_CST) & (1ull << irqn))
+        generate_irq();
+}
+
+void nvic_disable_irq(uint8_t irqn) {
+    if (irqn >= NVIC_IRQ_COUNT) return;
+    __atomic_and_fetch(&irq_enabled, ~(1ull << irqn), __ATOMIC_SEQ_CST);
+}
+
+uint8_t nvic_get_pending_irq(uint8_t irqn) {
+    if (irqn >= NVIC_IRQ_COUNT) return 0;
+    return (__atomic_load_n(&irq_pending, __ATOMIC_SEQ_CST) >> irqn) & 1;
+}
+
+void nvic_set_pending_irq(uint8_t irqn) {
+    sim_irq_raise(irqn);
+}
+
+void nvic_clear_pending_irq(uint8_t irqn) {
+    if (irqn >= NVIC_IRQ_COUNT) return;
+    __atomic_and_fetch(&irq_pending, ~(1ull << irqn), __ATOMIC_SEQ_CST);
+}
+
+uint8_t nvic_get_irq_enabled(uint8_t irqn) {
+    if (irqn >= NVIC_IRQ_COUNT) return 0;
+    return (__atomic_load_n(&irq_enabled, __ATOMIC_SEQ_CST) >> irqn) & 1;
+}
+
+void nvic_set_priority(uint8_t irqn, uint8_t priority) {
+    if (irqn < NVIC_IRQ_COUNT) irq_priority[irqn] = priority;
+}
+
+// Rutinas que el firmware no define
+static void sim_default_isr(void) {
+}
+
+#define SIM_WEAK_ISR(name) void name(void) __attribute__((weak, alias("sim_default_isr")))
+SIM_WEAK_ISR(wwdg_isr);
+SIM_WEAK_ISR(pvd_isr);
+SIM_WEAK_ISR(tamper_isr);
+SIM_WEAK_ISR(rtc_isr);
+SIM_WEAK_ISR(flash_isr);
+SIM_WEAK_ISR(rcc_isr);
+SIM_WEAK_ISR(exti0_isr);
+SIM_WEAK_ISR(exti1_isr);
+SIM_WEAK_ISR(exti2_isr);
+SIM_WEAK_ISR(exti3_isr);
+SIM_WEAK_ISR(exti4_isr);
+SIM_WEAK_ISR(dma1_channel1_isr);
+SIM_WEAK_ISR(dma1_channel2_isr);
+SIM_WEAK_ISR(dma1_channel3_isr);
+SIM_WEAK_ISR(dma1_channel4_isr);
+SIM_WEAK_ISR(dma1_channel5_isr);
+SIM_WEAK_ISR(dma1_channel6_isr);
+SIM_WEAK_ISR(dma1_channel7_isr);
+SIM_WEAK_ISR(adc1_2_isr);
+SIM_WEAK_ISR(usb_hp_can_tx_isr);
+SIM_WEAK_ISR(usb_lp_can_rx0_isr);
+SIM_WEAK_ISR(can_rx1_isr);
+SIM_WEAK_ISR(can_sce_isr);
+SIM_WEAK_ISR(exti9_5_isr);
+SIM_WEAK_ISR(tim1_brk_isr);
+SIM_WEAK_ISR(tim1_up_isr);
+SIM_WEAK_ISR(tim1_trg_com_isr);
+SIM_WEAK_ISR(tim1_cc_isr);
+SIM_WEAK_ISR(tim2_isr);
+SIM_WEAK_ISR(tim3_isr);
+SIM_WEAK_ISR(tim4_isr);
+SIM_WEAK_ISR(i2c1_ev_isr);
+SIM_WEAK_ISR(i2c1_er_isr);
+SIM_WEAK_ISR(i2c2_ev_isr);
+SIM_WEAK_ISR(i2c2_er_isr);
+SIM_WEAK_ISR(spi1_isr);
+SIM_WEAK_ISR(spi2_isr);
+SIM_WEAK_ISR(usart1_isr);
+SIM_WEAK_ISR(usart2_isr);
+SIM_WEAK_ISR(usart3_isr);
+SIM_WEAK_ISR(exti15_10_isr);
+SIM_WEAK_ISR(rtc_alarm_isr);
+SIM_WEAK_ISR(usb_wakeup_isr);
+
+void sim_use_virtual_time(void) {
+    virtual.enabled = 1;
+}
+
+void sim_init(void) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&sim_mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sim_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
+    vPortSetIrqHandler(sim_dispatch_irqs);
+    if (virtual.enabled) {
+        vPortSetVirtualTime(&virtual_hooks);
+        sim_schedule(SIM_TICK_NS, virtual_tick, NULL);
+        return;
+    }
+
+    // El hilo del simulador nunca atiende interrupciones: hereda todo bloqueado
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    pthread_create(&sim_thread, NULL, sim_thread_main, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
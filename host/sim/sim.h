@@ -0,0 +1,91 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Simulador del hardware para el build en el host. Mantiene los registros de los
+// periféricos, un hilo que ejecuta eventos en el tiempo (fin de una transferencia, un
+// dispositivo que termina de programar, etc.) y la generación de interrupciones.
+//
+// El hilo del simulador y las tareas comparten el estado de los modelos: todo acceso se
+// hace con sim_lock() tomado. sim_lock() bloquea además las interrupciones del hilo que
+// lo toma, así una ISR nunca espera un lock que tiene la tarea interrumpida.
+
+typedef void (*sim_event_fn)(void *arg);
+
+// Arranca el hilo del simulador y conecta el despacho de interrupciones al port
+void sim_init(void);
+
+// Tiempo virtual (llamar antes de sim_init()): el reloj del simulador no sigue al del host
+// sino que salta de un evento al siguiente cuando la CPU espera, y el tick es un evento
+// más. No hay hilo del simulador: los eventos corren en el hilo de la tarea que espera. La CPU espera cuando la tarea idle se duerme (el tickless idle del port saltea de
+// una vez los ticks en que todas las tareas están bloqueadas), en una espera activa
+// (taskYIELD() sin otra tarea lista, usart_send_blocking(), sim_spin_ns()) y nunca en
+// otro caso: el código de las tareas y las ISRs no consume tiempo. Las corridas son
+// deterministas y horas de firmware corren en segundos
+void sim_use_virtual_time(void);
+
+// Tiempo del simulador en ns desde sim_init()
+uint64_t sim_time_ns(void);
+
+// Espera activa: para tiempos más cortos que un cambio de contexto del host
+void sim_spin_ns(uint64_t ns);
+
+// El firmware espera un cambio del hardware sin bloquearse (un flag que tiene que subir).
+// Con tiempo virtual avanza hasta el próximo evento; con tiempo real no hace nada
+void sim_poll(void);
+
+// Lock de los modelos (recursivo)
+void sim_lock(void);
+void sim_unlock(void);
+
+// Programa fn(arg) dentro de delay_ns. Corre en el hilo del simulador (o en el de la CPU,
+// con tiempo virtual) con el lock tomado
+void sim_schedule(uint64_t delay_ns, sim_event_fn fn, void *arg);
+
+// Pone pendiente la interrupción irq. Se atiende cuando está habilitada en el NVIC y la
+// tarea que corre no está en una sección crítica
+void sim_irq_raise(uint8_t irq);
+
+// Avisos de la libopencm3 simulada a los modelos
+void sim_gpio_write(uint32_t port, uint16_t old_odr, uint16_t new_odr);
+void sim_dma_update(uint32_t dma, uint8_t channel);
+void sim_spi_update(uint32_t spi);
+uint8_t sim_spi_xfer(uint32_t spi, uint8_t mosi);
+void sim_usart_update(uint32_t usart);
+void sim_usart_send(uint32_t usart, uint16_t data);
+void sim_iwdg_update(void);
+
+// Código de salida del proceso cuando el IWDG resetea al micro
+#define SIM_IWDG_EXIT_STATUS 3
+
+// Dispositivo SPI: select/deselect al cambiar su chip select y xfer por cada byte
+typedef struct {
+    void (*select)(void *ctx);
+    void (*deselect)(void *ctx);
+    uint8_t (*xfer)(void *ctx, uint8_t mosi);
+} sim_spi_device_ops_t;
+
+// Conecta un dispositivo al bus spi con chip select en cs_port/cs_pin
+void sim_spi_attach(uint32_t spi, uint32_t cs_port, uint16_t cs_pin, const sim_spi_device_ops_t *ops, void *ctx);
+
+// Conecta una USART con el host: lo que transmite se escribe en out y lo que hay en in le
+// llega por RX al ritmo del baudrate, dejando line_gap_ns entre líneas ('\n'). in tiene que
+// ser un archivo común (la lectura no debe bloquear el hilo del simulador); in y out
+// pueden ser NULL
+void sim_usart_attach(uint32_t usart, FILE *in, FILE *out, uint64_t line_gap_ns);
+
+// Conecta TX con RX de la misma USART, como un cable entre los pines. Se suma a in y out
+void sim_usart_loopback(uint32_t usart);
+
+typedef struct {
+    uint32_t tx_bytes;
+    uint32_t rx_bytes;
+    uint32_t overruns;            // Bytes perdidos porque el firmware no leyó el anterior
+    uint8_t rx_done;              // Se terminó de enviar in
+} sim_usart_stats_t;
+
+void sim_usart_get_stats(uint32_t usart, sim_usart_stats_t *stats);
+
+#endif
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+#include <libopencm3/stm32/iwdg.h>
+
+// Modelo del IWDG. Una vez arrancado (KR = START) no se puede detener; cada recarga
+// (KR = RESET) vuelve a contar (RLR + 1) * (4 << PR) ciclos del LSI de 40 kHz. Si la
+// cuenta llega a cero el micro se resetea: en el host el proceso termina con
+// SIM_IWDG_EXIT_STATUS. Hay un solo evento programado, que se reprograma si hubo recargas
+
+#define LSI_FREQUENCY 40000
+
+typedef struct {
+    uint8_t started;
+    uint8_t scheduled;
+    uint64_t deadline_ns;
+} sim_iwdg_t;
+
+static sim_iwdg_t iwdg;
+
+static uint64_t timeout_ns(void) {
+    uint64_t cycles = (uint64_t)((IWDG_RLR & 0xfff) + 1) * (4u << (IWDG_PR & 0x7));
+    return cycles * 1000000000ull / LSI_FREQUENCY;
+}
+
+static void expire(void *arg) {
+    (void)arg;
+    uint64_t now = sim_time_ns();
+    if (now < iwdg.deadline_ns) {
+        sim_schedule(iwdg.deadline_ns - now, expire, NULL);
+        return;
+    }
+    fprintf(stderr, "\nsim: reset por el IWDG a los %.3f s\n", now / 1e9);
+    fflush(NULL);
+    _exit(SIM_IWDG_EXIT_STATUS);
+}
+
+void sim_iwdg_update(void) {
+    uint32_t key = IWDG_KR;
+    IWDG_KR = 0;                    // Solo escritura: en el hardware se lee 0
+
+    if (key == IWDG_KR_START) iwdg.started = 1;
+    else if (key != IWDG_KR_RESET) return;
+    if (!iwdg.started) return;
+
+    iwdg.deadline_ns = sim_time_ns() + timeout_ns();
+    if (!iwdg.scheduled) {
+        iwdg.scheduled = 1;
+        sim_schedule(timeout_ns(), expire, NULL);
+    }
+}
@@ -0,0 +1,150 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_nor.h"
+
+#define NOR_CMD_WRITE_ENABLE  0x06
+#define NOR_CMD_WRITE_DISABLE 0x04
+#define NOR_CMD_READ_STATUS   0x05
+#define NOR_CMD_READ          0x03
+#define NOR_CMD_FAST_READ     0x0B
+#define NOR_CMD_PAGE_PROGRAM  0x02
+#define NOR_CMD_SECTOR_ERASE  0x20
+#define NOR_CMD_JEDEC_ID      0x9F
+
+#define NOR_STATUS_BUSY 0x01
+#define NOR_STATUS_WEL  0x02
+
+#define NOR_PAGE_SIZE   256
+#define NOR_SECTOR_SIZE 4096
+
+struct sim_nor {
+    uint8_t *mem;
+    uint32_t size;
+    uint32_t jedec_id;
+
+    uint8_t wel;
+    uint64_t busy_until;          // Fin de la programación o borrado en curso
+
+    // Comando en curso (desde que baja el chip select)
+    uint8_t cmd;
+    uint32_t index;               // Bytes recibidos
+    uint32_t addr;
+
+    sim_nor_stats_t stats;
+};
+
+static uint8_t nor_busy(const sim_nor_t *nor) {
+    return sim_time_ns() < nor->busy_until;
+}
+
+static void nor_select(void *ctx) {
+    sim_nor_t *nor = ctx;
+    nor->index = 0;
+    nor->addr = 0;
+}
+
+static void nor_deselect(void *ctx) {
+    sim_nor_t *nor = ctx;
+    if (nor->index == 0) return;
+
+    switch (nor->cmd) {
+        case NOR_CMD_WRITE_ENABLE:
+            nor->wel = 1;
+            break;
+        case NOR_CMD_WRITE_DISABLE:
+            nor->wel = 0;
+            break;
+        case NOR_CMD_PAGE_PROGRAM:
+            if (nor->index > 4) {
+                nor->stats.page_programs++;
+                nor->busy_until = sim_time_ns() + SIM_NOR_PAGE_PROGRAM_NS;
+            }
+            nor->wel = 0;
+            break;
+        case NOR_CMD_SECTOR_ERASE:
+            if (nor->index == 4) {
+                memset(&nor->mem[nor->addr & ~(NOR_SECTOR_SIZE - 1)], 0xFF, NOR_SECTOR_SIZE);
+                nor->stats.sector_erases++;
+                nor->busy_until = sim_time_ns() + SIM_NOR_SECTOR_ERASE_NS;
+            }
+            nor->wel = 0;
+            break;
+    }
+}
+
+static uint8_t nor_xfer(void *ctx, uint8_t mosi) {
+    sim_nor_t *nor = ctx;
+    uint32_t i = nor->index++;
+
+    if (i == 0) {
+        // Ocupada solo atiende la lectura del status
+        nor->cmd = mosi;
+        if (nor_busy(nor) && mosi != NOR_CMD_READ_STATUS) nor->cmd = 0;
+        if ((mosi == NOR_CMD_PAGE_PROGRAM || mosi == NOR_CMD_SECTOR_ERASE) && !nor->wel) nor->cmd = 0;
+        return 0xFF;
+    }
+
+    switch (nor->cmd) {
+        case NOR_CMD_JEDEC_ID:
+            return i <= 3 ? (uint8_t)(nor->jedec_id >> (8 * (3 - i))) : 0xFF;
+
+        case NOR_CMD_READ_STATUS:
+            nor->stats.status_reads++;
+            return (nor_busy(nor) ? NOR_STATUS_BUSY : 0) | (nor->wel ? NOR_STATUS_WEL : 0);
+
+        case NOR_CMD_READ:
+        case NOR_CMD_FAST_READ:
+        case NOR_CMD_PAGE_PROGRAM:
+        case NOR_CMD_SECTOR_ERASE:
+            if (i <= 3) {
+                nor->addr = ((nor->addr << 8) | mosi) % nor->size;
+                return 0xFF;
+            }
+            break;
+
+        default:
+            return 0xFF;
+    }
+
+    if (nor->cmd == NOR_CMD_READ || nor->cmd == NOR_CMD_FAST_READ) {
+        // El fast read tiene un byte de espera después de la dirección
+        if (nor->cmd == NOR_CMD_FAST_READ && i == 4) return 0xFF;
+        uint8_t data = nor->mem[nor->addr];
+        nor->addr = (nor->addr + 1) % nor->size;
+        nor->stats.read_bytes++;
+        return data;
+    }
+
+    if (nor->cmd == NOR_CMD_PAGE_PROGRAM) {
+        // Programar solo baja bits; pasado el fin de la página se vuelve al principio
+        uint32_t page = nor->addr & ~(uint32_t)(NOR_PAGE_SIZE - 1);
+        uint32_t offset = (nor->addr + (i - 4)) % NOR_PAGE_SIZE;
+        nor->mem[page + offset] &= mosi;
+        nor->stats.programmed_bytes++;
+    }
+    return 0xFF;
+}
+
+static const sim_spi_device_ops_t nor_ops = {
+    .select = nor_select,
+    .deselect = nor_deselect,
+    .xfer = nor_xfer,
+};
+
+sim_nor_t *sim_nor_create(uint32_t size, uint32_t jedec_id) {
+    sim_nor_t *nor = calloc(1, sizeof(*nor));
+    nor->mem = malloc(size);
+    memset(nor->mem, 0xFF, size);
+    nor->size = size;
+    nor->jedec_id = jedec_id;
+    return nor;
+}
+
+void sim_nor_attach(sim_nor_t *nor, uint32_t spi, uint32_t cs_port, uint16_t cs_pin) {
+    sim_spi_attach(spi, cs_port, cs_pin, &nor_ops, nor);
+}
+
+const sim_nor_stats_t *sim_nor_get_stats(const sim_nor_t *nor) {
+    return &nor->stats;
+}
@@ -0,0 +1,33 @@
+#ifndef SIM_NOR_H
+#define SIM_NOR_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+// Modelo de una memoria NOR SPI tipo W25Qxx: read (0x03), fast read (0x0B), JEDEC ID,
+// status, write enable/disable, page program y sector erase. Los tiempos de programación
+// y borrado son los típicos de la hoja de datos y se reflejan en el bit BUSY.
+
+#define SIM_NOR_PAGE_PROGRAM_NS  700000ull
+#define SIM_NOR_SECTOR_ERASE_NS  45000000ull
+
+typedef struct {
+    uint32_t read_bytes;
+    uint32_t programmed_bytes;
+    uint32_t page_programs;
+    uint32_t sector_erases;
+    uint32_t status_reads;
+} sim_nor_stats_t;
+
+typedef struct sim_nor sim_nor_t;
+
+// Crea una memoria de size bytes, borrada (0xFF), que responde jedec_id (3 bytes)
+sim_nor_t *sim_nor_create(uint32_t size, uint32_t jedec_id);
+
+// Conecta la memoria al bus spi con chip select en cs_port/cs_pin
+void sim_nor_attach(sim_nor_t *nor, uint32_t spi, uint32_t cs_port, uint16_t cs_pin);
+
+const sim_nor_stats_t *sim_nor_get_stats(const sim_nor_t *nor);
+
+#endif
@@ -0,0 +1,198 @@
+#include <stddef.h>
+
+#include "sim.h"
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/spi.h>
+#include <libopencm3/stm32/dma.h>
+#include <libopencm3/cm3/nvic.h>
+
+// Modelo de SPI1/SPI2 en modo master con sus canales DMA fijos (RM0008, tabla 78).
+// Una transferencia por DMA arranca cuando el periférico, el pedido de TX y el canal de TX
+// están habilitados. Se intercambian todos los bytes con el dispositivo seleccionado al
+// cumplirse el tiempo que tarda en salir por el bus, y entonces se marcan los flags del
+// DMA y se genera la interrupción.
+
+#define SIM_SPI_MAX_DEVICES 4
+
+typedef struct {
+    uint32_t cs_port;
+    uint16_t cs_pin;
+    const sim_spi_device_ops_t *ops;
+    void *ctx;
+    uint8_t selected;
+} sim_spi_device_t;
+
+typedef struct {
+    uint32_t spi;
+    uint8_t rx_channel;
+    uint8_t tx_channel;
+    sim_spi_device_t devices[SIM_SPI_MAX_DEVICES];
+    uint8_t device_count;
+
+    // Transferencia por DMA en curso
+    uint8_t busy;
+    uint32_t generation;          // Invalida el evento de una transferencia abortada
+    const uint8_t *tx_mem;
+    uint8_t tx_minc;
+    uint8_t *rx_mem;              // NULL si no hay pedido de RX
+    uint8_t rx_minc;
+    uint16_t count;
+} sim_spi_bus_t;
+
+static sim_spi_bus_t buses[] = {
+    { .spi = SPI1, .rx_channel = DMA_CHANNEL2, .tx_channel = DMA_CHANNEL3 },
+    { .spi = SPI2, .rx_channel = DMA_CHANNEL4, .tx_channel = DMA_CHANNEL5 },
+};
+#define SIM_SPI_BUSES (sizeof(buses) / sizeof(buses[0]))
+
+static sim_spi_bus_t *get_bus(uint32_t spi) {
+    for (uint8_t i = 0; i < SIM_SPI_BUSES; i++)
+        if (buses[i].spi == spi) return &buses[i];
+    return NULL;
+}
+
+// Tiempo de un byte en el bus según el prescaler configurado
+static uint64_t byte_time_ns(const sim_spi_bus_t *bus) {
+    uint32_t pclk = bus->spi == SPI1 ? rcc_apb2_frequency : rcc_apb1_frequency;
+    uint32_t sck = pclk >> (((SPI_CR1(bus->spi) >> 3) & 0x7) + 1);
+    return 8ull * 1000000000ull / sck;
+}
+
+static uint8_t exchange(sim_spi_bus_t *bus, uint8_t mosi) {
+    for (uint8_t i = 0; i < bus->device_count; i++) {
+        sim_spi_device_t *dev = &bus->devices[i];
+        if (dev->selected) return dev->ops->xfer(dev->ctx, mosi);
+    }
+    // Nadie maneja MISO: la línea queda en alto
+    return 0xFF;
+}
+
+// El canal está habilitado y conectado al registro de datos del periférico
+static uint8_t channel_on_dr(const sim_spi_bus_t *bus, uint8_t channel) {
+    return (DMA_CCR(DMA1, channel) & DMA_CCR_EN) &&
+           DMA_CPAR(DMA1, channel) == (uint32_t)(uintptr_t)&SPI_DR(bus->spi);
+}
+
+static uint8_t tx_requested(const sim_spi_bus_t *bus) {
+    return (SPI_CR1(bus->spi) & SPI_CR1_SPE) &&
+           (SPI_CR2(bus->spi) & SPI_CR2_TXDMAEN) &&
+           channel_on_dr(bus, bus->tx_channel) &&
+           (DMA_CCR(DMA1, bus->tx_channel) & DMA_CCR_DIR);
+}
+
+static void set_channel_done(uint8_t channel) {
+    DMA_CNDTR(DMA1, channel) = 0;
+    DMA_ISR(DMA1) |= (DMA_GIF | DMA_TCIF | DMA_HTIF) << DMA_FLAG_OFFSET(channel);
+    if (DMA_CCR(DMA1, channel) & DMA_CCR_TCIE)
+        sim_irq_raise(NVIC_DMA1_CHANNEL1_IRQ + channel - 1);
+}
+
+static void transfer_complete(void *arg) {
+    uintptr_t token = (uintptr_t)arg;
+    sim_spi_bus_t *bus = &buses[token % SIM_SPI_BUSES];
+    if (!bus->busy || bus->generation != token / SIM_SPI_BUSES) return;
+    bus->busy = 0;
+
+    for (uint16_t i = 0; i < bus->count; i++) {
+        uint8_t miso = exchange(bus, bus->tx_mem[bus->tx_minc ? i : 0]);
+        if (bus->rx_mem != NULL)
+            bus->rx_mem[bus->rx_minc ? i : 0] = miso;
+        else
+            SPI_DR(bus->spi) = miso;
+    }
+
+    set_channel_done(bus->tx_channel);
+    if (bus->rx_mem != NULL) set_channel_done(bus->rx_channel);
+}
+
+static void check_transfer(sim_spi_bus_t *bus) {
+    if (bus->busy) {
+        // Se deshabilitó el canal o el pedido a mitad de la transferencia: se aborta
+        if (!tx_requested(bus)) {
+            bus->busy = 0;
+            bus->generation++;
+        }
+        return;
+    }
+
+    if (!tx_requested(bus) || DMA_CNDTR(DMA1, bus->tx_channel) == 0) return;
+
+    bus->count = DMA_CNDTR(DMA1, bus->tx_channel);
+    bus->tx_mem = (const uint8_t *)(uintptr_t)DMA_CMAR(DMA1, bus->tx_channel);
+    bus->tx_minc = (DMA_CCR(DMA1, bus->tx_channel) & DMA_CCR_MINC) != 0;
+    bus->rx_mem = NULL;
+    if ((SPI_CR2(bus->spi) & SPI_CR2_RXDMAEN) && channel_on_dr(bus, bus->rx_channel)) {
+        bus->rx_mem = (uint8_t *)(uintptr_t)DMA_CMAR(DMA1, bus->rx_channel);
+        bus->rx_minc = (DMA_CCR(DMA1, bus->rx_channel) & DMA_CCR_MINC) != 0;
+    }
+
+    bus->busy = 1;
+    bus->generation++;
+    uintptr_t token = bus->generation * SIM_SPI_BUSES + (uintptr_t)(bus - buses);
+    sim_schedule(bus->count * byte_time_ns(bus), transfer_complete, (void *)token);
+}
+
+void sim_spi_update(uint32_t spi) {
+    sim_spi_bus_t *bus = get_bus(spi);
+    if (bus == NULL) return;
+    sim_lock();
+    check_transfer(bus);
+    sim_unlock();
+}
+
+void sim_dma_update(uint32_t dma, uint8_t channel) {
+    if (dma != DMA1) return;
+    sim_lock();
+    for (uint8_t i = 0; i < SIM_SPI_BUSES; i++)
+        if (buses[i].rx_channel == channel || buses[i].tx_channel == channel)
+            check_transfer(&buses[i]);
+    sim_unlock();
+}
+
+uint8_t sim_spi_xfer(uint32_t spi, uint8_t mosi) {
+    sim_spi_bus_t *bus = get_bus(spi);
+    if (bus == NULL) return 0xFF;
+
+    sim_lock();
+    uint8_t miso = 0xFF;
+    uint64_t wait = 0;
+    if (SPI_CR1(spi) & SPI_CR1_SPE) {
+        miso = exchange(bus, mosi);
+        wait = byte_time_ns(bus);
+    }
+    SPI_DR(spi) = miso;
+    sim_unlock();
+
+    // spi_xfer espera a que el byte termine de salir
+    sim_spin_ns(wait);
+    return miso;
+}
+
+void sim_gpio_write(uint32_t port, uint16_t old_odr, uint16_t new_odr) {
+    for (uint8_t i = 0; i < SIM_SPI_BUSES; i++) {
+        for (uint8_t d = 0; d < buses[i].device_count; d++) {
+            sim_spi_device_t *dev = &buses[i].devices[d];
+            if (dev->cs_port != port) continue;
+
+            uint8_t was_high = (old_odr & dev->cs_pin) != 0;
+            uint8_t is_high = (new_odr & dev->cs_pin) != 0;
+            if (was_high && !is_high) {
+                dev->selected = 1;
+                if (dev->ops->select != NULL) dev->ops->select(dev->ctx);
+            } else if (!was_high && is_high && dev->selected) {
+                dev->selected = 0;
+                if (dev->ops->deselect != NULL) dev->ops->deselect(dev->ctx);
+            }
+        }
+    }
+}
+
+void sim_spi_attach(uint32_t spi, uint32_t cs_port, uint16_t cs_pin, const sim_spi_device_ops_t *ops, void *ctx) {
+    sim_spi_bus_t *bus = get_bus(spi);
+    if (bus == NULL || bus->device_count == SIM_SPI_MAX_DEVICES) return;
+
+    sim_lock();
+    bus->devices[bus->device_count++] = (sim_spi_device_t){ cs_port, cs_pin, ops, ctx, 0 };
+    sim_unlock();
+}
@@ -0,0 +1,153 @@
+#include <stddef.h>
+
+#include "sim.h"
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/usart.h>
+#include <libopencm3/cm3/nvic.h>
+
+// Modelo de USART1..3 en modo asíncrono, 8N1. Cada byte tarda 10 tiempos de bit según BRR.
+// TX: escribir DR baja TXE y TC; al terminar el byte se escribe en el archivo de salida y
+// se vuelven a subir. RX: con el periférico y el receptor habilitados, los bytes del
+// archivo de entrada llegan a DR de a uno, suben RXNE y generan la interrupción si
+// RXNEIE está habilitada. Si el firmware no leyó el byte anterior se pierde (ORE). En
+// loopback cada byte transmitido llega además por RX, como con TX cableado a RX.
+
+typedef struct {
+    uint32_t usart;
+    uint8_t irq;
+    FILE *in;
+    FILE *out;
+    uint64_t line_gap_ns;
+    uint8_t loopback;
+    uint8_t rx_running;
+    uint8_t tx_busy;
+    uint16_t tx_data;
+    sim_usart_stats_t stats;
+} sim_usart_t;
+
+static sim_usart_t usarts[] = {
+    { .usart = USART1, .irq = NVIC_USART1_IRQ },
+    { .usart = USART2, .irq = NVIC_USART2_IRQ },
+    { .usart = USART3, .irq = NVIC_USART3_IRQ },
+};
+#define SIM_USARTS (sizeof(usarts) / sizeof(usarts[0]))
+
+static sim_usart_t *get_usart(uint32_t usart) {
+    for (uint8_t i = 0; i < SIM_USARTS; i++)
+        if (usarts[i].usart == usart) return &usarts[i];
+    return NULL;
+}
+
+// Tiempo de un byte (start, 8 datos, stop) según BRR. 0 si no está configurada
+static uint64_t byte_time_ns(const sim_usart_t *u) {
+    uint32_t brr = USART_BRR(u->usart);
+    uint32_t pclk = u->usart == USART1 ? rcc_apb2_frequency : rcc_apb1_frequency;
+    if (brr == 0) return 0;
+    return 10ull * brr * 1000000000ull / pclk;
+}
+
+static uint8_t enabled(const sim_usart_t *u, uint32_t direction) {
+    return (USART_CR1(u->usart) & (USART_CR1_UE | direction)) == (USART_CR1_UE | direction);
+}
+
+static void update_irq(sim_usart_t *u) {
+    uint32_t sr = USART_SR(u->usart), cr1 = USART_CR1(u->usart);
+    if (((cr1 & USART_CR1_RXNEIE) && (sr & (USART_SR_RXNE | USART_SR_ORE))) ||
+        ((cr1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE)) ||
+        ((cr1 & USART_CR1_TCIE) && (sr & USART_SR_TC)))
+        sim_irq_raise(u->irq);
+}
+
+static void rx_deliver(sim_usart_t *u, uint8_t c) {
+    if (USART_SR(u->usart) & USART_SR_RXNE) {
+        USART_SR(u->usart) |= USART_SR_ORE;
+        u->stats.overruns++;
+    } else {
+        USART_DR(u->usart) = c;
+        USART_SR(u->usart) |= USART_SR_RXNE;
+        u->stats.rx_bytes++;
+    }
+    update_irq(u);
+}
+
+static void rx_byte(void *arg) {
+    sim_usart_t *u = arg;
+    int c = enabled(u, USART_CR1_RE) ? fgetc(u->in) : EOF;
+    if (c == EOF) {
+        u->rx_running = 0;
+        u->stats.rx_done = 1;
+        return;
+    }
+
+    rx_deliver(u, (uint8_t)c);
+
+    uint64_t next = byte_time_ns(u) + (c == '\n' ? u->line_gap_ns : 0);
+    sim_schedule(next, rx_byte, u);
+}
+
+static void tx_done(void *arg) {
+    sim_usart_t *u = arg;
+    u->tx_busy = 0;
+    if (u->out != NULL) fputc(u->tx_data & 0xFF, u->out);
+    u->stats.tx_bytes++;
+    USART_SR(u->usart) |= USART_SR_TXE | USART_SR_TC;
+    if (u->loopback && enabled(u, USART_CR1_RE)) rx_deliver(u, u->tx_data & 0xFF);
+    else update_irq(u);
+}
+
+void sim_usart_update(uint32_t usart) {
+    sim_usart_t *u = get_usart(usart);
+    if (u == NULL) return;
+    sim_lock();
+    if (!u->tx_busy) USART_SR(usart) |= USART_SR_TXE | USART_SR_TC;
+    if (u->in != NULL && !u->rx_running && !u->stats.rx_done &&
+        enabled(u, USART_CR1_RE) && byte_time_ns(u) != 0) {
+        u->rx_running = 1;
+        sim_schedule(byte_time_ns(u), rx_byte, u);
+    }
+    update_irq(u);
+    sim_unlock();
+}
+
+void sim_usart_send(uint32_t usart, uint16_t data) {
+    sim_usart_t *u = get_usart(usart);
+    if (u == NULL) return;
+    sim_lock();
+    // Escribir DR con TXE en 0 pisa el byte que esperaba: solo sale el último. En el
+    // hardware el DR que se escribe y el que se lee son registros distintos: USART_DR del
+    // modelo es el de recepción
+    u->tx_data = data;
+    USART_SR(usart) &= ~(USART_SR_TXE | USART_SR_TC);
+    if (!u->tx_busy && enabled(u, USART_CR1_TE)) {
+        u->tx_busy = 1;
+        sim_schedule(byte_time_ns(u), tx_done, u);
+    }
+    sim_unlock();
+}
+
+void sim_usart_attach(uint32_t usart, FILE *in, FILE *out, uint64_t line_gap_ns) {
+    sim_usart_t *u = get_usart(usart);
+    if (u == NULL) return;
+    sim_lock();
+    u->in = in;
+    u->out = out;
+    u->line_gap_ns = line_gap_ns;
+    sim_unlock();
+}
+
+void sim_usart_loopback(uint32_t usart) {
+    sim_usart_t *u = get_usart(usart);
+    if (u == NULL) return;
+    sim_lock();
+    u->loopback = 1;
+    sim_unlock();
+}
+
+void sim_usart_get_stats(uint32_t usart, sim_usart_stats_t *stats) {
+    sim_usart_t *u = get_usart(usart);
+    if (u == NULL) return;
+    sim_lock();
+    *stats = u->stats;
+    sim_unlock();
+}
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "i2c.h"
+#include "manifest.h"
+#include "latency.h"
+#include "sim.h"
+
+// Pruebas de la máquina de estados del master I2C (src/i2c.c) sobre la libopencm3
+// simulada. No hay modelo del bus: cada prueba hace de periférico, escribe en SR1 la
+// secuencia de eventos de RM0008 (SB, ADDR, TxE, BTF, RxNE) y llama a la ISR de eventos
+// como lo haría el NVIC. Entre un evento y otro revisa lo que dejó el driver en CR1, CR2
+// y DR. El driver se enlaza solo: la cola del manifiesto y la latencia son falsas.
+
+#define I2C_TEST_BUS        I2C2
+#define I2C_TEST_ADDR       0x48
+#define I2C_TEST_REG        0x05
+#define I2C_TEST_WAIT_MS    100
+
+static int failed;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("  %s:%d: no se cumple %s\n", __FILE__, __LINE__, #cond); \
+            failed = 1; \
+            return; \
+        } \
+    } while (0)
+
+// Falsos del manifiesto y de la latencia
+
+QueueHandle_t MANIFEST_queue(manifest_object_t id) {
+    static QueueHandle_t txq;
+    if (id != MANIFEST_I2C2_TXQ) return NULL;
+    if (txq == NULL) txq = xQueueCreate(4, sizeof(i2c_transaction_t *));
+    return txq;
+}
+
+void LATENCY_isr_enter(latency_source_t source) {
+    (void)source;
+}
+
+void LATENCY_isr_signal(latency_source_t source) {
+    (void)source;
+}
+
+void LATENCY_task_wake(latency_source_t source) {
+    (void)source;
+}
+
+// Transacción que hace la tarea cliente: registro y lectura con START repetido
+typedef struct {
+    uint8_t rx[4];
+    uint16_t rx_len;
+    volatile uint8_t done;
+    i2c_status_t status;
+} request_t;
+
+static request_t request;
+static TaskHandle_t client;
+
+static void taskClient(void *args) {
+    (void)args;
+    static const uint8_t reg = I2C_TEST_REG;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        request.status = I2C_write_read(I2C_TEST_BUS, I2C_TEST_ADDR, &reg, 1, request.rx, request.rx_len,
+                                        pdMS_TO_TICKS(I2C_TEST_WAIT_MS));
+        request.done = 1;
+    }
+}
+
+// Un evento del periférico: los flags quedan en SR1 y se atiende la interrupción
+static void event(uint32_t sr1) {
+    taskENTER_CRITICAL();
+    I2C_SR1(I2C_TEST_BUS) = sr1;
+    i2c2_ev_isr();
+    taskEXIT_CRITICAL();
+}
+
+// El hardware baja START al generarlo y STOP al terminar de enviarlo
+static void condition_sent(uint32_t bit) {
+    I2C_CR1(I2C_TEST_BUS) &= ~bit;
+}
+
+static BaseType_t wait_start(void) {
+    TickType_t start = xTaskGetTickCount();
+    while (!(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_START)) {
+        if (xTaskGetTickCount() - start > pdMS_TO_TICKS(I2C_TEST_WAIT_MS)) return pdFAIL;
+        vTaskDelay(1);
+    }
+    return pdPASS;
+}
+
+static BaseType_t wait_done(void) {
+    TickType_t start = xTaskGetTickCount();
+    while (!request.done) {
+        if (xTaskGetTickCount() - start > pdMS_TO_TICKS(I2C_TEST_WAIT_MS)) return pdFAIL;
+        vTaskDelay(1);
+    }
+    return pdPASS;
+}
+
+// Arranca la transacción y la lleva hasta el START repetido: dirección de escritura,
+// registro y BTF del último byte escrito
+static void write_phase(uint16_t rx_len) {
+    memset(&request, 0, sizeof(request));
+    request.rx_len = rx_len;
+    xTaskNotifyGive(client);
+    CHECK(wait_start() == pdPASS);
+    CHECK(I2C_CR2(I2C_TEST_BUS) & I2C_CR2_ITBUFEN);
+
+    condition_sent(I2C_CR1_START);
+    event(I2C_SR1_SB);
+    CHECK(I2C_DR(I2C_TEST_BUS) == I2C_TEST_ADDR << 1);
+    event(I2C_SR1_ADDR);
+    event(I2C_SR1_TxE);
+    CHECK(I2C_DR(I2C_TEST_BUS) == I2C_TEST_REG);
+    CHECK(!(I2C_CR2(I2C_TEST_BUS) & I2C_CR2_ITBUFEN));
+
+    event(I2C_SR1_TxE | I2C_SR1_BTF);
+    CHECK(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_START);
+    CHECK(!(I2C_CR2(I2C_TEST_BUS) & I2C_CR2_ITBUFEN));
+
+    // BTF y TxE siguen arriba hasta que sale el START: la interrupción vuelve a entrar
+    // sin que la lectura avance
+    I2C_DR(I2C_TEST_BUS) = 0xEE;
+    event(I2C_SR1_TxE | I2C_SR1_BTF);
+    event(I2C_SR1_TxE | I2C_SR1_BTF);
+    CHECK(!(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_STOP));
+    CHECK(!request.done);
+    CHECK(request.rx[0] == 0);
+
+    condition_sent(I2C_CR1_START);
+    event(I2C_SR1_SB);
+    CHECK(I2C_DR(I2C_TEST_BUS) == ((I2C_TEST_ADDR << 1) | 1));
+}
+
+// Lectura de 2 bytes: POS, NACK en EV6 y los dos bytes juntos con BTF
+static void test_write_read_2(void) {
+    write_phase(2);
+    if (failed) return;
+    CHECK(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_POS);
+
+    event(I2C_SR1_ADDR);
+    CHECK(!(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_ACK));
+    CHECK(!(I2C_CR2(I2C_TEST_BUS) & I2C_CR2_ITBUFEN));
+    CHECK(!request.done);
+
+    // En el simulador DR devuelve lo mismo en las dos lecturas
+    I2C_DR(I2C_TEST_BUS) = 0x5A;
+    event(I2C_SR1_RxNE | I2C_SR1_BTF);
+    CHECK(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_STOP);
+    condition_sent(I2C_CR1_STOP);
+    CHECK(wait_done() == pdPASS);
+    CHECK(request.status == I2C_OK);
+    CHECK(request.rx[0] == 0x5A && request.rx[1] == 0x5A);
+}
+
+// Lectura de 3 bytes: NACK con BTF antes del anteúltimo, STOP antes del último
+static void test_write_read_3(void) {
+    write_phase(3);
+    if (failed) return;
+    CHECK(!(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_POS));
+
+    event(I2C_SR1_ADDR);
+    CHECK(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_ACK);
+    CHECK(!(I2C_CR2(I2C_TEST_BUS) & I2C_CR2_ITBUFEN));
+
+    I2C_DR(I2C_TEST_BUS) = 0x11;
+    event(I2C_SR1_RxNE | I2C_SR1_BTF);
+    CHECK(!(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_ACK));
+    I2C_DR(I2C_TEST_BUS) = 0x22;
+    event(I2C_SR1_RxNE | I2C_SR1_BTF);
+    CHECK(I2C_CR1(I2C_TEST_BUS) & I2C_CR1_STOP);
+    CHECK(I2C_CR2(I2C_TEST_BUS) & I2C_CR2_ITBUFEN);
+    CHECK(!request.done);
+    I2C_DR(I2C_TEST_BUS) = 0x33;
+    event(I2C_SR1_RxNE);
+    condition_sent(I2C_CR1_STOP);
+
+    CHECK(wait_done() == pdPASS);
+    CHECK(request.status == I2C_OK);
+    CHECK(request.rx[0] == 0x11 && request.rx[1] == 0x22 && request.rx[2] == 0x33);
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} test_t;
+
+static const test_t tests[] = {
+    { "Escritura y 2 bytes", test_write_read_2 },
+    { "Escritura y 3 bytes", test_write_read_3 },
+};
+
+static void taskTest(void *args) {
+    (void)args;
+    int any_failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        failed = 0;
+        tests[i].run();
+        printf("%-24s %s\n", tests[i].name, failed ? "FALLÓ" : "ok");
+        any_failed |= failed;
+        if (failed) break;  // El driver quedó a mitad de una transacción
+    }
+    printf(any_failed ? "FALLÓ\n" : "OK\n");
+    fflush(NULL);
+    exit(any_failed);
+}
+
+static void taskBus(void *args) {
+    (void)args;
+    taskI2C(I2C_TEST_BUS);
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    (void)xTask;
+    fprintf(stderr, "stack overflow en %s\n", pcTaskName);
+    abort();
+}
+
+int main(void) {
+    sim_init();
+    // Antes de la tarea del bus, que espera en la cola
+    if (I2C_setup(I2C_TEST_BUS, 100000) != pdPASS) {
+        printf("I2C_setup FALLÓ\n");
+        return 1;
+    }
+    // Las interrupciones las genera la prueba llamando a la ISR
+    nvic_disable_irq(NVIC_I2C2_EV_IRQ);
+    nvic_disable_irq(NVIC_I2C2_ER_IRQ);
+
+    // El bus y el cliente por encima de la prueba: cuando ella corre, ellos esperan
+    xTaskCreate(taskBus, "I2C2", 2 * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, NULL);
+    xTaskCreate(taskClient, "Client", 2 * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, &client);
+    xTaskCreate(taskTest, "Test", 4 * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
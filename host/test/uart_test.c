@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "uart.h"
+#include "manifest.h"
+#include "latency.h"
+#include "supervisor.h"
+#include "sim.h"
+
+// Pruebas del driver de UART (src/uart.c) sobre la libopencm3 simulada. El driver se
+// enlaza solo, sin el resto del firmware: las colas del manifiesto, el supervisor y la
+// medición de latencia son falsos de este archivo. Los bytes de RX y los flags de error
+// se escriben directo en los registros de la USART (DR, RXNE, ORE) y la interrupción llega
+// por el NVIC simulado, como en el hardware.
+//
+// Al final mide el camino por byte del driver (ISR y UART_receive()) en tiempo del host:
+// falla si pasa UART_TEST_BUDGET_NS, para que una regresión en el camino caliente se vea
+// en make -C host test. El límite se cambia con -b NS.
+
+#define UART_TEST_TXQ_LENGTH    32
+#define UART_TEST_RXQ_LENGTH    16      // Corta, para llenarla rápido
+#define UART_TEST_WAIT_MS       100
+#define UART_TEST_TIMING_BYTES  1000    // Bytes por ronda de la medición
+#define UART_TEST_TIMING_ROUNDS 20      // Se queda con la mejor ronda
+#define UART_TEST_BUDGET_NS     20000   // Máximo por byte: unas diez veces lo de una PC
+
+static uint64_t budget_ns = UART_TEST_BUDGET_NS;
+static int failed;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("  %s:%d: no se cumple %s\n", __FILE__, __LINE__, #cond); \
+            failed = 1; \
+            return; \
+        } \
+    } while (0)
+
+// Falsos del manifiesto, del supervisor y de la latencia
+
+static QueueHandle_t handles[MANIFEST_OBJECT_COUNT];
+static supervisor_slot_t slot;
+static uint32_t signals[LATENCY_SOURCE_COUNT];
+
+// Los cuatro objetos de cada UART, como en el manifiesto
+QueueHandle_t MANIFEST_queue(manifest_object_t id) {
+    if (id >= MANIFEST_OBJECT_COUNT) return NULL;
+    if (handles[id] != NULL) return handles[id];
+
+    switch (id) {
+        case MANIFEST_UART1_TXQ:
+        case MANIFEST_UART2_TXQ:
+        case MANIFEST_UART3_TXQ:
+            handles[id] = xQueueCreate(UART_TEST_TXQ_LENGTH, sizeof(uint16_t));
+            break;
+        case MANIFEST_UART1_RXQ:
+        case MANIFEST_UART2_RXQ:
+        case MANIFEST_UART3_RXQ:
+            handles[id] = xQueueCreate(UART_TEST_RXQ_LENGTH, sizeof(uint16_t));
+            break;
+        case MANIFEST_UART1_MUTEX:
+        case MANIFEST_UART2_MUTEX:
+        case MANIFEST_UART3_MUTEX:
+            handles[id] = xSemaphoreCreateMutex();
+            break;
+        case MANIFEST_UART1_SEM:
+        case MANIFEST_UART2_SEM:
+        case MANIFEST_UART3_SEM:
+            handles[id] = xSemaphoreCreateBinary();
+            break;
+        default:
+            break;
+    }
+    return handles[id];
+}
+
+supervisor_slot_t *SUPERVISOR_self(void) {
+    return &slot;
+}
+
+void LATENCY_isr_enter(latency_source_t source) {
+    (void)source;
+}
+
+void LATENCY_isr_signal(latency_source_t source) {
+    signals[source]++;
+}
+
+void LATENCY_task_wake(latency_source_t source) {
+    (void)source;
+}
+
+// Un byte que llega por RX: si el anterior sigue en DR se pierde y sube ORE
+static void rx_inject(uint32_t usart, uint8_t byte) {
+    sim_lock();
+    if (USART_SR(usart) & USART_SR_RXNE) {
+        USART_SR(usart) |= USART_SR_ORE;
+    } else {
+        USART_DR(usart) = byte;
+        USART_SR(usart) |= USART_SR_RXNE;
+    }
+    sim_usart_update(usart);
+    sim_unlock();
+}
+
+// Hasta que la ISR leyó DR
+static BaseType_t rx_consumed(uint32_t usart) {
+    TickType_t start = xTaskGetTickCount();
+    while (USART_SR(usart) & USART_SR_RXNE) {
+        if (xTaskGetTickCount() - start > pdMS_TO_TICKS(UART_TEST_WAIT_MS)) return pdFAIL;
+        taskYIELD();
+    }
+    return pdPASS;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void test_setup(void) {
+    CHECK(UART_setup(USART1, 115200) == pdPASS);
+    CHECK(USART_BRR(USART1) == 72000000 / 115200);
+    CHECK((USART_CR1(USART1) & (USART_CR1_UE | USART_CR1_TE | USART_CR1_RE | USART_CR1_RXNEIE)) ==
+          (USART_CR1_UE | USART_CR1_TE | USART_CR1_RE | USART_CR1_RXNEIE));
+    CHECK(nvic_get_irq_enabled(NVIC_USART1_IRQ));
+    CHECK(UART_setup(USART2, 115200) == pdPASS);
+    CHECK(UART_setup(USART3, 115200) == pdPASS);
+    // USART2 y USART3 están en APB1, a la mitad. El divisor se redondea
+    CHECK(USART_BRR(USART2) == (36000000 + 115200 / 2) / 115200);
+
+    uart_stats_t stats;
+    CHECK(UART_setup(0, 115200) == pdFAIL);
+    CHECK(UART_get_stats(0, &stats) == pdFAIL);
+    CHECK(UART_putchar(0, 'x', 0) == pdFAIL);
+    CHECK(UART_set_baudrate(0, 9600) == pdFAIL);
+}
+
+// Cada byte se encola en orden, da el semáforo y marca la latencia
+static void test_rx_in_order(void) {
+    const char *text = "$GPGGA,1";
+    uart_stats_t before, after;
+    UART_get_stats(USART1, &before);
+    uint32_t signalled = signals[LATENCY_USART1];
+
+    for (const char *c = text; *c; c++) {
+        rx_inject(USART1, *c);
+        CHECK(UART_semaphore_take(USART1, pdMS_TO_TICKS(UART_TEST_WAIT_MS)) == pdPASS);
+        uint16_t data;
+        CHECK(UART_receive(USART1, &data, 0) == pdTRUE);
+        CHECK(data == (uint8_t)*c);
+    }
+
+    UART_get_stats(USART1, &after);
+    CHECK(after.interrupts - before.interrupts == strlen(text));
+    CHECK(after.overruns == before.overruns && after.rx_dropped == before.rx_dropped);
+    CHECK(signals[LATENCY_USART1] - signalled == strlen(text));
+}
+
+// Dos bytes con la interrupción enmascarada: el segundo se pierde en el periférico
+static void test_rx_overrun(void) {
+    uart_stats_t before, after;
+    UART_get_stats(USART1, &before);
+
+    nvic_disable_irq(NVIC_USART1_IRQ);
+    rx_inject(USART1, 'A');
+    rx_inject(USART1, 'B');
+    CHECK(USART_SR(USART1) & USART_SR_ORE);
+    nvic_enable_irq(NVIC_USART1_IRQ);
+    CHECK(rx_consumed(USART1) == pdPASS);
+
+    uint16_t data;
+    CHECK(UART_receive(USART1, &data, pdMS_TO_TICKS(UART_TEST_WAIT_MS)) == pdTRUE);
+    CHECK(data == 'A');
+    CHECK(UART_receive(USART1, &data, 0) == pdFALSE);
+    CHECK(!(USART_SR(USART1) & USART_SR_ORE));
+
+    UART_get_stats(USART1, &after);
+    CHECK(after.overruns - before.overruns == 1);
+    CHECK(after.rx_dropped == before.rx_dropped);
+}
+
+// Sin nadie que lea, lo que no entra en la cola se descarta y se cuenta
+static void test_rx_queue_full(void) {
+    uart_stats_t before, after;
+    UART_get_stats(USART1, &before);
+
+    for (uint8_t i = 0; i < UART_TEST_RXQ_LENGTH + 4; i++) {
+        rx_inject(USART1, 'a' + i);
+        CHECK(rx_consumed(USART1) == pdPASS);
+    }
+
+    UART_get_stats(USART1, &after);
+    CHECK(after.rx_dropped - before.rx_dropped == 4);
+    CHECK(after.overruns == before.overruns);
+
+    uint16_t data;
+    for (uint8_t i = 0; i < UART_TEST_RXQ_LENGTH; i++) {
+        CHECK(UART_receive(USART1, &data, 0) == pdTRUE);
+        CHECK(data == 'a' + i);
+    }
+    CHECK(UART_receive(USART1, &data, 0) == pdFALSE);
+    // El semáforo binario quedó dado por los bytes anteriores
+    CHECK(UART_semaphore_take(USART1, 0) == pdPASS);
+}
+
+static void test_clear_rx_queue(void) {
+    for (uint8_t i = 0; i < 3; i++) {
+        rx_inject(USART1, '0' + i);
+        CHECK(rx_consumed(USART1) == pdPASS);
+    }
+    CHECK(UART_clear_rx_queue(USART1, pdMS_TO_TICKS(UART_TEST_WAIT_MS)) == pdPASS);
+    uint16_t data;
+    CHECK(UART_receive(USART1, &data, 0) == pdFALSE);
+    UART_semaphore_take(USART1, 0);
+}
+
+// Lo encolado sale por la tarea de transmisión, en orden
+static void test_tx(void) {
+    static StaticTask_t tcb;
+    static StackType_t stack[configMINIMAL_STACK_SIZE];
+    const char *text = "FiubaSAT\r\n";
+    char out[32] = { 0 };
+
+    FILE *f = tmpfile();
+    CHECK(f != NULL);
+    sim_usart_attach(USART2, NULL, f, 0);
+    CHECK(xTaskCreateStatic((TaskFunction_t)taskUART_transmit, "UART2 TX", configMINIMAL_STACK_SIZE,
+                            (void *)USART2, tskIDLE_PRIORITY + 1, stack, &tcb) != NULL);
+
+    CHECK(UART_puts(USART2, text, pdMS_TO_TICKS(UART_TEST_WAIT_MS)) == strlen(text));
+    sim_usart_stats_t stats = { 0 };
+    TickType_t start = xTaskGetTickCount();
+    while (stats.tx_bytes < strlen(text) && xTaskGetTickCount() - start < pdMS_TO_TICKS(UART_TEST_WAIT_MS)) {
+        vTaskDelay(1);
+        sim_usart_get_stats(USART2, &stats);
+    }
+    CHECK(stats.tx_bytes == strlen(text));
+
+    sim_lock();
+    fflush(f);
+    rewind(f);
+    size_t n = fread(out, 1, sizeof(out) - 1, f);
+    sim_unlock();
+    CHECK(n == strlen(text) && strcmp(out, text) == 0);
+}
+
+static void test_set_baudrate(void) {
+    CHECK(UART_set_baudrate(USART1, 9600) == pdPASS);
+    CHECK(USART_BRR(USART1) == 72000000 / 9600);
+    CHECK(USART_CR1(USART1) & USART_CR1_UE);
+    CHECK(UART_set_baudrate(USART1, 115200) == pdPASS);
+}
+
+// Camino por byte: la ISR lee DR y encola, la tarea lo saca. La ISR se llama directo con
+// las interrupciones enmascaradas, como si la tarea fuera interrumpida; el byte se escribe
+// en los registros sin avisar al modelo, así no se genera otra interrupción
+static void test_timing(void) {
+    uint64_t best = UINT64_MAX;
+
+    nvic_disable_irq(NVIC_USART3_IRQ);
+    for (uint8_t round = 0; round < UART_TEST_TIMING_ROUNDS; round++) {
+        uint32_t received = 0;
+        taskENTER_CRITICAL();
+        uint64_t start = now_ns();
+        for (uint32_t i = 0; i < UART_TEST_TIMING_BYTES; i++) {
+            USART_DR(USART3) = (uint8_t)i;
+            USART_SR(USART3) |= USART_SR_RXNE;
+            usart3_isr();
+            uint16_t data;
+            if (UART_receive(USART3, &data, 0) == pdTRUE && data == (uint8_t)i) received++;
+        }
+        uint64_t elapsed = now_ns() - start;
+        taskEXIT_CRITICAL();
+
+        CHECK(received == UART_TEST_TIMING_BYTES);
+        if (elapsed < best) best = elapsed;
+    }
+    nvic_enable_irq(NVIC_USART3_IRQ);
+
+    uint64_t per_byte = best / UART_TEST_TIMING_BYTES;
+    printf("  %llu ns por byte (ISR y UART_receive(), tiempo del host; máximo %llu ns)\n",
+           (unsigned long long)per_byte, (unsigned long long)budget_ns);
+    CHECK(per_byte <= budget_ns);
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} test_t;
+
+static const test_t tests[] = {
+    { "UART_setup", test_setup },
+    { "RX en orden", test_rx_in_order },
+    { "RX con ORE", test_rx_overrun },
+    { "RX con la cola llena", test_rx_queue_full },
+    { "UART_clear_rx_queue", test_clear_rx_queue },
+    { "TX", test_tx },
+    { "UART_set_baudrate", test_set_baudrate },
+    { "Camino por byte", test_timing },
+};
+
+static void taskTest(void *args) {
+    (void)args;
+    int any_failed = 0;
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        failed = 0;
+        tests[i].run();
+        printf("%-24s %s\n", tests[i].name, failed ? "FALLÓ" : "ok");
+        any_failed |= failed;
+    }
+    printf(any_failed ? "FALLÓ\n" : "OK\n");
+    fflush(NULL);
+    exit(any_failed);
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    (void)xTask;
+    fprintf(stderr, "stack overflow en %s\n", pcTaskName);
+    abort();
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "-b") == 0) {
+        budget_ns = strtoull(argv[2], NULL, 10);
+    } else if (argc != 1) {
+        fprintf(stderr, "uso: %s [-b ns]\n", argv[0]);
+        return 2;
+    }
+
+    sim_init();
+    xTaskCreate(taskTest, "Test", 4 * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -90,23 +90,97 @@
 #define xPortSysTickHandler sys_tick_handler
 
 #define configUSE_PREEMPTION    1
+// LOW_POWER=1: tickless idle con modo STOP (src/power.c)
+#ifdef LOW_POWER
+#define configUSE_TICKLESS_IDLE		2
+#define configUSE_IDLE_HOOK		1
+#else
 #define configUSE_IDLE_HOOK		0
-#define configUSE_TICK_HOOK		0
+#endif
+/* Marca el ciclo de cada tick para el jitter de las tareas periódicas (src/periodic.c) */
+#define configUSE_TICK_HOOK		1
 #define configCPU_CLOCK_HZ		( ( unsigned long ) 72000000 )	
 #define configSYSTICK_CLOCK_HZ		( configCPU_CLOCK_HZ / 8 ) /* vTaskDelay() fix */
 #define configTICK_RATE_HZ		1000    // Revisar que relación tick-ms está 1 a 1
 #define configMAX_PRIORITIES		( 5 )
 #define configMINIMAL_STACK_SIZE	( ( unsigned short ) 128 )
-#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 17 * 1024 ) )
+// Tareas y colas son estáticas (src/manifest.h): el heap solo queda para buffers temporales
+#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 1536 ) )
 #define configMAX_TASK_NAME_LEN		( 16 )
-#define configUSE_TRACE_FACILITY	0
+#define configUSE_TRACE_FACILITY	1
 #define configUSE_16_BIT_TICKS		0
 #define configIDLE_SHOULD_YIELD		1
 #define configUSE_MUTEXES		1
+/* Solo los usan los benchmarks del kernel (src/kbench.c): sin KBENCH=1 el linker los descarta */
+#define configUSE_COUNTING_SEMAPHORES	1
 #define configCHECK_FOR_STACK_OVERFLOW	1
+#define configUSE_MALLOC_FAILED_HOOK	1	/* Cuenta las fallas (src/heapstats.c) */
+/* Ranura de check-in de cada tarea supervisada (src/supervisor.h) */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS	1
+
+/* Estadísticas de ejecución en ciclos del DWT, sin el tiempo en ISRs (src/cycles.c) */
+#define configGENERATE_RUN_TIME_STATS	1
+#define configRUN_TIME_COUNTER_TYPE	uint64_t
+void CYCLES_setup(void);
+uint64_t CYCLES_task_time(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	CYCLES_setup()
+#define portGET_RUN_TIME_COUNTER_VALUE()	CYCLES_task_time()
+
+/* TRACE=1: traza binaria del kernel en un buffer circular en RAM (src/trace.c).
+Los eventos de cola llevan la cantidad de mensajes después de la operación: las macros
+de envío se llaman antes de copiar el dato y las de recepción antes de descontarlo. */
+#ifdef TRACE_ENABLED
+#include "../../src/trace.h"
+#define configQUEUE_REGISTRY_SIZE	12
+#define TRACE_SATURATE_16( x )	( ( uint16_t ) ( ( x ) > 0xFFFFU ? 0xFFFFU : ( x ) ) )
+#define traceTASK_SWITCHED_IN()	TRACE_event( TRACE_EV_TASK_SWITCH, ( uint8_t ) pxCurrentTCB->uxPriority, ( uint16_t ) pxCurrentTCB->uxTCBNumber )
+#define traceMOVED_TASK_TO_READY_STATE( pxTCB )	TRACE_event( TRACE_EV_TASK_READY, ( uint8_t ) ( pxTCB )->uxPriority, ( uint16_t ) ( pxTCB )->uxTCBNumber )
+#define traceTASK_CREATE( pxNewTCB )	TRACE_event( TRACE_EV_TASK_CREATE, ( uint8_t ) ( pxNewTCB )->uxPriority, ( uint16_t ) ( pxNewTCB )->uxTCBNumber )
+#define traceTASK_DELETE( pxTCB )	TRACE_event( TRACE_EV_TASK_DELETE, 0, ( uint16_t ) ( pxTCB )->uxTCBNumber )
+#define traceTASK_DELAY()	TRACE_event( TRACE_EV_TASK_DELAY, 0, TRACE_SATURATE_16( xTicksToDelay ) )
+#define traceTASK_NOTIFY( uxIndexToNotify )	TRACE_event( TRACE_EV_NOTIFY, 0, ( uint16_t ) pxTCB->uxTCBNumber )
+#define traceTASK_NOTIFY_FROM_ISR( uxIndexToNotify )	TRACE_event( TRACE_EV_NOTIFY, 0, ( uint16_t ) pxTCB->uxTCBNumber )
+#define traceTASK_NOTIFY_GIVE_FROM_ISR( uxIndexToNotify )	TRACE_event( TRACE_EV_NOTIFY, 0, ( uint16_t ) pxTCB->uxTCBNumber )
+#define traceQUEUE_CREATE( pxNewQueue )	( pxNewQueue )->uxQueueNumber = TRACE_queue_create( ( pxNewQueue ), ( pxNewQueue )->uxLength, ( pxNewQueue )->uxItemSize, ( pxNewQueue )->ucQueueType )
+#define traceQUEUE_DELETE( pxQueue )	TRACE_queue_delete( pxQueue )
+#define TRACE_QUEUE_AFTER_SEND( pxQueue )	( uint16_t ) ( ( pxQueue )->uxMessagesWaiting < ( pxQueue )->uxLength ? ( pxQueue )->uxMessagesWaiting + 1 : ( pxQueue )->uxLength )
+#define TRACE_QUEUE_AFTER_RECEIVE( pxQueue )	( uint16_t ) ( ( pxQueue )->uxMessagesWaiting - 1 )
+#define traceQUEUE_SEND( pxQueue )	TRACE_event( TRACE_EV_QUEUE_SEND, ( uint8_t ) ( pxQueue )->uxQueueNumber, TRACE_QUEUE_AFTER_SEND( pxQueue ) )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )	TRACE_event( TRACE_EV_QUEUE_SEND, ( uint8_t ) ( pxQueue )->uxQueueNumber, TRACE_QUEUE_AFTER_SEND( pxQueue ) )
+#define traceQUEUE_RECEIVE( pxQueue )	TRACE_event( TRACE_EV_QUEUE_RECEIVE, ( uint8_t ) ( pxQueue )->uxQueueNumber, TRACE_QUEUE_AFTER_RECEIVE( pxQueue ) )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )	TRACE_event( TRACE_EV_QUEUE_RECEIVE, ( uint8_t ) ( pxQueue )->uxQueueNumber, TRACE_QUEUE_AFTER_RECEIVE( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )	TRACE_event( TRACE_EV_QUEUE_BLOCK_SEND, ( uint8_t ) ( pxQueue )->uxQueueNumber, 0 )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	TRACE_event( TRACE_EV_QUEUE_BLOCK_RECEIVE, ( uint8_t ) ( pxQueue )->uxQueueNumber, 0 )
+#define traceQUEUE_SEND_FAILED( pxQueue )	TRACE_event( TRACE_EV_QUEUE_SEND_FAILED, ( uint8_t ) ( pxQueue )->uxQueueNumber, 0 )
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue )	TRACE_event( TRACE_EV_QUEUE_SEND_FAILED, ( uint8_t ) ( pxQueue )->uxQueueNumber, 0 )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )	TRACE_event( TRACE_EV_QUEUE_RECEIVE_FAILED, ( uint8_t ) ( pxQueue )->uxQueueNumber, 0 )
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue )	TRACE_event( TRACE_EV_QUEUE_RECEIVE_FAILED, ( uint8_t ) ( pxQueue )->uxQueueNumber, 0 )
+#define traceISR_ENTER()	TRACE_isr_enter()
+#define traceISR_EXIT()	TRACE_isr_exit()
+#endif
+
+/* HEAP_TRACE=1: graba cada pvPortMalloc/vPortFree con el llamador (src/heapstats.c).
+Las macros se expanden dentro de pvPortMalloc y vPortFree: la dirección de retorno es
+la del llamador. Con -flto el compilador puede integrarlas en quien las llama y entonces
+queda el llamador de ese. */
+#ifdef HEAP_TRACE
+#include "../../src/heapstats.h"
+#define traceMALLOC( pvAddress, uiSize )	HEAPSTATS_trace( HEAPSTATS_OP_MALLOC, ( pvAddress ), ( uiSize ), __builtin_return_address( 0 ) )
+#define traceFREE( pvAddress, uiSize )	HEAPSTATS_trace( HEAPSTATS_OP_FREE, ( pvAddress ), ( uiSize ), __builtin_return_address( 0 ) )
+#endif
+
+/* CRITSTATS=1: tiempo con interrupciones enmascaradas en cada sección crítica del port,
+con el llamador de vPortEnterCritical (src/critstats.c). Como en HEAP_TRACE, la macro se
+expande dentro de vPortEnterCritical y la dirección de retorno es la de quien la llamó. */
+#ifdef CRITSTATS_ENABLED
+#include "../../src/critstats.h"
+#define traceCRITICAL_ENTER()	CRITSTATS_enter( __builtin_return_address( 0 ) )
+#define traceCRITICAL_EXIT()	CRITSTATS_exit()
+#endif
 
 /*Semaphore*/
 #define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configSUPPORT_STATIC_ALLOCATION 1
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
@@ -120,9 +194,11 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelete		1
 #define INCLUDE_vTaskCleanUpResources	0
 #define INCLUDE_vTaskSuspend		1
-#define INCLUDE_vTaskDelayUntil		0
+#define INCLUDE_xTaskDelayUntil		1	/* Tareas periódicas (src/periodic.h) */
 #define INCLUDE_vTaskDelay		1
 #define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+#define INCLUDE_eTaskGetState		1	/* Estado de una tarea colgada (src/supervisor.c) */
 
 /* Software timer related definitions. */
 #define configUSE_TIMERS                        1
@@ -107,6 +107,16 @@
     #define portTASK_RETURN_ADDRESS    prvTaskExitError
 #endif
 
+/* Instrumentation of the outermost critical section, called with interrupts
+ * masked (FreeRTOSConfig.h defines them with CRITSTATS=1, see src/critstats.h).
+ * Left undefined they generate no code. */
+#ifndef traceCRITICAL_ENTER
+    #define traceCRITICAL_ENTER()
+#endif
+#ifndef traceCRITICAL_EXIT
+    #define traceCRITICAL_EXIT()
+#endif
+
 /*
  * Setup the timer to generate the tick interrupts.  The implementation in this
  * file is weak to allow application writers to change the timer used to
@@ -381,6 +391,7 @@ void vPortEnterCritical( void )
     if( uxCriticalNesting == 1 )
     {
         configASSERT( ( portNVIC_INT_CTRL_REG & portVECTACTIVE_MASK ) == 0 );
+        traceCRITICAL_ENTER();
     }
 }
 /*-----------------------------------------------------------*/
@@ -392,6 +403,7 @@ void vPortExitCritical( void )
 
     if( uxCriticalNesting == 0 )
     {
+        traceCRITICAL_EXIT();
         portENABLE_INTERRUPTS();
     }
 }
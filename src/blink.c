@@ -1,11 +1,12 @@
 #include "FreeRTOS.h"
 #include "blink.h"
+#include "periodic.h"
 
-void taskBlink(void *args __attribute__((unused))) {
+void taskBlink(void *args) {
     //char *taskName = "taskBlink is running\r\n";
     for (;;) {
         gpio_toggle(GPIOC, GPIO13);
-		vTaskDelay(pdMS_TO_TICKS(250));
+        PERIODIC_wait(args);
 	}
 }
 
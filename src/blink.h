@@ -8,7 +8,10 @@
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/usart.h>
 
-void taskBlink(void *args __attribute__((unused)));
+#define BLINK_PERIOD_MS 250
+
+// Tarea periódica (periodic.h): recibe su periodic_t
+void taskBlink(void *args);
 void blink_setup(void);
 
 #endif /* ifndef BLINK_H */
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "cpustats.h"
+#include "cycles.h"
+#include "downlink.h"
+#include "periodic.h"
+#include "name.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// Historia de carga de una tarea, identificada por su número de TCB
+typedef struct {
+    UBaseType_t number;                 // 0: slot libre
+    uint32_t prev;                      // Tiempo de ejecución en la muestra anterior
+    char name[CPUSTATS_NAME_LEN];
+    uint16_t load[CPUSTATS_WINDOWS];
+} cpustats_slot_t;
+
+typedef struct {
+    cpustats_slot_t slots[CPUSTATS_MAX_TASKS];
+    uint16_t isr_load[CPUSTATS_WINDOWS];
+    uint8_t head;                       // Período que se escribe en la próxima muestra
+    uint8_t filled;                     // Períodos válidos en la ventana larga
+    int8_t idle;                        // Slot de la tarea idle
+    uint64_t prev_total;
+    uint64_t prev_isr;
+    cpustats_load_t load;
+} cpustats_t;
+
+static cpustats_t stats = { .idle = -1 };
+
+// Los tiempos de ejecución se restan en 32 bits: entre dos muestras hay mucho menos que
+// una vuelta del contador
+static uint16_t permille(uint32_t cycles, uint64_t window) {
+    if (window == 0) return 0;
+    uint64_t value = (uint64_t)cycles * 1000 / window;
+    return value > 1000 ? 1000 : (uint16_t)value;
+}
+
+static uint16_t window_average(const uint16_t *load) {
+    if (stats.filled == 0) return 0;
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < stats.filled; i++) sum += load[i];
+    return (uint16_t)(sum / stats.filled);
+}
+
+static uint16_t last_period(const uint16_t *load) {
+    return load[(stats.head + CPUSTATS_WINDOWS - 1) % CPUSTATS_WINDOWS];
+}
+
+static cpustats_slot_t *get_slot(UBaseType_t number) {
+    cpustats_slot_t *free_slot = NULL;
+    for (uint8_t i = 0; i < CPUSTATS_MAX_TASKS; i++) {
+        if (stats.slots[i].number == number) return &stats.slots[i];
+        if (stats.slots[i].number == 0 && free_slot == NULL) free_slot = &stats.slots[i];
+    }
+    if (free_slot != NULL) {
+        memset(free_slot, 0, sizeof(*free_slot));
+        free_slot->number = number;
+    }
+    return free_slot;
+}
+
+static BaseType_t cpustats_sample(void) {
+    UBaseType_t count = uxTaskGetNumberOfTasks();
+    TaskStatus_t *status = pvPortMalloc(count * sizeof(TaskStatus_t));
+    if (status == NULL) return pdFAIL;
+
+    configRUN_TIME_COUNTER_TYPE total;
+    count = uxTaskGetSystemState(status, count, &total);
+    uint64_t isr = CYCLES_isr_time();
+
+    // El tiempo de las tareas no incluye las ISRs: la ventana es la suma de los dos
+    uint32_t isr_delta = (uint32_t)(isr - stats.prev_isr);
+    uint64_t window = (total - stats.prev_total) + isr_delta;
+    stats.prev_total = total;
+    stats.prev_isr = isr;
+
+    uint8_t seen[CPUSTATS_MAX_TASKS] = { 0 };
+    TaskHandle_t idle = xTaskGetIdleTaskHandle();
+    stats.idle = -1;
+    for (UBaseType_t i = 0; i < count; i++) {
+        cpustats_slot_t *slot = get_slot(status[i].xTaskNumber);
+        if (slot == NULL) continue;
+
+        uint32_t runtime = (uint32_t)status[i].ulRunTimeCounter;
+        slot->load[stats.head] = permille(runtime - slot->prev, window);
+        slot->prev = runtime;
+        NAME_copy(slot->name, status[i].pcTaskName, CPUSTATS_NAME_LEN);
+
+        uint8_t index = (uint8_t)(slot - stats.slots);
+        seen[index] = 1;
+        if (status[i].xHandle == idle) stats.idle = (int8_t)index;
+    }
+    vPortFree(status);
+
+    // Las tareas borradas liberan su slot
+    for (uint8_t i = 0; i < CPUSTATS_MAX_TASKS; i++)
+        if (!seen[i]) stats.slots[i].number = 0;
+
+    stats.isr_load[stats.head] = permille(isr_delta, window);
+    stats.head = (stats.head + 1) % CPUSTATS_WINDOWS;
+    if (stats.filled < CPUSTATS_WINDOWS) stats.filled++;
+
+    cpustats_load_t load = {
+        .isr_short = last_period(stats.isr_load),
+        .isr_long = window_average(stats.isr_load),
+    };
+    if (stats.idle >= 0) {
+        load.idle_short = last_period(stats.slots[stats.idle].load);
+        load.idle_long = window_average(stats.slots[stats.idle].load);
+    }
+    taskENTER_CRITICAL();
+    stats.load = load;
+    taskEXIT_CRITICAL();
+    return pdPASS;
+}
+
+static void cpustats_publish(void) {
+    static cpustats_packet_t packet;
+
+    uint8_t used = 0;
+    for (uint8_t i = 0; i < CPUSTATS_MAX_TASKS; i++)
+        if (stats.slots[i].number != 0) used++;
+
+    packet.type = CPUSTATS_PACKET_TYPE;
+    packet.page = 0;
+    packet.pages = (used + CPUSTATS_TASKS_PER_PACKET - 1) / CPUSTATS_TASKS_PER_PACKET;
+    packet.uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    packet.isr_short = stats.load.isr_short;
+    packet.isr_long = stats.load.isr_long;
+    packet.idle_short = stats.load.idle_short;
+    packet.idle_long = stats.load.idle_long;
+    packet.count = 0;
+
+    for (uint8_t i = 0; i < CPUSTATS_MAX_TASKS; i++) {
+        const cpustats_slot_t *slot = &stats.slots[i];
+        if (slot->number == 0) continue;
+
+        cpustats_task_entry_t *entry = &packet.tasks[packet.count++];
+        memcpy(entry->name, slot->name, CPUSTATS_NAME_LEN);
+        entry->load_short = last_period(slot->load);
+        entry->load_long = window_average(slot->load);
+
+        if (packet.count == CPUSTATS_TASKS_PER_PACKET || packet.page * CPUSTATS_TASKS_PER_PACKET + packet.count == used) {
+            uint16_t len = offsetof(cpustats_packet_t, tasks) + packet.count * sizeof(cpustats_task_entry_t);
+            DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, len, 0);
+            packet.page++;
+            packet.count = 0;
+        }
+    }
+}
+
+void taskCpuStats(void *args) {
+    // La primera muestra solo fija la referencia de la ventana
+    cpustats_sample();
+    stats.filled = 0;
+    stats.head = 0;
+
+    for (;;) {
+        PERIODIC_wait(args);
+        if (cpustats_sample() == pdPASS) cpustats_publish();
+    }
+}
+
+void CPUSTATS_get_load(cpustats_load_t *load) {
+    taskENTER_CRITICAL();
+    *load = stats.load;
+    taskEXIT_CRITICAL();
+}
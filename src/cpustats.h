@@ -0,0 +1,57 @@
+#ifndef CPUSTATS_H
+#define CPUSTATS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+// Uso de CPU por tarea a partir de las estadísticas de ejecución de FreeRTOS (contadas en
+// ciclos, ver cycles.h). Cada CPUSTATS_PERIOD_MS se toma una muestra y se calcula la carga
+// de cada tarea, de las ISRs y de la tarea idle (margen libre) en dos ventanas: el último
+// período y los últimos CPUSTATS_WINDOWS períodos. El resultado sale como telemetría por
+// el stream de housekeeping del enlace de bajada.
+
+#define CPUSTATS_PERIOD_MS        1000
+#define CPUSTATS_WINDOWS          10     // Ventana larga, en períodos
+#define CPUSTATS_MAX_TASKS        12
+#define CPUSTATS_TASKS_PER_PACKET 8
+#define CPUSTATS_NAME_LEN         8
+
+#define CPUSTATS_PACKET_TYPE 0x43
+
+// Carga de una tarea, en milésimas de CPU
+typedef struct __attribute__((packed)) {
+    char name[CPUSTATS_NAME_LEN];   // Truncado, sin terminador si ocupa todo
+    uint16_t load_short;            // Último período
+    uint16_t load_long;             // Ventana larga
+} cpustats_task_entry_t;
+
+// Paquete de telemetría. Si hay más tareas que CPUSTATS_TASKS_PER_PACKET la muestra se
+// parte en varios paquetes (page de pages); solo se envían las entradas usadas
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // CPUSTATS_PACKET_TYPE
+    uint8_t page;
+    uint8_t pages;
+    uint8_t count;                  // Entradas de tareas en este paquete
+    uint32_t uptime_ms;
+    uint16_t isr_short;
+    uint16_t isr_long;
+    uint16_t idle_short;
+    uint16_t idle_long;
+    cpustats_task_entry_t tasks[CPUSTATS_TASKS_PER_PACKET];
+} cpustats_packet_t;
+
+// Resumen de la última muestra, en milésimas de CPU
+typedef struct {
+    uint16_t isr_short;
+    uint16_t isr_long;
+    uint16_t idle_short;
+    uint16_t idle_long;
+} cpustats_load_t;
+
+// Tarea periódica (periodic.h) que toma las muestras y publica la telemetría
+void taskCpuStats(void *args);
+
+void CPUSTATS_get_load(cpustats_load_t *load);
+
+#endif
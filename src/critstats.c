@@ -0,0 +1,104 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "critstats.h"
+#include "downlink.h"
+
+#include <libopencm3/cm3/dwt.h>
+#include <string.h>
+
+// Sin CRITSTATS=1 las macros del port quedan vacías y el módulo no se compila
+#ifdef CRITSTATS_ENABLED
+
+// Solo lo tocan el port y la copia de CRITSTATS_publish(), todos con las interrupciones
+// enmascaradas: no hace falta otro lock
+typedef struct {
+    uint32_t start;                 // CYCCNT al entrar a la sección en curso
+    uint32_t caller;
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+    critstats_offender_t worst[CRITSTATS_OFFENDERS];
+    uint16_t histogram[CRITSTATS_BUCKETS];
+} critstats_t;
+
+static critstats_t critstats;
+
+_Static_assert(sizeof(critstats_packet_t) <= DOWNLINK_MAX_FRAME, "El paquete de secciones críticas no entra en una trama");
+
+// Cubeta 0: < 2^CRITSTATS_MIN_LOG2. Después una por octava; la última junta todo lo que no entra
+static uint8_t bucket_of(uint32_t cycles) {
+    if (cycles < (1u << CRITSTATS_MIN_LOG2)) return 0;
+    uint32_t bucket = 1 + (31 - __builtin_clz(cycles)) - CRITSTATS_MIN_LOG2;
+    return bucket < CRITSTATS_BUCKETS ? bucket : CRITSTATS_BUCKETS - 1;
+}
+
+void CRITSTATS_enter(void *caller) {
+    critstats.caller = (uint32_t)(uintptr_t)caller;
+    critstats.start = DWT_CYCCNT;
+}
+
+void CRITSTATS_exit(void) {
+    uint32_t cycles = DWT_CYCCNT - critstats.start;
+
+    critstats.count++;
+    critstats.total += cycles;
+    if (cycles > critstats.max) critstats.max = cycles;
+    uint16_t *bucket = &critstats.histogram[bucket_of(cycles)];
+    if (*bucket != UINT16_MAX) (*bucket)++;
+
+    // El llamador ya está en la tabla o reemplaza al de la sección más corta
+    critstats_offender_t *entry = NULL;
+    critstats_offender_t *shortest = &critstats.worst[0];
+    for (uint8_t i = 0; i < CRITSTATS_OFFENDERS; i++) {
+        if (critstats.worst[i].caller == critstats.caller) {
+            entry = &critstats.worst[i];
+            break;
+        }
+        if (critstats.worst[i].max < shortest->max) shortest = &critstats.worst[i];
+    }
+    if (entry == NULL) {
+        if (cycles <= shortest->max) return;
+        entry = shortest;
+        entry->caller = critstats.caller;
+        entry->max = 0;
+        entry->count = 0;
+    }
+    entry->count++;
+    if (cycles > entry->max) entry->max = cycles;
+}
+
+void CRITSTATS_publish(void) {
+    static critstats_t copy;
+    taskENTER_CRITICAL();
+    copy = critstats;
+    taskEXIT_CRITICAL();
+    if (copy.count == 0) return;
+
+    static critstats_packet_t packet;
+    packet.type = CRITSTATS_PACKET_TYPE;
+    packet.buckets = CRITSTATS_BUCKETS;
+    packet.offenders = 0;
+    packet.reserved = 0;
+    packet.uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    packet.count = copy.count;
+    packet.max = copy.max;
+    packet.mean = (uint32_t)(copy.total / copy.count);
+    packet.total = copy.total;
+    memcpy(packet.histogram, copy.histogram, sizeof(packet.histogram));
+
+    // Ordenados por la sección más larga
+    memset(packet.worst, 0, sizeof(packet.worst));
+    for (uint8_t i = 0; i < CRITSTATS_OFFENDERS; i++) {
+        const critstats_offender_t *o = &copy.worst[i];
+        if (o->count == 0) continue;
+        uint8_t pos = packet.offenders++;
+        while (pos > 0 && packet.worst[pos - 1].max < o->max) {
+            packet.worst[pos] = packet.worst[pos - 1];
+            pos--;
+        }
+        packet.worst[pos] = *o;
+    }
+    DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, sizeof(packet), 0);
+}
+
+#endif
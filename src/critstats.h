@@ -0,0 +1,65 @@
+#ifndef CRITSTATS_H
+#define CRITSTATS_H
+
+#include <stdint.h>
+
+// Tiempo con interrupciones enmascaradas en las secciones críticas del kernel (compilando
+// con CRITSTATS=1). vPortEnterCritical() y vPortExitCritical() del port llaman a
+// CRITSTATS_enter() y CRITSTATS_exit() en la sección más externa (FreeRTOSConfig.h); sin
+// CRITSTATS=1 las macros del port quedan vacías y el módulo no se compila.
+//
+// Se mide con CYCCNT desde que BASEPRI enmascara hasta justo antes de desenmascarar: es
+// lo que una interrupción de prioridad configMAX_SYSCALL_INTERRUPT_PRIORITY o menor puede
+// tener que esperar. Por ejemplo, a 115200 baudios un byte tarda 87 µs: una sección más
+// larga que eso puede perder bytes de RX de una UART (ORE). Se lleva el máximo, la media,
+// un histograma con una cubeta por octava y los CRITSTATS_OFFENDERS llamadores con las
+// secciones más largas. Los paquetes salen por el stream de housekeeping desde la tarea de
+// telemetría (telemetry.h); tools/critstats_report.py los muestra y con el ELF
+// traduce los llamadores a funciones.
+//
+// OBS: no se miden las secciones de taskENTER_CRITICAL_FROM_ISR() ni el tiempo dentro de
+// las ISRs del kernel (SysTick, PendSV), que enmascaran sin pasar por el port. La medición
+// incluye unos ciclos de la propia instrumentación. El llamador es la dirección de retorno
+// de vPortEnterCritical(): con -flto el compilador puede integrarla en quien la llama y
+// entonces queda el llamador de ese.
+//
+// OBS: este header solo puede incluir headers estándar, lo incluye FreeRTOSConfig.h.
+
+#define CRITSTATS_BUCKETS   16
+#define CRITSTATS_MIN_LOG2  5       // La primera cubeta es < 32 ciclos
+#define CRITSTATS_OFFENDERS 4
+
+#define CRITSTATS_PACKET_TYPE 0x49
+
+// Llamador con las secciones más largas
+typedef struct __attribute__((packed)) {
+    uint32_t caller;                // Dirección de retorno de vPortEnterCritical()
+    uint32_t max;                   // Sección más larga, en ciclos
+    uint32_t count;                 // Secciones medidas desde que entró en la tabla
+} critstats_offender_t;
+
+// Paquete de telemetría, en ciclos del core, acumulado desde el arranque
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // CRITSTATS_PACKET_TYPE
+    uint8_t buckets;                // CRITSTATS_BUCKETS
+    uint8_t offenders;              // Entradas usadas de worst
+    uint8_t reserved;
+    uint32_t uptime_ms;
+    uint32_t count;                 // Secciones medidas
+    uint32_t max;
+    uint32_t mean;
+    uint64_t total;                 // Ciclos enmascarados en total
+    critstats_offender_t worst[CRITSTATS_OFFENDERS];   // De la más larga a la más corta
+    uint16_t histogram[CRITSTATS_BUCKETS];  // Satura en 0xFFFF
+} critstats_packet_t;
+
+// Desde el port, con las interrupciones ya enmascaradas
+void CRITSTATS_enter(void *caller);
+
+// Desde el port, antes de desenmascarar
+void CRITSTATS_exit(void);
+
+// Publica el paquete de telemetría
+void CRITSTATS_publish(void);
+
+#endif
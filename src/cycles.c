@@ -0,0 +1,68 @@
+#include "cycles.h"
+
+// Eventos de ISR de la traza del kernel (FreeRTOSConfig.h con TRACE_ENABLED)
+#ifndef traceISR_ENTER
+#define traceISR_ENTER()
+#define traceISR_EXIT()
+#endif
+
+typedef struct {
+    uint32_t high;         // Vueltas de CYCCNT
+    uint32_t last;         // Última lectura, para detectar la vuelta
+    uint32_t isr_depth;    // Anidamiento de ISRs instrumentadas
+    uint32_t isr_start;    // CYCCNT al entrar a la ISR más externa
+    uint64_t isr_cycles;
+} cycles_t;
+
+static cycles_t cycles;
+
+void CYCLES_setup(void) {
+    // TRACE_setup() lo habilita antes del scheduler: ponerlo en cero de nuevo haría
+    // retroceder los timestamps de la traza
+    if (!(DWT_CTRL & DWT_CTRL_CYCCNTENA)) dwt_enable_cycle_counter();
+    cycles.last = DWT_CYCCNT;
+}
+
+// Con las interrupciones enmascaradas: una ISR que lea en el medio vería la vuelta dos veces
+static uint64_t cycles_extend(void) {
+    uint32_t now = DWT_CYCCNT;
+    if (now < cycles.last) cycles.high++;
+    cycles.last = now;
+    return ((uint64_t)cycles.high << 32) | now;
+}
+
+uint64_t CYCLES_now(void) {
+    uint32_t mask = cm_mask_interrupts(1);
+    uint64_t now = cycles_extend();
+    cm_mask_interrupts(mask);
+    return now;
+}
+
+uint64_t CYCLES_task_time(void) {
+    uint32_t mask = cm_mask_interrupts(1);
+    uint64_t now = cycles_extend() - cycles.isr_cycles;
+    cm_mask_interrupts(mask);
+    return now;
+}
+
+uint64_t CYCLES_isr_time(void) {
+    uint32_t mask = cm_mask_interrupts(1);
+    uint64_t isr = cycles.isr_cycles;
+    cm_mask_interrupts(mask);
+    return isr;
+}
+
+// Solo se mide la ISR más externa: las anidadas quedan dentro de su intervalo
+void CYCLES_isr_enter(void) {
+    uint32_t mask = cm_mask_interrupts(1);
+    if (cycles.isr_depth++ == 0) cycles.isr_start = DWT_CYCCNT;
+    traceISR_ENTER();
+    cm_mask_interrupts(mask);
+}
+
+void CYCLES_isr_exit(void) {
+    uint32_t mask = cm_mask_interrupts(1);
+    traceISR_EXIT();
+    if (--cycles.isr_depth == 0) cycles.isr_cycles += DWT_CYCCNT - cycles.isr_start;
+    cm_mask_interrupts(mask);
+}
@@ -0,0 +1,34 @@
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+
+#include <libopencm3/cm3/dwt.h>
+#include <libopencm3/cm3/cortex.h>
+
+// Base de tiempo en ciclos del core con el contador CYCCNT del DWT, extendido a 64 bits.
+// CYCCNT da la vuelta cada 59,6 s a 72 MHz: la extensión necesita una lectura al menos
+// una vez por vuelta, y el cambio de contexto lee en cada switch.
+//
+// Además lleva la cuenta del tiempo en ISRs: las rutinas de interrupción llaman a
+// CYCLES_isr_enter() al entrar y CYCLES_isr_exit() al salir. El contador de las
+// estadísticas de FreeRTOS (CYCLES_task_time) descuenta ese tiempo, así el tiempo de una
+// tarea no incluye las interrupciones que la desplazaron.
+//
+// OBS: CYCLES_setup() y CYCLES_task_time() están declaradas en FreeRTOSConfig.h, que las
+// usa para portCONFIGURE_TIMER_FOR_RUN_TIME_STATS y portGET_RUN_TIME_COUNTER_VALUE.
+// El DWT no cuenta en modo STOP: ese tiempo no aparece en ninguna tarea.
+
+#define CYCLES_PER_US (configCPU_CLOCK_HZ / 1000000)
+
+// Ciclos desde CYCLES_setup()
+uint64_t CYCLES_now(void);
+
+// Ciclos totales dentro de ISRs instrumentadas
+uint64_t CYCLES_isr_time(void);
+
+void CYCLES_isr_enter(void);
+void CYCLES_isr_exit(void);
+
+#endif
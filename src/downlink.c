@@ -0,0 +1,261 @@
+#include "FreeRTOS.h"
+#include "downlink.h"
+#include "uart.h"
+#include "queue.h"
+#include "manifest.h"
+#include "supervisor.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define WIRE_MAX_FRAME (DOWNLINK_MAX_FRAME + DOWNLINK_FRAME_OVERHEAD)  // Trama con el sobre
+#define DRR_QUANTUM WIRE_MAX_FRAME      // Bytes que recibe un stream por cada unidad de peso
+#define PRIORITY_LEVELS 3               // Niveles de prioridad (0 es el más prioritario)
+#define MAX_REFILL_TICKS (10 * configTICK_RATE_HZ)  // Evita overflow al recargar tras mucho tiempo
+#define IDLE_WAIT_MS 1000               // Espera máxima sin tramas: check-in con el supervisor
+
+_Static_assert(DOWNLINK_MAX_FRAME <= UINT8_MAX, "El largo de la trama no entra en el sobre");
+
+typedef struct {
+    uint8_t priority;      // Nivel de prioridad estricta entre streams
+    uint8_t weight;        // Peso DRR dentro del mismo nivel
+    uint16_t rate;         // Tasa del token bucket en bytes/s (0 = sin límite)
+    uint16_t burst;        // Capacidad del token bucket en bytes (>= WIRE_MAX_FRAME)
+} stream_config_t;
+
+typedef struct {
+    QueueHandle_t queue;           // Tramas pendientes del stream (pbuf_t *)
+    uint32_t tokens;               // Tokens disponibles, en bytes * configTICK_RATE_HZ
+    uint32_t deficit;              // Déficit DRR en bytes
+    downlink_counters_t counters;
+} stream_t;
+
+// El enlace a 115200 baudios da ~11520 bytes/s. La telemetría tiene prioridad estricta,
+// GPS y log comparten el nivel 1 con pesos 2:1 y el payload usa lo que sobra.
+// La cola de cada stream y cuántas tramas guarda están en el manifiesto (manifest.h)
+static const stream_config_t stream_config[DOWNLINK_STREAM_COUNT] = {
+    [DOWNLINK_STREAM_HK]      = { .priority = 0, .weight = 1, .rate = 2048, .burst = 512 },
+    [DOWNLINK_STREAM_GPS]     = { .priority = 1, .weight = 2, .rate = 4096, .burst = 256 },
+    [DOWNLINK_STREAM_LOG]     = { .priority = 1, .weight = 1, .rate = 2048, .burst = 256 },
+    [DOWNLINK_STREAM_PAYLOAD] = { .priority = 2, .weight = 1, .rate = 0,    .burst = 0 },
+};
+
+static stream_t streams[DOWNLINK_STREAM_COUNT];
+static uint8_t drr_turn[PRIORITY_LEVELS];  // Stream que tiene el turno en cada nivel
+static uint32_t downlink_usart;
+static TaskHandle_t downlink_handle;
+static TickType_t last_refill;
+
+// Cola de cada stream en el manifiesto
+static const manifest_object_t stream_queues[DOWNLINK_STREAM_COUNT] = {
+    [DOWNLINK_STREAM_HK]      = MANIFEST_DOWNLINK_HK,
+    [DOWNLINK_STREAM_GPS]     = MANIFEST_DOWNLINK_GPS,
+    [DOWNLINK_STREAM_LOG]     = MANIFEST_DOWNLINK_LOG,
+    [DOWNLINK_STREAM_PAYLOAD] = MANIFEST_DOWNLINK_PAYLOAD,
+};
+
+// Nombres de las colas para la traza del kernel (registro vacío sin TRACE=1)
+static const char *const stream_names[DOWNLINK_STREAM_COUNT] __attribute__((unused)) =
+    { "DL HK", "DL GPS", "DL log", "DL payload" };
+
+BaseType_t DOWNLINK_setup(uint32_t usart) {
+    downlink_usart = usart;
+
+    for (uint8_t i = 0; i < DOWNLINK_STREAM_COUNT; i++) {
+        stream_t *s = &streams[i];
+        s->queue = MANIFEST_queue(stream_queues[i]);
+        if (s->queue == NULL) return pdFAIL;
+        vQueueAddToRegistry(s->queue, stream_names[i]);
+
+        // Los baldes arrancan llenos
+        s->tokens = (uint32_t)stream_config[i].burst * configTICK_RATE_HZ;
+        s->deficit = 0;
+    }
+    return pdPASS;
+}
+
+static void count_dropped(stream_t *s, uint16_t len) {
+    taskENTER_CRITICAL();
+    s->counters.dropped += len;
+    taskEXIT_CRITICAL();
+}
+
+BaseType_t DOWNLINK_send(downlink_stream_id_t stream, const uint8_t *data, uint16_t len, TickType_t xTicksToWait) {
+    if (stream >= DOWNLINK_STREAM_COUNT || len == 0) return pdFAIL;
+
+    pbuf_t *p = len <= DOWNLINK_MAX_FRAME ? PBUF_alloc(len, 0) : NULL;
+    if (p == NULL) {
+        count_dropped(&streams[stream], len);
+        return pdFAIL;
+    }
+    uint16_t offset = 0;
+    for (pbuf_t *q = p; q != NULL; q = q->next) {
+        memcpy(q->payload, data + offset, q->len);
+        offset += q->len;
+    }
+    return DOWNLINK_send_pbuf(stream, p, xTicksToWait);
+}
+
+BaseType_t DOWNLINK_send_pbuf(downlink_stream_id_t stream, pbuf_t *p, TickType_t xTicksToWait) {
+    if (p == NULL) return pdFAIL;
+    if (stream >= DOWNLINK_STREAM_COUNT || p->tot_len == 0) {
+        PBUF_free(p);
+        return pdFAIL;
+    }
+    stream_t *s = &streams[stream];
+    uint16_t len = p->tot_len;
+
+    // La trama entra completa o no entra: nunca se fragmenta
+    if (len > DOWNLINK_MAX_FRAME || xQueueSendToBack(s->queue, &p, xTicksToWait) != pdTRUE) {
+        PBUF_free(p);
+        count_dropped(s, len);
+        return pdFAIL;
+    }
+    taskENTER_CRITICAL();
+    s->counters.queued += len;
+    taskEXIT_CRITICAL();
+
+    // Avisar al despachador que hay una trama nueva
+    if (downlink_handle != NULL) xTaskNotifyGive(downlink_handle);
+    return pdPASS;
+}
+
+void DOWNLINK_get_counters(downlink_stream_id_t stream, downlink_counters_t *counters) {
+    if (stream >= DOWNLINK_STREAM_COUNT) return;
+
+    taskENTER_CRITICAL();
+    *counters = streams[stream].counters;
+    taskEXIT_CRITICAL();
+}
+
+// Bytes en la línea de la próxima trama del stream, con el sobre. 0 si no hay. Solo el
+// despachador saca tramas
+static size_t next_length(uint8_t id) {
+    pbuf_t *p;
+    return xQueuePeek(streams[id].queue, &p, 0) == pdTRUE ? p->tot_len + DOWNLINK_FRAME_OVERHEAD : 0;
+}
+
+// Recarga los token buckets según los ticks transcurridos
+static void refill_tokens(TickType_t now) {
+    TickType_t elapsed = now - last_refill;
+    last_refill = now;
+    if (elapsed > MAX_REFILL_TICKS) elapsed = MAX_REFILL_TICKS;
+
+    for (uint8_t i = 0; i < DOWNLINK_STREAM_COUNT; i++) {
+        const stream_config_t *config = &stream_config[i];
+        if (config->rate == 0) continue;
+
+        uint32_t capacity = (uint32_t)config->burst * configTICK_RATE_HZ;
+        streams[i].tokens += (uint32_t)config->rate * elapsed;
+        if (streams[i].tokens > capacity) streams[i].tokens = capacity;
+    }
+}
+
+static BaseType_t has_tokens(uint8_t id, size_t len) {
+    if (stream_config[id].rate == 0) return pdTRUE;
+    return streams[id].tokens >= len * configTICK_RATE_HZ;
+}
+
+// Deficit Round Robin entre los streams de un mismo nivel de prioridad.
+// Devuelve el stream que puede despachar su próxima trama, o -1 si ninguno puede.
+static int drr_select(uint8_t priority) {
+    uint8_t *turn = &drr_turn[priority];
+
+    for (uint8_t i = 0; i <= DOWNLINK_STREAM_COUNT; i++) {
+        uint8_t id = *turn;
+        if (stream_config[id].priority == priority) {
+            size_t len = next_length(id);
+            if (len == 0)
+                streams[id].deficit = 0;  // Un stream vacío pierde el déficit acumulado
+            else if (streams[id].deficit >= len && has_tokens(id, len))
+                return id;
+        }
+
+        // Pasar el turno al siguiente stream del nivel y otorgarle su quantum
+        *turn = (*turn + 1) % DOWNLINK_STREAM_COUNT;
+        id = *turn;
+        if (stream_config[id].priority == priority) {
+            uint32_t quantum = (uint32_t)stream_config[id].weight * DRR_QUANTUM;
+            streams[id].deficit += quantum;
+            if (streams[id].deficit > quantum + WIRE_MAX_FRAME)
+                streams[id].deficit = quantum + WIRE_MAX_FRAME;
+        }
+    }
+    return -1;
+}
+
+// Ticks hasta que algún stream con datos tenga tokens suficientes
+static TickType_t ticks_until_eligible(void) {
+    TickType_t wait = portMAX_DELAY;
+
+    for (uint8_t i = 0; i < DOWNLINK_STREAM_COUNT; i++) {
+        size_t len = next_length(i);
+        if (len == 0 || has_tokens(i, len)) continue;
+
+        uint32_t missing = len * configTICK_RATE_HZ - streams[i].tokens;
+        TickType_t ticks = (missing + stream_config[i].rate - 1) / stream_config[i].rate;
+        if (ticks < wait) wait = ticks;
+    }
+    return wait;
+}
+
+// CRC-16/CCITT-FALSE bit a bit: el enlace está limitado por la UART, no por el CRC
+static uint16_t crc16_update(uint16_t crc, uint8_t byte) {
+    crc ^= (uint16_t)byte << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+        crc = crc & 0x8000 ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    return crc;
+}
+
+static void put_byte(uint8_t byte, uint16_t *crc) {
+    if (crc != NULL) *crc = crc16_update(*crc, byte);
+    UART_putchar(downlink_usart, byte, portMAX_DELAY);
+}
+
+void taskDownlink(void *args __attribute__((unused))) {
+    supervisor_slot_t *alive = SUPERVISOR_self();
+    downlink_handle = xTaskGetCurrentTaskHandle();
+    last_refill = xTaskGetTickCount();
+
+    for (;;) {
+        SUPERVISOR_checkin(alive);
+        refill_tokens(xTaskGetTickCount());
+
+        // Prioridad estricta entre niveles, DRR dentro de cada nivel
+        int id = -1;
+        for (uint8_t priority = 0; priority < PRIORITY_LEVELS && id < 0; priority++)
+            id = drr_select(priority);
+
+        if (id < 0) {
+            // Nada para despachar: esperar una trama nueva o a que se recarguen los tokens
+            TickType_t wait = ticks_until_eligible();
+            ulTaskNotifyTake(pdTRUE, wait < pdMS_TO_TICKS(IDLE_WAIT_MS) ? wait : pdMS_TO_TICKS(IDLE_WAIT_MS));
+            continue;
+        }
+
+        stream_t *s = &streams[id];
+        pbuf_t *p;
+        if (xQueueReceive(s->queue, &p, 0) != pdTRUE) continue;
+        uint16_t len = p->tot_len;
+        uint16_t wire = len + DOWNLINK_FRAME_OVERHEAD;
+
+        if (stream_config[id].rate != 0) s->tokens -= wire * configTICK_RATE_HZ;
+        s->deficit -= wire;
+
+        // Se transmite desde los bloques de la trama, sin copiarla antes, y el CRC se
+        // calcula al vuelo. La cola de TX de la UART limita cuánto puede adelantarse una
+        // trama de menor prioridad
+        uint16_t crc = 0xFFFF;
+        put_byte(DOWNLINK_SYNC0, NULL);
+        put_byte(DOWNLINK_SYNC1, NULL);
+        put_byte((uint8_t)id, &crc);
+        put_byte((uint8_t)len, &crc);
+        for (const pbuf_t *q = p; q != NULL; q = q->next)
+            for (uint16_t i = 0; i < q->len; i++)
+                put_byte(q->payload[i], &crc);
+        put_byte((uint8_t)crc, NULL);
+        put_byte((uint8_t)(crc >> 8), NULL);
+        PBUF_free(p);
+        s->counters.sent += len;
+    }
+}
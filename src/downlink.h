@@ -0,0 +1,57 @@
+#ifndef DOWNLINK_H
+#define DOWNLINK_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pbuf.h"
+#include <stdint.h>
+
+// Tamaño máximo de una trama encolada en un stream
+#define DOWNLINK_MAX_FRAME 128
+
+// Cada trama sale por la UART dentro de un sobre, para que tierra separe los streams y
+// descarte las tramas dañadas (tools/downlink_frames.py):
+//   uint8_t  DOWNLINK_SYNC0, DOWNLINK_SYNC1
+//   uint8_t  stream (downlink_stream_id_t)
+//   uint8_t  largo de la trama
+//   ...      la trama
+//   uint16_t CRC-16/CCITT-FALSE (polinomio 0x1021, inicial 0xFFFF) del stream, el largo
+//            y la trama, little-endian
+#define DOWNLINK_SYNC0 0x1A
+#define DOWNLINK_SYNC1 0xCF
+#define DOWNLINK_FRAME_OVERHEAD 6
+
+// Streams que comparten el enlace de bajada
+typedef enum {
+    DOWNLINK_STREAM_HK = 0,     // Housekeeping / telemetría
+    DOWNLINK_STREAM_GPS,        // Sentencias NMEA del GPS
+    DOWNLINK_STREAM_LOG,        // Mensajes de log
+    DOWNLINK_STREAM_PAYLOAD,    // Datos de carga útil
+    DOWNLINK_STREAM_COUNT
+} downlink_stream_id_t;
+
+// Contadores por stream (en bytes)
+typedef struct {
+    uint32_t queued;   // Bytes aceptados en la cola del stream
+    uint32_t sent;     // Bytes entregados a la cola de TX de la UART
+    uint32_t dropped;  // Bytes descartados por falta de espacio
+} downlink_counters_t;
+
+// Toma del manifiesto las colas de cada stream. usart es la UART del enlace de bajada
+BaseType_t DOWNLINK_setup(uint32_t usart);
+
+// Tarea que despacha las tramas de los streams hacia la UART
+void taskDownlink(void *args __attribute__((unused)));
+
+// Copia una trama completa a un pbuf y la encola en el stream. Si no hay lugar en
+// xTicksToWait la descarta
+BaseType_t DOWNLINK_send(downlink_stream_id_t stream, const uint8_t *data, uint16_t len, TickType_t xTicksToWait);
+
+// Encola una trama ya armada en un pbuf, sin copiarla. El enlace se queda con la
+// referencia del que llama: la libera después de transmitirla o si la descarta
+BaseType_t DOWNLINK_send_pbuf(downlink_stream_id_t stream, pbuf_t *p, TickType_t xTicksToWait);
+
+// Copia los contadores del stream
+void DOWNLINK_get_counters(downlink_stream_id_t stream, downlink_counters_t *counters);
+
+#endif
@@ -0,0 +1,302 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// Heap TLSF (Two-Level Segregated Fit), alternativa a heap_4 que se elige con HEAP=tlsf en
+// el Makefile. Los bloques libres se guardan en listas por clase de tamaño: el primer
+// nivel es la potencia de 2 y el segundo la divide en TLSF_SL_COUNT partes. Dos bitmaps
+// dicen qué listas tienen bloques, así que buscar un bloque es un par de CLZ y no depende
+// de cuántos bloques libres haya: pvPortMalloc y vPortFree tardan un tiempo acotado con el
+// scheduler suspendido. heap_4 recorre la lista de bloques libres en los dos.
+//
+// Cada bloque guarda un puntero al bloque físico anterior para unirse con sus vecinos al
+// liberarse. Los tamaños incluyen el encabezado, como en heap_4, y las estadísticas son
+// las mismas (vPortGetHeapStats, traceMALLOC, vApplicationMallocFailedHook).
+//
+// OBS: la búsqueda redondea el pedido hacia arriba hasta el comienzo de la clase siguiente
+// para tomar cualquier bloque de la lista sin recorrerla. Un pedido puede fallar aunque
+// haya un bloque justo en su clase; en el peor caso se desperdicia 1/TLSF_SL_COUNT.
+
+#define TLSF_ALIGN_LOG2  3
+#define TLSF_SL_LOG2     3
+#define TLSF_SL_COUNT    (1 << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT    (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_SMALL_BLOCK ((size_t)1 << TLSF_FL_SHIFT)    // Debajo, clases lineales de a 8 B
+
+_Static_assert(portBYTE_ALIGNMENT == (1 << TLSF_ALIGN_LOG2), "TLSF asume portBYTE_ALIGNMENT 8");
+
+// log2 entero en tiempo de compilación, para dimensionar el primer nivel con el heap
+#define TLSF_LOG2_4(x)  ((x) >= 8 ? 3 : (x) >= 4 ? 2 : (x) >= 2 ? 1 : 0)
+#define TLSF_LOG2_8(x)  ((x) >= 16 ? 4 + TLSF_LOG2_4((x) >> 4) : TLSF_LOG2_4(x))
+#define TLSF_LOG2_16(x) ((x) >= 256 ? 8 + TLSF_LOG2_8((x) >> 8) : TLSF_LOG2_8(x))
+#define TLSF_LOG2_32(x) ((x) >= 65536 ? 16 + TLSF_LOG2_16((x) >> 16) : TLSF_LOG2_16(x))
+
+// Clases del primer nivel: la 0 para los bloques chicos y una por potencia de 2 hasta el heap
+#define TLSF_FL_COUNT (TLSF_LOG2_32(configTOTAL_HEAP_SIZE) - TLSF_FL_SHIFT + 2)
+
+_Static_assert(TLSF_FL_COUNT > 0 && TLSF_FL_COUNT <= 32, "configTOTAL_HEAP_SIZE fuera de rango para TLSF");
+
+#define TLSF_FREE ((size_t)1)     // Bit bajo de size: bloque libre
+
+typedef struct tlsf_block {
+    struct tlsf_block *prev_phys;   // Bloque anterior en memoria, NULL en el primero
+    size_t size;                    // Con el encabezado, múltiplo de 8 más TLSF_FREE
+    struct tlsf_block *next_free;   // Los enlaces solo existen en los bloques libres
+    struct tlsf_block *prev_free;
+} tlsf_block_t;
+
+#define TLSF_HEADER    offsetof(tlsf_block_t, next_free)
+#define TLSF_MIN_BLOCK sizeof(tlsf_block_t)
+
+#if (configAPPLICATION_ALLOCATED_HEAP == 1)
+extern uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+#else
+static uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+#endif
+
+typedef struct {
+    uint32_t fl_bitmap;
+    uint8_t sl_bitmap[TLSF_FL_COUNT];
+    tlsf_block_t *heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    uint8_t initialised;
+    size_t free_bytes;
+    size_t min_free_bytes;
+    size_t allocations;
+    size_t frees;
+} tlsf_t;
+
+static tlsf_t tlsf;
+
+static inline uint32_t tlsf_fls(size_t value) {
+    return 31 - (uint32_t)__builtin_clz((uint32_t)value);
+}
+
+static inline uint32_t tlsf_ffs(uint32_t value) {
+    return (uint32_t)__builtin_ctz(value);
+}
+
+static inline size_t block_size(const tlsf_block_t *block) {
+    return block->size & ~TLSF_FREE;
+}
+
+static inline tlsf_block_t *next_phys(const tlsf_block_t *block) {
+    return (tlsf_block_t *)((uint8_t *)block + block_size(block));
+}
+
+// Clase de la lista en la que se guarda un bloque de ese tamaño
+static void mapping_insert(size_t size, uint32_t *fl, uint32_t *sl) {
+    if (size < TLSF_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = (uint32_t)(size >> TLSF_ALIGN_LOG2);
+    } else {
+        uint32_t bit = tlsf_fls(size);
+        *fl = bit - TLSF_FL_SHIFT + 1;
+        *sl = (uint32_t)(size >> (bit - TLSF_SL_LOG2)) - TLSF_SL_COUNT;
+    }
+}
+
+// Primera clase en la que cualquier bloque alcanza para el pedido
+static void mapping_search(size_t size, uint32_t *fl, uint32_t *sl) {
+    if (size >= TLSF_SMALL_BLOCK) size += ((size_t)1 << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+    mapping_insert(size, fl, sl);
+}
+
+static void insert_block(tlsf_block_t *block) {
+    uint32_t fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    tlsf_block_t *head = tlsf.heads[fl][sl];
+    block->next_free = head;
+    block->prev_free = NULL;
+    if (head != NULL) head->prev_free = block;
+    tlsf.heads[fl][sl] = block;
+    tlsf.fl_bitmap |= 1UL << fl;
+    tlsf.sl_bitmap[fl] |= (uint8_t)(1U << sl);
+}
+
+static void remove_block(tlsf_block_t *block) {
+    uint32_t fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    if (block->next_free != NULL) block->next_free->prev_free = block->prev_free;
+    if (block->prev_free != NULL) {
+        block->prev_free->next_free = block->next_free;
+    } else {
+        tlsf.heads[fl][sl] = block->next_free;
+        if (block->next_free == NULL) {
+            tlsf.sl_bitmap[fl] &= (uint8_t)~(1U << sl);
+            if (tlsf.sl_bitmap[fl] == 0) tlsf.fl_bitmap &= ~(1UL << fl);
+        }
+    }
+}
+
+// Saca de su lista un bloque libre de al menos size bytes, o NULL
+static tlsf_block_t *find_block(size_t size) {
+    uint32_t fl, sl;
+    mapping_search(size, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT) return NULL;
+
+    uint32_t sl_map = tlsf.sl_bitmap[fl] & (~0UL << sl);
+    if (sl_map == 0) {
+        if (fl + 1 >= TLSF_FL_COUNT) return NULL;
+        uint32_t fl_map = tlsf.fl_bitmap & (~0UL << (fl + 1));
+        if (fl_map == 0) return NULL;
+        fl = tlsf_ffs(fl_map);
+        sl_map = tlsf.sl_bitmap[fl];
+    }
+    sl = tlsf_ffs(sl_map);
+
+    tlsf_block_t *block = tlsf.heads[fl][sl];
+    remove_block(block);
+    return block;
+}
+
+// Devuelve al heap lo que sobra de un bloque libre si alcanza para otro bloque
+static void split_block(tlsf_block_t *block, size_t size) {
+    size_t remaining = block_size(block) - size;
+    if (remaining < TLSF_MIN_BLOCK) return;
+
+    tlsf_block_t *rest = (tlsf_block_t *)((uint8_t *)block + size);
+    rest->size = remaining | TLSF_FREE;
+    rest->prev_phys = block;
+    next_phys(rest)->prev_phys = rest;
+    block->size = size | TLSF_FREE;
+    insert_block(rest);
+}
+
+// Un bloque libre con todo el heap y un bloque centinela ocupado de tamaño 0 al final,
+// para que el último bloque siempre tenga un vecino que no se une
+static void heap_init(void) {
+    uintptr_t start = ((uintptr_t)ucHeap + portBYTE_ALIGNMENT - 1) & ~(uintptr_t)portBYTE_ALIGNMENT_MASK;
+    uintptr_t end = ((uintptr_t)ucHeap + configTOTAL_HEAP_SIZE - TLSF_HEADER) & ~(uintptr_t)portBYTE_ALIGNMENT_MASK;
+
+    tlsf_block_t *first = (tlsf_block_t *)start;
+    first->prev_phys = NULL;
+    first->size = (size_t)(end - start) | TLSF_FREE;
+
+    tlsf_block_t *sentinel = (tlsf_block_t *)end;
+    sentinel->prev_phys = first;
+    sentinel->size = 0;
+
+    insert_block(first);
+    tlsf.free_bytes = block_size(first);
+    tlsf.min_free_bytes = tlsf.free_bytes;
+    tlsf.initialised = 1;
+}
+
+void *pvPortMalloc(size_t xWantedSize) {
+    void *pvReturn = NULL;
+    size_t size = 0;
+
+    vTaskSuspendAll();
+    {
+        if (!tlsf.initialised) heap_init();
+
+        if (xWantedSize > 0 && xWantedSize <= configTOTAL_HEAP_SIZE) {
+            size = (xWantedSize + TLSF_HEADER + portBYTE_ALIGNMENT_MASK) & ~(size_t)portBYTE_ALIGNMENT_MASK;
+            if (size < TLSF_MIN_BLOCK) size = TLSF_MIN_BLOCK;
+
+            tlsf_block_t *block = find_block(size);
+            if (block != NULL) {
+                split_block(block, size);
+                block->size &= ~TLSF_FREE;
+                size = block_size(block);
+
+                tlsf.free_bytes -= size;
+                if (tlsf.free_bytes < tlsf.min_free_bytes) tlsf.min_free_bytes = tlsf.free_bytes;
+                tlsf.allocations++;
+                pvReturn = (uint8_t *)block + TLSF_HEADER;
+            }
+        }
+        traceMALLOC(pvReturn, size);
+    }
+    (void)xTaskResumeAll();
+
+#if (configUSE_MALLOC_FAILED_HOOK == 1)
+    if (pvReturn == NULL) vApplicationMallocFailedHook();
+#endif
+    return pvReturn;
+}
+
+void vPortFree(void *pv) {
+    if (pv == NULL) return;
+
+    tlsf_block_t *block = (tlsf_block_t *)((uint8_t *)pv - TLSF_HEADER);
+    configASSERT((block->size & TLSF_FREE) == 0);
+    if (block->size & TLSF_FREE) return;
+
+    vTaskSuspendAll();
+    {
+        size_t size = block_size(block);
+        tlsf.free_bytes += size;
+        tlsf.frees++;
+        traceFREE(pv, size);
+
+        block->size |= TLSF_FREE;
+        tlsf_block_t *prev = block->prev_phys;
+        if (prev != NULL && (prev->size & TLSF_FREE)) {
+            remove_block(prev);
+            prev->size += size;
+            block = prev;
+        }
+        tlsf_block_t *next = next_phys(block);
+        if (next->size & TLSF_FREE) {
+            remove_block(next);
+            block->size += block_size(next);
+        }
+        next_phys(block)->prev_phys = block;
+        insert_block(block);
+    }
+    (void)xTaskResumeAll();
+}
+
+size_t xPortGetFreeHeapSize(void) {
+    return tlsf.free_bytes;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+    return tlsf.min_free_bytes;
+}
+
+void vPortInitialiseBlocks(void) {
+}
+
+void *pvPortCalloc(size_t xNum, size_t xSize) {
+    if (xNum > 0 && xSize > ((size_t)-1) / xNum) return NULL;
+    void *pv = pvPortMalloc(xNum * xSize);
+    if (pv != NULL) memset(pv, 0, xNum * xSize);
+    return pv;
+}
+
+// Recorre las listas: no es de tiempo acotado, como el de heap_4
+void vPortGetHeapStats(HeapStats_t *pxHeapStats) {
+    size_t largest = 0, smallest = (size_t)-1, blocks = 0;
+
+    vTaskSuspendAll();
+    {
+        for (uint32_t fl = 0; fl < TLSF_FL_COUNT; fl++) {
+            for (uint32_t sl = 0; sl < TLSF_SL_COUNT; sl++) {
+                for (const tlsf_block_t *block = tlsf.heads[fl][sl]; block != NULL; block = block->next_free) {
+                    size_t size = block_size(block);
+                    if (size > largest) largest = size;
+                    if (size < smallest) smallest = size;
+                    blocks++;
+                }
+            }
+        }
+    }
+    (void)xTaskResumeAll();
+
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = largest;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = blocks > 0 ? smallest : 0;
+    pxHeapStats->xNumberOfFreeBlocks = blocks;
+
+    taskENTER_CRITICAL();
+    {
+        pxHeapStats->xAvailableHeapSpaceInBytes = tlsf.free_bytes;
+        pxHeapStats->xNumberOfSuccessfulAllocations = tlsf.allocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = tlsf.frees;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = tlsf.min_free_bytes;
+    }
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,109 @@
+#include "heapstats.h"
+#include "downlink.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stddef.h>
+
+typedef struct {
+    uint16_t failures;
+    uint16_t last_failure_s;
+#ifdef HEAP_TRACE
+    heapstats_record_t records[HEAPSTATS_TRACE_RECORDS];
+    uint32_t head;                  // Registros grabados desde el arranque
+    uint32_t tail;                  // Registros publicados o perdidos
+    uint16_t dropped;               // Perdidos desde el último paquete
+#endif
+} heapstats_t;
+
+static heapstats_t heapstats;
+
+_Static_assert(sizeof(heapstats_trace_packet_t) <= DOWNLINK_MAX_FRAME, "El paquete de registros no entra en una trama");
+_Static_assert(sizeof(heapstats_packet_t) <= DOWNLINK_MAX_FRAME, "El paquete de estadísticas no entra en una trama");
+
+static uint16_t saturate(size_t value) {
+    return value > 0xFFFF ? 0xFFFF : (uint16_t)value;
+}
+
+// configUSE_MALLOC_FAILED_HOOK, declarado en portable.h
+void vApplicationMallocFailedHook(void) {
+    taskENTER_CRITICAL();
+    if (heapstats.failures < 0xFFFF) heapstats.failures++;
+    heapstats.last_failure_s = saturate(xTaskGetTickCount() / configTICK_RATE_HZ);
+    taskEXIT_CRITICAL();
+}
+
+uint16_t HEAPSTATS_get_failures(void) {
+    return heapstats.failures;
+}
+
+#ifdef HEAP_TRACE
+// Con el buffer lleno se descartan los registros nuevos: la secuencia publicada queda con
+// un hueco marcado en dropped en lugar de mezclar operaciones de dos vueltas del buffer
+void HEAPSTATS_trace(uint8_t op, void *address, size_t size, void *caller) {
+    if (heapstats.head - heapstats.tail == HEAPSTATS_TRACE_RECORDS) {
+        if (heapstats.dropped < 0xFFFF) heapstats.dropped++;
+        return;
+    }
+    heapstats_record_t *record = &heapstats.records[heapstats.head % HEAPSTATS_TRACE_RECORDS];
+    record->op = (op == HEAPSTATS_OP_MALLOC && address == NULL) ? HEAPSTATS_OP_FAIL : op;
+    record->reserved = 0;
+    record->size = saturate(size);
+    record->address = (uint32_t)(uintptr_t)address;
+    record->caller = (uint32_t)(uintptr_t)caller;
+    heapstats.head++;
+}
+
+static void heapstats_publish_trace(void) {
+    static heapstats_trace_packet_t packet;
+
+    for (;;) {
+        // pvPortMalloc y vPortFree graban con el scheduler suspendido
+        vTaskSuspendAll();
+        uint32_t pending = heapstats.head - heapstats.tail;
+        if (pending > HEAPSTATS_RECORDS_PER_PACKET) pending = HEAPSTATS_RECORDS_PER_PACKET;
+        packet.type = HEAPSTATS_TRACE_TYPE;
+        packet.count = (uint8_t)pending;
+        packet.dropped = heapstats.dropped;
+        packet.sequence = heapstats.tail;
+        for (uint32_t i = 0; i < pending; i++)
+            packet.records[i] = heapstats.records[(heapstats.tail + i) % HEAPSTATS_TRACE_RECORDS];
+        heapstats.tail += pending;
+        heapstats.dropped = 0;
+        (void)xTaskResumeAll();
+
+        if (pending == 0) return;
+        uint16_t len = offsetof(heapstats_trace_packet_t, records) + pending * sizeof(heapstats_record_t);
+        DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, len, 0);
+    }
+}
+#endif
+
+void HEAPSTATS_publish(void) {
+    static heapstats_packet_t packet;
+
+    HeapStats_t stats;
+    vPortGetHeapStats(&stats);
+
+    packet.type = HEAPSTATS_PACKET_TYPE;
+    packet.uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    taskENTER_CRITICAL();
+    packet.failures = heapstats.failures;
+    packet.last_failure_s = heapstats.last_failure_s;
+    taskEXIT_CRITICAL();
+    packet.heap_size = saturate(configTOTAL_HEAP_SIZE);
+    packet.free = saturate(stats.xAvailableHeapSpaceInBytes);
+    packet.min_free = saturate(stats.xMinimumEverFreeBytesRemaining);
+    packet.largest = saturate(stats.xSizeOfLargestFreeBlockInBytes);
+    packet.smallest = saturate(stats.xNumberOfFreeBlocks > 0 ? stats.xSizeOfSmallestFreeBlockInBytes : 0);
+    packet.blocks = saturate(stats.xNumberOfFreeBlocks);
+    packet.fragmentation = stats.xAvailableHeapSpaceInBytes == 0 ? 0 :
+        (uint16_t)(1000 - (uint32_t)((uint64_t)stats.xSizeOfLargestFreeBlockInBytes * 1000 / stats.xAvailableHeapSpaceInBytes));
+    packet.allocations = stats.xNumberOfSuccessfulAllocations;
+    packet.frees = stats.xNumberOfSuccessfulFrees;
+    DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, sizeof(packet), 0);
+
+#ifdef HEAP_TRACE
+    heapstats_publish_trace();
+#endif
+}
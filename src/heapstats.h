@@ -0,0 +1,72 @@
+#ifndef HEAPSTATS_H
+#define HEAPSTATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Estadísticas del heap: libre, mínimo libre histórico, bloque libre más grande y cantidad
+// de bloques libres (vPortGetHeapStats) más las fallas de pvPortMalloc, que cuenta
+// vApplicationMallocFailedHook. HEAPSTATS_publish() las manda al stream de housekeeping.
+//
+// Compilando con HEAP_TRACE=1 además se graba cada pvPortMalloc y vPortFree con el bloque,
+// su tamaño y la dirección desde la que se llamó. Los registros salen en paquetes junto con
+// las estadísticas; tools/heap_replay.py los agrupa por llamador y reproduce la secuencia
+// sobre un heap_4 simulado para ver la fragmentación con otros tamaños de heap.
+//
+// OBS: este header solo puede incluir headers estándar, lo incluye FreeRTOSConfig.h.
+
+#define HEAPSTATS_PACKET_TYPE 0x48
+#define HEAPSTATS_TRACE_TYPE  0x41
+
+#define HEAPSTATS_TRACE_RECORDS     32    // Registros pendientes de publicar, potencia de 2
+#define HEAPSTATS_RECORDS_PER_PACKET 8     // El paquete entra en una trama del enlace
+
+// Operaciones grabadas
+#define HEAPSTATS_OP_MALLOC 'M'
+#define HEAPSTATS_OP_FREE   'F'
+#define HEAPSTATS_OP_FAIL   'X'         // pvPortMalloc sin memoria
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // HEAPSTATS_PACKET_TYPE
+    uint8_t reserved;
+    uint16_t failures;              // Llamadas a vApplicationMallocFailedHook
+    uint32_t uptime_ms;
+    uint16_t heap_size;             // configTOTAL_HEAP_SIZE
+    uint16_t free;
+    uint16_t min_free;              // Mínimo libre desde el arranque
+    uint16_t largest;               // Bloque libre más grande
+    uint16_t smallest;              // Bloque libre más chico
+    uint16_t blocks;                // Bloques libres
+    uint16_t fragmentation;         // 1 - largest / free, en milésimas
+    uint16_t last_failure_s;        // Uptime de la última falla, 0 si no hubo
+    uint32_t allocations;
+    uint32_t frees;
+} heapstats_packet_t;
+
+// Una operación del heap. El tamaño es el del bloque: incluye el encabezado y la alineación
+typedef struct __attribute__((packed)) {
+    uint8_t op;                     // HEAPSTATS_OP_*
+    uint8_t reserved;
+    uint16_t size;
+    uint32_t address;               // Puntero devuelto o liberado, 0 en las fallas
+    uint32_t caller;                // Dirección de retorno de pvPortMalloc/vPortFree
+} heapstats_record_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // HEAPSTATS_TRACE_TYPE
+    uint8_t count;
+    uint16_t dropped;               // Registros perdidos antes de este paquete por buffer lleno
+    uint32_t sequence;              // Número del primer registro
+    heapstats_record_t records[HEAPSTATS_RECORDS_PER_PACKET];
+} heapstats_trace_packet_t;
+
+// Toma una muestra y la publica junto con los registros pendientes (HEAP_TRACE)
+void HEAPSTATS_publish(void);
+
+// Fallas de pvPortMalloc desde el arranque
+uint16_t HEAPSTATS_get_failures(void);
+
+// Ganchos de traceMALLOC y traceFREE (FreeRTOSConfig.h). Corren con el scheduler suspendido
+void HEAPSTATS_trace(uint8_t op, void *address, size_t size, void *caller);
+
+#endif
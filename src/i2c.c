@@ -0,0 +1,495 @@
+#include "FreeRTOS.h"
+#include "i2c.h"
+#include "cycles.h"
+#include "latency.h"
+#include "manifest.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define I2C_TIMEOUT_BASE_MS 10    // Timeout mínimo de una transacción
+#define I2C_STRETCH_WAIT_MS 25    // Tiempo máximo que se tolera SCL retenido por un esclavo
+#define I2C_RECOVERY_CLOCKS 9     // Pulsos de SCL para liberar un esclavo que retiene SDA
+
+// Prioridad de las interrupciones: debe ser numéricamente mayor o igual a
+// configMAX_SYSCALL_INTERRUPT_PRIORITY para poder usar la API FromISR
+#define I2C_IRQ_PRIORITY 0xC0
+
+// Fase de la transacción en curso
+typedef enum {
+    I2C_PHASE_WRITE,
+    I2C_PHASE_READ_ADDR,            // START y dirección de la lectura pendientes
+    I2C_PHASE_READ,
+} i2c_phase_t;
+
+typedef struct {
+    uint32_t i2c;                   // I2C_ID
+    uint32_t port;                  // Puerto GPIO de SCL y SDA
+    uint16_t scl;
+    uint16_t sda;
+    enum i2c_speeds speed;
+    QueueHandle_t txq;              // Cola de transacciones pendientes
+    TaskHandle_t task;              // Tarea que atiende el bus
+    i2c_transaction_t *volatile current;  // Transacción en curso (la avanza la ISR)
+    uint16_t index;                 // Próximo byte a escribir o leer
+    i2c_phase_t phase;
+    uint32_t recoveries;            // Contador de recuperaciones del bus
+    const i2c_slave_handlers_t *slave;  // Manejadores si el bus funciona como esclavo
+} i2c_bus_t;
+
+static i2c_bus_t i2c_bus1;
+static i2c_bus_t i2c_bus2;
+
+// Prototipos de funciones
+static void i2c_bus_init(i2c_bus_t *bus, uint32_t i2c);
+static void i2c_configure(i2c_bus_t *bus);
+static void i2c_ev_handler(i2c_bus_t *bus);
+static void i2c_er_handler(i2c_bus_t *bus);
+
+// Manejadores de buses I2C
+static i2c_bus_t *get_bus(uint32_t i2c) {
+    switch (i2c) {
+        case I2C1: return &i2c_bus1;
+        case I2C2: return &i2c_bus2;
+        default: return NULL;
+    }
+}
+
+BaseType_t I2C_setup(uint32_t i2c, uint32_t speed_hz) {
+    i2c_bus_t *bus = get_bus(i2c);
+    if (bus == NULL) return pdFAIL;
+
+    bus->txq = MANIFEST_queue(i2c == I2C1 ? MANIFEST_I2C1_TXQ : MANIFEST_I2C2_TXQ);
+    if (bus->txq == NULL) return pdFAIL;
+    vQueueAddToRegistry(bus->txq, i2c == I2C1 ? "I2C1" : "I2C2");
+
+    bus->speed = speed_hz >= 400000 ? i2c_speed_fm_400k : i2c_speed_sm_100k;
+    bus->slave = NULL;
+    i2c_bus_init(bus, i2c);
+    return pdPASS;
+}
+
+BaseType_t I2C_setup_slave(uint32_t i2c, uint8_t own_addr, const i2c_slave_handlers_t *handlers) {
+    i2c_bus_t *bus = get_bus(i2c);
+    if (bus == NULL || handlers == NULL) return pdFAIL;
+
+    // El clock del bus lo da el master; la velocidad solo ajusta los tiempos internos
+    bus->speed = i2c_speed_fm_400k;
+    bus->slave = handlers;
+    i2c_bus_init(bus, i2c);
+
+    i2c_set_own_7bit_slave_address(i2c, own_addr);
+    I2C_CR1(i2c) |= I2C_CR1_ACK;
+    I2C_CR2(i2c) |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN;
+    return pdPASS;
+}
+
+// Clocks, pines e interrupciones comunes a master y esclavo
+static void i2c_bus_init(i2c_bus_t *bus, uint32_t i2c) {
+    bus->i2c = i2c;
+    bus->port = GPIOB;
+    bus->current = NULL;
+    bus->recoveries = 0;
+
+    rcc_periph_clock_enable(RCC_GPIOB);
+    rcc_periph_clock_enable(RCC_AFIO);
+
+    if (i2c == I2C1) {
+        rcc_periph_clock_enable(RCC_I2C1);
+        bus->scl = GPIO_I2C1_SCL;
+        bus->sda = GPIO_I2C1_SDA;
+
+        nvic_set_priority(NVIC_I2C1_EV_IRQ, I2C_IRQ_PRIORITY);
+        nvic_set_priority(NVIC_I2C1_ER_IRQ, I2C_IRQ_PRIORITY);
+        nvic_enable_irq(NVIC_I2C1_EV_IRQ);
+        nvic_enable_irq(NVIC_I2C1_ER_IRQ);
+    } else {
+        rcc_periph_clock_enable(RCC_I2C2);
+        bus->scl = GPIO_I2C2_SCL;
+        bus->sda = GPIO_I2C2_SDA;
+
+        nvic_set_priority(NVIC_I2C2_EV_IRQ, I2C_IRQ_PRIORITY);
+        nvic_set_priority(NVIC_I2C2_ER_IRQ, I2C_IRQ_PRIORITY);
+        nvic_enable_irq(NVIC_I2C2_EV_IRQ);
+        nvic_enable_irq(NVIC_I2C2_ER_IRQ);
+    }
+
+    i2c_configure(bus);
+}
+
+// Pines en modo alternativo open-drain y periférico habilitado
+static void i2c_configure(i2c_bus_t *bus) {
+    gpio_set_mode(bus->port,
+        GPIO_MODE_OUTPUT_50_MHZ,
+        GPIO_CNF_OUTPUT_ALTFN_OPENDRAIN,
+        bus->scl | bus->sda);
+
+    i2c_peripheral_disable(bus->i2c);
+    i2c_set_speed(bus->i2c, bus->speed, rcc_apb1_frequency / 1000000);
+    i2c_peripheral_enable(bus->i2c);
+}
+
+// Prepara ACK y POS según la cantidad de bytes a leer (RM0008, recepción en master)
+static void i2c_prepare_read(uint32_t i2c, uint16_t len) {
+    if (len == 2) {
+        I2C_CR1(i2c) |= I2C_CR1_ACK | I2C_CR1_POS;
+    } else {
+        I2C_CR1(i2c) &= ~I2C_CR1_POS;
+        I2C_CR1(i2c) |= I2C_CR1_ACK;
+    }
+}
+
+// Arranca la transacción generando el START. La avanzan las interrupciones
+static void i2c_start(i2c_bus_t *bus, i2c_transaction_t *txn) {
+    bus->current = txn;
+    bus->index = 0;
+
+    // En la lectura RXNE recién se habilita en EV6, según la cantidad de bytes
+    if (txn->tx_len == 0 && txn->rx_len > 0) {
+        bus->phase = I2C_PHASE_READ_ADDR;
+        i2c_prepare_read(bus->i2c, txn->rx_len);
+        I2C_CR2(bus->i2c) |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+    } else {
+        bus->phase = I2C_PHASE_WRITE;
+        I2C_CR1(bus->i2c) &= ~I2C_CR1_POS;
+        I2C_CR2(bus->i2c) |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN;
+    }
+    I2C_CR1(bus->i2c) |= I2C_CR1_START;
+}
+
+// Termina la transacción en curso desde la ISR y despierta a la tarea del bus
+static void i2c_finish_from_isr(i2c_bus_t *bus, i2c_status_t status) {
+    BaseType_t woken = pdFALSE;
+
+    I2C_CR2(bus->i2c) &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN);
+    I2C_CR1(bus->i2c) &= ~I2C_CR1_POS;
+
+    bus->current->status = status;
+    bus->current = NULL;
+
+    vTaskNotifyGiveFromISR(bus->task, &woken);
+    LATENCY_isr_signal(bus->i2c == I2C1 ? LATENCY_I2C1 : LATENCY_I2C2);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Libera el bus: espera a un esclavo que estira el clock, genera pulsos de SCL hasta que
+// SDA quede libre, fuerza un STOP y resetea el periférico
+static void i2c_recover(i2c_bus_t *bus) {
+    bus->recoveries++;
+    i2c_peripheral_disable(bus->i2c);
+
+    // Tomar SCL y SDA como GPIO open-drain
+    gpio_set(bus->port, bus->scl | bus->sda);
+    gpio_set_mode(bus->port,
+        GPIO_MODE_OUTPUT_2_MHZ,
+        GPIO_CNF_OUTPUT_OPENDRAIN,
+        bus->scl | bus->sda);
+
+    for (uint8_t i = 0; i < I2C_STRETCH_WAIT_MS && !gpio_get(bus->port, bus->scl); i++)
+        vTaskDelay(pdMS_TO_TICKS(1));
+
+    for (uint8_t i = 0; i < I2C_RECOVERY_CLOCKS && !gpio_get(bus->port, bus->sda); i++) {
+        gpio_clear(bus->port, bus->scl);
+        vTaskDelay(pdMS_TO_TICKS(1));
+        gpio_set(bus->port, bus->scl);
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+
+    // STOP: SDA sube mientras SCL está en alto
+    gpio_clear(bus->port, bus->sda);
+    vTaskDelay(pdMS_TO_TICKS(1));
+    gpio_set(bus->port, bus->scl);
+    vTaskDelay(pdMS_TO_TICKS(1));
+    gpio_set(bus->port, bus->sda);
+
+    I2C_CR1(bus->i2c) |= I2C_CR1_SWRST;
+    I2C_CR1(bus->i2c) &= ~I2C_CR1_SWRST;
+    i2c_configure(bus);
+}
+
+void taskI2C(uint32_t i2c) {
+    i2c_bus_t *bus = get_bus(i2c);
+    if (bus == NULL) return;
+    bus->task = xTaskGetCurrentTaskHandle();
+
+    i2c_transaction_t *txn;
+    for (;;) {
+        if (xQueueReceive(bus->txq, &txn, portMAX_DELAY) != pdPASS) continue;
+
+        // El STOP de la transacción anterior tarda un tiempo de bit en salir. Se cede la CPU
+        // en lugar de dormir un tick para no separar las transacciones de un lote
+        while (I2C_CR1(bus->i2c) & I2C_CR1_STOP)
+            taskYIELD();
+
+        TickType_t timeout = pdMS_TO_TICKS(I2C_TIMEOUT_BASE_MS + (txn->tx_len + txn->rx_len) / 8);
+        ulTaskNotifyTake(pdTRUE, 0);  // Descartar avisos viejos
+
+        taskENTER_CRITICAL();
+        i2c_start(bus, txn);
+        taskEXIT_CRITICAL();
+
+        uint32_t notified = ulTaskNotifyTake(pdTRUE, timeout);
+        LATENCY_task_wake(bus->i2c == I2C1 ? LATENCY_I2C1 : LATENCY_I2C2);
+        if (notified == 0) {
+            // Sin respuesta: abortar, salvo que la ISR haya terminado justo ahora
+            BaseType_t timed_out = pdFALSE;
+            taskENTER_CRITICAL();
+            if (bus->current != NULL) {
+                I2C_CR2(bus->i2c) &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN);
+                bus->current = NULL;
+                timed_out = pdTRUE;
+            }
+            taskEXIT_CRITICAL();
+
+            if (timed_out) {
+                i2c_recover(bus);
+                txn->status = I2C_ERR_TIMEOUT;
+            }
+        } else if (txn->status == I2C_ERR_BUS) {
+            i2c_recover(bus);
+        }
+
+        // Avisar a la tarea que encoló la transacción
+        txn->done = 1;
+        if (txn->notify) xTaskNotifyGive(txn->task);
+    }
+}
+
+i2c_status_t I2C_transfer(uint32_t i2c, i2c_transaction_t *txn, TickType_t xTicksToWait) {
+    i2c_bus_t *bus = get_bus(i2c);
+    if (bus == NULL || txn == NULL) return I2C_ERR_PARAM;
+    if ((txn->tx_len > 0 && txn->tx == NULL) || (txn->rx_len > 0 && txn->rx == NULL)) return I2C_ERR_PARAM;
+
+    txn->task = xTaskGetCurrentTaskHandle();
+    txn->notify = 1;
+    txn->done = 0;
+    txn->status = I2C_ERR_TIMEOUT;
+
+    if (xQueueSend(bus->txq, &txn, xTicksToWait) != pdTRUE) return I2C_ERR_TIMEOUT;
+
+    // Una notificación ajena a la transacción no debe cortar la espera
+    while (!txn->done)
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    return txn->status;
+}
+
+uint8_t I2C_transfer_batch(uint32_t i2c, i2c_transaction_t *txns, uint8_t count, TickType_t xTicksToWait) {
+    i2c_bus_t *bus = get_bus(i2c);
+    if (bus == NULL || txns == NULL) return 0;
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    uint8_t queued;
+    for (queued = 0; queued < count; queued++) {
+        i2c_transaction_t *txn = &txns[queued];
+        txn->task = task;
+        txn->notify = (queued == count - 1);
+        txn->done = 0;
+        txn->status = I2C_ERR_TIMEOUT;
+        if (xQueueSend(bus->txq, &txn, xTicksToWait) != pdTRUE) break;
+    }
+    if (queued == 0) return 0;
+
+    // Las transacciones se ejecutan en orden: cuando termina la última terminaron todas.
+    // Si el lote quedó incompleto la última encolada no notifica y se consulta cada tick
+    i2c_transaction_t *last = &txns[queued - 1];
+    while (!last->done)
+        ulTaskNotifyTake(pdTRUE, last->notify ? portMAX_DELAY : pdMS_TO_TICKS(1));
+
+    return queued;
+}
+
+i2c_status_t I2C_write(uint32_t i2c, uint8_t addr, const uint8_t *data, uint16_t len, TickType_t xTicksToWait) {
+    i2c_transaction_t txn = { .addr = addr, .tx = data, .tx_len = len };
+    return I2C_transfer(i2c, &txn, xTicksToWait);
+}
+
+i2c_status_t I2C_read(uint32_t i2c, uint8_t addr, uint8_t *data, uint16_t len, TickType_t xTicksToWait) {
+    if (len == 0) return I2C_ERR_PARAM;
+    i2c_transaction_t txn = { .addr = addr, .rx = data, .rx_len = len };
+    return I2C_transfer(i2c, &txn, xTicksToWait);
+}
+
+i2c_status_t I2C_write_read(uint32_t i2c, uint8_t addr, const uint8_t *tx, uint16_t tx_len,
+                            uint8_t *rx, uint16_t rx_len, TickType_t xTicksToWait) {
+    i2c_transaction_t txn = { .addr = addr, .tx = tx, .tx_len = tx_len, .rx = rx, .rx_len = rx_len };
+    return I2C_transfer(i2c, &txn, xTicksToWait);
+}
+
+uint32_t I2C_get_recoveries(uint32_t i2c) {
+    i2c_bus_t *bus = get_bus(i2c);
+    if (bus == NULL) return 0;
+    return bus->recoveries;
+}
+
+uint32_t I2C_get_speed(uint32_t i2c) {
+    i2c_bus_t *bus = get_bus(i2c);
+    if (bus == NULL) return 0;
+    return bus->speed == i2c_speed_fm_400k ? 400000 : 100000;
+}
+
+void i2c1_ev_isr(void) {
+    CYCLES_isr_enter();
+    LATENCY_isr_enter(LATENCY_I2C1);
+    i2c_ev_handler(&i2c_bus1);
+    CYCLES_isr_exit();
+}
+
+void i2c1_er_isr(void) {
+    CYCLES_isr_enter();
+    LATENCY_isr_enter(LATENCY_I2C1);
+    i2c_er_handler(&i2c_bus1);
+    CYCLES_isr_exit();
+}
+
+void i2c2_ev_isr(void) {
+    CYCLES_isr_enter();
+    LATENCY_isr_enter(LATENCY_I2C2);
+    i2c_ev_handler(&i2c_bus2);
+    CYCLES_isr_exit();
+}
+
+void i2c2_er_isr(void) {
+    CYCLES_isr_enter();
+    LATENCY_isr_enter(LATENCY_I2C2);
+    i2c_er_handler(&i2c_bus2);
+    CYCLES_isr_exit();
+}
+
+// Máquina de estados del master (secuencias EV5..EV8 de RM0008)
+static void i2c_ev_handler(i2c_bus_t *bus) {
+    if (bus->slave != NULL) {
+        bus->slave->event(bus->i2c);
+        return;
+    }
+
+    uint32_t i2c = bus->i2c;
+    i2c_transaction_t *txn = bus->current;
+    uint32_t sr1 = I2C_SR1(i2c);
+
+    if (txn == NULL) {
+        // Evento sin transacción en curso (p. ej. tras un timeout)
+        I2C_CR2(i2c) &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN);
+        return;
+    }
+
+    // EV5: START generado, enviar la dirección
+    if (sr1 & I2C_SR1_SB) {
+        I2C_DR(i2c) = (uint8_t)((txn->addr << 1) | (bus->phase != I2C_PHASE_WRITE ? 1 : 0));
+        return;
+    }
+
+    // EV6: dirección reconocida. ADDR se limpia leyendo SR1 y luego SR2
+    if (sr1 & I2C_SR1_ADDR) {
+        if (bus->phase != I2C_PHASE_WRITE) {
+            bus->phase = I2C_PHASE_READ;
+            if (txn->rx_len == 1) {
+                I2C_CR1(i2c) &= ~I2C_CR1_ACK;
+                (void)I2C_SR2(i2c);
+                I2C_CR1(i2c) |= I2C_CR1_STOP;
+                I2C_CR2(i2c) |= I2C_CR2_ITBUFEN;
+            } else if (txn->rx_len == 2) {
+                // Se espera BTF con los dos bytes
+                I2C_CR1(i2c) &= ~I2C_CR1_ACK;
+                (void)I2C_SR2(i2c);
+            } else {
+                (void)I2C_SR2(i2c);
+                // Con 3 bytes o menos pendientes se sigue con BTF
+                if (txn->rx_len > 3) I2C_CR2(i2c) |= I2C_CR2_ITBUFEN;
+            }
+        } else {
+            (void)I2C_SR2(i2c);
+            if (txn->tx_len == 0) {
+                // Sondeo de dirección sin datos
+                I2C_CR1(i2c) |= I2C_CR1_STOP;
+                i2c_finish_from_isr(bus, I2C_OK);
+            }
+        }
+        return;
+    }
+
+    // BTF y TxE de la escritura siguen arriba hasta que sale el START repetido
+    if (bus->phase == I2C_PHASE_READ_ADDR) return;
+
+    if (bus->phase == I2C_PHASE_READ) {
+        uint16_t remaining = txn->rx_len - bus->index;
+
+        // EV7_1: los últimos bytes se manejan con BTF para poder NACKear el último a tiempo
+        if ((sr1 & I2C_SR1_BTF) && remaining >= 2 && remaining <= 3) {
+            if (txn->rx_len == 2) {
+                I2C_CR1(i2c) |= I2C_CR1_STOP;
+                txn->rx[bus->index++] = I2C_DR(i2c);
+                txn->rx[bus->index++] = I2C_DR(i2c);
+                i2c_finish_from_isr(bus, I2C_OK);
+            } else if (remaining == 3) {
+                I2C_CR1(i2c) &= ~I2C_CR1_ACK;
+                txn->rx[bus->index++] = I2C_DR(i2c);
+            } else {
+                I2C_CR1(i2c) |= I2C_CR1_STOP;
+                txn->rx[bus->index++] = I2C_DR(i2c);
+                I2C_CR2(i2c) |= I2C_CR2_ITBUFEN;  // El último byte llega con RXNE
+            }
+            return;
+        }
+
+        // EV7: byte recibido
+        if (sr1 & I2C_SR1_RxNE) {
+            txn->rx[bus->index++] = I2C_DR(i2c);
+            remaining--;
+            if (remaining == 0)
+                i2c_finish_from_isr(bus, I2C_OK);
+            else if (remaining == 3)
+                I2C_CR2(i2c) &= ~I2C_CR2_ITBUFEN;
+        }
+        return;
+    }
+
+    // EV8: registro de datos vacío
+    if (sr1 & (I2C_SR1_TxE | I2C_SR1_BTF)) {
+        if (bus->index < txn->tx_len) {
+            I2C_DR(i2c) = txn->tx[bus->index++];
+            // Con el último byte cargado se espera BTF para saber que salió
+            if (bus->index == txn->tx_len) I2C_CR2(i2c) &= ~I2C_CR2_ITBUFEN;
+        } else if (sr1 & I2C_SR1_BTF) {
+            if (txn->rx_len > 0) {
+                // START repetido para la fase de lectura. ITBUFEN sigue apagado desde
+                // el último byte escrito: se vuelve a habilitar en EV6
+                bus->phase = I2C_PHASE_READ_ADDR;
+                bus->index = 0;
+                i2c_prepare_read(i2c, txn->rx_len);
+                I2C_CR1(i2c) |= I2C_CR1_START;
+            } else {
+                I2C_CR1(i2c) |= I2C_CR1_STOP;
+                i2c_finish_from_isr(bus, I2C_OK);
+            }
+        }
+    }
+}
+
+static void i2c_er_handler(i2c_bus_t *bus) {
+    if (bus->slave != NULL) {
+        bus->slave->error(bus->i2c);
+        return;
+    }
+
+    uint32_t i2c = bus->i2c;
+    uint32_t sr1 = I2C_SR1(i2c);
+    i2c_status_t status = I2C_ERR_BUS;
+
+    if (sr1 & I2C_SR1_AF) {
+        // NACK: liberar el bus con un STOP
+        status = I2C_ERR_NACK;
+        I2C_CR1(i2c) |= I2C_CR1_STOP;
+    } else if (sr1 & I2C_SR1_ARLO) {
+        // Al perder el arbitraje el periférico ya pasó a esclavo y liberó el bus
+        status = I2C_ERR_ARLO;
+    }
+
+    // Los flags de error se limpian escribiendo cero
+    I2C_SR1(i2c) = sr1 & ~(I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR | I2C_SR1_OVR |
+                           I2C_SR1_PECERR | I2C_SR1_TIMEOUT);
+
+    if (bus->current != NULL)
+        i2c_finish_from_isr(bus, status);
+    else
+        I2C_CR2(i2c) &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN);
+}
@@ -0,0 +1,85 @@
+#ifndef I2C_H
+#define I2C_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <queue.h>
+#include <stdint.h>
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/i2c.h>
+#include <libopencm3/cm3/nvic.h>
+
+// OBS: I2C1 usa PB6 (SCL) y PB7 (SDA). I2C2 usa PB10 (SCL) y PB11 (SDA), los mismos
+// pines que USART3, por lo que ambos periféricos no pueden usarse a la vez.
+
+// Resultado de una transacción
+typedef enum {
+    I2C_OK = 0,
+    I2C_ERR_NACK,     // El esclavo no reconoció la dirección o un dato
+    I2C_ERR_ARLO,     // Se perdió el arbitraje del bus
+    I2C_ERR_BUS,      // Error de bus (START/STOP fuera de lugar, overrun)
+    I2C_ERR_TIMEOUT,  // La transacción no terminó a tiempo y se recuperó el bus
+    I2C_ERR_PARAM     // Bus inexistente o transacción inválida
+} i2c_status_t;
+
+// Transacción: escritura de tx_len bytes y/o lectura de rx_len bytes.
+// Si tiene ambas partes la lectura se hace con START repetido.
+typedef struct {
+    uint8_t addr;            // Dirección de 7 bits del esclavo
+    const uint8_t *tx;       // Bytes a escribir
+    uint16_t tx_len;
+    uint8_t *rx;             // Buffer para los bytes leídos
+    uint16_t rx_len;
+
+    // Uso interno del driver
+    TaskHandle_t task;              // Tarea a notificar al terminar
+    uint8_t notify;                 // Notificar a la tarea al terminar esta transacción
+    volatile uint8_t done;
+    volatile i2c_status_t status;
+} i2c_transaction_t;
+
+// Configura el periférico I2C como master. speed_hz: 100000 o 400000
+BaseType_t I2C_setup(uint32_t i2c, uint32_t speed_hz);
+
+// Manejadores de interrupción para un bus en modo esclavo
+typedef struct {
+    void (*event)(uint32_t i2c);
+    void (*error)(uint32_t i2c);
+} i2c_slave_handlers_t;
+
+// Configura el periférico I2C como esclavo en own_addr. Las interrupciones del bus
+// se delegan a handlers
+BaseType_t I2C_setup_slave(uint32_t i2c, uint8_t own_addr, const i2c_slave_handlers_t *handlers);
+
+// Tarea que ejecuta las transacciones encoladas para el bus
+void taskI2C(uint32_t i2c);
+
+// Encola la transacción y bloquea la tarea hasta que termina. xTicksToWait limita la espera
+// por lugar en la cola; la transacción en sí está acotada por el timeout del driver.
+// OBS: la finalización se avisa con la notificación de la tarea que llama.
+i2c_status_t I2C_transfer(uint32_t i2c, i2c_transaction_t *txn, TickType_t xTicksToWait);
+
+// Encola count transacciones y bloquea la tarea hasta que terminan todas. El bus las
+// ejecuta una detrás de otra y solo se notifica al terminar la última.
+// Devuelve la cantidad de transacciones encoladas; el resultado de cada una queda en status.
+uint8_t I2C_transfer_batch(uint32_t i2c, i2c_transaction_t *txns, uint8_t count, TickType_t xTicksToWait);
+
+// Escritura simple
+i2c_status_t I2C_write(uint32_t i2c, uint8_t addr, const uint8_t *data, uint16_t len, TickType_t xTicksToWait);
+
+// Lectura simple
+i2c_status_t I2C_read(uint32_t i2c, uint8_t addr, uint8_t *data, uint16_t len, TickType_t xTicksToWait);
+
+// Escritura seguida de lectura con START repetido (típicamente registro + datos)
+i2c_status_t I2C_write_read(uint32_t i2c, uint8_t addr, const uint8_t *tx, uint16_t tx_len,
+                            uint8_t *rx, uint16_t rx_len, TickType_t xTicksToWait);
+
+// Cantidad de recuperaciones de bus realizadas
+uint32_t I2C_get_recoveries(uint32_t i2c);
+
+// Velocidad configurada del bus en Hz
+uint32_t I2C_get_speed(uint32_t i2c);
+
+#endif
@@ -0,0 +1,508 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+#include "kbench.h"
+#include "cycles.h"
+#include "textline.h"
+
+#include <libopencm3/cm3/dwt.h>
+#include <libopencm3/cm3/nvic.h>
+
+// Sin KBENCH=1 el módulo no se compila
+#ifdef KBENCH_ENABLED
+
+#define KBENCH_IRQ              NVIC_TIM4_IRQ
+#define KBENCH_STACK_DEPTH      256
+#define KBENCH_WORKER_DEPTH     configMINIMAL_STACK_SIZE
+#define KBENCH_FINISH_WAIT_MS   (4 * KBENCH_WAIT_MS)
+
+_Static_assert(KBENCH_ITERATIONS % KBENCH_BATCH == 0, "KBENCH_ITERATIONS tiene que ser múltiplo de KBENCH_BATCH");
+
+// Una primitiva vista como un canal: envío (give en los semáforos) y recepción (take)
+typedef struct {
+    const char *name;
+    uint8_t bytes;                  // Datos por envío (0: solo la señal)
+    BaseType_t (*send)(TickType_t wait);
+    BaseType_t (*receive)(TickType_t wait);
+    BaseType_t (*send_from_isr)(BaseType_t *woken);
+    void (*reset)(void);
+} primitive_t;
+
+typedef void (*job_t)(void);
+
+// Tareas auxiliares fijas, una por prioridad relativa a la que mide: en el port del host no
+// se puede reusar el stack de una tarea recién borrada, y vTaskPrioritySet() no está
+// habilitada en FreeRTOSConfig.h
+typedef enum {
+    WORKER_HIGH,
+    WORKER_SAME,
+    WORKER_LOW,
+    WORKER_COUNT
+} worker_id_t;
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t start;
+    job_t job;
+    StaticTask_t tcb;
+    StaticSemaphore_t start_buffer;
+    StackType_t stack[KBENCH_WORKER_DEPTH];
+} worker_t;
+
+typedef struct {
+    kbench_done_t done;
+    TaskHandle_t controller;
+    worker_t workers[WORKER_COUNT];
+    SemaphoreHandle_t finished;     // Lo da un worker al terminar su trabajo
+    SemaphoreHandle_t drained;      // El worker vació una ráfaga
+    SemaphoreHandle_t ping;
+    SemaphoreHandle_t pong;
+    QueueHandle_t queue;
+    SemaphoreHandle_t counting;
+    StreamBufferHandle_t stream;
+    MessageBufferHandle_t message;
+    TaskHandle_t receiver;          // Destino de las notificaciones de la medición en curso
+    const primitive_t *primitive;   // Primitiva de la medición en curso
+    volatile uint8_t armed;         // La ISR envía una vez por vez que se arma
+    volatile uint8_t stop;
+    volatile uint8_t failed;
+    uint32_t isr_stamp;             // CYCCNT al entrar a la ISR
+    uint32_t isr_cycles;            // Ciclos en las llamadas FromISR
+} kbench_t;
+
+static kbench_t kbench;
+
+static StaticTask_t controller_tcb;
+static StackType_t controller_stack[KBENCH_STACK_DEPTH];
+static StaticSemaphore_t finished_buffer, drained_buffer, ping_buffer, pong_buffer, counting_buffer;
+static StaticQueue_t queue_buffer;
+static uint8_t queue_storage[KBENCH_BATCH * sizeof(uint32_t)];
+static StaticStreamBuffer_t stream_buffer, message_buffer;
+// Los buffers necesitan un byte más que su capacidad; cada mensaje lleva su largo adelante
+static uint8_t stream_storage[KBENCH_BATCH * KBENCH_ITEM_BYTES + 1];
+static uint8_t message_storage[KBENCH_BATCH * (KBENCH_ITEM_BYTES + sizeof(size_t)) + 1];
+
+static uint8_t tx_item[KBENCH_ITEM_BYTES];
+static uint8_t rx_item[KBENCH_ITEM_BYTES];
+
+// Primitivas
+
+static BaseType_t queue_send(TickType_t wait) {
+    return xQueueSend(kbench.queue, tx_item, wait);
+}
+
+static BaseType_t queue_receive(TickType_t wait) {
+    return xQueueReceive(kbench.queue, rx_item, wait);
+}
+
+static BaseType_t queue_send_from_isr(BaseType_t *woken) {
+    return xQueueSendFromISR(kbench.queue, tx_item, woken);
+}
+
+static void queue_reset(void) {
+    xQueueReset(kbench.queue);
+}
+
+static BaseType_t semaphore_give(TickType_t wait __attribute__((unused))) {
+    return xSemaphoreGive(kbench.counting);
+}
+
+static BaseType_t semaphore_take(TickType_t wait) {
+    return xSemaphoreTake(kbench.counting, wait);
+}
+
+static BaseType_t semaphore_give_from_isr(BaseType_t *woken) {
+    return xSemaphoreGiveFromISR(kbench.counting, woken);
+}
+
+static void semaphore_reset(void) {
+    while (xSemaphoreTake(kbench.counting, 0) == pdTRUE);
+}
+
+static BaseType_t stream_send(TickType_t wait) {
+    return xStreamBufferSend(kbench.stream, tx_item, KBENCH_ITEM_BYTES, wait) == KBENCH_ITEM_BYTES;
+}
+
+static BaseType_t stream_receive(TickType_t wait) {
+    return xStreamBufferReceive(kbench.stream, rx_item, KBENCH_ITEM_BYTES, wait) == KBENCH_ITEM_BYTES;
+}
+
+static BaseType_t stream_send_from_isr(BaseType_t *woken) {
+    return xStreamBufferSendFromISR(kbench.stream, tx_item, KBENCH_ITEM_BYTES, woken) == KBENCH_ITEM_BYTES;
+}
+
+static void stream_reset(void) {
+    xStreamBufferReset(kbench.stream);
+}
+
+static BaseType_t message_send(TickType_t wait) {
+    return xMessageBufferSend(kbench.message, tx_item, KBENCH_ITEM_BYTES, wait) == KBENCH_ITEM_BYTES;
+}
+
+static BaseType_t message_receive(TickType_t wait) {
+    return xMessageBufferReceive(kbench.message, rx_item, KBENCH_ITEM_BYTES, wait) == KBENCH_ITEM_BYTES;
+}
+
+static BaseType_t message_send_from_isr(BaseType_t *woken) {
+    return xMessageBufferSendFromISR(kbench.message, tx_item, KBENCH_ITEM_BYTES, woken) == KBENCH_ITEM_BYTES;
+}
+
+static void message_reset(void) {
+    xMessageBufferReset(kbench.message);
+}
+
+// Notificación usada como semáforo contador: give y take con decremento
+static BaseType_t notify_give(TickType_t wait __attribute__((unused))) {
+    return xTaskNotifyGive(kbench.receiver);
+}
+
+static BaseType_t notify_take(TickType_t wait) {
+    return ulTaskNotifyTake(pdFALSE, wait) > 0 ? pdPASS : pdFAIL;
+}
+
+static BaseType_t notify_give_from_isr(BaseType_t *woken) {
+    vTaskNotifyGiveFromISR(kbench.receiver, woken);
+    return pdPASS;
+}
+
+static void notify_reset(void) {
+    xTaskNotifyStateClear(kbench.receiver);
+    ulTaskNotifyValueClear(kbench.receiver, UINT32_MAX);
+}
+
+static const primitive_t primitives[] = {
+    { "cola (4 B)", sizeof(uint32_t), queue_send, queue_receive, queue_send_from_isr, queue_reset },
+    { "semáforo", 0, semaphore_give, semaphore_take, semaphore_give_from_isr, semaphore_reset },
+    { "stream buffer (16 B)", KBENCH_ITEM_BYTES, stream_send, stream_receive, stream_send_from_isr, stream_reset },
+    { "message buffer (16 B)", KBENCH_ITEM_BYTES, message_send, message_receive, message_send_from_isr, message_reset },
+    { "notificación", 0, notify_give, notify_take, notify_give_from_isr, notify_reset },
+};
+
+#define PRIMITIVE_COUNT (sizeof(primitives) / sizeof(primitives[0]))
+
+static void section(const char *title) {
+    TEXTLINE_end();
+    TEXTLINE_text(title, 0);
+    TEXTLINE_end();
+}
+
+// Una fila: media por operación, máximo (0 si no se mide), operaciones por segundo y
+// throughput si la operación lleva datos
+static void report(const char *name, const char *operation, uint64_t cycles, uint32_t ops,
+                   uint8_t bytes, uint32_t max) {
+    uint32_t mean = (uint32_t)((cycles + ops / 2) / ops);
+    uint32_t rate = mean > 0 ? configCPU_CLOCK_HZ / mean : 0;
+
+    TEXTLINE_text("  ", 0);
+    TEXTLINE_text(name, 22);
+    TEXTLINE_text(operation, 14);
+    TEXTLINE_uint(mean, 10);
+    if (max > 0) TEXTLINE_uint(max, 10);
+    else TEXTLINE_dash(10);
+    TEXTLINE_uint(rate, 10);
+    if (bytes > 0) TEXTLINE_uint((uint32_t)((uint64_t)rate * bytes / 1000), 10);
+    else TEXTLINE_dash(10);
+    TEXTLINE_end();
+}
+
+static void fail(void) {
+    kbench.failed = 1;
+}
+
+// Workers
+
+static void taskKBenchWorker(void *args) {
+    worker_t *worker = args;
+    for (;;) {
+        if (xSemaphoreTake(worker->start, portMAX_DELAY) != pdTRUE) continue;
+        worker->job();
+        xSemaphoreGive(kbench.finished);
+    }
+}
+
+static void worker_run(worker_id_t id, job_t job) {
+    kbench.workers[id].job = job;
+    xSemaphoreGive(kbench.workers[id].start);
+}
+
+// Los trabajos terminan solos: sus esperas están acotadas y cortan en la primera falla
+static void worker_wait(void) {
+    if (xSemaphoreTake(kbench.finished, pdMS_TO_TICKS(KBENCH_FINISH_WAIT_MS)) != pdTRUE) fail();
+}
+
+static void job_receive(void) {
+    for (uint32_t i = 0; i < KBENCH_ITERATIONS && !kbench.failed; i++)
+        if (kbench.primitive->receive(pdMS_TO_TICKS(KBENCH_WAIT_MS)) != pdPASS) fail();
+}
+
+static void job_drain(void) {
+    for (uint32_t round = 0; round < KBENCH_ITERATIONS / KBENCH_BATCH && !kbench.failed; round++) {
+        for (uint8_t i = 0; i < KBENCH_BATCH && !kbench.failed; i++)
+            if (kbench.primitive->receive(pdMS_TO_TICKS(KBENCH_WAIT_MS)) != pdPASS) fail();
+        xSemaphoreGive(kbench.drained);
+    }
+}
+
+// Mientras la tarea que mide está bloqueada este worker es lo único listo: la interrupción
+// queda pendiente justo después de que se bloquea
+static void job_trigger(void) {
+    while (!kbench.stop) nvic_set_pending_irq(KBENCH_IRQ);
+}
+
+static void job_pong_semaphore(void) {
+    for (uint32_t i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (xSemaphoreTake(kbench.ping, pdMS_TO_TICKS(KBENCH_WAIT_MS)) != pdTRUE) {
+            fail();
+            return;
+        }
+        xSemaphoreGive(kbench.pong);
+    }
+}
+
+static void job_pong_notify(void) {
+    for (uint32_t i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(KBENCH_WAIT_MS)) == 0) {
+            fail();
+            return;
+        }
+        xTaskNotifyGive(kbench.controller);
+    }
+}
+
+static void job_yield(void) {
+    for (uint32_t i = 0; i < KBENCH_ITERATIONS; i++) taskYIELD();
+}
+
+void tim4_isr(void) {
+    uint32_t entry = DWT_CYCCNT;
+    CYCLES_isr_enter();
+
+    BaseType_t woken = pdFALSE;
+    if (kbench.armed) {
+        kbench.armed = 0;
+        kbench.isr_stamp = entry;
+        uint32_t start = DWT_CYCCNT;
+        if (kbench.primitive->send_from_isr(&woken) != pdPASS) fail();
+        kbench.isr_cycles += DWT_CYCCNT - start;
+    }
+
+    CYCLES_isr_exit();
+    portYIELD_FROM_ISR(woken);
+}
+
+// Mediciones
+
+static void bench_local(const primitive_t *p) {
+    kbench.receiver = kbench.controller;
+    uint64_t send = 0;
+    uint64_t receive = 0;
+    for (uint32_t round = 0; round < KBENCH_ITERATIONS / KBENCH_BATCH && !kbench.failed; round++) {
+        uint32_t start = DWT_CYCCNT;
+        for (uint8_t i = 0; i < KBENCH_BATCH; i++)
+            if (p->send(0) != pdPASS) fail();
+        uint32_t middle = DWT_CYCCNT;
+        for (uint8_t i = 0; i < KBENCH_BATCH; i++)
+            if (p->receive(0) != pdPASS) fail();
+        receive += DWT_CYCCNT - middle;
+        send += middle - start;
+    }
+    p->reset();
+    if (kbench.failed) return;
+    report(p->name, "envío", send, KBENCH_ITERATIONS, p->bytes, 0);
+    report(p->name, "recepción", receive, KBENCH_ITERATIONS, p->bytes, 0);
+}
+
+static void bench_wake(const primitive_t *p) {
+    kbench.primitive = p;
+    kbench.receiver = kbench.workers[WORKER_HIGH].task;
+    // El worker tiene más prioridad: corre ya y queda bloqueado en la recepción
+    worker_run(WORKER_HIGH, job_receive);
+
+    uint32_t start = DWT_CYCCNT;
+    for (uint32_t i = 0; i < KBENCH_ITERATIONS && !kbench.failed; i++)
+        if (p->send(pdMS_TO_TICKS(KBENCH_WAIT_MS)) != pdPASS) fail();
+    uint32_t cycles = DWT_CYCCNT - start;
+
+    worker_wait();
+    p->reset();
+    if (!kbench.failed) report(p->name, "despertando", cycles, KBENCH_ITERATIONS, p->bytes, 0);
+}
+
+static void bench_burst(const primitive_t *p) {
+    kbench.primitive = p;
+    kbench.receiver = kbench.workers[WORKER_LOW].task;
+    // El worker tiene menos prioridad: arranca cuando esta tarea espera la primera ráfaga
+    worker_run(WORKER_LOW, job_drain);
+
+    uint32_t start = DWT_CYCCNT;
+    for (uint32_t round = 0; round < KBENCH_ITERATIONS / KBENCH_BATCH && !kbench.failed; round++) {
+        for (uint8_t i = 0; i < KBENCH_BATCH; i++)
+            if (p->send(0) != pdPASS) fail();
+        if (xSemaphoreTake(kbench.drained, pdMS_TO_TICKS(KBENCH_WAIT_MS)) != pdTRUE) fail();
+    }
+    uint32_t cycles = DWT_CYCCNT - start;
+
+    worker_wait();
+    p->reset();
+    if (!kbench.failed) report(p->name, "en ráfagas", cycles, KBENCH_ITERATIONS, p->bytes, 0);
+}
+
+static void bench_isr(const primitive_t *p) {
+    kbench.primitive = p;
+    kbench.receiver = kbench.controller;
+    kbench.isr_cycles = 0;
+    kbench.stop = 0;
+    worker_run(WORKER_LOW, job_trigger);
+
+    uint64_t latency = 0;
+    uint32_t max = 0;
+    for (uint32_t i = 0; i < KBENCH_ITERATIONS && !kbench.failed; i++) {
+        kbench.armed = 1;
+        if (p->receive(pdMS_TO_TICKS(KBENCH_WAIT_MS)) != pdPASS) {
+            fail();
+            break;
+        }
+        uint32_t cycles = DWT_CYCCNT - kbench.isr_stamp;
+        latency += cycles;
+        if (cycles > max) max = cycles;
+    }
+
+    kbench.armed = 0;
+    kbench.stop = 1;
+    worker_wait();
+    p->reset();
+    if (kbench.failed) return;
+    report(p->name, "FromISR", kbench.isr_cycles, KBENCH_ITERATIONS, p->bytes, 0);
+    report(p->name, "ISR a tarea", latency, KBENCH_ITERATIONS, p->bytes, max);
+}
+
+static void ping_semaphore(void) {
+    xSemaphoreGive(kbench.ping);
+}
+
+static BaseType_t pong_semaphore(void) {
+    return xSemaphoreTake(kbench.pong, pdMS_TO_TICKS(KBENCH_WAIT_MS));
+}
+
+static void ping_notify(void) {
+    xTaskNotifyGive(kbench.workers[WORKER_HIGH].task);
+}
+
+static BaseType_t pong_notify(void) {
+    return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(KBENCH_WAIT_MS)) > 0 ? pdPASS : pdFAIL;
+}
+
+// Cada vuelta: aviso al worker de mayor prioridad, que corre y contesta, y respuesta
+static void bench_round_trip(const char *name, job_t job, void (*ping)(void), BaseType_t (*pong)(void)) {
+    worker_run(WORKER_HIGH, job);
+
+    uint32_t start = DWT_CYCCNT;
+    for (uint32_t i = 0; i < KBENCH_ITERATIONS && !kbench.failed; i++) {
+        ping();
+        if (pong() != pdPASS) fail();
+    }
+    uint32_t cycles = DWT_CYCCNT - start;
+
+    worker_wait();
+    if (!kbench.failed) report(name, "ida y vuelta", cycles, KBENCH_ITERATIONS, 0, 0);
+}
+
+// Las dos tareas ceden la CPU KBENCH_ITERATIONS veces cada una: dos cambios por vuelta
+static void bench_switch(void) {
+    worker_run(WORKER_SAME, job_yield);
+
+    uint32_t start = DWT_CYCCNT;
+    for (uint32_t i = 0; i < KBENCH_ITERATIONS; i++) taskYIELD();
+    uint32_t cycles = DWT_CYCCNT - start;
+
+    worker_wait();
+    if (!kbench.failed) report("taskYIELD()", "cambio", cycles, 2 * KBENCH_ITERATIONS, 0, 0);
+}
+
+static void run_all(void (*bench)(const primitive_t *)) {
+    for (uint8_t i = 0; i < PRIMITIVE_COUNT && !kbench.failed; i++) bench(&primitives[i]);
+}
+
+static void taskKBench(void *args __attribute__((unused))) {
+    if (!(DWT_CTRL & DWT_CTRL_CYCCNTENA)) dwt_enable_cycle_counter();
+    for (uint8_t i = 0; i < KBENCH_ITEM_BYTES; i++) tx_item[i] = i;
+
+    TEXTLINE_text("Benchmarks del kernel: ", 0);
+    TEXTLINE_uint(KBENCH_ITERATIONS, 0);
+    TEXTLINE_text(" operaciones por medición, ciclos a ", 0);
+    TEXTLINE_uint(configCPU_CLOCK_HZ / 1000000, 0);
+    TEXTLINE_text(" MHz", 0);
+    TEXTLINE_end();
+    TEXTLINE_text("  ", 0);
+    TEXTLINE_text("Primitiva", 22);
+    TEXTLINE_text("Operación", 14);
+    TEXTLINE_text(" ciclos/op", 0);
+    TEXTLINE_text("       máx", 0);
+    TEXTLINE_text("     ops/s", 0);
+    TEXTLINE_text("      kB/s", 0);
+    TEXTLINE_end();
+
+    section("Sin bloqueo, en la misma tarea");
+    run_all(bench_local);
+    if (!kbench.failed) section("Tarea a tarea, el receptor tiene mayor prioridad");
+    run_all(bench_wake);
+    if (!kbench.failed) section("Tarea a tarea, ráfagas de 16 a un receptor de menor prioridad");
+    run_all(bench_burst);
+    if (!kbench.failed) section("ISR a tarea (TIM4 pendiente por software)");
+    run_all(bench_isr);
+    if (!kbench.failed) section("Entre dos tareas");
+    if (!kbench.failed) bench_round_trip("semáforo", job_pong_semaphore, ping_semaphore, pong_semaphore);
+    if (!kbench.failed) bench_round_trip("notificación", job_pong_notify, ping_notify, pong_notify);
+    if (!kbench.failed) bench_switch();
+
+    TEXTLINE_text(kbench.failed ? "FALLÓ" : "OK", 0);
+    TEXTLINE_end();
+
+    if (kbench.done != NULL) kbench.done(kbench.failed ? pdFAIL : pdPASS);
+    vTaskSuspend(NULL);
+}
+
+BaseType_t KBENCH_start(textline_print_t print, kbench_done_t done) {
+    TEXTLINE_setup(print);
+    kbench.done = done;
+
+    kbench.finished = xSemaphoreCreateBinaryStatic(&finished_buffer);
+    kbench.drained = xSemaphoreCreateBinaryStatic(&drained_buffer);
+    kbench.ping = xSemaphoreCreateBinaryStatic(&ping_buffer);
+    kbench.pong = xSemaphoreCreateBinaryStatic(&pong_buffer);
+    kbench.counting = xSemaphoreCreateCountingStatic(KBENCH_BATCH, 0, &counting_buffer);
+    kbench.queue = xQueueCreateStatic(KBENCH_BATCH, sizeof(uint32_t), queue_storage, &queue_buffer);
+    // Con el nivel de disparo en un envío la recepción despierta con el dato completo
+    kbench.stream = xStreamBufferCreateStatic(sizeof(stream_storage), KBENCH_ITEM_BYTES,
+                                              stream_storage, &stream_buffer);
+    kbench.message = xMessageBufferCreateStatic(sizeof(message_storage), message_storage, &message_buffer);
+    if (kbench.finished == NULL || kbench.drained == NULL || kbench.ping == NULL || kbench.pong == NULL
+        || kbench.counting == NULL || kbench.queue == NULL || kbench.stream == NULL || kbench.message == NULL)
+        return pdFAIL;
+
+    static const UBaseType_t priorities[WORKER_COUNT] = {
+        [WORKER_HIGH] = KBENCH_PRIORITY + 1,
+        [WORKER_SAME] = KBENCH_PRIORITY,
+        [WORKER_LOW] = KBENCH_PRIORITY - 1,
+    };
+    for (uint8_t i = 0; i < WORKER_COUNT; i++) {
+        worker_t *worker = &kbench.workers[i];
+        worker->start = xSemaphoreCreateBinaryStatic(&worker->start_buffer);
+        worker->task = xTaskCreateStatic(taskKBenchWorker, "KBenchW", KBENCH_WORKER_DEPTH, worker,
+                                         priorities[i], worker->stack, &worker->tcb);
+        if (worker->start == NULL || worker->task == NULL) return pdFAIL;
+    }
+    kbench.controller = xTaskCreateStatic(taskKBench, "KBench", KBENCH_STACK_DEPTH, NULL, KBENCH_PRIORITY,
+                                          controller_stack, &controller_tcb);
+    if (kbench.controller == NULL) return pdFAIL;
+
+    // Solo la pendiente por software: TIM4 no se configura
+    nvic_set_priority(KBENCH_IRQ, KBENCH_IRQ_PRIORITY);
+    nvic_enable_irq(KBENCH_IRQ);
+    return pdPASS;
+}
+
+#endif
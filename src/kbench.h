@@ -0,0 +1,45 @@
+#ifndef KBENCH_H
+#define KBENCH_H
+
+#include "FreeRTOS.h"
+#include "textline.h"
+#include <stdint.h>
+
+// Benchmarks de las primitivas del kernel (compilando con KBENCH=1): cuánto cuesta en
+// ciclos del core cada operación de colas, semáforos, stream buffers, message buffers y
+// notificaciones, para elegir con números cuál usar en cada camino de datos. Se mide con
+// CYCCNT del DWT el total de KBENCH_ITERATIONS operaciones y se informa la media por
+// operación, las operaciones por segundo y, si la operación lleva datos, el throughput:
+//  - sin bloqueo: envío y recepción en la misma tarea, de a KBENCH_BATCH por vez
+//  - despertando: cada envío despierta a una tarea de mayor prioridad que recibe (envío,
+//    dos cambios de contexto y recepción)
+//  - en ráfagas: KBENCH_BATCH envíos seguidos que vacía una tarea de menor prioridad
+//  - ISR a tarea: la rutina de TIM4 (pendiente por software, sin el timer) envía con la
+//    API FromISR a la tarea bloqueada. Se informa el costo de la llamada FromISR y la
+//    latencia desde la entrada a la ISR hasta que la tarea tiene el dato, con su máximo
+//  - ida y vuelta de un semáforo y de una notificación entre dos tareas
+//  - cambio de contexto: dos tareas de igual prioridad que se ceden la CPU con taskYIELD()
+//
+// En el firmware KBENCH=1 reemplaza las tareas del manifiesto: main() solo arranca los
+// benchmarks y los resultados salen como texto por la UART del enlace de bajada. En el
+// host corren con make -C host bench; ahí los ciclos son tiempo del host llevado a 72 MHz
+// y solo sirven para comparar las primitivas entre sí.
+//
+// OBS: la media incluye el lazo de medición (unos pocos ciclos). Todas las esperas están
+// acotadas a KBENCH_WAIT_MS: si algo no llega se corta la corrida y termina con FALLÓ.
+
+#define KBENCH_ITERATIONS   1024    // Operaciones por medición, múltiplo de KBENCH_BATCH
+#define KBENCH_BATCH        16      // Capacidad de las colas y buffers, en elementos
+#define KBENCH_ITEM_BYTES   16      // Datos por envío en stream y message buffers
+#define KBENCH_WAIT_MS      100
+#define KBENCH_PRIORITY     2       // Tarea que mide; los workers van una arriba y una abajo
+#define KBENCH_IRQ_PRIORITY 0xC0    // Debajo de configMAX_SYSCALL_INTERRUPT_PRIORITY
+
+// Al terminar, con pdPASS si todas las mediciones se completaron
+typedef void (*kbench_done_t)(BaseType_t result);
+
+// Crea las tareas de los benchmarks. Va antes de arrancar el scheduler. Sin done la tarea
+// que mide se suspende al terminar
+BaseType_t KBENCH_start(textline_print_t print, kbench_done_t done);
+
+#endif
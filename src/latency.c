@@ -0,0 +1,131 @@
+#include "latency.h"
+#include "downlink.h"
+#include "task.h"
+
+#include <libopencm3/cm3/dwt.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t entry;                 // CYCCNT al entrar a la última ISR de la fuente
+    uint32_t stamp;                 // Entrada de la ISR del primer aviso sin atender
+    uint8_t pending;
+    uint32_t count;
+    uint32_t coalesced;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint16_t histogram[LATENCY_BUCKETS];
+} latency_t;
+
+static latency_t sources[LATENCY_SOURCE_COUNT];
+
+_Static_assert(sizeof(latency_packet_t) <= DOWNLINK_MAX_FRAME, "El paquete de latencias no entra en una trama");
+
+// Cubeta 0: < 2^LATENCY_MIN_LOG2. Después dos por octava: [2^n, 1,5 * 2^n) y [1,5 * 2^n, 2^(n+1)).
+// La última junta todo lo que no entra
+static uint8_t bucket_of(uint32_t cycles) {
+    if (cycles < (1u << LATENCY_MIN_LOG2)) return 0;
+    uint8_t octave = 31 - __builtin_clz(cycles);
+    uint8_t half = (cycles >> (octave - 1)) & 1;
+    uint32_t bucket = 1 + (octave - LATENCY_MIN_LOG2) * 2 + half;
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+static uint32_t bucket_top(uint8_t bucket) {
+    if (bucket == 0) return 1u << LATENCY_MIN_LOG2;
+    uint8_t octave = LATENCY_MIN_LOG2 + (bucket - 1) / 2;
+    uint32_t half = 1u << (octave - 1);
+    return (1u << octave) + ((bucket - 1) % 2 + 1) * half;
+}
+
+void LATENCY_isr_enter(latency_source_t source) {
+    sources[source].entry = DWT_CYCCNT;
+}
+
+void LATENCY_isr_signal(latency_source_t source) {
+    latency_t *s = &sources[source];
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if (s->pending) {
+        s->coalesced++;
+    } else {
+        s->stamp = s->entry;
+        s->pending = 1;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+void LATENCY_task_wake(latency_source_t source) {
+    latency_t *s = &sources[source];
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if (s->pending) {
+        // La resta en 32 bits sirve mientras la latencia sea menor a una vuelta de CYCCNT
+        uint32_t cycles = DWT_CYCCNT - s->stamp;
+        s->pending = 0;
+        if (s->count == 0 || cycles < s->min) s->min = cycles;
+        if (cycles > s->max) s->max = cycles;
+        s->count++;
+        s->sum += cycles;
+        uint16_t *bucket = &s->histogram[bucket_of(cycles)];
+        if (*bucket != UINT16_MAX) (*bucket)++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+void LATENCY_reset(void) {
+    for (uint8_t i = 0; i < LATENCY_SOURCE_COUNT; i++) {
+        latency_t *s = &sources[i];
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        s->count = 0;
+        s->coalesced = 0;
+        s->min = 0;
+        s->max = 0;
+        s->sum = 0;
+        memset(s->histogram, 0, sizeof(s->histogram));
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+    }
+}
+
+// Borde superior de la cubeta donde se alcanza el percentil, sin pasarse del máximo
+static uint32_t percentile(const latency_t *s, uint32_t total, uint8_t pct) {
+    uint32_t rank = (total * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < LATENCY_BUCKETS - 1; i++) {
+        seen += s->histogram[i];
+        if (seen >= rank) {
+            uint32_t top = bucket_top(i);
+            return top < s->max ? top : s->max;
+        }
+    }
+    return s->max;
+}
+
+void LATENCY_publish(void) {
+    for (uint8_t i = 0; i < LATENCY_SOURCE_COUNT; i++) {
+        latency_t copy;
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        copy = sources[i];
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+        if (copy.count == 0) continue;
+
+        // Los percentiles salen del histograma, que satura: se usa su suma y no count
+        uint32_t total = 0;
+        for (uint8_t b = 0; b < LATENCY_BUCKETS; b++) total += copy.histogram[b];
+
+        latency_packet_t packet = {
+            .type = LATENCY_PACKET_TYPE,
+            .source = i,
+            .buckets = LATENCY_BUCKETS,
+            .uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS,
+            .count = copy.count,
+            .coalesced = copy.coalesced,
+            .min = copy.min,
+            .mean = (uint32_t)(copy.sum / copy.count),
+            .max = copy.max,
+            .p50 = percentile(&copy, total, 50),
+            .p90 = percentile(&copy, total, 90),
+            .p99 = percentile(&copy, total, 99),
+        };
+        memcpy(packet.histogram, copy.histogram, sizeof(packet.histogram));
+        DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, sizeof(packet), 0);
+    }
+}
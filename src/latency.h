@@ -0,0 +1,70 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+
+// Latencia de interrupción a tarea: el tiempo desde que entra la ISR de una fuente hasta
+// que la tarea que consume el evento vuelve a correr, medido con CYCCNT del DWT.
+//
+// La ISR llama a LATENCY_isr_enter() al entrar y a LATENCY_isr_signal() cuando despierta
+// a la tarea (da el semáforo, encola, notifica). La tarea llama a LATENCY_task_wake() al
+// volver de la espera. Si la ISR avisa otra vez antes de que la tarea despierte, la
+// medición sigue siendo desde el primer aviso (el evento más viejo sin atender) y el
+// aviso extra se cuenta como agrupado.
+//
+// Por fuente se lleva mínimo, media, máximo y un histograma logarítmico (dos cubetas por
+// octava) del que salen los percentiles. Los paquetes salen por el stream de
+// housekeeping desde la tarea de telemetría (telemetry.h), acumulados desde el
+// arranque o desde el último LATENCY_reset() (comando PILINK_CMD_LATENCY_RESET).
+// tools/latency_report.py los muestra y los compara contra una referencia.
+
+#define LATENCY_BUCKETS     26
+#define LATENCY_MIN_LOG2    6       // La primera cubeta es < 64 ciclos (0,9 µs a 72 MHz)
+
+#define LATENCY_PACKET_TYPE 0x4C
+
+typedef enum {
+    LATENCY_USART1,
+    LATENCY_USART2,
+    LATENCY_USART3,
+    LATENCY_I2C1,                   // Esclavo del enlace con la Raspberry (pilink.h)
+    LATENCY_I2C2,
+    LATENCY_SOURCE_COUNT
+} latency_source_t;
+
+// Paquete de telemetría de una fuente, en ciclos del core. Los percentiles son el borde
+// superior de la cubeta (nunca más que el máximo)
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // LATENCY_PACKET_TYPE
+    uint8_t source;                 // latency_source_t
+    uint8_t buckets;                // LATENCY_BUCKETS
+    uint8_t reserved;
+    uint32_t uptime_ms;
+    uint32_t count;                 // Latencias medidas
+    uint32_t coalesced;             // Avisos agrupados con uno anterior sin atender
+    uint32_t min;
+    uint32_t mean;
+    uint32_t max;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint16_t histogram[LATENCY_BUCKETS];    // Satura en 0xFFFF
+} latency_packet_t;
+
+// Desde la ISR de la fuente, antes de atender el periférico
+void LATENCY_isr_enter(latency_source_t source);
+
+// Desde la ISR, al despertar a la tarea que consume el evento
+void LATENCY_isr_signal(latency_source_t source);
+
+// Desde la tarea, al volver de la espera por el evento
+void LATENCY_task_wake(latency_source_t source);
+
+// Borra las mediciones de todas las fuentes
+void LATENCY_reset(void);
+
+// Publica un paquete por cada fuente con mediciones
+void LATENCY_publish(void);
+
+#endif
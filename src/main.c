@@ -7,23 +7,49 @@
 #include <stdio.h>
 #include "semphr.h"
 #include "test.h"
+#include "downlink.h"
+#include "i2c.h"
+#include "pilink.h"
+#include "sensors.h"
+#include "power.h"
+#include "trace.h"
+#include "manifest.h"
+#include "pbuf.h"
+#include "supervisor.h"
+#include "kbench.h"
+#include "uartbench.h"
+#include "perfsuite.h"
+#include "nmea.h"
 
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/usart.h>
 
-// Handle para la tarea del parpadeo
-static TaskHandle_t blink_handle;
+// El bus de sensores (I2C2) usa PB10/PB11, los mismos pines que USART3. Compilando con
+// SENSOR_BUS_I2C2 se habilita y el enlace de bajada pasa a USART2.
+#ifdef SENSOR_BUS_I2C2
+#define DOWNLINK_USART USART2
+#else
+#define DOWNLINK_USART USART3
+#endif
 
-static void taskUART1_GPS(uint32_t usart_id) {
+// Espera máxima por datos de las tareas de recepción: sin datos igual hacen check-in con
+// el supervisor
+#define RX_IDLE_WAIT_MS 1000
+
+void taskUART1_GPS(uint32_t usart_id) {
+    supervisor_slot_t *alive = SUPERVISOR_self();
     uint16_t data;
+    nmea_framer_t framer = { 0 };
     for (;;) {
+        SUPERVISOR_checkin(alive);
         // Esperar a que el semáforo indique que hay datos disponibles
-        if (UART_semaphore_take(usart_id, portMAX_DELAY) == pdTRUE) {
+        if (UART_semaphore_take(usart_id, pdMS_TO_TICKS(RX_IDLE_WAIT_MS)) == pdTRUE) {
             // Procesar todos los datos en la cola
             while (UART_receive(usart_id, &data, pdMS_TO_TICKS(100))) {
-                // Aquí puedes manejar el dato recibido (por ejemplo, almacenarlo o procesarlo)
-                UART_putchar(USART3, data, pdMS_TO_TICKS(100));
+                SUPERVISOR_checkin(alive);
+                // La sentencia se arma en un pbuf y pasa entera al stream del GPS (nmea.h)
+                NMEA_feed(&framer, (uint8_t)data);
             }
             // Liberar el semáforo después de procesar los datos
             UART_semaphore_release(usart_id);
@@ -33,13 +59,16 @@ static void taskUART1_GPS(uint32_t usart_id) {
 }
 
 /* Acá estaría la tarea asignada al periférico conectado a la interfaz USART3 */
-static void taskUART3_receive(uint32_t usart_id) {
+void taskUART3_receive(uint32_t usart_id) {
+    supervisor_slot_t *alive = SUPERVISOR_self();
     uint16_t data;
     for (;;) {
+        SUPERVISOR_checkin(alive);
         // Esperar a que el semáforo indique que hay datos disponibles
-        if (UART_semaphore_take(usart_id, portMAX_DELAY) == pdTRUE) {
+        if (UART_semaphore_take(usart_id, pdMS_TO_TICKS(RX_IDLE_WAIT_MS)) == pdTRUE) {
             // Procesar todos los datos en la cola
             while (UART_receive(usart_id, &data, pdMS_TO_TICKS(100))) {
+                SUPERVISOR_checkin(alive);
                 // Aquí puedes manejar el dato recibido (por ejemplo, almacenarlo o procesarlo)
                 UART_putchar(USART3, data, pdMS_TO_TICKS(100));
             }
@@ -50,36 +79,106 @@ static void taskUART3_receive(uint32_t usart_id) {
     }
 }
 
-/* Handler en caso de que la aplicación cause un overflow del stack */
-void vApplicationStackOverflowHook(TaskHandle_t xTask __attribute__((unused)), char *pcTaskName __attribute__((unused))) {
+/* Handler en caso de que la aplicación cause un overflow del stack. Queda registrado para
+el próximo arranque y el IWDG resetea: con el scheduler detenido nadie lo recarga */
+void vApplicationStackOverflowHook(TaskHandle_t xTask __attribute__((unused)), char *pcTaskName) {
+    SUPERVISOR_stack_overflow(pcTaskName);
 	for (;;);
 }
 
+#if defined(KBENCH_ENABLED) || defined(UARTBENCH_ENABLED) || defined(PERFSUITE_ENABLED)
+// Resultados de los benchmarks, directo al registro: no corre la tarea de TX del enlace
+static void bench_print(const char *line) {
+    while (*line) usart_send_blocking(DOWNLINK_USART, *line++);
+    usart_send_blocking(DOWNLINK_USART, '\r');
+    usart_send_blocking(DOWNLINK_USART, '\n');
+}
+#endif
+
 /* Main loop donde arranca el programa */
 int main(void) {
     // Setup main clock, using external 8MHz crystal 
     rcc_clock_setup_in_hse_8mhz_out_72mhz();
 
+#ifdef KBENCH_ENABLED
+    // Solo los benchmarks del kernel: sin las tareas del manifiesto ni el IWDG, que nadie
+    // recargaría. La UART usa las colas del manifiesto
+    MANIFEST_setup();
+    if(UART_setup(DOWNLINK_USART, 115200) != pdPASS) return -1;
+    if(KBENCH_start(bench_print, NULL) != pdPASS) return -1;
+    vTaskStartScheduler();
+    for (;;);
+#endif
+
+#ifdef UARTBENCH_ENABLED
+    // Solo el benchmark de UART en loopback, como KBENCH. Las USARTs que mide las
+    // configura el benchmark
+    MANIFEST_setup();
+    if(UART_setup(DOWNLINK_USART, 115200) != pdPASS) return -1;
+    if(UARTBENCH_start(bench_print) != pdPASS) return -1;
+    vTaskStartScheduler();
+    for (;;);
+#endif
+
+#ifdef PERFSUITE_ENABLED
+    // Solo la suite de rendimiento, como KBENCH. El enlace de bajada no tiene su tarea: las
+    // tramas que arman los caminos medidos las libera la suite
+    MANIFEST_setup();
+    PBUF_setup();
+    if(UART_setup(DOWNLINK_USART, 115200) != pdPASS) return -1;
+    if(UART_setup(USART1, 115200) != pdPASS) return -1;
+    if(DOWNLINK_setup(DOWNLINK_USART) != pdPASS) return -1;
+    if(PERFSUITE_start(bench_print) != pdPASS) return -1;
+    vTaskStartScheduler();
+    for (;;);
+#endif
+
+    // Causa del reset anterior y arranque del IWDG, antes de cualquier otra inicialización
+    SUPERVISOR_setup();
+
+#ifdef TRACE_ENABLED
+    // Antes de crear colas y tareas, así sus eventos también quedan en la traza
+    TRACE_setup();
+#endif
+
+    // Colas, semáforos y message buffers del manifiesto, antes de configurar los periféricos
+    MANIFEST_setup();
+
+    // Pool de buffers de paquete de las tramas del enlace de bajada
+    PBUF_setup();
+
     // Inicialización del LED para el blink
     blink_setup();
 
     // Inicialización de UARTs con sus baudrates
     if(UART_setup(USART1, 115200) != pdPASS) return -1;
     if(UART_setup(USART2, 115200) != pdPASS) return -1;
+#ifndef SENSOR_BUS_I2C2
     if(UART_setup(USART3, 115200) != pdPASS) return -1;
+#else
+    // Bus de sensores I2C2 como master
+    if(I2C_setup(I2C2, 100000) != pdPASS) return -1;
+#endif
 
-    // Crear tarea para parpadear el LED
-    xTaskCreate(taskBlink, "LED", 100, NULL, 2, &blink_handle);  // Crear tarea para parpadear el LED
+#ifdef LOW_POWER
+    // Modo STOP en idle: despierta con el RTC o al llegar datos del GPS (RX de USART1)
+    if(POWER_setup() != pdPASS) return -1;
+    POWER_add_wakeup_pin(GPIOA, GPIO10);
+#ifndef SENSOR_BUS_I2C2
+    POWER_add_wakeup_pin(GPIOB, GPIO11);  // RX de USART3
+#endif
+    POWER_add_i2c_slave(PILINK_DMA_CHANNEL, GPIOB, GPIO7);  // START de la Raspberry Pi en SDA de I2C1
+#endif
 
-    // Creación de tareas genéricas para transmisión UART
-    xTaskCreate((TaskFunction_t)taskUART_transmit, "UART1 TX", 128, (void *)USART1, 2, NULL);
-    xTaskCreate((TaskFunction_t)taskUART_transmit, "UART2 TX", 128, (void *)USART2, 2, NULL);
-    xTaskCreate((TaskFunction_t)taskUART_transmit, "UART3 TX", 128, (void *)USART3, 2, NULL);
+    // Enlace con la Raspberry Pi: esclavo en I2C1 (PB6 SCL, PB7 SDA)
+    if(PILINK_setup() != pdPASS) return -1;
+
+    // Colas de los streams del enlace de bajada
+    if(DOWNLINK_setup(DOWNLINK_USART) != pdPASS) return -1;
+
+    // Tareas del manifiesto, con stacks estáticos
+    MANIFEST_create_tasks();
 
-    // Creación de tareas genéricas para recepción UART
-    xTaskCreate((TaskFunction_t)taskUART3_receive, "UART3 RX", 128, (void *)USART3, 2, NULL);
-    xTaskCreate((TaskFunction_t)taskUART1_GPS, "UART1 RX", 128, (void *)USART1, 2, NULL);
-    
     // Crear tareas para Test
     //xTaskCreate(taskTestUART_Semaphore, "Test_Semaphore", 100, NULL, 2, NULL);  // Crear tarea para Test
     //xTaskCreate(taskTest, "Test", 100, NULL, 2, NULL);  // Crear tarea para Test
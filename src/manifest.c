@@ -0,0 +1,125 @@
+#include "manifest.h"
+#include "semphr.h"
+#include "timers.h"
+
+#include "blink.h"
+#include "uart.h"
+#include "i2c.h"
+#include "downlink.h"
+#include "pilink.h"
+#include "sensors.h"
+#include "cpustats.h"
+#include "stackmon.h"
+#include "telemetry.h"
+#include "periodic.h"
+#include "supervisor.h"
+#include "trace.h"
+
+#include <libopencm3/stm32/usart.h>
+
+// Memoria de un objeto: colas y semáforos comparten la estructura de control
+typedef StaticQueue_t manifest_static_t;
+
+// Un stack y un TCB por tarea
+#define MANIFEST_TASK_MEMORY(name, function, label, depth, param, priority, window_ms) \
+    static StackType_t name##_stack[depth]; \
+    static StaticTask_t name##_tcb;
+MANIFEST_TASKS(MANIFEST_TASK_MEMORY)
+
+// Las periódicas además tienen su periodic_t
+#define MANIFEST_PERIODIC_MEMORY(name, function, text, depth, period_ms, deadline_ms) \
+    static StackType_t name##_stack[depth]; \
+    static StaticTask_t name##_tcb; \
+    static periodic_t name##_periodic = { .label = text, .period = pdMS_TO_TICKS(period_ms), \
+                                          .deadline = pdMS_TO_TICKS(deadline_ms) };
+MANIFEST_PERIODIC(MANIFEST_PERIODIC_MEMORY)
+
+#define MANIFEST_PERIODIC_POINTER(name, function, label, depth, period_ms, deadline_ms) &name##_periodic,
+static periodic_t *const periodic_tasks[] = { MANIFEST_PERIODIC(MANIFEST_PERIODIC_POINTER) };
+
+// Un área de datos y una estructura de control por objeto. Con length 0 ninguna de las dos
+#define MANIFEST_OBJECT_MEMORY(id, kind, length, item_size) \
+    static uint8_t id##_storage[(length) * (item_size)]; \
+    static manifest_static_t id##_object[(length) > 0];
+MANIFEST_OBJECTS(MANIFEST_OBJECT_MEMORY)
+
+// Idle y timers también son estáticas (configSUPPORT_STATIC_ALLOCATION las exige)
+static StackType_t idle_stack[configMINIMAL_STACK_SIZE];
+static StaticTask_t idle_tcb;
+static StackType_t timer_stack[configTIMER_TASK_STACK_DEPTH];
+static StaticTask_t timer_tcb;
+
+// Presupuesto de RAM: si el manifiesto crece por encima del presupuesto no compila.
+// El chequeo de toda la RAM (con el heap y el resto de .bss) lo hace el linker script
+#define MANIFEST_TASK_BYTES(name, function, label, depth, param, priority, window_ms) \
+    + (depth) * sizeof(StackType_t) + sizeof(StaticTask_t)
+#define MANIFEST_PERIODIC_BYTES(name, function, label, depth, period_ms, deadline_ms) \
+    + (depth) * sizeof(StackType_t) + sizeof(StaticTask_t) + sizeof(periodic_t)
+#define MANIFEST_OBJECT_BYTES(id, kind, length, item_size) \
+    + (length) * (item_size) + ((length) > 0) * sizeof(manifest_static_t)
+#define MANIFEST_RAM_BYTES ( \
+    MANIFEST_TASKS(MANIFEST_TASK_BYTES) \
+    MANIFEST_PERIODIC(MANIFEST_PERIODIC_BYTES) \
+    MANIFEST_OBJECTS(MANIFEST_OBJECT_BYTES) \
+    + sizeof(idle_stack) + sizeof(idle_tcb) + sizeof(timer_stack) + sizeof(timer_tcb))
+
+_Static_assert(MANIFEST_RAM_BYTES <= MANIFEST_RAM_BUDGET, "El manifiesto supera MANIFEST_RAM_BUDGET");
+
+static void *handles[MANIFEST_OBJECT_COUNT];
+
+static void *manifest_create(uint8_t kind, UBaseType_t length, UBaseType_t item_size,
+                             uint8_t *storage, manifest_static_t *object) {
+    if (length == 0) return NULL;
+    switch (kind) {
+        case MANIFEST_QUEUE:  return xQueueCreateStatic(length, item_size, storage, object);
+        case MANIFEST_MUTEX:  return xSemaphoreCreateMutexStatic(object);
+        case MANIFEST_BINARY: return xSemaphoreCreateBinaryStatic(object);
+        default:              return NULL;
+    }
+}
+
+void MANIFEST_setup(void) {
+#define MANIFEST_OBJECT_CREATE(id, kind, length, item_size) \
+    handles[MANIFEST_##id] = manifest_create(kind, length, item_size, id##_storage, id##_object);
+    MANIFEST_OBJECTS(MANIFEST_OBJECT_CREATE)
+#undef MANIFEST_OBJECT_CREATE
+}
+
+// Monitor de stacks y supervisor de cada tarea creada
+static void manifest_register(TaskHandle_t task, configSTACK_DEPTH_TYPE depth, uint32_t window_ms) {
+    STACKMON_register(task, depth);
+    if (window_ms > 0) SUPERVISOR_register(task, pdMS_TO_TICKS(window_ms));
+}
+
+void MANIFEST_create_tasks(void) {
+#define MANIFEST_TASK_CREATE(name, function, label, depth, param, priority, window_ms) \
+    manifest_register(xTaskCreateStatic((TaskFunction_t)function, label, depth, (void *)(param), \
+                                        priority, name##_stack, &name##_tcb), depth, window_ms);
+    MANIFEST_TASKS(MANIFEST_TASK_CREATE)
+#undef MANIFEST_TASK_CREATE
+
+    // Las prioridades de las periódicas salen de comparar los períodos de todas
+    PERIODIC_setup(periodic_tasks, sizeof(periodic_tasks) / sizeof(periodic_tasks[0]));
+#define MANIFEST_PERIODIC_CREATE(name, function, label, depth, period_ms, deadline_ms) \
+    manifest_register(xTaskCreateStatic((TaskFunction_t)function, label, depth, &name##_periodic, \
+                                        name##_periodic.priority, name##_stack, &name##_tcb), depth, \
+                      (uint32_t)SUPERVISOR_PERIODS * (period_ms));
+    MANIFEST_PERIODIC(MANIFEST_PERIODIC_CREATE)
+#undef MANIFEST_PERIODIC_CREATE
+}
+
+QueueHandle_t MANIFEST_queue(manifest_object_t id) {
+    return id < MANIFEST_OBJECT_COUNT ? handles[id] : NULL;
+}
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *depth) {
+    *tcb = &idle_tcb;
+    *stack = idle_stack;
+    *depth = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *depth) {
+    *tcb = &timer_tcb;
+    *stack = timer_stack;
+    *depth = configTIMER_TASK_STACK_DEPTH;
+}
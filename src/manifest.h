@@ -0,0 +1,132 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include <stdint.h>
+
+// Manifiesto de tareas y objetos del kernel. Todo se crea con memoria estática
+// (configSUPPORT_STATIC_ALLOCATION): el espacio de cada stack, cola y semáforo se reserva
+// en .bss al compilar y su creación no puede fallar. manifest.c expande estas listas en
+// los objetos, verifica el presupuesto de RAM (MANIFEST_RAM_BUDGET) y los crea; los
+// módulos toman los handles con MANIFEST_queue(), cada uno por su id.
+//
+// Para agregar una tarea o una cola alcanza con una línea en la lista correspondiente. Las
+// tareas periódicas van en su propia lista: declaran período y plazo en lugar de la
+// prioridad, que les asigna periodic.h por período (rate-monotonic).
+//
+// Cada tarea declara también la ventana en que tiene que hacer check-in con el supervisor
+// (supervisor.h); con 0 no se supervisa. Las que esperan eventos sin plazo (una cola con
+// portMAX_DELAY) no pueden supervisarse. Las periódicas se supervisan siempre, con una
+// ventana de SUPERVISOR_PERIODS períodos.
+
+#ifndef MANIFEST_RAM_BUDGET
+#define MANIFEST_RAM_BUDGET (14 * 1024)   // Stacks, TCBs y objetos del manifiesto
+#endif
+
+// Clases de objeto
+#define MANIFEST_QUEUE          0
+#define MANIFEST_MUTEX          1
+#define MANIFEST_BINARY         2   // Semáforo binario
+
+// Los objetos de USART3 no existen con el bus de sensores (comparten pines), igual que
+// sus tareas (MANIFEST_TASKS_UART3). Un objeto con length 0 no ocupa lugar y su handle
+// queda en NULL
+#ifdef SENSOR_BUS_I2C2
+#define MANIFEST_UART3_LENGTH 0
+#define MANIFEST_UART3_SYNC   0     // Mutex y semáforo
+#define MANIFEST_I2C2_LENGTH  8
+#else
+#define MANIFEST_UART3_LENGTH 256
+#define MANIFEST_UART3_SYNC   1
+#define MANIFEST_I2C2_LENGTH  0
+#endif
+
+// X(id, clase, length, item_size)
+// Las colas de los streams guardan punteros a las tramas, que están en el pool de pbuf.h
+// Nadie escribe en USART1 (GPS) ni lee lo que llega por USART2: esas colas son cortas
+#define MANIFEST_OBJECTS(X) \
+    X(UART1_TXQ,    MANIFEST_QUEUE,  32,  sizeof(uint16_t)) \
+    X(UART1_RXQ,    MANIFEST_QUEUE,  256, sizeof(uint16_t)) \
+    X(UART1_MUTEX,  MANIFEST_MUTEX,  1, 0) \
+    X(UART1_SEM,    MANIFEST_BINARY, 1, 0) \
+    X(UART2_TXQ,    MANIFEST_QUEUE,  256, sizeof(uint16_t)) \
+    X(UART2_RXQ,    MANIFEST_QUEUE,  16,  sizeof(uint16_t)) \
+    X(UART2_MUTEX,  MANIFEST_MUTEX,  1, 0) \
+    X(UART2_SEM,    MANIFEST_BINARY, 1, 0) \
+    X(UART3_TXQ,    MANIFEST_QUEUE,  MANIFEST_UART3_LENGTH, sizeof(uint16_t)) \
+    X(UART3_RXQ,    MANIFEST_QUEUE,  MANIFEST_UART3_LENGTH, sizeof(uint16_t)) \
+    X(UART3_MUTEX,  MANIFEST_MUTEX,  MANIFEST_UART3_SYNC, 0) \
+    X(UART3_SEM,    MANIFEST_BINARY, MANIFEST_UART3_SYNC, 0) \
+    X(I2C1_TXQ,     MANIFEST_QUEUE,  0, sizeof(void *)) \
+    X(I2C2_TXQ,     MANIFEST_QUEUE,  MANIFEST_I2C2_LENGTH, sizeof(void *)) \
+    X(PILINK_CMDQ,  MANIFEST_QUEUE,  4, sizeof(pilink_command_t)) \
+    X(PILINK_MUTEX, MANIFEST_MUTEX,  1, 0) \
+    X(DOWNLINK_HK,      MANIFEST_QUEUE,  6, sizeof(pbuf_t *)) \
+    X(DOWNLINK_GPS,     MANIFEST_QUEUE,  4, sizeof(pbuf_t *)) \
+    X(DOWNLINK_LOG,     MANIFEST_QUEUE,  4, sizeof(pbuf_t *)) \
+    X(DOWNLINK_PAYLOAD, MANIFEST_QUEUE,  6, sizeof(pbuf_t *))
+
+// Tareas según la configuración del build
+#ifdef SENSOR_BUS_I2C2
+#define MANIFEST_TASKS_UART3(X)
+#define MANIFEST_TASKS_SENSOR_BUS(X) \
+    X(i2c2,    taskI2C,     "I2C2",    128, I2C2, 3, 0) \
+    X(sensors, taskSensors, "Sensors", 128, I2C2, 2, 0)
+#else
+#define MANIFEST_TASKS_UART3(X) \
+    X(uart3_tx, taskUART_transmit, "UART3 TX", 128, USART3, 2, 2000) \
+    X(uart3_rx, taskUART3_receive, "UART3 RX", 128, USART3, 2, 2000)
+#define MANIFEST_TASKS_SENSOR_BUS(X)
+#endif
+
+#ifdef TRACE_ENABLED
+#define MANIFEST_TASKS_TRACE(X) \
+    X(trace, taskTrace, "Trace", 128, NULL, 1, 0)
+#else
+#define MANIFEST_TASKS_TRACE(X)
+#endif
+
+// X(nombre, función, etiqueta, stack en palabras, parámetro, prioridad, ventana en ms)
+// El supervisor va arriba de todas: si no llega a correr, el IWDG resetea sin registro
+#define MANIFEST_TASKS(X) \
+    X(supervisor, taskSupervisor,  "Supervisor", 128, NULL, configMAX_PRIORITIES - 1, 0) \
+    X(uart1_tx, taskUART_transmit, "UART1 TX", 128, USART1, 2, 2000) \
+    X(uart2_tx, taskUART_transmit, "UART2 TX", 128, USART2, 2, 2000) \
+    X(downlink, taskDownlink,      "Downlink", 128, NULL, 2, 2000) \
+    X(pilink,   taskPilink,        "PiLink",   128, NULL, 2, 1000) \
+    X(uart1_rx, taskUART1_GPS,     "UART1 RX", 128, USART1, 2, 2000) \
+    MANIFEST_TASKS_UART3(X) \
+    MANIFEST_TASKS_SENSOR_BUS(X) \
+    MANIFEST_TASKS_TRACE(X)
+
+// Tareas periódicas: reciben su periodic_t como parámetro
+// X(nombre, función, etiqueta, stack en palabras, período en ms, plazo en ms)
+#define MANIFEST_PERIODIC(X) \
+    X(blink,    taskBlink,    "LED",      100, BLINK_PERIOD_MS,    BLINK_PERIOD_MS) \
+    X(cpustats, taskCpuStats, "CpuStats", 128, CPUSTATS_PERIOD_MS, CPUSTATS_PERIOD_MS) \
+    X(stackmon, taskStackMon, "StackMon", 128, STACKMON_PERIOD_MS, STACKMON_PERIOD_MS) \
+    X(telemetry, taskTelemetry, "Telemetry", 128, TELEMETRY_PERIOD_MS, TELEMETRY_PERIOD_MS)
+
+#define MANIFEST_OBJECT_ID(id, kind, length, item_size) MANIFEST_##id,
+typedef enum {
+    MANIFEST_OBJECTS(MANIFEST_OBJECT_ID)
+    MANIFEST_OBJECT_COUNT
+} manifest_object_t;
+#undef MANIFEST_OBJECT_ID
+
+// Tareas de la aplicación definidas en main.c
+void taskUART1_GPS(uint32_t usart_id);
+void taskUART3_receive(uint32_t usart_id);
+
+// Crea las colas y los semáforos. Va antes de configurar los periféricos
+void MANIFEST_setup(void);
+
+// Crea las tareas. Va antes de arrancar el scheduler
+void MANIFEST_create_tasks(void);
+
+// Handle de un objeto creado por MANIFEST_setup(). NULL si tiene length 0
+QueueHandle_t MANIFEST_queue(manifest_object_t id);
+
+#endif
@@ -0,0 +1,11 @@
+#include "name.h"
+
+#include <string.h>
+
+void NAME_copy(char *dst, const char *src, size_t size) {
+    // memchr y no strnlen(), que no está en C99
+    const char *end = memchr(src, '\0', size);
+    size_t len = end != NULL ? (size_t)(end - src) : size;
+    memcpy(dst, src, len);
+    memset(dst + len, 0, size - len);
+}
@@ -0,0 +1,11 @@
+#ifndef NAME_H
+#define NAME_H
+
+#include <stddef.h>
+
+// Copia un nombre (de tarea, de cola) a un campo de largo fijo de la telemetría: a lo sumo
+// size bytes y el resto del campo en cero. Si el nombre ocupa todo queda sin terminador;
+// para un campo con terminador se pasa un byte menos que su tamaño y el campo ya en cero
+void NAME_copy(char *dst, const char *src, size_t size);
+
+#endif
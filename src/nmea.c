@@ -0,0 +1,29 @@
+#include "nmea.h"
+#include "downlink.h"
+
+// Sin lugar para la sentencia: se descarta lo que falta de ella
+static void nmea_drop(nmea_framer_t *framer, uint8_t ch) {
+    if (framer->sentence != NULL) PBUF_free(framer->sentence);
+    framer->sentence = NULL;
+    framer->discarding = ch != '\n';
+}
+
+void NMEA_feed(nmea_framer_t *framer, uint8_t ch) {
+    if (framer->discarding) {
+        if (ch == '\n') framer->discarding = 0;
+        return;
+    }
+    if (framer->sentence == NULL && (framer->sentence = PBUF_alloc(0, 0)) == NULL) {
+        nmea_drop(framer, ch);
+        return;
+    }
+    if (PBUF_append(framer->sentence, &ch, 1) != pdPASS) {
+        nmea_drop(framer, ch);
+        return;
+    }
+    // Una sentencia más larga que una trama se corta en tramas
+    if (ch == '\n' || framer->sentence->tot_len == DOWNLINK_MAX_FRAME) {
+        DOWNLINK_send_pbuf(DOWNLINK_STREAM_GPS, framer->sentence, 0);
+        framer->sentence = NULL;
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef NMEA_H
+#define NMEA_H
+
+#include "FreeRTOS.h"
+#include "pbuf.h"
+#include <stdint.h>
+
+// Armado de las sentencias NMEA que llegan del GPS: se juntan byte a byte en un pbuf que,
+// con el fin de línea, pasa entero al stream del GPS del enlace de bajada, sin copiarse.
+// Sin bloques libres se descarta la sentencia en armado hasta su fin de línea: el resto no
+// sale como un fragmento suelto y no se vuelve a pedir un bloque por cada byte.
+
+typedef struct {
+    pbuf_t *sentence;           // Sentencia en armado, NULL entre sentencias
+    uint8_t discarding;         // Descartando hasta el próximo fin de línea
+} nmea_framer_t;
+
+// Agrega un byte a la sentencia en armado
+void NMEA_feed(nmea_framer_t *framer, uint8_t ch);
+
+#endif
@@ -0,0 +1,104 @@
+#include "FreeRTOS.h"
+#include "nor.h"
+
+// Comandos
+#define NOR_CMD_WRITE_ENABLE  0x06
+#define NOR_CMD_READ_STATUS   0x05
+#define NOR_CMD_FAST_READ     0x0B
+#define NOR_CMD_PAGE_PROGRAM  0x02
+#define NOR_CMD_SECTOR_ERASE  0x20
+#define NOR_CMD_JEDEC_ID      0x9F
+
+#define NOR_STATUS_BUSY 0x01
+
+#define NOR_QUEUE_WAIT_MS 100      // Espera máxima por lugar en la cola del bus
+#define NOR_PROGRAM_TIMEOUT_MS 5   // tPP máximo de la familia: 3 ms
+#define NOR_ERASE_TIMEOUT_MS 500   // tSE máximo de la familia: 400 ms
+
+// Comando seguido de una dirección de 24 bits
+static void nor_address_cmd(uint8_t *cmd, uint8_t op, uint32_t addr) {
+    cmd[0] = op;
+    cmd[1] = (addr >> 16) & 0xFF;
+    cmd[2] = (addr >> 8) & 0xFF;
+    cmd[3] = addr & 0xFF;
+}
+
+static BaseType_t nor_command(const spi_device_t *dev, uint8_t op) {
+    spi_transaction_t txn = { .dev = dev, .cmd = &op, .cmd_len = 1 };
+    return SPI_transfer(&txn, pdMS_TO_TICKS(NOR_QUEUE_WAIT_MS)) == SPI_OK ? pdPASS : pdFAIL;
+}
+
+// Espera a que termine la programación o el borrado en curso. La programación de una
+// página tarda menos de un tick, así que entre consultas se cede la CPU en lugar de
+// dormir; el borrado se consulta una vez por tick
+static BaseType_t nor_wait_ready(const spi_device_t *dev, TickType_t poll, TickType_t timeout) {
+    uint8_t op = NOR_CMD_READ_STATUS;
+    uint8_t status;
+    TickType_t start = xTaskGetTickCount();
+
+    for (;;) {
+        spi_transaction_t txn = { .dev = dev, .cmd = &op, .cmd_len = 1, .rx = &status, .len = 1 };
+        if (SPI_transfer(&txn, pdMS_TO_TICKS(NOR_QUEUE_WAIT_MS)) != SPI_OK) return pdFAIL;
+        if (!(status & NOR_STATUS_BUSY)) return pdPASS;
+        if (xTaskGetTickCount() - start > timeout) return pdFAIL;
+
+        if (poll > 0)
+            vTaskDelay(poll);
+        else
+            taskYIELD();
+    }
+}
+
+BaseType_t NOR_read_id(const spi_device_t *dev, uint32_t *jedec_id) {
+    uint8_t op = NOR_CMD_JEDEC_ID;
+    uint8_t id[3];
+    spi_transaction_t txn = { .dev = dev, .cmd = &op, .cmd_len = 1, .rx = id, .len = sizeof(id) };
+
+    if (SPI_transfer(&txn, pdMS_TO_TICKS(NOR_QUEUE_WAIT_MS)) != SPI_OK) return pdFAIL;
+    *jedec_id = ((uint32_t)id[0] << 16) | ((uint32_t)id[1] << 8) | id[2];
+    return pdPASS;
+}
+
+BaseType_t NOR_read(const spi_device_t *dev, uint32_t addr, uint8_t *data, uint16_t len) {
+    // Lectura rápida: dirección y un byte dummy, luego los datos por DMA
+    uint8_t cmd[5];
+    nor_address_cmd(cmd, NOR_CMD_FAST_READ, addr);
+    cmd[4] = 0;
+
+    spi_transaction_t txn = { .dev = dev, .cmd = cmd, .cmd_len = sizeof(cmd), .rx = data, .len = len };
+    return SPI_transfer(&txn, pdMS_TO_TICKS(NOR_QUEUE_WAIT_MS)) == SPI_OK ? pdPASS : pdFAIL;
+}
+
+BaseType_t NOR_program(const spi_device_t *dev, uint32_t addr, const uint8_t *data, uint32_t len) {
+    uint8_t cmd[4];
+
+    while (len > 0) {
+        // Hasta el final de la página
+        uint16_t chunk = NOR_PAGE_SIZE - (addr % NOR_PAGE_SIZE);
+        if (chunk > len) chunk = len;
+
+        if (nor_command(dev, NOR_CMD_WRITE_ENABLE) != pdPASS) return pdFAIL;
+
+        nor_address_cmd(cmd, NOR_CMD_PAGE_PROGRAM, addr);
+        spi_transaction_t txn = { .dev = dev, .cmd = cmd, .cmd_len = sizeof(cmd), .tx = data, .len = chunk };
+        if (SPI_transfer(&txn, pdMS_TO_TICKS(NOR_QUEUE_WAIT_MS)) != SPI_OK) return pdFAIL;
+        if (nor_wait_ready(dev, 0, pdMS_TO_TICKS(NOR_PROGRAM_TIMEOUT_MS)) != pdPASS) return pdFAIL;
+
+        addr += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+    return pdPASS;
+}
+
+BaseType_t NOR_erase_sector(const spi_device_t *dev, uint32_t addr) {
+    uint8_t cmd[4];
+
+    if (nor_command(dev, NOR_CMD_WRITE_ENABLE) != pdPASS) return pdFAIL;
+
+    nor_address_cmd(cmd, NOR_CMD_SECTOR_ERASE, addr);
+    spi_transaction_t txn = { .dev = dev, .cmd = cmd, .cmd_len = sizeof(cmd) };
+    if (SPI_transfer(&txn, pdMS_TO_TICKS(NOR_QUEUE_WAIT_MS)) != SPI_OK) return pdFAIL;
+
+    return nor_wait_ready(dev, pdMS_TO_TICKS(1), pdMS_TO_TICKS(NOR_ERASE_TIMEOUT_MS));
+}
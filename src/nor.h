@@ -0,0 +1,25 @@
+#ifndef NOR_H
+#define NOR_H
+
+#include "FreeRTOS.h"
+#include "spi.h"
+#include <stdint.h>
+
+// Memoria NOR SPI con el juego de comandos de la familia W25Qxx
+
+#define NOR_PAGE_SIZE   256    // Una programación no puede cruzar el borde de página
+#define NOR_SECTOR_SIZE 4096   // Mínima unidad de borrado
+
+// Lee el identificador JEDEC (fabricante, tipo y capacidad)
+BaseType_t NOR_read_id(const spi_device_t *dev, uint32_t *jedec_id);
+
+// Lee len bytes a partir de addr en una sola transacción
+BaseType_t NOR_read(const spi_device_t *dev, uint32_t addr, uint8_t *data, uint16_t len);
+
+// Programa len bytes a partir de addr, partiendo en páginas. La zona debe estar borrada
+BaseType_t NOR_program(const spi_device_t *dev, uint32_t addr, const uint8_t *data, uint32_t len);
+
+// Borra el sector de 4 KB que contiene addr
+BaseType_t NOR_erase_sector(const spi_device_t *dev, uint32_t addr);
+
+#endif
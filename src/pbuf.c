@@ -0,0 +1,155 @@
+#include "pbuf.h"
+#include "task.h"
+
+#include <string.h>
+
+typedef struct {
+    pbuf_t blocks[PBUF_COUNT];
+    pbuf_t *free_list;              // Pila de bloques libres, enlazada por next
+    pbuf_stats_t stats;
+} pbuf_pool_t;
+
+static pbuf_pool_t pool;
+
+void PBUF_setup(void) {
+    pool.free_list = NULL;
+    for (uint16_t i = PBUF_COUNT; i-- > 0; ) {
+        pool.blocks[i].next = pool.free_list;
+        pool.free_list = &pool.blocks[i];
+    }
+    pool.stats.free = PBUF_COUNT;
+    pool.stats.min_free = PBUF_COUNT;
+}
+
+static uint16_t blocks_for(uint16_t len, uint16_t header) {
+    uint16_t first = PBUF_BLOCK_SIZE - header;
+    return 1 + (len > first ? (len - first + PBUF_BLOCK_SIZE - 1) / PBUF_BLOCK_SIZE : 0);
+}
+
+pbuf_t *PBUF_alloc(uint16_t len, uint16_t header) {
+    if (header > PBUF_BLOCK_SIZE) return NULL;
+    uint16_t count = blocks_for(len, header);
+
+    // Los bloques de arriba de la pila ya están enlazados: se cortan count de una vez
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    if (pool.stats.free < count) {
+        pool.stats.exhausted++;
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+        return NULL;
+    }
+    pbuf_t *head = pool.free_list;
+    pbuf_t *last = head;
+    for (uint16_t i = 1; i < count; i++) last = last->next;
+    pool.free_list = last->next;
+    last->next = NULL;
+    pool.stats.free -= count;
+    if (pool.stats.free < pool.stats.min_free) pool.stats.min_free = pool.stats.free;
+    pool.stats.allocated += count;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    uint16_t remaining = len;
+    for (pbuf_t *q = head; q != NULL; q = q->next) {
+        uint16_t offset = q == head ? header : 0;
+        q->payload = &q->data[offset];
+        q->len = remaining < PBUF_BLOCK_SIZE - offset ? remaining : PBUF_BLOCK_SIZE - offset;
+        q->tot_len = remaining;
+        q->ref = 1;
+        remaining -= q->len;
+    }
+    return head;
+}
+
+void PBUF_free(pbuf_t *p) {
+    while (p != NULL) {
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        configASSERT(p->ref > 0);
+        pbuf_t *next = p->next;
+        uint8_t ref = --p->ref;
+        if (ref == 0) {
+            p->next = pool.free_list;
+            pool.free_list = p;
+            pool.stats.free++;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+
+        // El resto de la cadena sigue viva si alguien más la referencia
+        if (ref != 0) return;
+        p = next;
+    }
+}
+
+void PBUF_ref(pbuf_t *p) {
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    p->ref++;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+BaseType_t PBUF_header(pbuf_t *p, int16_t delta) {
+    if (delta > 0) {
+        if (p->payload - p->data < delta) return pdFAIL;
+    } else if (-delta > p->len) {
+        return pdFAIL;
+    }
+    p->payload -= delta;
+    p->len += delta;
+    p->tot_len += delta;
+    return pdPASS;
+}
+
+BaseType_t PBUF_append(pbuf_t *p, const uint8_t *data, uint16_t len) {
+    pbuf_t *tail = p;
+    while (tail->next != NULL) tail = tail->next;
+
+    uint16_t space = (uint16_t)(&tail->data[PBUF_BLOCK_SIZE] - (tail->payload + tail->len));
+    uint16_t here = len < space ? len : space;
+
+    // Los bloques nuevos se piden antes de tocar la cadena
+    pbuf_t *extra = NULL;
+    if (len > here) {
+        extra = PBUF_alloc(len - here, 0);
+        if (extra == NULL) return pdFAIL;
+    }
+
+    for (pbuf_t *q = p; q != NULL; q = q->next) q->tot_len += len;
+    memcpy(tail->payload + tail->len, data, here);
+    tail->len += here;
+
+    for (pbuf_t *q = extra; q != NULL; q = q->next) {
+        memcpy(q->payload, data + here, q->len);
+        here += q->len;
+    }
+    tail->next = extra;
+    return pdPASS;
+}
+
+void PBUF_cat(pbuf_t *head, pbuf_t *tail) {
+    pbuf_t *q = head;
+    for (;;) {
+        q->tot_len += tail->tot_len;
+        if (q->next == NULL) break;
+        q = q->next;
+    }
+    q->next = tail;
+}
+
+uint16_t PBUF_copy_out(const pbuf_t *p, uint8_t *buf, uint16_t len, uint16_t offset) {
+    uint16_t copied = 0;
+    for (const pbuf_t *q = p; q != NULL && copied < len; q = q->next) {
+        if (offset >= q->len) {
+            offset -= q->len;
+            continue;
+        }
+        uint16_t n = q->len - offset;
+        if (n > len - copied) n = len - copied;
+        memcpy(buf + copied, q->payload + offset, n);
+        copied += n;
+        offset = 0;
+    }
+    return copied;
+}
+
+void PBUF_get_stats(pbuf_stats_t *stats) {
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *stats = pool.stats;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
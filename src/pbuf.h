@@ -0,0 +1,70 @@
+#ifndef PBUF_H
+#define PBUF_H
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+
+// Buffers de paquete: bloques de tamaño fijo de un pool estático que se encadenan para
+// datos más largos que un bloque. Un paquete pasa de una capa a otra (y entre tareas e
+// ISRs) como un puntero, sin copiar los datos: quien lo recibe se queda con la referencia
+// y lo libera cuando termina. Con PBUF_ref() varios consumidores comparten el mismo
+// paquete; los bloques vuelven al pool cuando se suelta la última referencia.
+//
+// El primer bloque puede reservar lugar delante de los datos para que una capa inferior
+// agregue su encabezado con PBUF_header() sin mover el contenido.
+//
+// Pedir y liberar un bloque es O(1) (pila de bloques libres) y se puede hacer desde una
+// ISR: el pool se protege enmascarando las interrupciones del kernel, no con el scheduler.
+
+#define PBUF_BLOCK_SIZE 64      // Bytes de datos por bloque
+#define PBUF_COUNT      24      // Bloques en el pool
+
+typedef struct pbuf {
+    struct pbuf *next;          // Siguiente bloque de la cadena, NULL en el último
+    uint8_t *payload;           // Comienzo de los datos de este bloque
+    uint16_t len;               // Bytes de datos en este bloque
+    uint16_t tot_len;           // Bytes desde este bloque hasta el final de la cadena
+    uint8_t ref;                // Referencias a este bloque
+    uint8_t reserved[3];
+    uint8_t data[PBUF_BLOCK_SIZE];
+} pbuf_t;
+
+typedef struct {
+    uint16_t free;              // Bloques libres
+    uint16_t min_free;          // Mínimo de bloques libres desde el arranque
+    uint32_t allocated;         // Bloques entregados
+    uint32_t exhausted;         // Pedidos que fallaron por pool vacío
+} pbuf_stats_t;
+
+// Arma la pila de bloques libres. Va antes de cualquier otro uso
+void PBUF_setup(void);
+
+// Cadena con capacidad para len bytes y header bytes libres delante de los datos del
+// primer bloque (header <= PBUF_BLOCK_SIZE). NULL si no hay bloques suficientes.
+// Los datos quedan sin inicializar y len en todos los bloques. Se puede llamar desde ISRs
+pbuf_t *PBUF_alloc(uint16_t len, uint16_t header);
+
+// Suelta una referencia al paquete. Los bloques que quedan sin referencias vuelven al
+// pool, siguiendo la cadena hasta el primero que tenga otra. Se puede llamar desde ISRs
+void PBUF_free(pbuf_t *p);
+
+// Agrega una referencia al paquete (para pasárselo a otro consumidor sin copiarlo)
+void PBUF_ref(pbuf_t *p);
+
+// Mueve el comienzo de los datos del primer bloque: delta > 0 agrega un encabezado en el
+// lugar reservado, delta < 0 quita uno. pdFAIL si no hay lugar o datos suficientes
+BaseType_t PBUF_header(pbuf_t *p, int16_t delta);
+
+// Agrega len bytes al final de la cadena, llenando el último bloque y pidiendo más si
+// hace falta. Si el pool no alcanza la cadena no cambia y devuelve pdFAIL
+BaseType_t PBUF_append(pbuf_t *p, const uint8_t *data, uint16_t len);
+
+// Une tail al final de head. head se queda con la referencia del que llama a tail
+void PBUF_cat(pbuf_t *head, pbuf_t *tail);
+
+// Copia hasta len bytes desde offset a buf. Devuelve los bytes copiados
+uint16_t PBUF_copy_out(const pbuf_t *p, uint8_t *buf, uint16_t len, uint16_t offset);
+
+void PBUF_get_stats(pbuf_stats_t *stats);
+
+#endif
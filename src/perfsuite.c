@@ -0,0 +1,156 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "perfsuite.h"
+#include "uart.h"
+#include "nmea.h"
+#include "downlink.h"
+#include "manifest.h"
+#include "supervisor.h"
+
+#include <libopencm3/cm3/dwt.h>
+#include <libopencm3/cm3/nvic.h>
+
+// Sin PERFSUITE=1 el módulo no se compila
+#ifdef PERFSUITE_ENABLED
+
+#define PERFSUITE_STACK_DEPTH   256
+
+static const char gga[] = "$GPGGA,123519,3436.234,S,05822.123,W,1,08,0.9,25.4,M,16.9,M,,*76\r\n";
+
+static TaskHandle_t partner;
+static StaticTask_t suite_tcb, partner_tcb;
+static StackType_t suite_stack[PERFSUITE_STACK_DEPTH];
+static StackType_t partner_stack[configMINIMAL_STACK_SIZE];
+
+// Las tramas encoladas no salen (no corre la tarea del enlace): se liberan entre rondas
+static void drain_stream(manifest_object_t id) {
+    pbuf_t *p;
+    while (xQueueReceive(MANIFEST_queue(id), &p, 0) == pdTRUE) PBUF_free(p);
+}
+
+static void put_result(const char *name, uint32_t cycles) {
+    TEXTLINE_text(name, 20);
+    TEXTLINE_uint(cycles, 10);
+    TEXTLINE_end();
+}
+
+// 0 si no llegaron los bytes
+static uint32_t measure_uart_isr(void) {
+    uint16_t data;
+    while (UART_receive(USART1, &data, 0) == pdTRUE);
+
+    TEXTLINE_text("Esperando ", 0);
+    TEXTLINE_uint(PERFSUITE_RX_BYTES, 0);
+    TEXTLINE_text(" bytes por USART1", 0);
+    TEXTLINE_end();
+
+    TickType_t start = xTaskGetTickCount();
+    while (!usart_get_flag(USART1, USART_SR_RXNE)) {
+        if (xTaskGetTickCount() - start > pdMS_TO_TICKS(PERFSUITE_RX_WAIT_MS)) return 0;
+        vTaskDelay(1);
+    }
+    // Que termine de llegar el resto
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    taskENTER_CRITICAL();
+    uint32_t t0 = DWT_CYCCNT;
+    usart1_isr();
+    uint32_t cycles = DWT_CYCCNT - t0;
+    taskEXIT_CRITICAL();
+
+    uint32_t received = 0;
+    while (UART_receive(USART1, &data, 0) == pdTRUE) received++;
+    return received > 0 ? cycles / received : 0;
+}
+
+static uint32_t measure_telemetry(void) {
+    uint32_t best = UINT32_MAX;
+    for (uint8_t round = 0; round < PERFSUITE_ROUNDS; round++) {
+        uint32_t t0 = DWT_CYCCNT;
+        SUPERVISOR_publish();
+        uint32_t cycles = DWT_CYCCNT - t0;
+        drain_stream(MANIFEST_DOWNLINK_HK);
+        if (cycles < best) best = cycles;
+    }
+    return best;
+}
+
+static uint32_t measure_nmea(void) {
+    uint32_t best = UINT32_MAX;
+    for (uint8_t round = 0; round < PERFSUITE_ROUNDS; round++) {
+        nmea_framer_t framer = { 0 };
+        uint32_t t0 = DWT_CYCCNT;
+        for (const char *c = gga; *c; c++) NMEA_feed(&framer, (uint8_t)*c);
+        uint32_t cycles = DWT_CYCCNT - t0;
+        drain_stream(MANIFEST_DOWNLINK_GPS);
+        if (cycles < best) best = cycles;
+    }
+    return best;
+}
+
+// Se despierta por ronda y devuelve cada taskYIELD() de la tarea que mide
+static void taskPerfPartner(void *args __attribute__((unused))) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (uint32_t i = 0; i < PERFSUITE_SWITCHES; i++) taskYIELD();
+    }
+}
+
+static uint32_t measure_switch(void) {
+    uint32_t best = UINT32_MAX;
+    for (uint8_t round = 0; round < PERFSUITE_ROUNDS; round++) {
+        // Recién pasado un tick, y con la otra tarea de vuelta esperando la notificación
+        vTaskDelay(1);
+        xTaskNotifyGive(partner);
+        uint32_t t0 = DWT_CYCCNT;
+        for (uint32_t i = 0; i < PERFSUITE_SWITCHES; i++) taskYIELD();
+        uint32_t cycles = DWT_CYCCNT - t0;
+        // Dos cambios por cada taskYIELD() de esta tarea
+        cycles /= 2 * PERFSUITE_SWITCHES;
+        if (cycles < best) best = cycles;
+    }
+    return best;
+}
+
+static void taskPerfSuite(void *args __attribute__((unused))) {
+    if (!(DWT_CTRL & DWT_CTRL_CYCCNTENA)) dwt_enable_cycle_counter();
+    // La ISR se llama a mano: los bytes esperan en la USART
+    nvic_disable_irq(NVIC_USART1_IRQ);
+
+    TEXTLINE_text("Rendimiento en ciclos, mejor de ", 0);
+    TEXTLINE_uint(PERFSUITE_ROUNDS, 0);
+    TEXTLINE_text(" rondas", 0);
+    TEXTLINE_end();
+
+    uint32_t isr = measure_uart_isr();
+    uint32_t telemetry = measure_telemetry();
+    uint32_t nmea = measure_nmea();
+    uint32_t context_switch = measure_switch();
+
+    if (isr > 0) {
+        put_result("isr_uart_byte", isr);
+    } else {
+        TEXTLINE_text("isr_uart_byte", 20);
+        TEXTLINE_dash(10);
+        TEXTLINE_end();
+    }
+    put_result("paquete_telemetria", telemetry);
+    put_result("sentencia_nmea", nmea);
+    put_result("cambio_contexto", context_switch);
+
+    TEXTLINE_text(isr > 0 ? "OK" : "FALLÓ", 0);
+    TEXTLINE_end();
+    vTaskSuspend(NULL);
+}
+
+BaseType_t PERFSUITE_start(textline_print_t print) {
+    TEXTLINE_setup(print);
+
+    partner = xTaskCreateStatic(taskPerfPartner, "PerfPartner", configMINIMAL_STACK_SIZE, NULL,
+                                PERFSUITE_PRIORITY, partner_stack, &partner_tcb);
+    if (partner == NULL) return pdFAIL;
+    return xTaskCreateStatic(taskPerfSuite, "PerfSuite", PERFSUITE_STACK_DEPTH, NULL, PERFSUITE_PRIORITY,
+                             suite_stack, &suite_tcb) != NULL ? pdPASS : pdFAIL;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef PERFSUITE_H
+#define PERFSUITE_H
+
+#include "FreeRTOS.h"
+#include "textline.h"
+#include <stdint.h>
+
+// Suite de regresión de rendimiento (compilando con PERFSUITE=1): ciclos de CYCCNT de un
+// conjunto fijo de caminos calientes, para comparar cada build contra una referencia con
+// tools/perf_compare.py. En Renode (../renode) CYCCNT cuenta instrucciones y la corrida
+// es determinista: cualquier diferencia es del código. Los caminos:
+//  - isr_uart_byte: la ISR de USART1 por byte recibido. Se llama con las interrupciones
+//    del kernel enmascaradas después de que llegan PERFSUITE_RX_BYTES bytes por RX; en
+//    Renode la USART los guarda todos y la ISR los saca en una llamada, en el hardware DR
+//    guarda uno solo y es el costo completo de la ISR con un byte
+//  - paquete_telemetria: armar un paquete de housekeeping y encolarlo en el enlace de
+//    bajada (SUPERVISOR_publish())
+//  - sentencia_nmea: una sentencia GGA byte a byte por NMEA_feed() hasta el stream del GPS
+//  - cambio_contexto: dos tareas de igual prioridad que se ceden la CPU con taskYIELD()
+//
+// Cada camino se mide PERFSUITE_ROUNDS veces y se informa la mejor (sin ticks en el
+// medio), salvo la ISR que consume los bytes en la primera. Los resultados salen como
+// texto por la UART del enlace de bajada, una línea por camino, y al final OK, o FALLÓ si
+// no llegaron los bytes de RX en PERFSUITE_RX_WAIT_MS.
+
+#define PERFSUITE_RX_BYTES      64
+#define PERFSUITE_RX_WAIT_MS    10000
+#define PERFSUITE_ROUNDS        8
+#define PERFSUITE_SWITCHES      64      // taskYIELD() por ronda de cada tarea
+#define PERFSUITE_PRIORITY      2
+
+// Crea las tareas de la suite. Va antes de arrancar el scheduler, después de
+// MANIFEST_setup(), PBUF_setup(), DOWNLINK_setup() y UART_setup() de USART1
+BaseType_t PERFSUITE_start(textline_print_t print);
+
+#endif
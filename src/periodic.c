@@ -0,0 +1,125 @@
+#include "periodic.h"
+#include "downlink.h"
+#include "cycles.h"
+#include "name.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define CYCLES_PER_TICK (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+
+typedef struct {
+    periodic_t *const *tasks;
+    uint8_t count;
+    TickType_t tick;                // Último tick que pasó por el hook
+    uint32_t tick_cycles;           // CYCCNT en ese tick
+} periodic_state_t;
+
+static periodic_state_t periodic;
+
+_Static_assert(sizeof(periodic_packet_t) <= DOWNLINK_MAX_FRAME, "El paquete de tareas periódicas no entra en una trama");
+
+void PERIODIC_setup(periodic_t *const *tasks, uint8_t count) {
+    periodic.tasks = tasks;
+    periodic.count = count;
+
+    // El rango de una tarea es la cantidad de períodos distintos más cortos que el suyo
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t rank = 0;
+        for (uint8_t j = 0; j < count; j++) {
+            if (tasks[j]->period >= tasks[i]->period) continue;
+            uint8_t repeated = 0;
+            for (uint8_t k = 0; k < j; k++)
+                if (tasks[k]->period == tasks[j]->period) repeated = 1;
+            rank += !repeated;
+        }
+        tasks[i]->priority = rank < PERIODIC_PRIORITY_HIGH - PERIODIC_PRIORITY_LOW
+                           ? PERIODIC_PRIORITY_HIGH - rank : PERIODIC_PRIORITY_LOW;
+    }
+}
+
+void vApplicationTickHook(void) {
+    periodic.tick = xTaskGetTickCountFromISR();
+    periodic.tick_cycles = DWT_CYCCNT;
+}
+
+// Ciclos desde el tick release. Si el tick actual no pasó por el hook (ticks salteados en
+// el tickless idle) queda la resolución del tick. Satura en UINT32_MAX
+static uint32_t since_release(TickType_t release) {
+    taskENTER_CRITICAL();
+    TickType_t now = xTaskGetTickCount();
+    uint32_t cycles = DWT_CYCCNT - periodic.tick_cycles;
+    uint8_t hooked = periodic.tick == now;
+    taskEXIT_CRITICAL();
+
+    uint64_t total = (uint64_t)(TickType_t)(now - release) * CYCLES_PER_TICK + (hooked ? cycles : 0);
+    return total < UINT32_MAX ? (uint32_t)total : UINT32_MAX;
+}
+
+void PERIODIC_wait(periodic_t *task) {
+    if (!task->started) {
+        task->started = 1;
+        task->release = xTaskGetTickCount();
+        task->alive = SUPERVISOR_self();
+    } else {
+        uint32_t response = since_release(task->release);
+        taskENTER_CRITICAL();
+        task->releases++;
+        task->response_sum += response;
+        if (response > task->response_max) task->response_max = response;
+        if (response > (uint64_t)task->deadline * CYCLES_PER_TICK && task->misses != UINT16_MAX) task->misses++;
+        taskEXIT_CRITICAL();
+    }
+
+    SUPERVISOR_checkin(task->alive);
+
+    // Sin bloquear: la liberación siguiente ya pasó y el ciclo arranca atrasado
+    BaseType_t delayed = xTaskDelayUntil(&task->release, task->period);
+
+    uint32_t jitter = since_release(task->release);
+    taskENTER_CRITICAL();
+    if (delayed == pdFALSE && task->skipped != UINT16_MAX) task->skipped++;
+    if (jitter > task->jitter_max) task->jitter_max = jitter;
+    taskEXIT_CRITICAL();
+}
+
+static uint32_t to_us(uint32_t cycles) {
+    return cycles / CYCLES_PER_US;
+}
+
+void PERIODIC_publish(void) {
+    static periodic_packet_t packet;
+
+    packet.type = PERIODIC_PACKET_TYPE;
+    packet.page = 0;
+    packet.pages = (periodic.count + PERIODIC_TASKS_PER_PACKET - 1) / PERIODIC_TASKS_PER_PACKET;
+    packet.uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    packet.count = 0;
+
+    for (uint8_t i = 0; i < periodic.count; i++) {
+        periodic_t copy;
+        taskENTER_CRITICAL();
+        copy = *periodic.tasks[i];
+        taskEXIT_CRITICAL();
+
+        periodic_entry_t *entry = &packet.tasks[packet.count++];
+        NAME_copy(entry->name, copy.label, PERIODIC_NAME_LEN);
+        entry->priority = copy.priority;
+        entry->reserved = 0;
+        entry->period_ms = copy.period * portTICK_PERIOD_MS;
+        entry->deadline_ms = copy.deadline * portTICK_PERIOD_MS;
+        entry->misses = copy.misses;
+        entry->skipped = copy.skipped;
+        entry->releases = copy.releases;
+        entry->jitter_max_us = to_us(copy.jitter_max);
+        entry->response_mean_us = copy.releases ? to_us(copy.response_sum / copy.releases) : 0;
+        entry->response_max_us = to_us(copy.response_max);
+
+        if (packet.count == PERIODIC_TASKS_PER_PACKET || i + 1 == periodic.count) {
+            uint16_t len = offsetof(periodic_packet_t, tasks) + packet.count * sizeof(periodic_entry_t);
+            DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, len, 0);
+            packet.page++;
+            packet.count = 0;
+        }
+    }
+}
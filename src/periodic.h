@@ -0,0 +1,90 @@
+#ifndef PERIODIC_H
+#define PERIODIC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "supervisor.h"
+#include <stdint.h>
+
+// Tareas periódicas con prioridades rate-monotonic. Cada tarea declara en el manifiesto
+// (MANIFEST_PERIODIC en manifest.h) su período y su plazo; PERIODIC_setup() les asigna
+// prioridades dentro de la banda [PERIODIC_PRIORITY_LOW, PERIODIC_PRIORITY_HIGH]: a
+// menor período, mayor prioridad. Si hay más períodos distintos que niveles, los más
+// largos comparten el nivel más bajo.
+//
+// La tarea recibe su periodic_t como parámetro y termina cada ciclo con PERIODIC_wait(),
+// que la libera de nuevo con xTaskDelayUntil(): las liberaciones quedan fijas en
+// múltiplos del período y no se corren con el tiempo de ejecución. Por tarea se mide:
+//  - jitter de liberación: desde el tick en que se liberó hasta que volvió a correr
+//  - tiempo de respuesta: desde la liberación hasta que llamó a PERIODIC_wait()
+//  - plazos perdidos: respuestas mayores al plazo
+//  - liberaciones salteadas: el ciclo terminó después de la liberación siguiente
+// PERIODIC_wait() hace además el check-in de la tarea con el supervisor (supervisor.h).
+// Los paquetes salen por el stream de housekeeping desde la tarea de telemetría
+// (telemetry.h); tools/periodic_report.py los muestra.
+//
+// OBS: el jitter se mide en ciclos desde el tick de liberación (vApplicationTickHook). Con
+// LOW_POWER los ticks salteados en STOP no pasan por el hook y el DWT no cuenta: el jitter
+// de una liberación al salir de STOP queda con resolución de un tick.
+
+#define PERIODIC_PRIORITY_LOW     1
+#define PERIODIC_PRIORITY_HIGH    2
+#define PERIODIC_TASKS_PER_PACKET 3
+#define PERIODIC_NAME_LEN         8
+
+#define PERIODIC_PACKET_TYPE 0x50
+
+// Una tarea periódica. El manifiesto completa la configuración; el resto es del módulo
+typedef struct {
+    const char *label;
+    TickType_t period;
+    TickType_t deadline;
+    UBaseType_t priority;           // Asignada por PERIODIC_setup()
+
+    TickType_t release;             // Tick de la última liberación
+    uint8_t started;
+    uint32_t releases;
+    uint16_t misses;
+    uint16_t skipped;
+    uint32_t jitter_max;            // En ciclos
+    uint32_t response_max;
+    uint64_t response_sum;
+    supervisor_slot_t *alive;       // Ranura del supervisor, tomada en el primer ciclo
+} periodic_t;
+
+// Entrada de una tarea, tiempos en µs
+typedef struct __attribute__((packed)) {
+    char name[PERIODIC_NAME_LEN];   // Truncado, sin terminador si ocupa todo
+    uint8_t priority;
+    uint8_t reserved;
+    uint16_t period_ms;
+    uint16_t deadline_ms;
+    uint16_t misses;                // Saturan en 0xFFFF
+    uint16_t skipped;
+    uint32_t releases;              // Ciclos medidos
+    uint32_t jitter_max_us;
+    uint32_t response_mean_us;
+    uint32_t response_max_us;
+} periodic_entry_t;
+
+// Paquete de telemetría, partido en páginas como el de cpustats.h
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // PERIODIC_PACKET_TYPE
+    uint8_t page;
+    uint8_t pages;
+    uint8_t count;                  // Entradas en este paquete
+    uint32_t uptime_ms;
+    periodic_entry_t tasks[PERIODIC_TASKS_PER_PACKET];
+} periodic_packet_t;
+
+// Asigna las prioridades de las tareas del manifiesto. Va antes de crearlas
+void PERIODIC_setup(periodic_t *const *tasks, uint8_t count);
+
+// Fin del ciclo: registra el tiempo de respuesta y bloquea hasta la próxima liberación.
+// El primer llamado solo fija la primera liberación
+void PERIODIC_wait(periodic_t *task);
+
+// Publica un paquete por cada PERIODIC_TASKS_PER_PACKET tareas
+void PERIODIC_publish(void);
+
+#endif
@@ -0,0 +1,274 @@
+#include "FreeRTOS.h"
+#include "pilink.h"
+#include "i2c.h"
+#include "downlink.h"
+#include "cycles.h"
+#include "latency.h"
+#include "trace.h"
+#include "manifest.h"
+#include "supervisor.h"
+#include "semphr.h"
+#include <stddef.h>
+#include <string.h>
+
+#define PILINK_PERIOD_MS 100             // Período de refresco del snapshot
+#define PILINK_BANKS 3
+#define NO_BANK 0xFF
+#define PILINK_DMA_IRQ_PRIORITY 0xC0     // Misma prioridad que las interrupciones de I2C
+
+_Static_assert(offsetof(pilink_status_t, cmd_ack) == offsetof(pilink_status_t, cmd_result) + 1,
+               "cmd_result y cmd_ack se publican juntos");
+
+// Triple buffer: el master lee el banco publicado mientras la tarea arma el siguiente
+// en un banco que no está publicado ni siendo leído por el DMA
+static uint8_t banks[PILINK_BANKS][PILINK_MAP_SIZE];
+static volatile uint8_t active_bank;        // Banco publicado
+static volatile uint8_t tx_bank = NO_BANK;  // Banco que está transmitiendo el DMA
+static volatile uint8_t dma_active;
+
+static uint8_t pointer;       // Puntero de registro escrito por el master
+static uint8_t cursor;        // Posición de escritura dentro de la transacción en curso
+static uint8_t rx_count;      // Bytes recibidos en la transacción en curso
+static uint8_t mailbox[sizeof(pilink_command_t)];
+static uint8_t mailbox_dirty;
+
+static QueueHandle_t cmdq;
+static SemaphoreHandle_t mutex;
+
+// Prototipos de funciones
+static void pilink_event(uint32_t i2c);
+static void pilink_error(uint32_t i2c);
+
+static const i2c_slave_handlers_t pilink_handlers = {
+    .event = pilink_event,
+    .error = pilink_error,
+};
+
+BaseType_t PILINK_setup(void) {
+    cmdq = MANIFEST_queue(MANIFEST_PILINK_CMDQ);
+    mutex = MANIFEST_queue(MANIFEST_PILINK_MUTEX);
+    if (cmdq == NULL || mutex == NULL) return pdFAIL;
+    vQueueAddToRegistry(cmdq, "PiLink cmd");
+
+    pilink_status_t status = { .magic = PILINK_MAGIC, .version = PILINK_VERSION };
+    memcpy(&banks[0][PILINK_REG_STATUS], &status, sizeof(status));
+    active_bank = 0;
+
+    // Canal DMA de transmisión: memoria -> I2C1_DR, de a un byte
+    rcc_periph_clock_enable(RCC_DMA1);
+    dma_channel_reset(DMA1, PILINK_DMA_CHANNEL);
+    dma_set_peripheral_address(DMA1, PILINK_DMA_CHANNEL, (uint32_t)&I2C_DR(PILINK_I2C));
+    dma_set_read_from_memory(DMA1, PILINK_DMA_CHANNEL);
+    dma_enable_memory_increment_mode(DMA1, PILINK_DMA_CHANNEL);
+    dma_set_peripheral_size(DMA1, PILINK_DMA_CHANNEL, DMA_CCR_PSIZE_8BIT);
+    dma_set_memory_size(DMA1, PILINK_DMA_CHANNEL, DMA_CCR_MSIZE_8BIT);
+    dma_set_priority(DMA1, PILINK_DMA_CHANNEL, DMA_CCR_PL_HIGH);
+    dma_enable_transfer_complete_interrupt(DMA1, PILINK_DMA_CHANNEL);
+
+    nvic_set_priority(NVIC_DMA1_CHANNEL6_IRQ, PILINK_DMA_IRQ_PRIORITY);
+    nvic_enable_irq(NVIC_DMA1_CHANNEL6_IRQ);
+
+    return I2C_setup_slave(PILINK_I2C, PILINK_ADDRESS, &pilink_handlers);
+}
+
+BaseType_t PILINK_write(uint8_t offset, const void *data, uint8_t len) {
+    if ((uint16_t)offset + len > PILINK_MAP_SIZE) return pdFAIL;
+    if (xSemaphoreTake(mutex, portMAX_DELAY) != pdTRUE) return pdFAIL;
+
+    taskENTER_CRITICAL();
+    uint8_t current = active_bank;
+    uint8_t busy = tx_bank;
+    taskEXIT_CRITICAL();
+
+    uint8_t next = 0;
+    while (next == current || next == busy) next++;
+
+    // Se parte del banco publicado para no perder el resto del mapa
+    memcpy(banks[next], banks[current], PILINK_MAP_SIZE);
+    memcpy(&banks[next][offset], data, len);
+
+    pilink_status_t *status = (pilink_status_t *)&banks[next][PILINK_REG_STATUS];
+    status->seq++;
+
+    // Publicar: la ISR toma el banco activo al comenzar cada lectura
+    active_bank = next;
+
+    xSemaphoreGive(mutex);
+    return pdPASS;
+}
+
+// Atiende un comando del buzón y deja el resultado en el bloque de estado
+static void pilink_handle_command(const pilink_command_t *cmd) {
+    // Resultado y secuencia contiguos (cmd_result, cmd_ack): se publican en la misma escritura
+    uint8_t ack[2] = { PILINK_RESULT_OK, cmd->seq };
+
+    switch (cmd->id) {
+        case PILINK_CMD_PING:
+            break;
+        case PILINK_CMD_LATENCY_RESET:
+            LATENCY_reset();
+            break;
+#ifdef TRACE_ENABLED
+        case PILINK_CMD_TRACE_DUMP:
+            if (TRACE_request_dump() != pdPASS) ack[0] = PILINK_RESULT_FAIL;
+            break;
+#endif
+        default:
+            ack[0] = PILINK_RESULT_UNKNOWN;
+            break;
+    }
+
+    PILINK_write(PILINK_REG_STATUS + offsetof(pilink_status_t, cmd_result), ack, sizeof(ack));
+}
+
+void taskPilink(void *args __attribute__((unused))) {
+    supervisor_slot_t *alive = SUPERVISOR_self();
+    pilink_telemetry_t telemetry;
+    pilink_command_t cmd;
+    TickType_t last_refresh = xTaskGetTickCount();
+
+    memset(&telemetry, 0, sizeof(telemetry));
+    for (;;) {
+        SUPERVISOR_checkin(alive);
+        TickType_t elapsed = xTaskGetTickCount() - last_refresh;
+        TickType_t wait = elapsed < pdMS_TO_TICKS(PILINK_PERIOD_MS) ? pdMS_TO_TICKS(PILINK_PERIOD_MS) - elapsed : 0;
+
+        if (xQueueReceive(cmdq, &cmd, wait) == pdPASS) {
+            LATENCY_task_wake(LATENCY_I2C1);
+            pilink_handle_command(&cmd);
+            continue;
+        }
+
+        // Refrescar el snapshot de telemetría
+        last_refresh = xTaskGetTickCount();
+        telemetry.uptime_ms = last_refresh * portTICK_PERIOD_MS;
+        for (uint8_t i = 0; i < DOWNLINK_STREAM_COUNT; i++) {
+            downlink_counters_t counters;
+            DOWNLINK_get_counters(i, &counters);
+            telemetry.downlink_queued[i] = counters.queued;
+            telemetry.downlink_sent[i] = counters.sent;
+            telemetry.downlink_dropped[i] = counters.dropped;
+        }
+        pbuf_stats_t pool;
+        PBUF_get_stats(&pool);
+        telemetry.pbuf_free = pool.free;
+        telemetry.pbuf_min_free = pool.min_free;
+        telemetry.pbuf_exhausted = pool.exhausted > UINT16_MAX ? UINT16_MAX : (uint16_t)pool.exhausted;
+        PILINK_write(PILINK_REG_TELEMETRY, &telemetry, sizeof(telemetry));
+    }
+}
+
+// Lectura del master: el DMA transmite desde el puntero hasta el final del mapa
+static void pilink_start_tx(uint32_t i2c) {
+    if (pointer >= PILINK_MAP_SIZE) {
+        // Fuera del mapa: se responde 0xFF con TxE
+        I2C_CR2(i2c) |= I2C_CR2_ITBUFEN;
+        return;
+    }
+
+    uint8_t bank = active_bank;
+    tx_bank = bank;
+
+    dma_disable_channel(DMA1, PILINK_DMA_CHANNEL);
+    dma_set_memory_address(DMA1, PILINK_DMA_CHANNEL, (uint32_t)&banks[bank][pointer]);
+    dma_set_number_of_data(DMA1, PILINK_DMA_CHANNEL, PILINK_MAP_SIZE - pointer);
+    dma_enable_channel(DMA1, PILINK_DMA_CHANNEL);
+
+    dma_active = 1;
+    I2C_CR2(i2c) &= ~I2C_CR2_ITBUFEN;
+    I2C_CR2(i2c) |= I2C_CR2_DMAEN;
+}
+
+static void pilink_stop_tx(uint32_t i2c) {
+    dma_disable_channel(DMA1, PILINK_DMA_CHANNEL);
+    I2C_CR2(i2c) &= ~I2C_CR2_DMAEN;
+    I2C_CR2(i2c) |= I2C_CR2_ITBUFEN;
+    dma_active = 0;
+    tx_bank = NO_BANK;
+}
+
+// Escritura del master terminada: si tocó el buzón se encola el comando
+static void pilink_commit_command(void) {
+    if (!mailbox_dirty) return;
+    mailbox_dirty = 0;
+
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendToBackFromISR(cmdq, mailbox, &woken) == pdTRUE) LATENCY_isr_signal(LATENCY_I2C1);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void pilink_event(uint32_t i2c) {
+    uint32_t sr1 = I2C_SR1(i2c);
+
+    // Dirección reconocida. ADDR se limpia leyendo SR1 y luego SR2
+    if (sr1 & I2C_SR1_ADDR) {
+        uint32_t sr2 = I2C_SR2(i2c);
+        if (sr2 & I2C_SR2_TRA) {
+            pilink_start_tx(i2c);
+        } else {
+            rx_count = 0;
+            I2C_CR2(i2c) |= I2C_CR2_ITBUFEN;
+        }
+        return;
+    }
+
+    if (sr1 & I2C_SR1_RxNE) {
+        uint8_t data = I2C_DR(i2c);
+        if (rx_count++ == 0) {
+            // El primer byte de cada escritura es el puntero de registro
+            pointer = data;
+            cursor = data;
+        } else {
+            // Solo el buzón de comandos es escribible
+            if (cursor >= PILINK_REG_COMMAND && cursor < PILINK_MAP_SIZE) {
+                mailbox[cursor - PILINK_REG_COMMAND] = data;
+                mailbox_dirty = 1;
+            }
+            cursor++;
+        }
+    }
+
+    // STOP: se limpia leyendo SR1 (ya hecho) y escribiendo CR1
+    if (sr1 & I2C_SR1_STOPF) {
+        I2C_CR1(i2c) |= I2C_CR1_PE;
+        pilink_commit_command();
+    }
+
+    // Lectura más allá del mapa o después de que el DMA terminó
+    if ((sr1 & I2C_SR1_TxE) && !dma_active)
+        I2C_DR(i2c) = 0xFF;
+}
+
+static void pilink_error(uint32_t i2c) {
+    uint32_t sr1 = I2C_SR1(i2c);
+
+    // Los flags de error se limpian escribiendo cero
+    I2C_SR1(i2c) = sr1 & ~(I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR | I2C_SR1_OVR |
+                           I2C_SR1_PECERR | I2C_SR1_TIMEOUT);
+
+    if (!(sr1 & I2C_SR1_AF)) {
+        // Error de bus: se descarta la escritura parcial
+        mailbox_dirty = 0;
+        rx_count = 0;
+    }
+
+    // El NACK del master marca el fin de su lectura. El DMA ya cargó en DR el byte
+    // siguiente: se reinicia el periférico para que no salga al comienzo de la próxima
+    pilink_stop_tx(i2c);
+    I2C_CR1(i2c) &= ~I2C_CR1_PE;
+    I2C_CR1(i2c) |= I2C_CR1_PE;
+    I2C_CR1(i2c) |= I2C_CR1_ACK;
+}
+
+// Fin del mapa: lo que siga leyendo el master se responde con 0xFF
+void dma1_channel6_isr(void) {
+    CYCLES_isr_enter();
+    if (dma_get_interrupt_flag(DMA1, PILINK_DMA_CHANNEL, DMA_TCIF)) {
+        dma_clear_interrupt_flags(DMA1, PILINK_DMA_CHANNEL, DMA_TCIF);
+        dma_disable_channel(DMA1, PILINK_DMA_CHANNEL);
+        I2C_CR2(PILINK_I2C) &= ~I2C_CR2_DMAEN;
+        dma_active = 0;
+        I2C_CR2(PILINK_I2C) |= I2C_CR2_ITBUFEN;
+    }
+    CYCLES_isr_exit();
+}
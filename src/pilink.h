@@ -0,0 +1,79 @@
+#ifndef PILINK_H
+#define PILINK_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+#include <libopencm3/stm32/i2c.h>
+#include <libopencm3/stm32/dma.h>
+
+// Enlace con la Raspberry Pi: el STM32 es esclavo I2C en I2C1 (PB6 SCL, PB7 SDA) y expone
+// un mapa de registros. El master escribe primero el puntero de registro; las lecturas
+// siguientes avanzan solas desde ese puntero (auto-incremento) y el puntero no se mueve,
+// así una misma lectura en bloque se puede repetir sin volver a escribirlo.
+
+#define PILINK_ADDRESS 0x08
+#define PILINK_I2C I2C1
+#define PILINK_DMA_CHANNEL DMA_CHANNEL6  // I2C1_TX
+
+// Mapa de registros
+#define PILINK_REG_STATUS     0x00  // Estado (8 bytes)
+#define PILINK_REG_TELEMETRY  0x08  // Última telemetría (80 bytes)
+#define PILINK_REG_COMMAND    0x58  // Buzón de comandos (8 bytes, escribible)
+#define PILINK_MAP_SIZE       0x60
+
+#define PILINK_MAGIC   0xF5
+#define PILINK_VERSION 2
+
+// Bloque de estado
+typedef struct __attribute__((packed)) {
+    uint8_t magic;      // PILINK_MAGIC
+    uint8_t version;    // PILINK_VERSION
+    uint8_t flags;      // Reservado
+    uint8_t reserved;
+    uint16_t seq;       // Se incrementa con cada snapshot publicado
+    uint8_t cmd_result; // Resultado del último comando procesado
+    uint8_t cmd_ack;    // Secuencia del último comando procesado. Se publica junto con
+                        // cmd_result: cuando el master ve su secuencia el resultado es el suyo
+} pilink_status_t;
+
+// Snapshot de telemetría
+typedef struct __attribute__((packed)) {
+    uint32_t uptime_ms;
+    uint32_t downlink_queued[4];
+    uint32_t downlink_sent[4];
+    uint32_t downlink_dropped[4];
+    uint16_t pbuf_free;         // Bloques libres del pool de buffers de paquete
+    uint16_t pbuf_min_free;     // Mínimo de bloques libres desde el arranque
+    uint16_t pbuf_exhausted;    // Pedidos que fallaron por pool vacío (satura)
+    uint8_t reserved[22];
+} pilink_telemetry_t;
+
+// Comando escrito por el master en el buzón
+typedef struct __attribute__((packed)) {
+    uint8_t seq;       // Lo elige el master; se devuelve en cmd_ack
+    uint8_t id;
+    uint8_t args[6];
+} pilink_command_t;
+
+// Comandos
+#define PILINK_CMD_PING          0x01
+#define PILINK_CMD_TRACE_DUMP    0x02   // Vuelca la traza del kernel por USART2 (TRACE=1)
+#define PILINK_CMD_LATENCY_RESET 0x03   // Borra las mediciones de latencia (latency.h)
+
+// Resultados de comando
+#define PILINK_RESULT_OK      0x00
+#define PILINK_RESULT_FAIL    0x01
+#define PILINK_RESULT_UNKNOWN 0xFF
+
+// Configura I2C1 como esclavo, el canal DMA de transmisión y la cola de comandos
+BaseType_t PILINK_setup(void);
+
+// Tarea que refresca el snapshot y atiende los comandos del buzón
+void taskPilink(void *args __attribute__((unused)));
+
+// Publica len bytes en el mapa a partir de offset. El cambio es atómico para el master
+BaseType_t PILINK_write(uint8_t offset, const void *data, uint8_t len);
+
+#endif
@@ -0,0 +1,300 @@
+#include "power.h"
+#include "downlink.h"
+
+#include <libopencm3/stm32/rtc.h>
+#include <libopencm3/stm32/pwr.h>
+#include <libopencm3/stm32/exti.h>
+#include <libopencm3/cm3/nvic.h>
+#include <libopencm3/stm32/dma.h>
+#include <libopencm3/stm32/usart.h>
+#include <libopencm3/stm32/i2c.h>
+#include <libopencm3/stm32/spi.h>
+#include <libopencm3/cm3/scb.h>
+#include <libopencm3/cm3/systick.h>
+#include <libopencm3/cm3/cortex.h>
+
+#define POWER_RTC_PRESCALER 1        // LSE / 2 = 16384 Hz (RM0008 desaconseja PRL = 0)
+#define POWER_RTC_HZ        16384
+#define POWER_SYSTICK_HZ    configSYSTICK_CLOCK_HZ
+#define POWER_TICK_COUNTS   (configSYSTICK_CLOCK_HZ / configTICK_RATE_HZ)
+#define POWER_LSE_TIMEOUT   10000000 // Iteraciones esperando el LSE (~1 s)
+#define POWER_WAKE_MARGIN   50       // Cuentas del RTC (~3 ms) antes de medir la primera latencia
+#define POWER_MIN_ALARM     4        // Cuentas mínimas hasta la alarma (la escritura tarda 3)
+
+typedef struct {
+    uint8_t enabled;
+    uint16_t wakeup_lines;           // Líneas EXTI de los pines de wakeup
+    uint8_t slave_dma;               // Canales DMA de I2C esclavos (bit por canal)
+    uint32_t wake_margin;            // Cuentas del RTC que se adelanta la alarma
+    uint32_t wake_latency_max;       // En cuentas del RTC
+    uint32_t residue;                // Resto de pasar cuentas del RTC a cuentas del SysTick
+    uint64_t stop_counts;
+    TickType_t late_ticks;           // Ticks dormidos de más, se recuperan en el idle hook
+    power_stats_t stats;
+} power_t;
+
+static power_t power = {
+    .wake_margin = POWER_WAKE_MARGIN,
+};
+
+BaseType_t POWER_setup(void) {
+    rcc_periph_clock_enable(RCC_PWR);
+    rcc_periph_clock_enable(RCC_BKP);
+    // Para elegir el puerto de las líneas EXTI de los pines de wakeup (AFIO_EXTICR)
+    rcc_periph_clock_enable(RCC_AFIO);
+    pwr_disable_backup_domain_write_protect();
+
+    // rtc_auto_awake() espera al LSE sin límite: se arranca antes con timeout
+    rcc_osc_on(RCC_LSE);
+    uint32_t timeout = POWER_LSE_TIMEOUT;
+    while (!rcc_is_osc_ready(RCC_LSE))
+        if (--timeout == 0) return pdFAIL;
+
+    // El RTC puede venir configurado de antes del reset (dominio de backup): se fuerza el prescaler
+    rtc_auto_awake(RCC_LSE, POWER_RTC_PRESCALER);
+    rtc_set_prescale_val(POWER_RTC_PRESCALER);
+    rtc_interrupt_enable(RTC_ALR);
+
+    exti_set_trigger(EXTI17, EXTI_TRIGGER_RISING);
+
+    power.enabled = 1;
+    return pdPASS;
+}
+
+void POWER_add_wakeup_pin(uint32_t gpioport, uint16_t gpio) {
+    exti_select_source(gpio, gpioport);
+    exti_set_trigger(gpio, EXTI_TRIGGER_FALLING);
+    power.wakeup_lines |= gpio;
+}
+
+void POWER_add_i2c_slave(uint8_t dma_channel, uint32_t sda_port, uint16_t sda) {
+    POWER_add_wakeup_pin(sda_port, sda);
+    power.slave_dma |= 1 << dma_channel;
+}
+
+void POWER_get_stats(power_stats_t *stats) {
+    taskENTER_CRITICAL();
+    *stats = power.stats;
+    stats->stop_ms = (uint32_t)(power.stop_counts * 1000 / POWER_RTC_HZ);
+    taskEXIT_CRITICAL();
+}
+
+void POWER_publish(void) {
+    power_stats_t stats;
+    POWER_get_stats(&stats);
+    power_packet_t packet = {
+        .type = POWER_PACKET_TYPE,
+        .enabled = power.enabled,
+        .uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS,
+        .stats = stats,
+    };
+    DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, sizeof(packet), 0);
+}
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+// El contador se lee en dos mitades: se repite si la parte alta cambió en el medio
+static uint32_t rtc_read(void) {
+    uint16_t high, low;
+    do {
+        high = RTC_CNTH;
+        low = RTC_CNTL;
+    } while (high != RTC_CNTH);
+    return ((uint32_t)high << 16) | low;
+}
+
+// Espera el próximo incremento del contador y lo devuelve
+static uint32_t rtc_wait_edge(void) {
+    uint32_t start = rtc_read();
+    uint32_t now;
+    while ((now = rtc_read()) == start);
+    return now;
+}
+
+// Después de STOP la interfaz APB1 del RTC estuvo sin reloj: hay que resincronizarla
+static void rtc_sync(void) {
+    RTC_CRL &= ~RTC_CRL_RSF;
+    while (!(RTC_CRL & RTC_CRL_RSF));
+}
+
+static uint8_t exti_irq(uint8_t line) {
+    if (line <= 4) return NVIC_EXTI0_IRQ + line;
+    if (line <= 9) return NVIC_EXTI9_5_IRQ;
+    return NVIC_EXTI15_10_IRQ;
+}
+
+// Solo habilitadas mientras dura el STOP, con las interrupciones deshabilitadas: despiertan
+// al WFI pero nunca llegan a ejecutar una ISR
+static void wakeup_sources_enable(void) {
+    exti_reset_request(EXTI17 | power.wakeup_lines);
+    exti_enable_request(EXTI17 | power.wakeup_lines);
+    nvic_enable_irq(NVIC_RTC_ALARM_IRQ);
+    for (uint8_t line = 0; line < 16; line++)
+        if (power.wakeup_lines & (1 << line)) nvic_enable_irq(exti_irq(line));
+}
+
+static void wakeup_sources_disable(void) {
+    exti_disable_request(EXTI17 | power.wakeup_lines);
+    exti_reset_request(EXTI17 | power.wakeup_lines);
+    nvic_disable_irq(NVIC_RTC_ALARM_IRQ);
+    nvic_clear_pending_irq(NVIC_RTC_ALARM_IRQ);
+    for (uint8_t line = 0; line < 16; line++) {
+        if (power.wakeup_lines & (1 << line)) {
+            nvic_disable_irq(exti_irq(line));
+            nvic_clear_pending_irq(exti_irq(line));
+        }
+    }
+}
+
+// Periféricos que pierden datos si se les corta el reloj
+static uint8_t peripherals_busy(void) {
+    static const uint32_t usarts[] = { USART1, USART2, USART3 };
+    static const uint32_t i2cs[] = { I2C1, I2C2 };
+    static const uint32_t spis[] = { SPI1, SPI2 };
+
+    // Transferencias por DMA en curso. Los canales de los esclavos I2C quedan habilitados
+    // esperando al master: solo mueven datos con el bus ocupado, que se revisa abajo
+    for (uint8_t channel = DMA_CHANNEL1; channel <= DMA_CHANNEL7; channel++) {
+        if (power.slave_dma & (1 << channel)) continue;
+        if ((DMA_CCR(DMA1, channel) & DMA_CCR_EN) && DMA_CNDTR(DMA1, channel) != 0) return 1;
+    }
+
+    // El último byte de un USART todavía saliendo
+    for (uint8_t i = 0; i < sizeof(usarts) / sizeof(usarts[0]); i++)
+        if ((USART_CR1(usarts[i]) & USART_CR1_UE) && !(USART_SR(usarts[i]) & USART_SR_TC)) return 1;
+
+    // Transacción en el bus. Un esclavo esperando al master no impide el STOP: lo despierta
+    // el START por el pin de SDA
+    for (uint8_t i = 0; i < sizeof(i2cs) / sizeof(i2cs[0]); i++)
+        if ((I2C_CR1(i2cs[i]) & I2C_CR1_PE) && (I2C_SR2(i2cs[i]) & I2C_SR2_BUSY)) return 1;
+
+    for (uint8_t i = 0; i < sizeof(spis) / sizeof(spis[0]); i++)
+        if ((SPI_CR1(spis[i]) & SPI_CR1_SPE) && (SPI_SR(spis[i]) & SPI_SR_BSY)) return 1;
+
+    return 0;
+}
+
+// Sleep común: el tick sigue andando y despierta al core en el próximo período
+static void sleep_until_interrupt(void) {
+    cm_disable_interrupts();
+    if (eTaskConfirmSleepModeStatus() != eAbortSleep) {
+        __asm volatile("dsb");
+        __asm volatile("wfi");
+        __asm volatile("isb");
+    }
+    cm_enable_interrupts();
+}
+
+// Reemplaza al SysTick mientras el core está en STOP (configUSE_TICKLESS_IDLE = 2). Corre
+// en la tarea idle con el planificador suspendido
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+    if (!power.enabled || xExpectedIdleTime < POWER_MIN_STOP_TICKS || peripherals_busy()) {
+        sleep_until_interrupt();
+        return;
+    }
+    if (xExpectedIdleTime > POWER_MAX_STOP_TICKS) xExpectedIdleTime = POWER_MAX_STOP_TICKS;
+
+    cm_disable_interrupts();
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        cm_enable_interrupts();
+        return;
+    }
+
+    // El SysTick se detiene justo en un flanco del RTC: el tiempo dormido se mide de flanco
+    // a flanco, sin el error de cuantización de las cuentas del RTC
+    (void)systick_get_countflag();
+    uint32_t start = rtc_wait_edge();
+    systick_counter_disable();
+    if (systick_get_countflag() || (SCB_ICSR & SCB_ICSR_PENDSTSET)) {
+        // Venció un tick mientras se esperaba el flanco: se atiende y se reintenta
+        systick_counter_enable();
+        cm_enable_interrupts();
+        return;
+    }
+    uint32_t elapsed = STK_RVR - STK_CVR;   // Cuentas del SysTick del tick en curso
+
+    // La alarma se adelanta lo que tarda en volver el reloj para no pasarse del tick
+    // en que se despierta una tarea
+    uint64_t until = (uint64_t)xExpectedIdleTime * POWER_TICK_COUNTS - elapsed;
+    uint32_t counts = (uint32_t)(until * POWER_RTC_HZ / POWER_SYSTICK_HZ);
+    if (counts < power.wake_margin + POWER_MIN_ALARM) {
+        systick_counter_enable();
+        cm_enable_interrupts();
+        return;
+    }
+    uint32_t alarm = start + counts - power.wake_margin;
+    rtc_clear_flag(RTC_ALR);
+    rtc_set_alarm_time(alarm);
+
+    wakeup_sources_enable();
+    PWR_CR &= ~PWR_CR_PDDS;
+    PWR_CR |= PWR_CR_LPDS | PWR_CR_CWUF;
+    SCB_SCR |= SCB_SCR_SLEEPDEEP;
+    __asm volatile("dsb");
+    __asm volatile("wfi");
+    __asm volatile("isb");
+    SCB_SCR &= ~SCB_SCR_SLEEPDEEP;
+
+    // Al salir de STOP el sistema corre con el HSI
+    rcc_clock_setup_in_hse_8mhz_out_72mhz();
+
+    uint8_t by_alarm = (EXTI_PR & EXTI17) != 0;
+    wakeup_sources_disable();
+    rtc_clear_flag(RTC_ALR);
+    rtc_sync();
+    uint32_t wake = rtc_read();
+    uint32_t end = rtc_wait_edge();
+
+    // Cuentas del SysTick desde el último tick. El resto de la conversión pasa a la próxima
+    // vez para que el contador de ticks no derive respecto del RTC
+    uint64_t scaled = (uint64_t)(end - start) * POWER_SYSTICK_HZ + power.residue;
+    power.residue = (uint32_t)(scaled % POWER_RTC_HZ);
+    uint64_t cycles = scaled / POWER_RTC_HZ + elapsed;
+    TickType_t ticks = (TickType_t)(cycles / POWER_TICK_COUNTS);
+    uint32_t remaining = POWER_TICK_COUNTS - (uint32_t)(cycles % POWER_TICK_COUNTS);
+
+    // El primer período termina donde hubiera terminado el tick en curso; los siguientes
+    // vuelven a ser completos
+    if (remaining < 2) {
+        ticks++;
+        remaining = POWER_TICK_COUNTS;
+    }
+    STK_CVR = 0;
+    STK_RVR = remaining - 1;
+    systick_counter_enable();
+    STK_RVR = POWER_TICK_COUNTS - 1;
+
+    if (ticks > xExpectedIdleTime) {
+        power.late_ticks += ticks - xExpectedIdleTime;
+        ticks = xExpectedIdleTime;
+        power.stats.late_wakeups++;
+    }
+    vTaskStepTick(ticks);
+
+    power.stats.stops++;
+    power.stop_counts += end - start;
+    if (by_alarm) {
+        uint32_t latency = wake - alarm;
+        power.stats.wake_latency_us = latency * 1000000 / POWER_RTC_HZ;
+        if (latency > power.wake_latency_max) {
+            power.wake_latency_max = latency;
+            power.stats.wake_latency_max_us = power.stats.wake_latency_us;
+            power.wake_margin = latency + 2;
+        }
+    } else {
+        power.stats.early_wakeups++;
+    }
+
+    cm_enable_interrupts();
+}
+
+// Los ticks dormidos de más no se pueden sumar con el planificador suspendido
+void vApplicationIdleHook(void) {
+    if (power.late_ticks > 0) {
+        TickType_t late = power.late_ticks;
+        power.late_ticks = 0;
+        xTaskCatchUpTicks(late);
+    }
+}
+
+#endif
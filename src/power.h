@@ -0,0 +1,69 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/gpio.h>
+
+// Tickless idle con modo STOP (compilando con LOW_POWER=1). Cuando todas las tareas están
+// bloqueadas por al menos POWER_MIN_STOP_TICKS la tarea idle detiene el SysTick, programa
+// la alarma del RTC (LSE) y entra en STOP. Despierta con la alarma o con un flanco en un
+// pin de wakeup, vuelve al PLL de 72 MHz y adelanta el contador de ticks según el tiempo
+// medido con el RTC. Si la espera es más corta o hay un periférico ocupado solo se duerme
+// el core (WFI) con el tick andando.
+//
+// Las estadísticas salen por el stream de housekeeping desde la tarea de telemetría
+// (telemetry.h); tools/power_report.py las muestra.
+//
+// OBS: el RTC usa la alarma y la línea 17 del EXTI. Las líneas de los pines de wakeup y sus
+// IRQ del EXTI quedan reservadas para este módulo.
+
+#define POWER_MIN_STOP_TICKS 10      // Por debajo no compensa el arranque del HSE y el PLL
+#define POWER_MAX_STOP_TICKS 60000   // Se despierta al menos una vez por minuto
+
+#define POWER_PACKET_TYPE 0x45
+
+typedef struct {
+    uint32_t stops;                  // Entradas a modo STOP
+    uint32_t early_wakeups;          // Despertadas por un pin antes de la alarma
+    uint32_t late_wakeups;           // Despertadas después del tick esperado
+    uint32_t stop_ms;                // Tiempo total en STOP
+    uint32_t wake_latency_us;        // Última latencia desde la alarma hasta volver a 72 MHz
+    uint32_t wake_latency_max_us;
+} power_stats_t;
+
+// Paquete de telemetría, acumulado desde el arranque
+typedef struct __attribute__((packed)) {
+    uint8_t type;                    // POWER_PACKET_TYPE
+    uint8_t enabled;                 // 0 si el LSE no arrancó y solo se duerme el core
+    uint16_t reserved;
+    uint32_t uptime_ms;
+    power_stats_t stats;
+} power_packet_t;
+
+// Arranca el LSE y el RTC y habilita el modo STOP. Falla si el LSE no arranca
+BaseType_t POWER_setup(void);
+
+// Un flanco descendente en el pin despierta del modo STOP (RX de un USART, por ejemplo).
+// OBS: el byte que despierta se pierde, el USART no tiene reloj hasta volver a 72 MHz
+void POWER_add_wakeup_pin(uint32_t gpioport, uint16_t gpio);
+
+// I2C esclavo que debe seguir atendiendo al master: el START (flanco descendente en SDA)
+// despierta del modo STOP y el canal DMA del esclavo, habilitado a la espera del master,
+// no cuenta como transferencia en curso. Solo impide el STOP una transacción en el bus.
+// OBS: en STOP el I2C no tiene reloj y no reconoce la dirección de la transacción que lo
+// despierta: el master recibe NACK y tiene que reintentar
+void POWER_add_i2c_slave(uint8_t dma_channel, uint32_t sda_port, uint16_t sda);
+
+void POWER_get_stats(power_stats_t *stats);
+
+// Publica el paquete de telemetría (desde la tarea de telemetría, telemetry.h)
+void POWER_publish(void);
+
+// Hook de la tarea idle (configUSE_IDLE_HOOK con LOW_POWER)
+void vApplicationIdleHook(void);
+
+#endif
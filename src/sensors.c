@@ -0,0 +1,199 @@
+#include "FreeRTOS.h"
+#include "sensors.h"
+#include "i2c.h"
+#include <string.h>
+
+#define SENSORS_WINDOW_MS 1000    // Ventana de medición de la ocupación del bus
+#define SENSORS_QUEUE_WAIT_MS 10  // Espera máxima por lugar en la cola del bus
+
+// Barrera de compilador: en un único núcleo alcanza para ordenar datos y secuencia
+#define compiler_barrier() __asm__ volatile("" ::: "memory")
+
+// Tabla de sondeo. Las entradas del mismo dispositivo con registros contiguos que vencen
+// juntas se leen en una sola transacción (por ejemplo presión y temperatura del BMP280)
+static const sensor_poll_t sensors[SENSOR_COUNT] = {
+    [SENSOR_IMU]        = { "MPU6050 accel/gyro", 0x68, 0x3B, 14, 10 },
+    [SENSOR_MAG]        = { "HMC5883L",           0x1E, 0x03, 6,  20 },
+    [SENSOR_BARO_PRESS] = { "BMP280 presion",     0x76, 0xF7, 3,  100 },
+    [SENSOR_BARO_TEMP]  = { "BMP280 temperatura", 0x76, 0xFA, 3,  100 },
+};
+
+// Snapshot compartido. Cada sensor tiene dos copias: la tarea escribe la que no está
+// publicada y después incrementa seq, que indica la publicada. El lector copia sin
+// bloquear la copia publicada y solo reintenta si la tarea publicó durante la copia.
+// Si el lector interrumpe a la tarea a mitad de una escritura no hay reintento: la
+// copia a medio escribir nunca es la publicada
+typedef struct {
+    uint8_t data[SENSORS_MAX_READ];
+    TickType_t timestamp;
+} sensor_sample_t;
+
+typedef struct {
+    sensor_sample_t sample[2];
+    volatile uint32_t seq;        // La copia publicada es sample[seq & 1]
+    sensor_stats_t stats;
+    TickType_t next_due;
+} sensor_state_t;
+
+static sensor_state_t state[SENSOR_COUNT];
+static volatile uint16_t bus_utilization;
+
+// Lote en curso
+static i2c_transaction_t batch[SENSOR_COUNT];
+static uint8_t batch_txn[SENSOR_COUNT];   // Transacción que lee cada sensor vencido
+static uint8_t batch_rx[SENSOR_COUNT * SENSORS_MAX_READ];
+
+// Prototipos de funciones
+static uint32_t sensors_build_batch(TickType_t now, uint8_t *due, uint8_t *txn_count);
+static void sensors_publish(sensor_id_t id, const uint8_t *data, TickType_t timestamp);
+
+// Bits en el cable de una transacción: dirección, datos y ACKs (9 bits por byte) más
+// START, START repetido y STOP. No incluye el estiramiento de reloj de los esclavos
+static uint32_t txn_bits(const i2c_transaction_t *txn) {
+    uint32_t bits = 2;
+    if (txn->tx_len > 0) bits += 9 * (1 + txn->tx_len);
+    if (txn->rx_len > 0) bits += 1 + 9 * (1 + txn->rx_len);
+    return bits;
+}
+
+void taskSensors(uint32_t i2c) {
+    uint8_t due[SENSOR_COUNT];
+    uint32_t window_bits = 0;
+    TickType_t window_start = xTaskGetTickCount();
+
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+        state[i].next_due = window_start;
+
+    for (;;) {
+        TickType_t now = xTaskGetTickCount();
+
+        uint8_t txn_count;
+        window_bits += sensors_build_batch(now, due, &txn_count);
+
+        if (txn_count > 0) {
+            uint8_t done = I2C_transfer_batch(i2c, batch, txn_count, pdMS_TO_TICKS(SENSORS_QUEUE_WAIT_MS));
+            TickType_t finished = xTaskGetTickCount();
+
+            for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+                if (!due[i]) continue;
+                sensor_state_t *s = &state[i];
+                i2c_transaction_t *txn = &batch[batch_txn[i]];
+
+                if (batch_txn[i] < done && txn->status == I2C_OK) {
+                    // El sensor está en su lugar dentro del buffer de la transacción
+                    sensors_publish(i, txn->rx + (sensors[i].reg - txn->tx[0]), finished);
+                    TickType_t latency = finished - s->next_due;
+                    s->stats.latency_ms = latency * portTICK_PERIOD_MS;
+                    if (s->stats.latency_ms > s->stats.latency_max_ms)
+                        s->stats.latency_max_ms = s->stats.latency_ms;
+                } else {
+                    s->stats.errors++;
+                }
+
+                // Si la tarea se atrasó más de un período se saltean las lecturas perdidas
+                s->next_due += pdMS_TO_TICKS(sensors[i].period_ms);
+                if ((int32_t)(finished - s->next_due) >= 0)
+                    s->next_due = finished + pdMS_TO_TICKS(sensors[i].period_ms);
+            }
+        }
+
+        // Ocupación del bus en la ventana
+        now = xTaskGetTickCount();
+        TickType_t window = now - window_start;
+        if (window >= pdMS_TO_TICKS(SENSORS_WINDOW_MS)) {
+            uint32_t speed = I2C_get_speed(i2c);
+            uint32_t window_ms = window * portTICK_PERIOD_MS;
+            if (speed > 0)
+                bus_utilization = (uint64_t)window_bits * 1000000 / ((uint64_t)speed * window_ms);
+            window_bits = 0;
+            window_start = now;
+        }
+
+        // Dormir hasta el vencimiento más próximo
+        TickType_t wait = portMAX_DELAY;
+        for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+            int32_t remaining = (int32_t)(state[i].next_due - now);
+            if (remaining <= 0) {
+                wait = 0;
+                break;
+            }
+            if ((TickType_t)remaining < wait) wait = remaining;
+        }
+        if (wait > 0) vTaskDelay(wait);
+    }
+}
+
+// Arma el lote con los sensores vencidos. Un sensor se agrega a la última transacción si
+// es del mismo dispositivo y su registro sigue al último leído. Devuelve los bits del lote
+static uint32_t sensors_build_batch(TickType_t now, uint8_t *due, uint8_t *txn_count) {
+    uint8_t count = 0;
+    uint16_t rx_used = 0;
+    uint32_t bits = 0;
+
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        due[i] = (int32_t)(now - state[i].next_due) >= 0;
+        if (!due[i]) continue;
+
+        i2c_transaction_t *last = count > 0 ? &batch[count - 1] : NULL;
+        if (last != NULL && last->addr == sensors[i].addr &&
+            last->tx[0] + last->rx_len == sensors[i].reg) {
+            last->rx_len += sensors[i].len;
+        } else {
+            i2c_transaction_t *txn = &batch[count++];
+            txn->addr = sensors[i].addr;
+            txn->tx = &sensors[i].reg;
+            txn->tx_len = 1;
+            txn->rx = &batch_rx[rx_used];
+            txn->rx_len = sensors[i].len;
+        }
+        batch_txn[i] = count - 1;
+        rx_used += sensors[i].len;
+    }
+
+    for (uint8_t t = 0; t < count; t++)
+        bits += txn_bits(&batch[t]);
+
+    *txn_count = count;
+    return bits;
+}
+
+static void sensors_publish(sensor_id_t id, const uint8_t *data, TickType_t timestamp) {
+    sensor_state_t *s = &state[id];
+    sensor_sample_t *sample = &s->sample[(s->seq + 1) & 1];
+
+    memcpy(sample->data, data, sensors[id].len);
+    sample->timestamp = timestamp;
+    s->stats.samples++;
+
+    compiler_barrier();
+    s->seq++;
+}
+
+BaseType_t SENSORS_read(sensor_id_t id, uint8_t *data, uint8_t len, TickType_t *timestamp) {
+    if (id >= SENSOR_COUNT) return pdFAIL;
+    sensor_state_t *s = &state[id];
+    if (len > sensors[id].len) len = sensors[id].len;
+
+    uint32_t seq;
+    do {
+        seq = s->seq;
+        if (seq == 0) return pdFAIL;
+        compiler_barrier();
+        memcpy(data, s->sample[seq & 1].data, len);
+        if (timestamp != NULL) *timestamp = s->sample[seq & 1].timestamp;
+        compiler_barrier();
+    } while (s->seq != seq);
+
+    return pdPASS;
+}
+
+void SENSORS_get_stats(sensor_id_t id, sensor_stats_t *stats) {
+    if (id >= SENSOR_COUNT) return;
+    taskENTER_CRITICAL();
+    *stats = state[id].stats;
+    taskEXIT_CRITICAL();
+}
+
+uint16_t SENSORS_get_bus_utilization(void) {
+    return bus_utilization;
+}
@@ -0,0 +1,55 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+// Planificador de lecturas del bus de sensores. Cada sensor se describe con una entrada
+// de la tabla de sondeo (dirección, registro, largo y período). Una sola tarea despierta
+// cuando vence el próximo sensor, junta todas las lecturas vencidas en un lote de
+// transacciones consecutivas y publica los resultados en un snapshot compartido.
+
+#define SENSORS_MAX_READ 16  // Largo máximo de una lectura
+
+// Sensores de la tabla de sondeo (ver sensors.c)
+typedef enum {
+    SENSOR_IMU = 0,
+    SENSOR_MAG,
+    SENSOR_BARO_PRESS,
+    SENSOR_BARO_TEMP,
+    SENSOR_COUNT
+} sensor_id_t;
+
+// Entrada de la tabla de sondeo
+typedef struct {
+    const char *name;
+    uint8_t addr;        // Dirección de 7 bits
+    uint8_t reg;         // Primer registro a leer
+    uint8_t len;         // Bytes a leer (<= SENSORS_MAX_READ)
+    uint16_t period_ms;
+} sensor_poll_t;
+
+// Estadísticas de un sensor
+typedef struct {
+    uint32_t samples;         // Lecturas exitosas
+    uint32_t errors;          // Lecturas fallidas
+    uint16_t latency_ms;      // Demora entre el vencimiento y la publicación de la última lectura
+    uint16_t latency_max_ms;
+} sensor_stats_t;
+
+// Tarea que sondea los sensores del bus
+void taskSensors(uint32_t i2c);
+
+// Copia la última lectura del sensor id. timestamp (opcional) recibe el tick de la lectura.
+// No bloquea: si la tarea está publicando justo esa lectura se reintenta la copia.
+// Devuelve pdFAIL si el sensor todavía no tiene lecturas válidas
+BaseType_t SENSORS_read(sensor_id_t id, uint8_t *data, uint8_t len, TickType_t *timestamp);
+
+// Estadísticas de lectura del sensor id
+void SENSORS_get_stats(sensor_id_t id, sensor_stats_t *stats);
+
+// Ocupación del bus en la última ventana de medición, en milésimos
+uint16_t SENSORS_get_bus_utilization(void);
+
+#endif
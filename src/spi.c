@@ -0,0 +1,317 @@
+#include "FreeRTOS.h"
+#include "spi.h"
+#include "cycles.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define SPI_QUEUE_SIZE 8          // Transacciones pendientes por bus
+#define SPI_TIMEOUT_BASE_MS 10    // Timeout mínimo de una transacción
+#define SPI_POLL_MAX 8            // Transacciones de hasta estos bytes se hacen sin DMA
+
+// Prioridad de las interrupciones: debe ser numéricamente mayor o igual a
+// configMAX_SYSCALL_INTERRUPT_PRIORITY para poder usar la API FromISR
+#define SPI_IRQ_PRIORITY 0xC0
+
+typedef struct {
+    uint32_t spi;                   // SPI_ID
+    uint8_t rx_channel;             // Canales DMA1 del periférico
+    uint8_t tx_channel;
+    QueueHandle_t txq;              // Cola de transacciones pendientes
+    StaticQueue_t txq_object;       // Memoria estática de la cola
+    spi_transaction_t *txq_storage[SPI_QUEUE_SIZE];
+    TaskHandle_t task;              // Tarea que atiende el bus
+    spi_transaction_t *volatile current;  // Transacción en curso (la avanza la ISR)
+    uint8_t data_phase;             // La fase en curso es la de datos
+    const spi_device_t *configured; // Dispositivo para el que está configurado el bus
+    uint8_t dummy_rx;               // Destino de lo recibido cuando se descarta
+    uint32_t bytes;                 // Bytes transferidos
+} spi_bus_t;
+
+static spi_bus_t spi_bus1;
+static spi_bus_t spi_bus2;
+
+// Lo que se transmite cuando la transacción no tiene datos de salida
+static const uint8_t dummy_tx = 0xFF;
+
+// Prototipos de funciones
+static void spi_dma_channel_init(spi_bus_t *bus, uint8_t channel, uint8_t from_memory);
+
+// Manejadores de buses SPI
+static spi_bus_t *get_bus(uint32_t spi) {
+    switch (spi) {
+        case SPI1: return &spi_bus1;
+        case SPI2: return &spi_bus2;
+        default: return NULL;
+    }
+}
+
+BaseType_t SPI_setup(uint32_t spi) {
+    spi_bus_t *bus = get_bus(spi);
+    if (bus == NULL) return pdFAIL;
+
+    // El bus no está en el manifiesto (lo usa el driver de NOR y el benchmark del host):
+    // la cola vive en su estructura, también sin heap
+    bus->txq = xQueueCreateStatic(SPI_QUEUE_SIZE, sizeof(spi_transaction_t *),
+                                  (uint8_t *)bus->txq_storage, &bus->txq_object);
+    if (bus->txq == NULL) return pdFAIL;
+    vQueueAddToRegistry(bus->txq, spi == SPI1 ? "SPI1" : "SPI2");
+
+    bus->spi = spi;
+    bus->current = NULL;
+    bus->configured = NULL;
+    bus->bytes = 0;
+
+    rcc_periph_clock_enable(RCC_DMA1);
+
+    if (spi == SPI1) {
+        rcc_periph_clock_enable(RCC_GPIOA);
+        rcc_periph_clock_enable(RCC_SPI1);
+        gpio_set_mode(GPIOA, GPIO_MODE_OUTPUT_50_MHZ, GPIO_CNF_OUTPUT_ALTFN_PUSHPULL, GPIO_SPI1_SCK | GPIO_SPI1_MOSI);
+        gpio_set_mode(GPIOA, GPIO_MODE_INPUT, GPIO_CNF_INPUT_FLOAT, GPIO_SPI1_MISO);
+
+        bus->rx_channel = DMA_CHANNEL2;
+        bus->tx_channel = DMA_CHANNEL3;
+        nvic_set_priority(NVIC_DMA1_CHANNEL2_IRQ, SPI_IRQ_PRIORITY);
+        nvic_enable_irq(NVIC_DMA1_CHANNEL2_IRQ);
+    } else {
+        rcc_periph_clock_enable(RCC_GPIOB);
+        rcc_periph_clock_enable(RCC_SPI2);
+        gpio_set_mode(GPIOB, GPIO_MODE_OUTPUT_50_MHZ, GPIO_CNF_OUTPUT_ALTFN_PUSHPULL, GPIO_SPI2_SCK | GPIO_SPI2_MOSI);
+        gpio_set_mode(GPIOB, GPIO_MODE_INPUT, GPIO_CNF_INPUT_FLOAT, GPIO_SPI2_MISO);
+
+        bus->rx_channel = DMA_CHANNEL4;
+        bus->tx_channel = DMA_CHANNEL5;
+        nvic_set_priority(NVIC_DMA1_CHANNEL4_IRQ, SPI_IRQ_PRIORITY);
+        nvic_enable_irq(NVIC_DMA1_CHANNEL4_IRQ);
+    }
+
+    spi_reset(spi);
+    spi_dma_channel_init(bus, bus->rx_channel, 0);
+    spi_dma_channel_init(bus, bus->tx_channel, 1);
+    return pdPASS;
+}
+
+BaseType_t SPI_add_device(const spi_device_t *dev) {
+    if (dev == NULL || get_bus(dev->spi) == NULL) return pdFAIL;
+
+    switch (dev->cs_port) {
+        case GPIOA: rcc_periph_clock_enable(RCC_GPIOA); break;
+        case GPIOB: rcc_periph_clock_enable(RCC_GPIOB); break;
+        case GPIOC: rcc_periph_clock_enable(RCC_GPIOC); break;
+        default: return pdFAIL;
+    }
+
+    gpio_set(dev->cs_port, dev->cs_pin);
+    gpio_set_mode(dev->cs_port, GPIO_MODE_OUTPUT_50_MHZ, GPIO_CNF_OUTPUT_PUSHPULL, dev->cs_pin);
+    return pdPASS;
+}
+
+// Canal DMA entre SPI_DR y memoria, de a un byte. La recepción tiene más prioridad que la
+// transmisión para que no se pierdan bytes (overrun) con el bus a máxima velocidad
+static void spi_dma_channel_init(spi_bus_t *bus, uint8_t channel, uint8_t from_memory) {
+    dma_channel_reset(DMA1, channel);
+    dma_set_peripheral_address(DMA1, channel, (uint32_t)&SPI_DR(bus->spi));
+    if (from_memory) {
+        dma_set_read_from_memory(DMA1, channel);
+        dma_set_priority(DMA1, channel, DMA_CCR_PL_HIGH);
+    } else {
+        dma_set_read_from_peripheral(DMA1, channel);
+        dma_set_priority(DMA1, channel, DMA_CCR_PL_VERY_HIGH);
+        dma_enable_transfer_complete_interrupt(DMA1, channel);
+    }
+    dma_set_peripheral_size(DMA1, channel, DMA_CCR_PSIZE_8BIT);
+    dma_set_memory_size(DMA1, channel, DMA_CCR_MSIZE_8BIT);
+}
+
+// Clock y modo del dispositivo. Solo se pueden cambiar con el periférico deshabilitado
+static void spi_configure(spi_bus_t *bus, const spi_device_t *dev) {
+    if (bus->configured == dev) return;
+
+    spi_disable(bus->spi);
+    spi_init_master(bus->spi, dev->baudrate,
+        (dev->mode & 2) ? SPI_CR1_CPOL_CLK_TO_1_WHEN_IDLE : SPI_CR1_CPOL_CLK_TO_0_WHEN_IDLE,
+        (dev->mode & 1) ? SPI_CR1_CPHA_CLK_TRANSITION_2 : SPI_CR1_CPHA_CLK_TRANSITION_1,
+        SPI_CR1_DFF_8BIT, SPI_CR1_MSBFIRST);
+
+    // NSS por software: el chip select lo maneja el driver
+    spi_enable_software_slave_management(bus->spi);
+    spi_set_nss_high(bus->spi);
+    spi_enable(bus->spi);
+
+    bus->configured = dev;
+}
+
+// Frecuencia de SCK del dispositivo en Hz
+static uint32_t spi_sck_hz(const spi_device_t *dev) {
+    uint32_t pclk = dev->spi == SPI1 ? rcc_apb2_frequency : rcc_apb1_frequency;
+    return pclk >> (((dev->baudrate >> 3) & 0x7) + 1);
+}
+
+// Arranca una fase por DMA. Sin datos de salida se transmite siempre el mismo byte y sin
+// destino se recibe siempre en el mismo byte, sin incrementar la dirección de memoria
+static void spi_start_dma(spi_bus_t *bus, const uint8_t *tx, uint8_t *rx, uint16_t len) {
+    if (rx != NULL) {
+        dma_set_memory_address(DMA1, bus->rx_channel, (uint32_t)rx);
+        dma_enable_memory_increment_mode(DMA1, bus->rx_channel);
+    } else {
+        dma_set_memory_address(DMA1, bus->rx_channel, (uint32_t)&bus->dummy_rx);
+        dma_disable_memory_increment_mode(DMA1, bus->rx_channel);
+    }
+    dma_set_number_of_data(DMA1, bus->rx_channel, len);
+
+    if (tx != NULL) {
+        dma_set_memory_address(DMA1, bus->tx_channel, (uint32_t)tx);
+        dma_enable_memory_increment_mode(DMA1, bus->tx_channel);
+    } else {
+        dma_set_memory_address(DMA1, bus->tx_channel, (uint32_t)&dummy_tx);
+        dma_disable_memory_increment_mode(DMA1, bus->tx_channel);
+    }
+    dma_set_number_of_data(DMA1, bus->tx_channel, len);
+
+    dma_enable_channel(DMA1, bus->rx_channel);
+    dma_enable_channel(DMA1, bus->tx_channel);
+
+    // RM0008: primero el pedido de recepción y después el de transmisión, que arranca
+    spi_enable_rx_dma(bus->spi);
+    spi_enable_tx_dma(bus->spi);
+}
+
+static void spi_stop_dma(spi_bus_t *bus) {
+    spi_disable_tx_dma(bus->spi);
+    spi_disable_rx_dma(bus->spi);
+    dma_disable_channel(DMA1, bus->tx_channel);
+    dma_disable_channel(DMA1, bus->rx_channel);
+    dma_clear_interrupt_flags(DMA1, bus->tx_channel, DMA_TCIF | DMA_HTIF);
+}
+
+// Transferencia corta sin DMA: configurar los canales y atender la interrupción cuesta
+// más que esperar unos pocos bytes
+static void spi_poll(spi_bus_t *bus, const uint8_t *tx, uint8_t *rx, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        uint8_t data = spi_xfer(bus->spi, tx != NULL ? tx[i] : dummy_tx);
+        if (rx != NULL) rx[i] = data;
+    }
+}
+
+void taskSPI(uint32_t spi) {
+    spi_bus_t *bus = get_bus(spi);
+    if (bus == NULL) return;
+    bus->task = xTaskGetCurrentTaskHandle();
+
+    spi_transaction_t *txn;
+    for (;;) {
+        if (xQueueReceive(bus->txq, &txn, portMAX_DELAY) != pdPASS) continue;
+
+        uint32_t total = (uint32_t)txn->cmd_len + txn->len;
+        spi_configure(bus, txn->dev);
+        gpio_clear(txn->dev->cs_port, txn->dev->cs_pin);
+
+        if (total <= SPI_POLL_MAX) {
+            spi_poll(bus, txn->cmd, NULL, txn->cmd_len);
+            spi_poll(bus, txn->tx, txn->rx, txn->len);
+            txn->status = SPI_OK;
+        } else {
+            TickType_t timeout = pdMS_TO_TICKS(SPI_TIMEOUT_BASE_MS + total * 8 * 1000 / spi_sck_hz(txn->dev));
+            ulTaskNotifyTake(pdTRUE, 0);  // Descartar avisos viejos
+
+            // La ISR encadena la fase de datos detrás del comando
+            taskENTER_CRITICAL();
+            bus->current = txn;
+            bus->data_phase = (txn->cmd_len == 0);
+            if (bus->data_phase)
+                spi_start_dma(bus, txn->tx, txn->rx, txn->len);
+            else
+                spi_start_dma(bus, txn->cmd, NULL, txn->cmd_len);
+            taskEXIT_CRITICAL();
+
+            if (ulTaskNotifyTake(pdTRUE, timeout) == 0) {
+                // Sin respuesta: abortar, salvo que la ISR haya terminado justo ahora
+                taskENTER_CRITICAL();
+                if (bus->current != NULL) {
+                    spi_stop_dma(bus);
+                    bus->current = NULL;
+                    txn->status = SPI_ERR_TIMEOUT;
+                }
+                taskEXIT_CRITICAL();
+            }
+        }
+
+        // El último byte ya se recibió, así que terminó de salir por el bus
+        gpio_set(txn->dev->cs_port, txn->dev->cs_pin);
+        bus->bytes += total;
+
+        // Avisar a la tarea que encoló la transacción
+        txn->done = 1;
+        xTaskNotifyGive(txn->task);
+    }
+}
+
+spi_status_t SPI_transfer(spi_transaction_t *txn, TickType_t xTicksToWait) {
+    if (txn == NULL || txn->dev == NULL) return SPI_ERR_PARAM;
+    spi_bus_t *bus = get_bus(txn->dev->spi);
+    if (bus == NULL) return SPI_ERR_PARAM;
+    if ((txn->cmd_len > 0 && txn->cmd == NULL) || txn->cmd_len + txn->len == 0) return SPI_ERR_PARAM;
+
+    txn->task = xTaskGetCurrentTaskHandle();
+    txn->done = 0;
+    txn->status = SPI_ERR_TIMEOUT;
+
+    if (xQueueSend(bus->txq, &txn, xTicksToWait) != pdTRUE) return SPI_ERR_TIMEOUT;
+
+    // Una notificación ajena a la transacción no debe cortar la espera
+    while (!txn->done)
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    return txn->status;
+}
+
+spi_status_t SPI_write(const spi_device_t *dev, const uint8_t *data, uint16_t len, TickType_t xTicksToWait) {
+    if (data == NULL) return SPI_ERR_PARAM;
+    spi_transaction_t txn = { .dev = dev, .tx = data, .len = len };
+    return SPI_transfer(&txn, xTicksToWait);
+}
+
+spi_status_t SPI_exchange(const spi_device_t *dev, const uint8_t *tx, uint8_t *rx, uint16_t len, TickType_t xTicksToWait) {
+    spi_transaction_t txn = { .dev = dev, .tx = tx, .rx = rx, .len = len };
+    return SPI_transfer(&txn, xTicksToWait);
+}
+
+uint32_t SPI_get_bytes(uint32_t spi) {
+    spi_bus_t *bus = get_bus(spi);
+    if (bus == NULL) return 0;
+    return bus->bytes;
+}
+
+// Fin de una fase: si terminó el comando arranca la fase de datos sin pasar por la tarea
+static void spi_dma_isr(spi_bus_t *bus) {
+    if (!dma_get_interrupt_flag(DMA1, bus->rx_channel, DMA_TCIF)) return;
+    dma_clear_interrupt_flags(DMA1, bus->rx_channel, DMA_TCIF | DMA_HTIF);
+    spi_stop_dma(bus);
+
+    spi_transaction_t *txn = bus->current;
+    if (txn == NULL) return;
+
+    if (!bus->data_phase && txn->len > 0) {
+        bus->data_phase = 1;
+        spi_start_dma(bus, txn->tx, txn->rx, txn->len);
+        return;
+    }
+
+    BaseType_t woken = pdFALSE;
+    txn->status = SPI_OK;
+    bus->current = NULL;
+    vTaskNotifyGiveFromISR(bus->task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void dma1_channel2_isr(void) {
+    CYCLES_isr_enter();
+    spi_dma_isr(&spi_bus1);
+    CYCLES_isr_exit();
+}
+
+void dma1_channel4_isr(void) {
+    CYCLES_isr_enter();
+    spi_dma_isr(&spi_bus2);
+    CYCLES_isr_exit();
+}
@@ -0,0 +1,76 @@
+#ifndef SPI_H
+#define SPI_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <queue.h>
+#include <stdint.h>
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/spi.h>
+#include <libopencm3/stm32/dma.h>
+#include <libopencm3/cm3/nvic.h>
+
+// OBS: SPI1 usa PA5 (SCK), PA6 (MISO), PA7 (MOSI) y los canales 2 (RX) y 3 (TX) del DMA1.
+// SPI2 usa PB13 (SCK), PB14 (MISO), PB15 (MOSI) y los canales 4 (RX) y 5 (TX).
+// El chip select de cada dispositivo es un GPIO cualquiera manejado por el driver.
+
+// Resultado de una transacción
+typedef enum {
+    SPI_OK = 0,
+    SPI_ERR_TIMEOUT,  // El DMA no terminó a tiempo y se abortó la transacción
+    SPI_ERR_PARAM     // Bus inexistente o transacción inválida
+} spi_status_t;
+
+// Dispositivo conectado a un bus. Cada dispositivo tiene su propia configuración de
+// clock y modo; el driver reconfigura el bus cuando cambia de dispositivo
+typedef struct {
+    uint32_t spi;         // SPI1 o SPI2
+    uint32_t cs_port;     // Puerto y pin del chip select (activo en bajo)
+    uint16_t cs_pin;
+    uint32_t baudrate;    // SPI_CR1_BAUDRATE_FPCLK_DIV_x
+    uint8_t mode;         // Modo SPI 0 a 3 (CPOL << 1 | CPHA)
+} spi_device_t;
+
+// Transacción con el chip select activo de principio a fin. La fase de comando (opcional)
+// solo transmite; en la fase de datos se transmite tx (o 0xFF si es NULL) y se recibe en
+// rx (o se descarta si es NULL)
+typedef struct {
+    const spi_device_t *dev;
+    const uint8_t *cmd;      // Comando, dirección, bytes dummy, etc.
+    uint16_t cmd_len;
+    const uint8_t *tx;
+    uint8_t *rx;
+    uint16_t len;
+
+    // Uso interno del driver
+    TaskHandle_t task;              // Tarea a notificar al terminar
+    volatile uint8_t done;
+    volatile spi_status_t status;
+} spi_transaction_t;
+
+// Configura el periférico SPI como master, sus pines y los canales DMA
+BaseType_t SPI_setup(uint32_t spi);
+
+// Configura el pin de chip select del dispositivo como salida en alto
+BaseType_t SPI_add_device(const spi_device_t *dev);
+
+// Tarea que ejecuta las transacciones encoladas para el bus
+void taskSPI(uint32_t spi);
+
+// Encola la transacción y bloquea la tarea hasta que termina. xTicksToWait limita la espera
+// por lugar en la cola; la transacción en sí está acotada por el timeout del driver.
+// OBS: la finalización se avisa con la notificación de la tarea que llama.
+spi_status_t SPI_transfer(spi_transaction_t *txn, TickType_t xTicksToWait);
+
+// Solo transmisión
+spi_status_t SPI_write(const spi_device_t *dev, const uint8_t *data, uint16_t len, TickType_t xTicksToWait);
+
+// Full-duplex: transmite tx y recibe en rx la misma cantidad de bytes
+spi_status_t SPI_exchange(const spi_device_t *dev, const uint8_t *tx, uint8_t *rx, uint16_t len, TickType_t xTicksToWait);
+
+// Bytes transferidos por el bus (comando y datos)
+uint32_t SPI_get_bytes(uint32_t spi);
+
+#endif
@@ -0,0 +1,99 @@
+#include "stackmon.h"
+#include "downlink.h"
+#include "periodic.h"
+#include "name.h"
+#include "timers.h"
+
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    TaskHandle_t handle;            // NULL: slot libre
+    configSTACK_DEPTH_TYPE depth;
+} stackmon_slot_t;
+
+typedef struct {
+    stackmon_slot_t slots[STACKMON_MAX_TASKS];
+    uint8_t low;
+} stackmon_t;
+
+static stackmon_t stackmon;
+
+void STACKMON_register(TaskHandle_t handle, configSTACK_DEPTH_TYPE depth) {
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < STACKMON_MAX_TASKS; i++) {
+        stackmon_slot_t *slot = &stackmon.slots[i];
+        if (slot->handle == NULL || slot->handle == handle) {
+            slot->handle = handle;
+            slot->depth = depth;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+static configSTACK_DEPTH_TYPE stackmon_depth(TaskHandle_t handle) {
+    for (uint8_t i = 0; i < STACKMON_MAX_TASKS; i++)
+        if (stackmon.slots[i].handle == handle) return stackmon.slots[i].depth;
+    return 0;
+}
+
+static void stackmon_sample(void) {
+    static stackmon_packet_t packet;
+
+    UBaseType_t count = uxTaskGetNumberOfTasks();
+    TaskStatus_t *status = pvPortMalloc(count * sizeof(TaskStatus_t));
+    if (status == NULL) return;
+    count = uxTaskGetSystemState(status, count, NULL);
+
+    // Los slots de tareas borradas se liberan para no confundirlos con un handle reusado
+    for (uint8_t i = 0; i < STACKMON_MAX_TASKS; i++) {
+        stackmon_slot_t *slot = &stackmon.slots[i];
+        if (slot->handle == NULL) continue;
+        UBaseType_t j = 0;
+        while (j < count && status[j].xHandle != slot->handle) j++;
+        if (j == count) slot->handle = NULL;
+    }
+
+    uint8_t low = 0;
+    for (UBaseType_t i = 0; i < count; i++)
+        if (status[i].usStackHighWaterMark < STACKMON_LOW_WORDS) low++;
+    stackmon.low = low;
+
+    packet.type = STACKMON_PACKET_TYPE;
+    packet.page = 0;
+    packet.pages = (count + STACKMON_TASKS_PER_PACKET - 1) / STACKMON_TASKS_PER_PACKET;
+    packet.uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    packet.low = low;
+    packet.count = 0;
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        stackmon_entry_t *entry = &packet.tasks[packet.count++];
+        NAME_copy(entry->name, status[i].pcTaskName, STACKMON_NAME_LEN);
+        entry->size = stackmon_depth(status[i].xHandle);
+        entry->min_free = status[i].usStackHighWaterMark;
+
+        if (packet.count == STACKMON_TASKS_PER_PACKET || i + 1 == count) {
+            uint16_t len = offsetof(stackmon_packet_t, tasks) + packet.count * sizeof(stackmon_entry_t);
+            DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, len, 0);
+            packet.page++;
+            packet.count = 0;
+        }
+    }
+    vPortFree(status);
+}
+
+void taskStackMon(void *args) {
+    // Las tareas del kernel se crean al arrancar el scheduler, con tamaños de la configuración
+    STACKMON_register(xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE);
+    STACKMON_register(xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+
+    for (;;) {
+        stackmon_sample();
+        PERIODIC_wait(args);
+    }
+}
+
+uint8_t STACKMON_get_low(void) {
+    return stackmon.low;
+}
@@ -0,0 +1,52 @@
+#ifndef STACKMON_H
+#define STACKMON_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+// Monitor de stacks: cada STACKMON_PERIOD_MS lee el mínimo de stack libre de cada tarea
+// (high-water mark) y lo publica junto con el tamaño asignado en el stream de housekeeping.
+// Con esos paquetes tools/stack_report.py recomienda el tamaño de cada stack. El resto del
+// housekeeping lo publica la tarea de telemetría (telemetry.h).
+//
+// OBS: FreeRTOS no guarda el tamaño del stack de una tarea. El manifiesto (manifest.h)
+// registra el de cada tarea que crea; idle y timers se agregan solas.
+
+#define STACKMON_PERIOD_MS        5000
+#define STACKMON_MAX_TASKS        16
+#define STACKMON_TASKS_PER_PACKET 8
+#define STACKMON_NAME_LEN         8
+#define STACKMON_LOW_WORDS        16     // Por debajo la tarea se cuenta como en riesgo
+
+#define STACKMON_PACKET_TYPE 0x53
+
+// Stack de una tarea, en palabras de 4 bytes
+typedef struct __attribute__((packed)) {
+    char name[STACKMON_NAME_LEN];   // Truncado, sin terminador si ocupa todo
+    uint16_t size;                  // Tamaño asignado, 0 si no está registrado
+    uint16_t min_free;              // Mínimo libre desde que arrancó la tarea
+} stackmon_entry_t;
+
+// Paquete de telemetría, partido en páginas como el de cpustats.h
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // STACKMON_PACKET_TYPE
+    uint8_t page;
+    uint8_t pages;
+    uint8_t count;                  // Entradas en este paquete
+    uint32_t uptime_ms;
+    uint8_t low;                    // Tareas con menos de STACKMON_LOW_WORDS libres
+    uint8_t reserved[3];
+    stackmon_entry_t tasks[STACKMON_TASKS_PER_PACKET];
+} stackmon_packet_t;
+
+// Registra el tamaño del stack de una tarea, en palabras
+void STACKMON_register(TaskHandle_t handle, configSTACK_DEPTH_TYPE depth);
+
+// Tarea periódica (periodic.h) que toma las muestras y publica la telemetría
+void taskStackMon(void *args);
+
+// Tareas en riesgo en la última muestra
+uint8_t STACKMON_get_low(void);
+
+#endif
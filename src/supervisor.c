@@ -0,0 +1,160 @@
+#include "supervisor.h"
+#include "downlink.h"
+#include "name.h"
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/iwdg.h>
+#include <libopencm3/stm32/dbgmcu.h>
+#include <stddef.h>
+#include <string.h>
+
+#define SUPERVISOR_MAGIC 0x57444F47u    // "WDOG"
+
+// Sobrevive al reset: el startup no la inicializa (sección .noinit del linker script).
+// Después de un power-on tiene basura, que el checksum descarta
+typedef struct {
+    uint32_t magic;
+    uint32_t boots;
+    uint32_t watchdog_resets;
+    uint8_t cause;                  // supervisor_cause_t
+    uint8_t state;
+    uint16_t stack_free;
+    uint32_t uptime_ms;
+    uint32_t silent_ms;
+    char task[configMAX_TASK_NAME_LEN];
+    uint32_t checksum;
+} supervisor_record_t;
+
+typedef struct {
+    TaskHandle_t task;
+    TickType_t window;
+    supervisor_slot_t slot;
+} supervised_t;
+
+typedef struct {
+    supervised_t tasks[SUPERVISOR_MAX_TASKS];
+    uint8_t count;
+    uint8_t reset_flags;            // RCC_CSR[31:24] al arrancar
+    uint8_t recorded;               // Ya se registró una falla: no se recarga más el IWDG
+    supervisor_record_t previous;   // Registro con el que arrancó
+} supervisor_state_t;
+
+static supervisor_state_t supervisor;
+static supervisor_record_t record __attribute__((section(".noinit")));
+static supervisor_slot_t unsupervised;
+
+_Static_assert(sizeof(supervisor_packet_t) <= DOWNLINK_MAX_FRAME, "El paquete del supervisor no entra en una trama");
+_Static_assert(offsetof(supervisor_record_t, checksum) % sizeof(uint32_t) == 0, "El checksum recorre palabras");
+
+static uint32_t record_checksum(const supervisor_record_t *r) {
+    const uint32_t *words = (const uint32_t *)r;
+    uint32_t sum = 0;
+    for (size_t i = 0; i < offsetof(supervisor_record_t, checksum) / sizeof(uint32_t); i++)
+        sum = ((sum << 5) | (sum >> 27)) ^ words[i];
+    return sum;
+}
+
+void SUPERVISOR_setup(void) {
+    uint32_t csr = RCC_CSR;
+    supervisor.reset_flags = csr >> 24;
+
+    if (record.magic != SUPERVISOR_MAGIC || record.checksum != record_checksum(&record)
+        || (csr & RCC_CSR_PORRSTF)) {
+        memset(&record, 0, sizeof(record));
+        record.magic = SUPERVISOR_MAGIC;
+    }
+    record.boots++;
+    if (csr & RCC_CSR_IWDGRSTF) record.watchdog_resets++;
+
+    // La falla queda para la telemetría de esta corrida y se borra del registro
+    supervisor.previous = record;
+    record.cause = SUPERVISOR_CAUSE_NONE;
+    record.checksum = record_checksum(&record);
+
+    // Los flags de reset se acumulan hasta que se borran
+    RCC_CSR |= RCC_CSR_RMVF;
+
+    // Con el core detenido por el debugger el IWDG también se detiene
+    DBGMCU_CR |= DBGMCU_CR_IWDG_STOP;
+    iwdg_set_period_ms(SUPERVISOR_IWDG_MS);
+    iwdg_start();
+}
+
+void SUPERVISOR_register(TaskHandle_t task, TickType_t window) {
+    if (task == NULL || supervisor.count >= SUPERVISOR_MAX_TASKS) return;
+
+    supervised_t *s = &supervisor.tasks[supervisor.count++];
+    s->task = task;
+    s->window = window;
+    s->slot.last = xTaskGetTickCount();
+    vTaskSetThreadLocalStoragePointer(task, SUPERVISOR_TLS_INDEX, &s->slot);
+}
+
+supervisor_slot_t *SUPERVISOR_self(void) {
+    supervisor_slot_t *slot = pvTaskGetThreadLocalStoragePointer(NULL, SUPERVISOR_TLS_INDEX);
+    return slot != NULL ? slot : &unsupervised;
+}
+
+// Solo la primera falla: la que llevó al reset
+static void record_fault(supervisor_cause_t cause, const char *name, eTaskState state,
+                         uint16_t stack_free, uint32_t silent_ms) {
+    if (supervisor.recorded) return;
+    supervisor.recorded = 1;
+
+    record.cause = cause;
+    record.state = state;
+    record.stack_free = stack_free;
+    record.uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    record.silent_ms = silent_ms;
+    record.task[sizeof(record.task) - 1] = '\0';
+    NAME_copy(record.task, name, sizeof(record.task) - 1);
+    record.checksum = record_checksum(&record);
+}
+
+void SUPERVISOR_stack_overflow(const char *name) {
+    // El stack de la tarea está roto: no se consulta al kernel sobre ella
+    record_fault(SUPERVISOR_CAUSE_STACK_OVERFLOW, name, eRunning, 0, 0);
+}
+
+void taskSupervisor(void *args __attribute__((unused))) {
+    TickType_t wake = xTaskGetTickCount();
+
+    for (;;) {
+        uint8_t current = !supervisor.recorded;
+        for (uint8_t i = 0; i < supervisor.count; i++) {
+            supervised_t *s = &supervisor.tasks[i];
+            // El check-in se lee antes que el tick: uno posterior no puede dar una resta negativa
+            TickType_t last = s->slot.last;
+            TickType_t silent = xTaskGetTickCount() - last;
+            if (silent <= s->window) continue;
+
+            current = 0;
+            record_fault(SUPERVISOR_CAUSE_HUNG, pcTaskGetName(s->task), eTaskGetState(s->task),
+                         uxTaskGetStackHighWaterMark(s->task), silent * portTICK_PERIOD_MS);
+        }
+
+        if (current) iwdg_reset();
+        xTaskDelayUntil(&wake, pdMS_TO_TICKS(SUPERVISOR_PERIOD_MS));
+    }
+}
+
+void SUPERVISOR_publish(void) {
+    const supervisor_record_t *last = &supervisor.previous;
+    supervisor_packet_t packet = {
+        .type = SUPERVISOR_PACKET_TYPE,
+        .reset_flags = supervisor.reset_flags,
+        .cause = last->cause,
+        .state = last->cause != SUPERVISOR_CAUSE_NONE ? last->state : 0,
+        .uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS,
+        .boots = last->boots,
+        .watchdog_resets = last->watchdog_resets,
+        .tasks = supervisor.count,
+    };
+    if (last->cause != SUPERVISOR_CAUSE_NONE) {
+        packet.fault_uptime_ms = last->uptime_ms;
+        packet.silent_ms = last->silent_ms;
+        packet.stack_free = last->stack_free;
+        memcpy(packet.task, last->task, sizeof(packet.task));
+    }
+    DOWNLINK_send(DOWNLINK_STREAM_HK, (const uint8_t *)&packet, sizeof(packet), 0);
+}
@@ -0,0 +1,87 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+// Supervisor de tareas y watchdog independiente (IWDG). Cada tarea supervisada declara en
+// el manifiesto (manifest.h) una ventana: tiene que pasar por SUPERVISOR_checkin() al
+// menos una vez en ese tiempo. taskSupervisor revisa las ventanas cada
+// SUPERVISOR_PERIOD_MS y recarga el IWDG solo si todas están al día. Si una tarea se
+// pasó, guarda en RAM sin inicializar (.noinit, ver el linker script) cuál fue y en qué
+// estado estaba, y deja de recargar: el IWDG resetea el micro a lo sumo
+// SUPERVISOR_IWDG_MS después. El desborde de stack (vApplicationStackOverflowHook) se
+// registra igual.
+//
+// Al arrancar, SUPERVISOR_setup() lee el registro y la causa del reset (RCC_CSR) y los
+// publica por el stream de housekeeping desde la tarea de telemetría (telemetry.h);
+// tools/supervisor_report.py los muestra.
+//
+// El check-in es un solo store, sin locks: la tarea toma su ranura una vez con
+// SUPERVISOR_self() (queda en el thread local storage de la tarea) y después solo escribe
+// el tick actual. Las tareas periódicas (periodic.h) hacen el check-in en PERIODIC_wait()
+// con una ventana de SUPERVISOR_PERIODS períodos.
+//
+// OBS: el IWDG no se detiene en STOP. Con LOW_POWER el supervisor despierta al micro cada
+// SUPERVISOR_PERIOD_MS, que pasa a ser la estadía máxima en STOP.
+
+#define SUPERVISOR_PERIOD_MS     1000
+#define SUPERVISOR_IWDG_MS       4000   // Con el LSI a 40 kHz, que varía entre 30 y 60 kHz
+#define SUPERVISOR_MAX_TASKS     12
+#define SUPERVISOR_PERIODS       3
+#define SUPERVISOR_TLS_INDEX     0
+
+#define SUPERVISOR_PACKET_TYPE 0x57
+
+// Causa registrada antes del último reset
+typedef enum {
+    SUPERVISOR_CAUSE_NONE,
+    SUPERVISOR_CAUSE_HUNG,          // Una tarea no hizo check-in dentro de su ventana
+    SUPERVISOR_CAUSE_STACK_OVERFLOW,
+} supervisor_cause_t;
+
+typedef struct {
+    volatile TickType_t last;       // Tick del último check-in
+} supervisor_slot_t;
+
+// Paquete de telemetría
+typedef struct __attribute__((packed)) {
+    uint8_t type;                   // SUPERVISOR_PACKET_TYPE
+    uint8_t reset_flags;            // RCC_CSR[31:24] al arrancar (IWDGRSTF es el bit 5)
+    uint8_t cause;                  // supervisor_cause_t
+    uint8_t state;                  // eTaskState de la tarea cuando se registró
+    uint32_t uptime_ms;
+    uint32_t boots;                 // Arranques desde el último power-on
+    uint32_t watchdog_resets;       // De esos, por el IWDG
+    uint32_t fault_uptime_ms;       // Cuándo se registró la falla
+    uint32_t silent_ms;             // Tiempo desde el último check-in de la tarea
+    uint16_t stack_free;            // Mínimo de stack libre de la tarea, en palabras
+    uint8_t tasks;                  // Tareas supervisadas
+    uint8_t reserved;
+    char task[configMAX_TASK_NAME_LEN];
+} supervisor_packet_t;
+
+// Lee el registro del reset anterior y arranca el IWDG. Va al principio de main()
+void SUPERVISOR_setup(void);
+
+// Supervisa una tarea con una ventana de window ticks. Va antes de arrancar el scheduler
+void SUPERVISOR_register(TaskHandle_t task, TickType_t window);
+
+// Ranura de la tarea que llama. Si no está supervisada devuelve una que nadie revisa
+supervisor_slot_t *SUPERVISOR_self(void);
+
+static inline void SUPERVISOR_checkin(supervisor_slot_t *slot) {
+    slot->last = xTaskGetTickCount();
+}
+
+// Registra un desborde de stack de la tarea name. Desde vApplicationStackOverflowHook():
+// el hook no vuelve, el supervisor deja de correr y el IWDG resetea
+void SUPERVISOR_stack_overflow(const char *name);
+
+// Publica el paquete de telemetría
+void SUPERVISOR_publish(void);
+
+void taskSupervisor(void *args);
+
+#endif
@@ -0,0 +1,27 @@
+#include "telemetry.h"
+#include "heapstats.h"
+#include "latency.h"
+#include "periodic.h"
+#include "supervisor.h"
+#include "critstats.h"
+#include "power.h"
+
+static void (*const publishers[])(void) = {
+    HEAPSTATS_publish,
+    LATENCY_publish,
+    PERIODIC_publish,
+    SUPERVISOR_publish,
+#ifdef CRITSTATS_ENABLED
+    CRITSTATS_publish,
+#endif
+#ifdef LOW_POWER
+    POWER_publish,
+#endif
+};
+
+void taskTelemetry(void *args) {
+    for (;;) {
+        for (uint8_t i = 0; i < sizeof(publishers) / sizeof(publishers[0]); i++) publishers[i]();
+        PERIODIC_wait(args);
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Publicación periódica del housekeeping: cada TELEMETRY_PERIOD_MS la tarea llama a cada
+// publicador de la tabla de telemetry.c, que arma su paquete y lo encola en el stream de
+// housekeeping del enlace de bajada. Publican las estadísticas del heap (heapstats.h), las
+// latencias de interrupción a tarea (latency.h), las tareas periódicas (periodic.h), el
+// supervisor (supervisor.h), con CRITSTATS=1 las secciones críticas del kernel
+// (critstats.h) y con LOW_POWER=1 el modo STOP (power.h). El monitor de stacks
+// (stackmon.h) publica aparte, desde su propia tarea.
+//
+// Para agregar un paquete alcanza con una línea en la tabla.
+
+#define TELEMETRY_PERIOD_MS 5000
+
+// Tarea periódica del manifiesto
+void taskTelemetry(void *args);
+
+#endif
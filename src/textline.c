@@ -0,0 +1,52 @@
+#include "textline.h"
+
+#include <stddef.h>
+
+typedef struct {
+    textline_print_t print;
+    char line[TEXTLINE_LEN];
+    uint8_t used;
+} textline_t;
+
+static textline_t textline;
+
+static void put(char c) {
+    if (textline.used < TEXTLINE_LEN - 1) textline.line[textline.used++] = c;
+}
+
+void TEXTLINE_setup(textline_print_t print) {
+    textline.print = print;
+    textline.used = 0;
+}
+
+void TEXTLINE_text(const char *text, uint8_t width) {
+    uint8_t chars = 0;
+    for ( ; *text; text++) {
+        // Los bytes de continuación de UTF-8 no ocupan columna
+        if ((*text & 0xC0) != 0x80) chars++;
+        put(*text);
+    }
+    while (chars++ < width) put(' ');
+}
+
+void TEXTLINE_uint(uint32_t value, uint8_t width) {
+    char digits[10];
+    uint8_t n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (width-- > n) put(' ');
+    while (n > 0) put(digits[--n]);
+}
+
+void TEXTLINE_dash(uint8_t width) {
+    while (width-- > 1) put(' ');
+    put('-');
+}
+
+void TEXTLINE_end(void) {
+    textline.line[textline.used] = '\0';
+    if (textline.print != NULL) textline.print(textline.line);
+    textline.used = 0;
+}
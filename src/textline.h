@@ -0,0 +1,32 @@
+#ifndef TEXTLINE_H
+#define TEXTLINE_H
+
+#include <stdint.h>
+
+// Líneas de texto en columnas para los modos de benchmark (kbench.h, uartbench.h): el
+// firmware no tiene printf. La línea se arma en un buffer estático y TEXTLINE_end() la
+// pasa completa a la función de impresión, sin el fin de línea. Las columnas se cuentan
+// en caracteres: los acentos (UTF-8) no corren la alineación.
+//
+// OBS: un solo buffer; lo usa una sola tarea a la vez.
+
+#define TEXTLINE_LEN 128
+
+// Imprime una línea, sin el fin de línea
+typedef void (*textline_print_t)(const char *line);
+
+void TEXTLINE_setup(textline_print_t print);
+
+// Texto alineado a la izquierda en width columnas (0: sin relleno)
+void TEXTLINE_text(const char *text, uint8_t width);
+
+// Número alineado a la derecha en width columnas
+void TEXTLINE_uint(uint32_t value, uint8_t width);
+
+// Un guion alineado a la derecha, para los valores que no aplican
+void TEXTLINE_dash(uint8_t width);
+
+// Imprime la línea armada (vacía si no se agregó nada) y empieza otra
+void TEXTLINE_end(void);
+
+#endif
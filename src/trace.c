@@ -0,0 +1,221 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "trace.h"
+#include "cycles.h"
+#include "uart.h"
+#include "name.h"
+
+#include <string.h>
+
+#include <libopencm3/stm32/usart.h>
+
+// Sin TRACE=1 las macros de traza quedan vacías y el módulo no se compila
+#ifdef TRACE_ENABLED
+
+// UART del volcado. Con el bus de sensores USART2 es el enlace de bajada y el volcado
+// se mezclaría con las tramas: no hay volcado
+#ifndef SENSOR_BUS_I2C2
+#define TRACE_USART USART2
+#endif
+
+typedef struct {
+    void *handle;               // NULL: slot libre
+    uint16_t length;
+    uint16_t item_size;
+    uint8_t number;
+    uint8_t type;
+} trace_queue_t;
+
+typedef struct {
+    trace_event_t events[TRACE_EVENTS];
+    uint32_t head;              // Eventos grabados desde el último volcado
+    uint8_t frozen;             // No se graba mientras se vuelca
+    uint8_t next_queue;         // Número de la próxima cola creada
+    volatile uint8_t dumping;
+    trace_queue_t queues[TRACE_MAX_QUEUES];
+    TaskHandle_t task;
+    uint32_t crc;
+} trace_t;
+
+static trace_t trace = { .next_queue = 1 };
+
+void TRACE_setup(void) {
+    // Los eventos de las tareas creadas antes del scheduler ya llevan timestamp
+    CYCLES_setup();
+}
+
+// Con las interrupciones enmascaradas alcanza con un índice: los eventos del kernel y
+// de las ISRs se escriben en orden. Son unas decenas de ciclos por evento
+void TRACE_event(uint8_t type, uint8_t arg8, uint16_t arg16) {
+    uint32_t mask = cm_mask_interrupts(1);
+    if (!trace.frozen) {
+        trace_event_t *event = &trace.events[trace.head & (TRACE_EVENTS - 1)];
+        event->timestamp = DWT_CYCCNT;
+        event->type = type;
+        event->arg8 = arg8;
+        event->arg16 = arg16;
+        trace.head++;
+    }
+    cm_mask_interrupts(mask);
+}
+
+void TRACE_mark(uint8_t id, uint16_t value) {
+    TRACE_event(TRACE_EV_USER, id, value);
+}
+
+uint16_t TRACE_queue_create(void *queue, uint32_t length, uint32_t item_size, uint8_t type) {
+    uint8_t number = 0;
+    uint32_t mask = cm_mask_interrupts(1);
+    for (uint8_t i = 0; i < TRACE_MAX_QUEUES; i++) {
+        trace_queue_t *slot = &trace.queues[i];
+        if (slot->handle != NULL) continue;
+
+        // Los números no se reutilizan hasta dar la vuelta, así una cola borrada no se
+        // confunde con la siguiente en la misma traza
+        number = trace.next_queue++;
+        if (trace.next_queue == 0) trace.next_queue = 1;
+        slot->handle = queue;
+        slot->length = (uint16_t)length;
+        slot->item_size = (uint16_t)item_size;
+        slot->number = number;
+        slot->type = type;
+        break;
+    }
+    cm_mask_interrupts(mask);
+
+    // Sin slot la cola queda con número 0 y sus eventos no se pueden atribuir
+    TRACE_event(TRACE_EV_QUEUE_CREATE, number, type);
+    return number;
+}
+
+void TRACE_queue_delete(void *queue) {
+    uint32_t mask = cm_mask_interrupts(1);
+    for (uint8_t i = 0; i < TRACE_MAX_QUEUES; i++)
+        if (trace.queues[i].handle == queue) trace.queues[i].handle = NULL;
+    cm_mask_interrupts(mask);
+}
+
+static uint8_t active_exception(void) {
+    uint32_t ipsr;
+    __asm__ volatile ("mrs %0, ipsr" : "=r" (ipsr));
+    return (uint8_t)ipsr;
+}
+
+void TRACE_isr_enter(void) {
+    TRACE_event(TRACE_EV_ISR_ENTER, active_exception(), 0);
+}
+
+void TRACE_isr_exit(void) {
+    TRACE_event(TRACE_EV_ISR_EXIT, active_exception(), 0);
+}
+
+int32_t TRACE_request_dump(void) {
+#ifdef TRACE_USART
+    BaseType_t result = pdFAIL;
+    taskENTER_CRITICAL();
+    if (trace.task != NULL && !trace.dumping) {
+        trace.dumping = 1;
+        result = pdPASS;
+    }
+    taskEXIT_CRITICAL();
+    if (result == pdPASS) xTaskNotifyGive(trace.task);
+    return result;
+#else
+    return pdFAIL;
+#endif
+}
+
+#ifdef TRACE_USART
+// CRC-32 IEEE bit a bit: el volcado está limitado por la UART, no por el CRC
+static void trace_write(const void *data, uint32_t len) {
+    const uint8_t *bytes = data;
+    for (uint32_t i = 0; i < len; i++) {
+        trace.crc ^= bytes[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            trace.crc = (trace.crc >> 1) ^ (0xEDB88320 & -(trace.crc & 1));
+        UART_putchar(TRACE_USART, bytes[i], portMAX_DELAY);
+    }
+}
+
+static void trace_dump(void) {
+    // Congelar: lo que sigue no se graba y el buffer no cambia mientras se lee
+    uint32_t mask = cm_mask_interrupts(1);
+    trace.frozen = 1;
+    uint32_t head = trace.head;
+    cm_mask_interrupts(mask);
+
+    UBaseType_t task_count = uxTaskGetNumberOfTasks();
+    TaskStatus_t *status = pvPortMalloc(task_count * sizeof(TaskStatus_t));
+    task_count = status != NULL ? uxTaskGetSystemState(status, task_count, NULL) : 0;
+
+    trace_queue_t queues[TRACE_MAX_QUEUES];
+    uint8_t queue_count = 0;
+    mask = cm_mask_interrupts(1);
+    for (uint8_t i = 0; i < TRACE_MAX_QUEUES; i++)
+        if (trace.queues[i].handle != NULL) queues[queue_count++] = trace.queues[i];
+    cm_mask_interrupts(mask);
+
+    trace_header_t header = {
+        .magic = TRACE_MAGIC,
+        .version = TRACE_VERSION,
+        .event_size = sizeof(trace_event_t),
+        .task_count = (uint8_t)task_count,
+        .queue_count = queue_count,
+        .cpu_hz = configCPU_CLOCK_HZ,
+        .event_count = head < TRACE_EVENTS ? head : TRACE_EVENTS,
+        .overwritten = head > TRACE_EVENTS ? head - TRACE_EVENTS : 0,
+    };
+    trace.crc = 0xFFFFFFFF;
+    trace_write(&header, sizeof(header));
+
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        trace_task_entry_t entry = {
+            .number = (uint16_t)status[i].xTaskNumber,
+            .priority = (uint8_t)status[i].uxCurrentPriority,
+            .handle = (uint32_t)status[i].xHandle,
+        };
+        NAME_copy(entry.name, status[i].pcTaskName, sizeof(entry.name) - 1);
+        trace_write(&entry, sizeof(entry));
+    }
+    vPortFree(status);
+
+    for (uint8_t i = 0; i < queue_count; i++) {
+        trace_queue_entry_t entry = {
+            .number = queues[i].number,
+            .type = queues[i].type,
+            .handle = (uint32_t)queues[i].handle,
+            .length = queues[i].length,
+            .item_size = queues[i].item_size,
+        };
+        const char *name = pcQueueGetName(queues[i].handle);
+        if (name != NULL) NAME_copy(entry.name, name, sizeof(entry.name) - 1);
+        trace_write(&entry, sizeof(entry));
+    }
+
+    for (uint32_t i = head - header.event_count; i != head; i++)
+        trace_write(&trace.events[i & (TRACE_EVENTS - 1)], sizeof(trace_event_t));
+
+    uint32_t crc = ~trace.crc;
+    trace_write(&crc, sizeof(crc));
+
+    // Se sigue grabando con el buffer vacío
+    mask = cm_mask_interrupts(1);
+    trace.head = 0;
+    trace.frozen = 0;
+    cm_mask_interrupts(mask);
+}
+#endif
+
+void taskTrace(void *args __attribute__((unused))) {
+    trace.task = xTaskGetCurrentTaskHandle();
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#ifdef TRACE_USART
+        trace_dump();
+#endif
+        trace.dumping = 0;
+    }
+}
+
+#endif
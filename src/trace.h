@@ -0,0 +1,104 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Traza binaria del kernel (compilando con TRACE=1). Las macros de traza de FreeRTOS
+// (FreeRTOSConfig.h) y las ISRs instrumentadas (cycles.c) escriben eventos de 8 bytes con
+// timestamp en ciclos en un buffer circular en RAM. El buffer funciona como caja negra:
+// cuando se llena pisa los eventos más viejos. TRACE_request_dump() lo congela y taskTrace
+// lo vuelca por TRACE_USART; después la grabación sigue con el buffer vacío.
+//
+// OBS: este header solo puede incluir headers estándar, lo incluye FreeRTOSConfig.h.
+
+#define TRACE_EVENTS     256          // Potencia de 2
+#define TRACE_MAX_QUEUES 24           // Colas, semáforos y mutex vivos con número de traza
+#define TRACE_MAGIC      0x43525446   // "FTRC"
+#define TRACE_VERSION    1
+
+// Tipos de evento. Los argumentos van en arg8 y arg16
+typedef enum {
+    TRACE_EV_TASK_SWITCH = 1,   // arg16: tarea que entra, arg8: prioridad
+    TRACE_EV_TASK_READY,        // arg16: tarea que pasa a ready
+    TRACE_EV_TASK_CREATE,       // arg16: tarea, arg8: prioridad
+    TRACE_EV_TASK_DELETE,       // arg16: tarea
+    TRACE_EV_TASK_DELAY,        // arg16: ticks (saturado)
+    TRACE_EV_QUEUE_CREATE,      // arg8: cola, arg16: tipo (queueQUEUE_TYPE_*)
+    TRACE_EV_QUEUE_SEND,        // arg8: cola, arg16: mensajes después de la operación
+    TRACE_EV_QUEUE_RECEIVE,     // arg8: cola, arg16: mensajes después de la operación
+    TRACE_EV_QUEUE_BLOCK_SEND,  // arg8: cola llena, la tarea se bloquea
+    TRACE_EV_QUEUE_BLOCK_RECEIVE,
+    TRACE_EV_QUEUE_SEND_FAILED, // arg8: cola, venció el timeout o llena desde una ISR
+    TRACE_EV_QUEUE_RECEIVE_FAILED,
+    TRACE_EV_NOTIFY,            // arg16: tarea notificada
+    TRACE_EV_ISR_ENTER,         // arg8: número de excepción (16 + IRQ)
+    TRACE_EV_ISR_EXIT,          // arg8: número de excepción
+    TRACE_EV_USER,              // arg8: id, arg16: valor (TRACE_mark)
+} trace_event_type_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;         // CYCCNT, 32 bits bajos
+    uint8_t type;
+    uint8_t arg8;
+    uint16_t arg16;
+} trace_event_t;
+
+// Formato del volcado, todo little-endian:
+//   trace_header_t
+//   task_count  x trace_task_entry_t
+//   queue_count x trace_queue_entry_t
+//   event_count x trace_event_t, del más viejo al más nuevo
+//   uint32_t CRC-32 (IEEE) de todo lo anterior
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // TRACE_MAGIC
+    uint8_t version;            // TRACE_VERSION
+    uint8_t event_size;         // sizeof(trace_event_t)
+    uint8_t task_count;
+    uint8_t queue_count;
+    uint32_t cpu_hz;
+    uint32_t event_count;
+    uint32_t overwritten;       // Eventos pisados desde el volcado anterior
+} trace_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t number;            // Número de TCB (arg16 de los eventos de tarea)
+    uint8_t priority;
+    uint8_t reserved;
+    uint32_t handle;
+    char name[16];              // configMAX_TASK_NAME_LEN, con terminador
+} trace_task_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t number;             // arg8 de los eventos de cola
+    uint8_t type;               // queueQUEUE_TYPE_*
+    uint16_t reserved;
+    uint32_t handle;
+    uint16_t length;
+    uint16_t item_size;
+    char name[12];              // Del registro de colas; vacío si no está registrada
+} trace_queue_entry_t;
+
+// Habilita el contador de ciclos y la grabación
+void TRACE_setup(void);
+
+// Graba un evento. Se puede llamar desde ISRs y desde el kernel
+void TRACE_event(uint8_t type, uint8_t arg8, uint16_t arg16);
+
+// Evento de usuario para marcar puntos del código
+void TRACE_mark(uint8_t id, uint16_t value);
+
+// Asigna el número de traza de una cola nueva (traceQUEUE_CREATE)
+uint16_t TRACE_queue_create(void *queue, uint32_t length, uint32_t item_size, uint8_t type);
+void TRACE_queue_delete(void *queue);
+
+// Eventos de ISR con el número de excepción activa (CYCLES_isr_enter/exit)
+void TRACE_isr_enter(void);
+void TRACE_isr_exit(void);
+
+// Pide un volcado a taskTrace. Falla si no hay UART para el volcado o ya hay uno en curso
+int32_t TRACE_request_dump(void);
+
+// Tarea que vuelca el buffer cuando se pide
+void taskTrace(void *args __attribute__((unused)));
+
+#endif
@@ -1,12 +1,14 @@
 #include "FreeRTOS.h"
 #include "uart.h"
+#include "cycles.h"
+#include "latency.h"
+#include "manifest.h"
+#include "supervisor.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 
-#define SIZE_BUFFER 256  // Queues size
-
 typedef struct {
     uint32_t usart;  // USART_ID 
     QueueHandle_t txq;  // Cola de transmisión
@@ -14,8 +16,30 @@ typedef struct {
     SemaphoreHandle_t mutex;  // Mutex para protección de acceso
     SemaphoreHandle_t semaphore; // Semáforo para señalizar datos de rxq
     int interrupciones;  // Contador de interrupciones
+    uint32_t overruns;  // Bytes que pisó el siguiente antes de que la ISR los leyera (ORE)
+    uint32_t rx_dropped;  // Bytes descartados con la cola de recepción llena
+    latency_source_t latency;  // Fuente en la medición de latencia de la ISR a la tarea
+    TaskHandle_t tx_task;  // Tarea de transmisión, la despierta la ISR con TXE
+    uart_rx_hook_t rx_hook;  // Instrumentación: cada byte que entró en rxq
 } uart_t;
 
+// Espera máxima por TXE antes de volver a mirar el flag
+#define UART_TX_WAIT_MS 10
+
+// Objetos del manifiesto de cada UART, por id: no dependen del orden de la lista
+typedef struct {
+    manifest_object_t txq;
+    manifest_object_t rxq;
+    manifest_object_t mutex;
+    manifest_object_t semaphore;
+} uart_objects_t;
+
+static const uart_objects_t uart_objects[] = {
+    { MANIFEST_UART1_TXQ, MANIFEST_UART1_RXQ, MANIFEST_UART1_MUTEX, MANIFEST_UART1_SEM },
+    { MANIFEST_UART2_TXQ, MANIFEST_UART2_RXQ, MANIFEST_UART2_MUTEX, MANIFEST_UART2_SEM },
+    { MANIFEST_UART3_TXQ, MANIFEST_UART3_RXQ, MANIFEST_UART3_MUTEX, MANIFEST_UART3_SEM },
+};
+
 // Definición de estructuras UART
 static uart_t uart1;
 static uart_t uart2;
@@ -125,32 +149,25 @@ BaseType_t UART_setup(uint32_t usart, uint32_t baudrate) {
 // Inicialización de UART
 static BaseType_t uart_init(uart_t *uart, uint32_t usart) {
     uart->usart = usart;  // Asigna el USART correspondiente
-    uart->txq = xQueueCreate(SIZE_BUFFER, sizeof(uint16_t)); // Crea la cola de transmisión
-    if (uart->txq == NULL) return pdFAIL;
 
-    uart->rxq = xQueueCreate(SIZE_BUFFER, sizeof(uint16_t)); // Crea la cola de recepción
-    if (uart->rxq == NULL) {
-        vQueueDelete(uart->txq);
+    // Colas y semáforos del manifiesto
+    const uart_objects_t *objects = &uart_objects[usart == USART1 ? 0 : usart == USART2 ? 1 : 2];
+    uart->txq = MANIFEST_queue(objects->txq);           // Cola de transmisión
+    uart->rxq = MANIFEST_queue(objects->rxq);           // Cola de recepción
+    uart->mutex = MANIFEST_queue(objects->mutex);
+    uart->semaphore = MANIFEST_queue(objects->semaphore);
+    if (uart->txq == NULL || uart->rxq == NULL || uart->mutex == NULL || uart->semaphore == NULL)
         return pdFAIL;
-    }
-
-    uart->mutex = xSemaphoreCreateMutex();
-    if (uart->mutex == NULL) {
-        vQueueDelete(uart->txq);
-        vQueueDelete(uart->rxq);
-        return pdFAIL;
-    }
-    xSemaphoreGive(uart->mutex);
 
-    uart->semaphore = xSemaphoreCreateBinary();
-    if (uart->semaphore == NULL) {
-        vQueueDelete(uart->txq);
-        vQueueDelete(uart->rxq);
-        vSemaphoreDelete(uart->mutex);
-        return pdFAIL;
-    }
+    // Nombres de las colas para la traza del kernel (registro vacío sin TRACE=1)
+    vQueueAddToRegistry(uart->txq, usart == USART1 ? "UART1 TX" : usart == USART2 ? "UART2 TX" : "UART3 TX");
+    vQueueAddToRegistry(uart->rxq, usart == USART1 ? "UART1 RX" : usart == USART2 ? "UART2 RX" : "UART3 RX");
 
     uart->interrupciones = 0;
+    uart->overruns = 0;
+    uart->rx_dropped = 0;
+    uart->rx_hook = NULL;
+    uart->latency = usart == USART1 ? LATENCY_USART1 : usart == USART2 ? LATENCY_USART2 : LATENCY_USART3;
     return pdPASS;
 }
 
@@ -158,15 +175,24 @@ void taskUART_transmit(uint32_t usart_id) {
     uart_t *uart = get_uart(usart_id);
     if (uart == NULL) return;
 
+    supervisor_slot_t *alive = SUPERVISOR_self();
+    uart->tx_task = xTaskGetCurrentTaskHandle();
     uint16_t ch;
     for (;;) {
+        SUPERVISOR_checkin(alive);
         // Intentar adquirir el mutex antes de acceder a la cola de transmisión
         if (xSemaphoreTake(uart->mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             // Recibir datos de la cola de transmisión
             while (xQueueReceive(uart->txq, &ch, pdMS_TO_TICKS(500)) == pdPASS) {
-                // Esperar hasta que el registro de transmisión esté vacío
-                while (!usart_get_flag(uart->usart, USART_SR_TXE))
-                    taskYIELD(); // Ceder la CPU hasta que esté listo
+                // Con la cola siempre con datos no se sale de este lazo
+                SUPERVISOR_checkin(alive);
+                // Esperar bloqueada hasta que el registro de transmisión esté vacío: la ISR
+                // deshabilita la interrupción de TXE y avisa. Si TXE ya subió entre la
+                // consulta y la habilitación, la interrupción entra enseguida
+                while (!usart_get_flag(uart->usart, USART_SR_TXE)) {
+                    usart_enable_tx_interrupt(uart->usart);
+                    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(UART_TX_WAIT_MS));
+                }
                 // Enviar el byte a través de USART
                 usart_send(uart->usart, ch);
             }
@@ -178,6 +204,41 @@ void taskUART_transmit(uint32_t usart_id) {
     }
 }
 
+// Cambia el baudrate con la USART en marcha. Lo que esté en el aire se corrompe: se usa
+// con la transmisión terminada
+BaseType_t UART_set_baudrate(uint32_t usart_id, uint32_t baudrate) {
+    uart_t *uart = get_uart(usart_id);
+    if (uart == NULL) return pdFAIL;
+
+    usart_disable(uart->usart);
+    usart_set_baudrate(uart->usart, baudrate);
+    usart_enable(uart->usart);
+    return pdPASS;
+}
+
+BaseType_t UART_set_rx_hook(uint32_t usart_id, uart_rx_hook_t hook) {
+    uart_t *uart = get_uart(usart_id);
+    if (uart == NULL) return pdFAIL;
+
+    taskENTER_CRITICAL();
+    uart->rx_hook = hook;
+    taskEXIT_CRITICAL();
+    return pdPASS;
+}
+
+BaseType_t UART_get_stats(uint32_t usart_id, uart_stats_t *stats) {
+    uart_t *uart = get_uart(usart_id);
+    if (uart == NULL) return pdFAIL;
+
+    // Los escribe la ISR: se copian juntos
+    taskENTER_CRITICAL();
+    stats->interrupts = uart->interrupciones;
+    stats->overruns = uart->overruns;
+    stats->rx_dropped = uart->rx_dropped;
+    taskEXIT_CRITICAL();
+    return pdPASS;
+}
+
 BaseType_t UART_receive(uint32_t usart_id, uint16_t *data, TickType_t xTicksToWait) {
     uart_t *uart = get_uart(usart_id);
     if (uart == NULL) return -1;
@@ -231,15 +292,24 @@ BaseType_t UART_putchar(uint32_t usart_id, uint16_t ch, TickType_t xTicksToWait)
 }
 
 void usart1_isr(void) {
+    CYCLES_isr_enter();
+    LATENCY_isr_enter(LATENCY_USART1);
     usart_generic_isr(USART1);
+    CYCLES_isr_exit();
 }
 
 void usart2_isr(void) {
+    CYCLES_isr_enter();
+    LATENCY_isr_enter(LATENCY_USART2);
     usart_generic_isr(USART2);
+    CYCLES_isr_exit();
 }
 
 void usart3_isr(void) {
+    CYCLES_isr_enter();
+    LATENCY_isr_enter(LATENCY_USART3);
     usart_generic_isr(USART3);
+    CYCLES_isr_exit();
 }
 
 // Rutina de interrupción genérica para USART
@@ -252,14 +322,29 @@ static void usart_generic_isr(uint32_t usart_id) {
 
     // flag USART_SR_RXNE: Receive Data Register Not Empty
     while (usart_get_flag(uart->usart, USART_SR_RXNE)) {
+        // ORE se borra con la lectura de DR que sigue: un byte anterior se perdió
+        if (usart_get_flag(uart->usart, USART_SR_ORE)) uart->overruns++;
         // Leer el byte de datos recibido del registro de datos del USART correspondiente
         uint16_t data = usart_recv_blocking(uart->usart);
         // Añade el byte de datos a la cola de recepción desde la rutina de interrupción
         if (xQueueSendToBackFromISR(uart->rxq, &data, NULL) == pdTRUE) { 
             // Dar el semáforo para indicar que hay datos disponibles en la cola
             xSemaphoreGiveFromISR(uart->semaphore, NULL);
+            LATENCY_isr_signal(uart->latency);
+            if (uart->rx_hook != NULL) uart->rx_hook(uart->usart);
+        } else {
+            uart->rx_dropped++;
         }
     }
+
+    // TXE con la interrupción habilitada: la tarea de transmisión espera lugar en DR
+    if ((USART_CR1(uart->usart) & USART_CR1_TXEIE) && usart_get_flag(uart->usart, USART_SR_TXE)) {
+        usart_disable_tx_interrupt(uart->usart);
+        // Sin el cambio de contexto la tarea esperaría al próximo tick: un byte por tick
+        BaseType_t woken = pdFALSE;
+        if (uart->tx_task != NULL) vTaskNotifyGiveFromISR(uart->tx_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
 }
 
 // Imprimir los elementos en uart->rxq de UART (auxiliar)
@@ -312,7 +397,9 @@ BaseType_t UART_semaphore_take(uint32_t usart_id, TickType_t ticks_to_wait) {
     uart_t *uart = get_uart(usart_id);
     if (uart == NULL) return pdFAIL;
 
-    return xSemaphoreTake(uart->semaphore, ticks_to_wait);
+    if (xSemaphoreTake(uart->semaphore, ticks_to_wait) != pdTRUE) return pdFAIL;
+    LATENCY_task_wake(uart->latency);
+    return pdPASS;
 }
 
 // Wrapper SemaphoreGive
@@ -10,9 +10,30 @@
 #include <libopencm3/stm32/usart.h>
 #include <libopencm3/cm3/nvic.h>
 
+// Contadores del driver desde UART_setup()
+typedef struct {
+    uint32_t interrupts;
+    uint32_t overruns;      // Bytes perdidos en el periférico: la ISR no llegó a leerlos (ORE)
+    uint32_t rx_dropped;    // Bytes descartados en la ISR con la cola de recepción llena
+} uart_stats_t;
+
+// Se llama desde la ISR con cada byte que entró en la cola de recepción, en el mismo
+// orden en que UART_receive() los entrega. Es para instrumentación (uartbench.c): corre
+// en la interrupción y tiene que ser corto
+typedef void (*uart_rx_hook_t)(uint32_t usart_id);
+
 // Configura el periférico USART
 BaseType_t UART_setup(uint32_t usart, uint32_t baudrate);
 
+// Cambia el baudrate de una USART ya configurada, con la transmisión terminada
+BaseType_t UART_set_baudrate(uint32_t usart_id, uint32_t baudrate);
+
+// Copia los contadores del driver
+BaseType_t UART_get_stats(uint32_t usart_id, uart_stats_t *stats);
+
+// Instala el hook de recepción, NULL para quitarlo
+BaseType_t UART_set_rx_hook(uint32_t usart_id, uart_rx_hook_t hook);
+
 // Tarea que transmite datos a través de UART1
 void taskUART_transmit(uint32_t usart_id);
 
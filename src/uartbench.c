@@ -0,0 +1,352 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "uartbench.h"
+#include "uart.h"
+#include "manifest.h"
+#include "cycles.h"
+
+#include <libopencm3/cm3/dwt.h>
+#include <string.h>
+
+// Sin UARTBENCH=1 el módulo no se compila
+#ifdef UARTBENCH_ENABLED
+
+#define UARTBENCH_STACK_DEPTH   256
+#define UARTBENCH_TASK_DEPTH    128
+
+static const uint32_t baudrates[] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600 };
+
+typedef struct {
+    uint32_t usart;
+    const char *name;
+    manifest_object_t txq;          // Colas del driver, para informar su largo
+    manifest_object_t rxq;
+    StaticTask_t tcb;               // Tarea de transmisión del driver
+    StackType_t stack[UARTBENCH_TASK_DEPTH];
+} port_t;
+
+static port_t ports[] = {
+    { .usart = USART1, .name = "USART1", .txq = MANIFEST_UART1_TXQ, .rxq = MANIFEST_UART1_RXQ },
+#ifndef SENSOR_BUS_I2C2
+    { .usart = USART2, .name = "USART2", .txq = MANIFEST_UART2_TXQ, .rxq = MANIFEST_UART2_RXQ },
+#endif
+};
+
+#define PORT_COUNT (sizeof(ports) / sizeof(ports[0]))
+#define BAUDRATE_COUNT (sizeof(baudrates) / sizeof(baudrates[0]))
+
+// Contadores para la carga de CPU. Leídos desde una tarea, el de idle está al día
+typedef struct {
+    uint64_t wall;
+    uint64_t isr;
+    configRUN_TIME_COUNTER_TYPE idle;
+} load_t;
+
+// Una corrida: un baudrate en una USART
+typedef struct {
+    uint32_t usart;
+    uint32_t bytes;                 // A transmitir
+    uint32_t seed;
+    volatile uint32_t sent;
+    volatile uint8_t sender_done;
+    uint8_t failed;                 // La cola de TX no se movió en UARTBENCH_WAIT_MS
+    uint8_t synced;
+    uint8_t unsynced;               // Bytes recibidos desde que se perdió la sincronía
+    uint8_t last[UARTBENCH_SYNC_BYTES];
+    uint32_t expected;              // Posición en el patrón del próximo byte
+    uint32_t received;
+    uint32_t matched;               // Recibidos que encajan en el patrón
+    volatile uint32_t queued;       // Bytes que la ISR dejó en la cola de RX
+    uint32_t first_tx;              // CYCCNT
+    uint32_t last_rx;
+    load_t start;                   // Al transmitir el primer byte
+    load_t end;                     // Al recibir el último
+    uint32_t latency_max;
+    uint16_t histogram[UARTBENCH_BUCKETS];
+} run_t;
+
+typedef struct {
+    TaskHandle_t controller;
+    SemaphoreHandle_t send;
+    SemaphoreHandle_t receive;
+    uint8_t failed;
+} uartbench_t;
+
+static uartbench_t bench;
+static run_t run;
+// CYCCNT cuando la ISR dejó cada byte en la cola de RX, por orden de llegada
+static uint32_t stamps[UARTBENCH_WINDOW];
+
+static StaticTask_t controller_tcb, sender_tcb, receiver_tcb;
+static StackType_t controller_stack[UARTBENCH_STACK_DEPTH];
+static StackType_t sender_stack[UARTBENCH_TASK_DEPTH];
+static StackType_t receiver_stack[UARTBENCH_TASK_DEPTH];
+static StaticSemaphore_t send_buffer, receive_buffer;
+
+// Byte del patrón en la posición i: un hash, así se ubica cualquier tramo sin recorrerlo
+static uint8_t pattern(uint32_t i) {
+    uint32_t x = (i + run.seed) * 2654435761u;
+    x ^= x >> 16;
+    x *= 0x45D9F3Bu;
+    x ^= x >> 16;
+    return (uint8_t)x;
+}
+
+// Cubeta 0: < 2^UARTBENCH_MIN_LOG2. Después dos por octava, como en latency.c
+static uint8_t bucket_of(uint32_t cycles) {
+    if (cycles < (1u << UARTBENCH_MIN_LOG2)) return 0;
+    uint8_t octave = 31 - __builtin_clz(cycles);
+    uint8_t half = (cycles >> (octave - 1)) & 1;
+    uint32_t bucket = 1 + (octave - UARTBENCH_MIN_LOG2) * 2 + half;
+    return bucket < UARTBENCH_BUCKETS ? bucket : UARTBENCH_BUCKETS - 1;
+}
+
+static uint32_t bucket_top(uint8_t bucket) {
+    if (bucket == 0) return 1u << UARTBENCH_MIN_LOG2;
+    uint8_t octave = UARTBENCH_MIN_LOG2 + (bucket - 1) / 2;
+    uint32_t half = 1u << (octave - 1);
+    return (1u << octave) + ((bucket - 1) % 2 + 1) * half;
+}
+
+// Borde superior de la cubeta donde se alcanza el percentil, sin pasarse del máximo
+static uint32_t percentile(uint32_t total, uint8_t pct) {
+    uint32_t rank = (total * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < UARTBENCH_BUCKETS - 1; i++) {
+        seen += run.histogram[i];
+        if (seen >= rank) {
+            uint32_t top = bucket_top(i);
+            return top < run.latency_max ? top : run.latency_max;
+        }
+    }
+    return run.latency_max;
+}
+
+static void load_sample(load_t *load) {
+    load->wall = CYCLES_now();
+    load->isr = CYCLES_isr_time();
+    load->idle = ulTaskGetIdleRunTimeCounter();
+}
+
+// Hook de recepción del driver, en la ISR
+static void rx_stamp(uint32_t usart_id __attribute__((unused))) {
+    stamps[run.queued % UARTBENCH_WINDOW] = DWT_CYCCNT;
+    run.queued++;
+}
+
+static void taskBenchSender(void *args __attribute__((unused))) {
+    for (;;) {
+        if (xSemaphoreTake(bench.send, portMAX_DELAY) != pdTRUE) continue;
+
+        load_sample(&run.start);
+        run.first_tx = DWT_CYCCNT;
+        for (uint32_t i = 0; i < run.bytes; i++) {
+            if (UART_putchar(run.usart, pattern(i), pdMS_TO_TICKS(UARTBENCH_WAIT_MS)) != pdTRUE) {
+                run.failed = 1;
+                break;
+            }
+            run.sent = i + 1;
+        }
+        run.sender_done = 1;
+        xTaskNotifyGive(bench.controller);
+    }
+}
+
+// De la ISR a la tarea: el byte número index que entregó UART_receive() es el que la ISR
+// encoló en ese orden
+static void measure(uint32_t index, uint32_t now) {
+    // El sello ya es de otro byte: no se mide
+    if (run.queued - index > UARTBENCH_WINDOW) return;
+
+    uint32_t cycles = now - stamps[index % UARTBENCH_WINDOW];
+    if (cycles > run.latency_max) run.latency_max = cycles;
+    uint16_t *bucket = &run.histogram[bucket_of(cycles)];
+    if (*bucket != UINT16_MAX) (*bucket)++;
+}
+
+static void check_byte(uint8_t byte) {
+    if (run.synced) {
+        if (byte == pattern(run.expected)) {
+            run.expected++;
+            run.matched++;
+            return;
+        }
+        run.synced = 0;
+        run.unsynced = 0;
+    }
+
+    // Sin sincronía: se buscan los últimos bytes recibidos más adelante en el patrón. Con
+    // UARTBENCH_SYNC_BYTES bytes una coincidencia casual es muy improbable
+    memmove(run.last, run.last + 1, UARTBENCH_SYNC_BYTES - 1);
+    run.last[UARTBENCH_SYNC_BYTES - 1] = byte;
+    if (run.unsynced < UARTBENCH_SYNC_BYTES) run.unsynced++;
+    if (run.unsynced < UARTBENCH_SYNC_BYTES) return;
+
+    for (uint32_t i = run.expected; i < run.expected + UARTBENCH_WINDOW; i++) {
+        uint8_t j = 0;
+        while (j < UARTBENCH_SYNC_BYTES && pattern(i + j) == run.last[j]) j++;
+        if (j == UARTBENCH_SYNC_BYTES) {
+            run.matched += UARTBENCH_SYNC_BYTES;
+            run.expected = i + UARTBENCH_SYNC_BYTES;
+            run.synced = 1;
+            return;
+        }
+    }
+}
+
+static void taskBenchReceiver(void *args __attribute__((unused))) {
+    for (;;) {
+        if (xSemaphoreTake(bench.receive, portMAX_DELAY) != pdTRUE) continue;
+
+        uint16_t data;
+        for (;;) {
+            if (UART_receive(run.usart, &data, pdMS_TO_TICKS(UARTBENCH_IDLE_MS)) != pdTRUE) {
+                if (run.sender_done) break;
+                continue;
+            }
+            uint32_t now = DWT_CYCCNT;
+            measure(run.received, now);
+            run.last_rx = now;
+            run.received++;
+            check_byte((uint8_t)data);
+            load_sample(&run.end);
+        }
+        xTaskNotifyGive(bench.controller);
+    }
+}
+
+static uint32_t permille(uint64_t part, uint64_t total) {
+    if (total == 0) return 0;
+    return part >= total ? 1000 : (uint32_t)(part * 1000 / total);
+}
+
+static void put_percent(uint32_t permille_value, uint8_t width) {
+    TEXTLINE_uint((permille_value + 5) / 10, width - 1);
+    TEXTLINE_text("%", 0);
+}
+
+static void put_us(uint32_t cycles, uint8_t width) {
+    TEXTLINE_uint((cycles + CYCLES_PER_US / 2) / CYCLES_PER_US, width);
+}
+
+static void bench_run(const port_t *port, uint32_t baudrate) {
+    UART_set_baudrate(port->usart, baudrate);
+    uint16_t data;
+    while (UART_receive(port->usart, &data, 0) == pdTRUE);
+
+    memset(&run, 0, sizeof(run));
+    run.usart = port->usart;
+    run.bytes = baudrate / 10 * UARTBENCH_RUN_MS / 1000;
+    run.seed = baudrate ^ port->usart;
+    run.synced = 1;
+
+    uart_stats_t before, after;
+    UART_get_stats(port->usart, &before);
+
+    xSemaphoreGive(bench.receive);
+    xSemaphoreGive(bench.send);
+    // Transmisión, vaciado de las colas y el silencio que cierra la corrida
+    for (uint8_t i = 0; i < 2; i++)
+        if (ulTaskNotifyTake(pdFALSE, pdMS_TO_TICKS(4 * UARTBENCH_RUN_MS + UARTBENCH_IDLE_MS)) == 0) run.failed = 1;
+
+    UART_get_stats(port->usart, &after);
+    if (run.failed || run.received == 0) bench.failed = 1;
+
+    uint32_t elapsed = run.last_rx - run.first_tx;
+    uint32_t rate = elapsed > 0 ? (uint32_t)((uint64_t)run.received * configCPU_CLOCK_HZ / elapsed) : 0;
+    uint32_t measured = 0;
+    for (uint8_t i = 0; i < UARTBENCH_BUCKETS; i++) measured += run.histogram[i];
+
+    TEXTLINE_uint(baudrate, 9);
+    TEXTLINE_uint(rate, 8);
+    put_percent(permille(rate, baudrate / 10), 7);
+    if (run.received > 0) {
+        // Del primer byte transmitido al último recibido, sin el silencio que cierra la corrida
+        uint64_t wall = run.end.wall - run.start.wall;
+        put_percent(1000 - permille(run.end.idle - run.start.idle, wall), 6);
+        put_percent(permille(run.end.isr - run.start.isr, wall), 6);
+    } else {
+        TEXTLINE_dash(6);
+        TEXTLINE_dash(6);
+    }
+    TEXTLINE_uint(run.sent - run.received, 9);
+    TEXTLINE_uint(after.overruns - before.overruns, 6);
+    TEXTLINE_uint(after.rx_dropped - before.rx_dropped, 6);
+    TEXTLINE_uint(run.received - run.matched, 8);
+    if (measured > 0) {
+        put_us(percentile(measured, 50), 8);
+        put_us(percentile(measured, 90), 8);
+        put_us(percentile(measured, 99), 8);
+        put_us(run.latency_max, 8);
+    } else {
+        TEXTLINE_dash(8);
+        TEXTLINE_dash(8);
+        TEXTLINE_dash(8);
+        TEXTLINE_dash(8);
+    }
+    if (run.failed) TEXTLINE_text("  TX detenida", 0);
+    TEXTLINE_end();
+}
+
+static void taskUartBench(void *args __attribute__((unused))) {
+    if (!(DWT_CTRL & DWT_CTRL_CYCCNTENA)) dwt_enable_cycle_counter();
+
+    TEXTLINE_text("Benchmark de UART en loopback: ", 0);
+    TEXTLINE_uint(UARTBENCH_RUN_MS, 0);
+    TEXTLINE_text(" ms por baudrate, latencias en µs", 0);
+    TEXTLINE_end();
+
+    for (uint8_t p = 0; p < PORT_COUNT; p++) {
+        const port_t *port = &ports[p];
+        // Con las colas vacías el lugar libre es su largo
+        TEXTLINE_end();
+        TEXTLINE_text(port->name, 0);
+        TEXTLINE_text(": cola de TX de ", 0);
+        TEXTLINE_uint(uxQueueSpacesAvailable(MANIFEST_queue(port->txq)), 0);
+        TEXTLINE_text(", cola de RX de ", 0);
+        TEXTLINE_uint(uxQueueSpacesAvailable(MANIFEST_queue(port->rxq)), 0);
+        TEXTLINE_end();
+        TEXTLINE_text("  Baudios     B/s  Línea   CPU   ISR Perdidos   ORE  Cola Errores     p50     p90     p99     máx", 0);
+        TEXTLINE_end();
+        for (uint8_t b = 0; b < BAUDRATE_COUNT; b++) bench_run(port, baudrates[b]);
+    }
+
+    TEXTLINE_text(bench.failed ? "FALLÓ" : "OK", 0);
+    TEXTLINE_end();
+
+    UARTBENCH_done(bench.failed ? pdFAIL : pdPASS);
+    vTaskSuspend(NULL);
+}
+
+__attribute__((weak)) void UARTBENCH_done(BaseType_t result __attribute__((unused))) {
+}
+
+BaseType_t UARTBENCH_start(textline_print_t print) {
+    TEXTLINE_setup(print);
+
+    bench.send = xSemaphoreCreateBinaryStatic(&send_buffer);
+    bench.receive = xSemaphoreCreateBinaryStatic(&receive_buffer);
+    if (bench.send == NULL || bench.receive == NULL) return pdFAIL;
+
+    // Cada USART con su tarea de transmisión, como en el manifiesto
+    for (uint8_t p = 0; p < PORT_COUNT; p++) {
+        port_t *port = &ports[p];
+        if (UART_setup(port->usart, baudrates[0]) != pdPASS) return pdFAIL;
+        if (UART_set_rx_hook(port->usart, rx_stamp) != pdPASS) return pdFAIL;
+        if (xTaskCreateStatic((TaskFunction_t)taskUART_transmit, port->name, UARTBENCH_TASK_DEPTH,
+                              (void *)port->usart, UARTBENCH_PRIORITY, port->stack, &port->tcb) == NULL)
+            return pdFAIL;
+    }
+
+    if (xTaskCreateStatic(taskBenchSender, "BenchTX", UARTBENCH_TASK_DEPTH, NULL, UARTBENCH_PRIORITY,
+                          sender_stack, &sender_tcb) == NULL) return pdFAIL;
+    if (xTaskCreateStatic(taskBenchReceiver, "BenchRX", UARTBENCH_TASK_DEPTH, NULL, UARTBENCH_PRIORITY,
+                          receiver_stack, &receiver_tcb) == NULL) return pdFAIL;
+    // Arriba de las que mide: solo corre entre corridas
+    bench.controller = xTaskCreateStatic(taskUartBench, "UartBench", UARTBENCH_STACK_DEPTH, NULL,
+                                         UARTBENCH_PRIORITY + 1, controller_stack, &controller_tcb);
+    return bench.controller != NULL ? pdPASS : pdFAIL;
+}
+
+#endif
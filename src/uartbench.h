@@ -0,0 +1,52 @@
+#ifndef UARTBENCH_H
+#define UARTBENCH_H
+
+#include "FreeRTOS.h"
+#include "textline.h"
+#include <stdint.h>
+
+// Benchmark del driver de UART en loopback (compilando con UARTBENCH=1): TX cableado a RX
+// en USART1 (PA9-PA10) y USART2 (PA2-PA3). Por cada baudrate de la lista una tarea manda
+// durante UARTBENCH_RUN_MS un patrón pseudoaleatorio con UART_putchar() y otra lo recibe
+// con UART_receive() y lo compara: el camino completo del driver (cola de TX, tarea de
+// transmisión, ISR de RX y cola de RX). Las dos USARTs tienen distintas colas en el
+// manifiesto, así que además comparan dos configuraciones de buffers. Por corrida informa:
+//  - bytes por segundo sostenidos y qué fracción de la línea ocupan
+//  - carga de CPU (lo que no corrió la tarea idle) y la parte en ISRs, desde el primer
+//    byte transmitido hasta el último recibido. Todas las tareas medidas esperan
+//    bloqueadas, también la de transmisión del driver (interrupción de TXE): el tiempo
+//    que sobra lo corre la tarea idle y no cuenta como carga
+//  - bytes perdidos, y de esos cuántos por ORE (la ISR no llegó a leer DR) y cuántos por
+//    la cola de RX llena (uart_stats_t)
+//  - bytes recibidos que no encajan en el patrón (errores)
+//  - latencia de cada byte desde que la ISR lo dejó en la cola de RX hasta que
+//    UART_receive() se lo entrega a la tarea (hook de recepción del driver): percentiles
+//    50, 90 y 99 y máximo, en µs
+//
+// El patrón depende solo de la posición del byte: después de una pérdida el receptor se
+// vuelve a sincronizar buscando UARTBENCH_SYNC_BYTES bytes seguidos hasta
+// UARTBENCH_WINDOW posiciones adelante. Los resultados salen como texto por la UART del
+// enlace de bajada. En el host corre con make -C host bench, con las USARTs simuladas en
+// loopback y tiempo virtual: el código no consume tiempo, así que la carga da 0 y la
+// latencia es solo la que agrega el scheduler. Las dos valen en el hardware.
+//
+// OBS: con SENSOR_BUS_I2C2 el enlace de bajada usa USART2 y solo se mide USART1.
+
+#define UARTBENCH_RUN_MS        500     // Transmisión por baudrate
+#define UARTBENCH_WAIT_MS       100     // Espera máxima por lugar en la cola de TX
+#define UARTBENCH_IDLE_MS       100     // Sin datos este tiempo, terminó la corrida
+#define UARTBENCH_WINDOW        512     // Más que los bytes en vuelo en las colas del driver
+#define UARTBENCH_SYNC_BYTES    3
+#define UARTBENCH_BUCKETS       40
+#define UARTBENCH_MIN_LOG2      6       // La primera cubeta es < 64 ciclos
+#define UARTBENCH_PRIORITY      2       // Como las tareas de la aplicación
+
+// Crea las tareas del benchmark y configura las USARTs en loopback. Va antes de arrancar
+// el scheduler, después de MANIFEST_setup()
+BaseType_t UARTBENCH_start(textline_print_t print);
+
+// Al terminar, con pdPASS si todas las corridas recibieron datos. Por defecto no hace
+// nada (la tarea del benchmark se suspende); el build del host la reemplaza para salir
+void UARTBENCH_done(BaseType_t result);
+
+#endif
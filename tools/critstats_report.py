@@ -0,0 +1,105 @@
+"""Tiempo con interrupciones enmascaradas a partir de la telemetría de src/critstats.h.
+
+Lee una captura cruda del enlace de bajada de un firmware compilado con CRITSTATS=1 y se
+queda con el último paquete (las mediciones son acumuladas desde el arranque). Muestra la
+sección crítica más larga, la media, la fracción del tiempo con interrupciones
+enmascaradas, los llamadores con las secciones más largas y el histograma:
+
+    make CRITSTATS=1 && make flash
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > downlink.bin
+    python3 critstats_report.py downlink.bin --elf ../src/fiubasat.elf --histogram
+
+--budget-us fija el máximo tolerado (por defecto el tiempo de un byte a 115200 baudios,
+que es lo que tarda RX en pisar el byte anterior). Sale con código 1 si se supera.
+"""
+import argparse
+import struct
+import sys
+
+import downlink_frames
+from trace2perfetto import Elf
+
+PACKET_TYPE = 0x49
+HEADER_FMT = "<BBBBIIIIQ"
+OFFENDER_FMT = "<III"
+OFFENDERS = 4
+MIN_LOG2 = 5
+
+
+def bucket_range(i):
+    if i == 0:
+        return 0, 1 << MIN_LOG2
+    return 1 << (MIN_LOG2 + i - 1), 1 << (MIN_LOG2 + i)
+
+
+def packets(data):
+    """Paquetes de secciones críticas en la captura, de las tramas de housekeeping
+    (downlink_frames.py)."""
+    header_len = struct.calcsize(HEADER_FMT)
+    offender_len = struct.calcsize(OFFENDER_FMT)
+    for frame in downlink_frames.packets(data, PACKET_TYPE):
+        if len(frame) < header_len:
+            continue
+        _, buckets, offenders, _, uptime_ms, count, high, mean, total = struct.unpack_from(HEADER_FMT, frame)
+        end = header_len + OFFENDERS * offender_len + 2 * buckets
+        if offenders > OFFENDERS or len(frame) < end:
+            continue
+        worst = [struct.unpack_from(OFFENDER_FMT, frame, header_len + i * offender_len) for i in range(offenders)]
+        histogram = struct.unpack_from(f"<{buckets}H", frame, end - 2 * buckets)
+        yield {"uptime_ms": uptime_ms, "count": count, "max": high, "mean": mean,
+               "total": total, "worst": worst, "histogram": histogram}
+
+
+def caller_name(elf, caller):
+    # La dirección de retorno apunta después del salto y tiene el bit de Thumb
+    name = elf.symbol_at((caller & ~1) - 2) if elf else None
+    return name or f"0x{caller:08x}"
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captura cruda del enlace de bajada ('-' para stdin)")
+    parser.add_argument("-e", "--elf", help="ELF del firmware para resolver los llamadores")
+    parser.add_argument("--clock", type=float, default=72e6, help="frecuencia del core en Hz (72 MHz)")
+    parser.add_argument("--histogram", action="store_true", help="muestra el histograma")
+    parser.add_argument("--budget-us", type=float, default=10 / 115200 * 1e6,
+                        help="sección más larga tolerada en µs (un byte a 115200 baudios)")
+    args = parser.parse_args()
+
+    data = downlink_frames.read_capture(args.capture)
+    last = None
+    for packet in packets(data):
+        last = packet
+    if last is None:
+        print("no se encontraron paquetes de secciones críticas (¿firmware con CRITSTATS=1?)", file=sys.stderr)
+        sys.exit(1)
+
+    elf = Elf(args.elf) if args.elf else None
+
+    def us(cycles):
+        return cycles * 1e6 / args.clock
+
+    uptime_cycles = last["uptime_ms"] / 1000 * args.clock
+    print(f"Hasta {last['uptime_ms'] / 1000:.0f} s de uptime: {last['count']} secciones críticas")
+    print(f"  Máxima  {us(last['max']):8.2f} µs ({last['max']} ciclos)")
+    print(f"  Media   {us(last['mean']):8.2f} µs")
+    if uptime_cycles:
+        print(f"  Enmascarado el {100 * last['total'] / uptime_cycles:.2f}% del tiempo")
+
+    print(f"\n{'Llamador':40s} {'Máx (µs)':>9s} {'Secciones':>10s}")
+    for caller, high, count in last["worst"]:
+        print(f"{caller_name(elf, caller):40s} {us(high):9.2f} {count:10d}")
+
+    if args.histogram:
+        total = sum(last["histogram"]) or 1
+        print()
+        for i, n in enumerate(last["histogram"]):
+            if n == 0:
+                continue
+            low, high = bucket_range(i)
+            top = f"{us(high):8.2f}" if i < len(last["histogram"]) - 1 else "     ..."
+            print(f"    {us(low):8.2f} - {top} µs  {n:6d}  {'#' * max(1, n * 50 // total)}")
+
+    if us(last["max"]) > args.budget_us:
+        print(f"\nLa sección más larga supera {args.budget_us:.1f} µs: puede perderse RX de una UART")
+        sys.exit(1)
@@ -0,0 +1,85 @@
+"""Separa una captura cruda del enlace de bajada en las tramas de src/downlink.h.
+
+Cada trama sale dentro de un sobre: dos bytes de sync, el stream, el largo, la trama y un
+CRC-16/CCITT-FALSE del stream, el largo y la trama (little-endian). Las herramientas de
+telemetría (stack_report.py, periodic_report.py, ...) leen sus paquetes con este módulo:
+solo ven las tramas del stream de housekeeping con el CRC correcto, nunca bytes de las
+sentencias NMEA ni de otro stream. También sirve solo, para ver qué llegó por stream:
+
+    python3 downlink_frames.py downlink.bin
+"""
+import argparse
+import sys
+from collections import Counter
+
+SYNC = bytes([0x1A, 0xCF])
+HEADER_LEN = 4                      # Sync, stream y largo
+OVERHEAD = HEADER_LEN + 2
+STREAM_HK, STREAM_GPS, STREAM_LOG, STREAM_PAYLOAD = range(4)
+STREAMS = ("HK", "GPS", "Log", "Payload")
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def frames(data, stream=None):
+    """(stream, trama) de cada sobre con el CRC correcto, en orden. Un sobre dañado o
+    cortado al final de la captura se saltea: se busca el sync un byte más adelante."""
+    pos = data.find(SYNC)
+    while pos >= 0:
+        if pos + HEADER_LEN <= len(data):
+            length = data[pos + 3]
+            end = pos + HEADER_LEN + length + 2
+            if end <= len(data):
+                crc = int.from_bytes(data[end - 2:end], "little")
+                if crc16(data[pos + 2:end - 2]) == crc:
+                    if stream is None or data[pos + 2] == stream:
+                        yield data[pos + 2], data[pos + HEADER_LEN:end - 2]
+                    pos = data.find(SYNC, end)
+                    continue
+        pos = data.find(SYNC, pos + 1)
+
+
+def packets(data, *types):
+    """Tramas de housekeeping cuyo primer byte (el tipo de paquete) es uno de types."""
+    for _, frame in frames(data, STREAM_HK):
+        if frame and frame[0] in types:
+            yield frame
+
+
+def read_capture(path):
+    """La captura entera, de un archivo o de stdin con '-'."""
+    if path == "-":
+        return sys.stdin.buffer.read()
+    with open(path, "rb") as f:
+        return f.read()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captura cruda del enlace de bajada ('-' para stdin)")
+    args = parser.parse_args()
+
+    data = read_capture(args.capture)
+    count = Counter()
+    size = Counter()
+    types = Counter()
+    for stream, frame in frames(data):
+        count[stream] += 1
+        size[stream] += len(frame)
+        if stream == STREAM_HK and frame:
+            types[frame[0]] += 1
+
+    framed = sum(size.values()) + OVERHEAD * sum(count.values())
+    print(f"{len(data)} bytes, {framed} en tramas válidas, {len(data) - framed} fuera de ellas\n")
+    print(f"{'Stream':8s} {'Tramas':>8s} {'Bytes':>9s}")
+    for stream in sorted(count):
+        name = STREAMS[stream] if stream < len(STREAMS) else str(stream)
+        print(f"{name:8s} {count[stream]:8d} {size[stream]:9d}")
+    if types:
+        print("\nHK por tipo: " + ", ".join(f"0x{t:02X} {n}" for t, n in sorted(types.items())))
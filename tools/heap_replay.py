@@ -0,0 +1,259 @@
+"""Analiza la telemetría del heap (src/heapstats.h) y reproduce la secuencia de operaciones.
+
+Lee una captura cruda del enlace de bajada de un firmware compilado con HEAP_TRACE=1. Agrupa
+las operaciones por llamador y las vuelve a ejecutar sobre un modelo de heap_4 (primer
+ajuste sobre la lista de bloques libres ordenada por dirección, con unión de vecinos) para
+uno o varios tamaños de heap. Así se ve la fragmentación que tendría la misma carga con
+menos memoria y el heap mínimo con el que no falla ninguna asignación:
+
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > downlink.bin
+    python3 heap_replay.py downlink.bin --elf ../src/fiubasat.elf
+    python3 heap_replay.py downlink.bin --heap-size 1024 --heap-size 768 --min-size
+    python3 heap_replay.py downlink.bin --export trace.txt && ../host/build/heap_bench trace.txt
+
+--export escribe la secuencia en el formato del benchmark de heaps del host
+(host/bench/heap_bench.c), que la corre sobre heap_4 y sobre el heap TLSF.
+
+OBS: los registros traen el tamaño de bloque que calculó el firmware (pedido, encabezado y
+alineación), así que el modelo no repite ese cálculo. Si la captura empieza después del
+arranque, las liberaciones de bloques anteriores se ignoran.
+"""
+import argparse
+import struct
+import sys
+
+import downlink_frames
+from trace2perfetto import Elf
+
+STATS_TYPE = 0x48
+TRACE_TYPE = 0x41
+STATS_FMT = "<BBHIHHHHHHHHII"
+TRACE_HEADER_FMT = "<BBHI"
+RECORD_FMT = "<BBHII"
+RECORDS_PER_PACKET = 8
+
+HEADER_SIZE = 8                     # BlockLink_t alineado a portBYTE_ALIGNMENT
+MIN_BLOCK = 2 * HEADER_SIZE         # heapMINIMUM_BLOCK_SIZE
+ALIGNMENT = 8
+
+
+def stats_packet(frame):
+    if len(frame) < struct.calcsize(STATS_FMT):
+        return None
+    return struct.unpack_from(STATS_FMT, frame)
+
+
+def trace_packet(frame):
+    header_len = struct.calcsize(TRACE_HEADER_FMT)
+    record_len = struct.calcsize(RECORD_FMT)
+    if len(frame) < header_len:
+        return None
+    _, count, dropped, sequence = struct.unpack_from(TRACE_HEADER_FMT, frame)
+    if count > RECORDS_PER_PACKET or len(frame) < header_len + count * record_len:
+        return None
+    records = [struct.unpack_from(RECORD_FMT, frame, header_len + i * record_len) for i in range(count)]
+    return dropped, sequence, records
+
+
+def packets(data):
+    """Paquetes del heap en la captura, de las tramas de housekeeping (downlink_frames.py)."""
+    for frame in downlink_frames.packets(data, STATS_TYPE, TRACE_TYPE):
+        kind = frame[0]
+        parsed = stats_packet(frame) if kind == STATS_TYPE else trace_packet(frame)
+        if parsed is not None:
+            yield kind, parsed
+
+
+class Heap4:
+    """Modelo de heap_4: lista de bloques libres por dirección, primer ajuste, unión al liberar."""
+
+    def __init__(self, total):
+        usable = (total & ~(ALIGNMENT - 1)) - HEADER_SIZE    # pxEnd ocupa el final
+        self.free_list = [[0, usable]]
+        self.free = usable
+        self.min_free = usable
+        self.failures = 0
+        self.max_fragmentation = 0
+        self.first_failure = None
+
+    def largest(self):
+        return max((size for _, size in self.free_list), default=0)
+
+    def malloc(self, size, index):
+        for i, (address, block) in enumerate(self.free_list):
+            if block >= size:
+                if block - size > MIN_BLOCK:
+                    self.free_list[i] = [address + size, block - size]
+                else:
+                    size = block
+                    del self.free_list[i]
+                self.free -= size
+                self.min_free = min(self.min_free, self.free)
+                self.update()
+                return address, size
+        self.failures += 1
+        if self.first_failure is None:
+            self.first_failure = index
+        return None
+
+    def release(self, address, size):
+        i = 0
+        while i < len(self.free_list) and self.free_list[i][0] < address:
+            i += 1
+        self.free_list.insert(i, [address, size])
+        # Unión con el siguiente y con el anterior
+        if i + 1 < len(self.free_list) and address + size == self.free_list[i + 1][0]:
+            self.free_list[i][1] += self.free_list.pop(i + 1)[1]
+        if i > 0 and self.free_list[i - 1][0] + self.free_list[i - 1][1] == address:
+            self.free_list[i - 1][1] += self.free_list.pop(i)[1]
+        self.free += size
+        self.update()
+
+    def update(self):
+        if self.free:
+            self.max_fragmentation = max(self.max_fragmentation, 1000 - self.largest() * 1000 // self.free)
+
+
+def replay(records, heap_size):
+    heap = Heap4(heap_size)
+    blocks = {}             # dirección en el firmware -> (dirección en el modelo, tamaño)
+    for index, (op, _, size, address, _) in enumerate(records):
+        if op == ord("F"):
+            block = blocks.pop(address, None)
+            if block is not None:
+                heap.release(*block)
+            continue
+        block = heap.malloc(size, index) if size > 0 else None
+        if block is not None and op == ord("M"):
+            blocks[address] = block
+        elif block is not None:
+            heap.release(*block)    # Falló en el firmware: nunca se libera
+    return heap
+
+
+def minimum_size(records, start):
+    """Heap más chico, en pasos de la alineación, con el que la secuencia no falla."""
+    size = (start + ALIGNMENT - 1) & ~(ALIGNMENT - 1)
+    while replay(records, size).failures:
+        size += ALIGNMENT
+    return size
+
+
+def export(records, path):
+    """Secuencia para el benchmark: 'm <slot> <pedido>' y 'f <slot>'. Los bloques se numeran
+    reusando los slots liberados y el pedido se estima como el bloque menos el encabezado."""
+    slots = {}
+    free_slots = []
+    count = 0
+    with open(path, "w") as out:
+        for op, _, size, address, _ in records:
+            if op == ord("F"):
+                if address in slots:
+                    slot = slots.pop(address)
+                    free_slots.append(slot)
+                    out.write(f"f {slot}\n")
+                continue
+            slot = free_slots.pop() if free_slots else count
+            count = max(count, slot + 1)
+            out.write(f"m {slot} {max(1, size - HEADER_SIZE)}\n")
+            if op == ord("M"):
+                slots[address] = slot
+            else:
+                out.write(f"f {slot}\n")      # Falló en el firmware: el benchmark lo libera si pudo
+                free_slots.append(slot)
+    return count
+
+
+def caller_name(elf, caller):
+    # La dirección de retorno apunta después del salto y tiene el bit de Thumb
+    name = elf.symbol_at((caller & ~1) - 2) if elf else None
+    return name or f"0x{caller:08x}"
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captura cruda del enlace de bajada ('-' para stdin)")
+    parser.add_argument("-e", "--elf", help="ELF del firmware para resolver los llamadores")
+    parser.add_argument("--heap-size", type=int, action="append",
+                        help="tamaño de heap a simular, en bytes (repetible; por defecto el del firmware)")
+    parser.add_argument("--min-size", action="store_true", help="busca el heap mínimo sin fallas")
+    parser.add_argument("--export", metavar="ARCHIVO", help="escribe la secuencia para host/bench/heap_bench.c")
+    args = parser.parse_args()
+
+    data = downlink_frames.read_capture(args.capture)
+    elf = Elf(args.elf) if args.elf else None
+
+    last_stats = None
+    records = []
+    gaps = 0
+    expected = None
+    for kind, fields in packets(data):
+        if kind == STATS_TYPE:
+            last_stats = fields
+            continue
+        dropped, sequence, packet_records = fields
+        if dropped or (expected is not None and sequence != expected):
+            gaps += 1
+        expected = sequence + len(packet_records)
+        records.extend(packet_records)
+
+    if last_stats is None and not records:
+        print("no se encontraron paquetes del heap", file=sys.stderr)
+        sys.exit(1)
+
+    if last_stats is not None:
+        (_, _, failures, uptime_ms, size, free, min_free, largest, smallest, blocks, frag,
+         last_failure_s, allocations, frees) = last_stats
+        print(f"Firmware a los {uptime_ms / 1000:.0f} s: heap {size} B, libre {free} B, mínimo {min_free} B, "
+              f"bloque mayor {largest} B, {blocks} bloques libres, fragmentación {frag / 10:.1f}%")
+        print(f"  {allocations} asignaciones, {frees} liberaciones, {failures} fallas"
+              + (f" (última a los {last_failure_s} s)" if failures else ""))
+
+    if not records:
+        print("\nsin registros de operaciones: compilar el firmware con HEAP_TRACE=1")
+        sys.exit(0)
+
+    if gaps:
+        print(f"\nOJO: {gaps} huecos en la secuencia (buffer lleno o paquetes perdidos)")
+
+    # Operaciones por llamador
+    callers = {}
+    sizes = {}              # dirección -> (tamaño, llamador) de los bloques vivos
+    for op, _, size, address, caller in records:
+        entry = callers.setdefault(caller, [0, 0, 0, 0, 0])    # malloc, free, fallas, bytes, máximo
+        if op == ord("M"):
+            entry[0] += 1
+            entry[3] += size
+            entry[4] = max(entry[4], size)
+            sizes[address] = (size, caller)
+        elif op == ord("F"):
+            entry[1] += 1
+            sizes.pop(address, None)
+        else:
+            entry[2] += 1
+    live = {}
+    for size, caller in sizes.values():
+        live[caller] = live.get(caller, 0) + size
+
+    print(f"\n{len(records)} operaciones\n")
+    print(f"{'Llamador':32s} {'Malloc':>7s} {'Free':>7s} {'Fallas':>7s} {'Bytes':>8s} {'Máximo':>7s} {'Vivo':>6s}")
+    for caller, (mallocs, frees, fails, total, largest) in sorted(callers.items(), key=lambda c: -c[1][3]):
+        print(f"{caller_name(elf, caller):32.32s} {mallocs:7d} {frees:7d} {fails:7d} {total:8d} {largest:7d} "
+              f"{live.get(caller, 0):6d}")
+
+    heap_sizes = args.heap_size or [last_stats[4] if last_stats else 1536]
+    print(f"\n{'Heap':>6s} {'Mín. libre':>11s} {'Libre final':>12s} {'Bloque mayor':>13s} {'Frag. máx':>10s} "
+          f"{'Fallas':>7s} {'Primera':>8s}")
+    for heap_size in heap_sizes:
+        heap = replay(records, heap_size)
+        first = "-" if heap.first_failure is None else str(heap.first_failure)
+        print(f"{heap_size:6d} {heap.min_free:11d} {heap.free:12d} {heap.largest():13d} "
+              f"{heap.max_fragmentation / 10:9.1f}% {heap.failures:7d} {first:>8s}")
+
+    if args.min_size:
+        peak = max(1, max(heap_sizes) - replay(records, max(heap_sizes)).min_free)
+        print(f"\nHeap mínimo sin fallas para esta secuencia: {minimum_size(records, peak)} B")
+
+    if args.export:
+        slots = export(records, args.export)
+        print(f"\nSecuencia exportada a {args.export} ({slots} bloques simultáneos)")
@@ -0,0 +1,123 @@
+"""Latencias de interrupción a tarea a partir de la telemetría de src/latency.h.
+
+Lee una captura cruda del enlace de bajada y se queda con el último paquete de cada fuente
+(las mediciones son acumuladas). Muestra mínimo, media, percentiles y máximo en µs y el
+histograma de cada fuente:
+
+    python3 ../Raspberry/pilink.py --latency-reset     # en la Raspberry, antes de la corrida
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > downlink.bin
+    python3 latency_report.py downlink.bin --histogram
+
+Como benchmark de regresión: --save guarda los percentiles de la corrida como referencia
+y --baseline compara contra una referencia guardada. Sale con código 1 si en alguna fuente
+el p50, p90, p99 o el máximo empeoran más que --tolerance:
+
+    python3 latency_report.py base.bin --save latency_base.json
+    python3 latency_report.py nueva.bin --baseline latency_base.json --tolerance 25
+
+OBS: los percentiles son el borde superior de la cubeta del histograma (dos por octava),
+así que tienen hasta un 50% de error hacia arriba. Para comparar corridas conviene la
+misma carga y la misma duración.
+"""
+import argparse
+import json
+import struct
+import sys
+
+import downlink_frames
+
+PACKET_TYPE = 0x4C
+HEADER_FMT = "<BBBBIIIIIIIII"
+MIN_LOG2 = 6
+SOURCES = ("USART1", "USART2", "USART3", "I2C1", "I2C2")
+METRICS = ("p50", "p90", "p99", "max")
+
+
+def bucket_range(i):
+    if i == 0:
+        return 0, 1 << MIN_LOG2
+    octave = MIN_LOG2 + (i - 1) // 2
+    half = 1 << (octave - 1)
+    low = (1 << octave) + ((i - 1) % 2) * half
+    return low, low + half
+
+
+def packets(data):
+    """Paquetes de latencia en la captura, de las tramas de housekeeping (downlink_frames.py)."""
+    header_len = struct.calcsize(HEADER_FMT)
+    for frame in downlink_frames.packets(data, PACKET_TYPE):
+        if len(frame) < header_len:
+            continue
+        (_, source, buckets, _, uptime_ms, count, coalesced,
+         low, mean, high, p50, p90, p99) = struct.unpack_from(HEADER_FMT, frame)
+        if source >= len(SOURCES) or len(frame) < header_len + 2 * buckets:
+            continue
+        histogram = struct.unpack_from(f"<{buckets}H", frame, header_len)
+        yield {"source": SOURCES[source], "uptime_ms": uptime_ms, "count": count,
+               "coalesced": coalesced, "min": low, "mean": mean, "max": high,
+               "p50": p50, "p90": p90, "p99": p99, "histogram": histogram}
+
+
+def us(cycles, clock):
+    return cycles * 1e6 / clock
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captura cruda del enlace de bajada ('-' para stdin)")
+    parser.add_argument("--clock", type=float, default=72e6, help="frecuencia del core en Hz (72 MHz)")
+    parser.add_argument("--histogram", action="store_true", help="muestra el histograma de cada fuente")
+    parser.add_argument("--save", metavar="ARCHIVO", help="guarda la corrida como referencia (JSON)")
+    parser.add_argument("--baseline", metavar="ARCHIVO", help="compara contra una referencia guardada")
+    parser.add_argument("--tolerance", type=float, default=20, help="empeoramiento tolerado, en %% (20)")
+    args = parser.parse_args()
+
+    data = downlink_frames.read_capture(args.capture)
+    last = {}
+    for packet in packets(data):
+        last[packet["source"]] = packet
+    if not last:
+        print("no se encontraron paquetes de latencia", file=sys.stderr)
+        sys.exit(1)
+
+    print(f"{'Fuente':8s} {'Eventos':>8s} {'Agrup.':>7s} {'Mín':>8s} {'Media':>8s} {'p50':>8s} "
+          f"{'p90':>8s} {'p99':>8s} {'Máx':>8s}  (µs)")
+    for name in SOURCES:
+        p = last.get(name)
+        if p is None:
+            continue
+        print(f"{name:8s} {p['count']:8d} {p['coalesced']:7d} " +
+              " ".join(f"{us(p[k], args.clock):8.1f}" for k in ("min", "mean", "p50", "p90", "p99", "max")))
+        if args.histogram:
+            total = sum(p["histogram"]) or 1
+            for i, n in enumerate(p["histogram"]):
+                if n == 0:
+                    continue
+                low, high = bucket_range(i)
+                top = f"{us(high, args.clock):8.1f}" if i < len(p["histogram"]) - 1 else "     ..."
+                print(f"    {us(low, args.clock):8.1f} - {top}  {n:6d}  {'#' * max(1, n * 50 // total)}")
+
+    if args.save:
+        with open(args.save, "w") as out:
+            json.dump({name: {k: p[k] for k in METRICS} for name, p in last.items()}, out, indent=2)
+        print(f"\nReferencia guardada en {args.save}")
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        regressions = []
+        for name, reference in baseline.items():
+            p = last.get(name)
+            if p is None:
+                print(f"\n{name}: sin mediciones en esta corrida")
+                continue
+            for k in METRICS:
+                if p[k] > reference[k] * (1 + args.tolerance / 100):
+                    regressions.append(f"{name} {k}: {us(reference[k], args.clock):.1f} -> "
+                                       f"{us(p[k], args.clock):.1f} µs")
+        if regressions:
+            print(f"\nRegresiones (tolerancia {args.tolerance:g}%):")
+            for line in regressions:
+                print(f"  {line}")
+            sys.exit(1)
+        print(f"\nSin regresiones contra {args.baseline} (tolerancia {args.tolerance:g}%)")
@@ -0,0 +1,93 @@
+"""Suite de rendimiento de src/perfsuite.h contra una referencia.
+
+Lee la salida de texto de un firmware compilado con PERFSUITE=1 (la que deja la emulación
+en Renode o una captura del enlace de bajada) y muestra los ciclos de cada camino. --save
+guarda la corrida como referencia y --baseline compara contra una referencia guardada:
+
+    cd src && make perf_baseline        # en el build de referencia
+    cd src && make perf_test            # en cada build nuevo
+
+    python3 perf_compare.py perf.txt --baseline perf_base.json --tolerance 2
+
+Sale con código 1 si la corrida no terminó con OK, si falta un camino de la referencia o
+si alguno la supera en más de --tolerance. En Renode los ciclos son instrucciones y la
+corrida es determinista: una diferencia es un cambio del código, no ruido.
+"""
+import argparse
+import json
+import re
+import sys
+
+PATHS = ("isr_uart_byte", "paquete_telemetria", "sentencia_nmea", "cambio_contexto")
+LINE = re.compile(r"^(\w+)\s+(\d+)\s*$")
+
+
+def results(text):
+    """Ciclos por camino y si la suite terminó con OK. Se queda con la última corrida."""
+    found, ok = {}, False
+    for line in text.splitlines():
+        line = line.strip()
+        match = LINE.match(line)
+        if match and match.group(1) in PATHS:
+            found[match.group(1)] = int(match.group(2))
+        elif line == "OK":
+            ok = True
+        elif line.startswith("Rendimiento"):
+            found, ok = {}, False
+    return found, ok
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("output", help="salida de la suite ('-' para stdin)")
+    parser.add_argument("--save", metavar="ARCHIVO", help="guarda la corrida como referencia (JSON)")
+    parser.add_argument("--baseline", metavar="ARCHIVO", help="compara contra una referencia guardada")
+    parser.add_argument("--tolerance", type=float, default=2, help="empeoramiento tolerado, en %% (2)")
+    args = parser.parse_args()
+
+    raw = sys.stdin.buffer.read() if args.output == "-" else open(args.output, "rb").read()
+    cycles, ok = results(raw.decode("utf-8", errors="replace"))
+    if not ok:
+        print("la suite no terminó con OK (¿firmware con PERFSUITE=1? ¿llegaron los bytes de RX?)",
+              file=sys.stderr)
+        sys.exit(1)
+
+    baseline = None
+    if args.baseline:
+        try:
+            with open(args.baseline) as f:
+                baseline = json.load(f)
+        except FileNotFoundError:
+            print(f"no hay referencia en {args.baseline}: se guarda con --save (make perf_baseline)",
+                  file=sys.stderr)
+            sys.exit(1)
+
+    print(f"{'Camino':20s} {'Ciclos':>10s}" + (f" {'Referencia':>10s} {'Cambio':>8s}" if baseline else ""))
+    regressions = []
+    for name in PATHS:
+        if name not in cycles:
+            continue
+        line = f"{name:20s} {cycles[name]:10d}"
+        if baseline and name in baseline:
+            reference = baseline[name]
+            change = 100 * (cycles[name] - reference) / reference if reference else 0
+            line += f" {reference:10d} {change:+7.1f}%"
+            if cycles[name] > reference * (1 + args.tolerance / 100):
+                regressions.append(f"{name}: {reference} -> {cycles[name]} ciclos ({change:+.1f}%)")
+        print(line)
+
+    if args.save:
+        with open(args.save, "w") as out:
+            json.dump(cycles, out, indent=2)
+        print(f"\nReferencia guardada en {args.save}")
+
+    if baseline:
+        missing = [name for name in baseline if name not in cycles]
+        for name in missing:
+            regressions.append(f"{name}: sin medición en esta corrida")
+        if regressions:
+            print(f"\nRegresiones (tolerancia {args.tolerance:g}%):")
+            for line in regressions:
+                print(f"  {line}")
+            sys.exit(1)
+        print(f"\nSin regresiones contra {args.baseline} (tolerancia {args.tolerance:g}%)")
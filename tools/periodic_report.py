@@ -0,0 +1,76 @@
+"""Tiempos de las tareas periódicas a partir de la telemetría de src/periodic.h.
+
+Lee una captura cruda del enlace de bajada y se queda con el último paquete de cada tarea
+(las mediciones son acumuladas desde el arranque). Para cada tarea muestra prioridad,
+período y plazo, el peor jitter de liberación, el tiempo de respuesta medio y el peor, los
+plazos perdidos y las liberaciones salteadas:
+
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > downlink.bin
+    python3 periodic_report.py downlink.bin
+
+Sale con código 1 si alguna tarea perdió plazos, para usarlo como chequeo después de una
+corrida larga (por ejemplo con el tiempo virtual del build en el host, host/README.md).
+
+OBS: la utilización (respuesta media sobre período) incluye el tiempo en que la tarea
+estuvo desplazada por otras de mayor prioridad: es una cota, no su uso de CPU.
+"""
+import argparse
+import struct
+import sys
+
+import downlink_frames
+
+PACKET_TYPE = 0x50
+HEADER_FMT = "<BBBBI"
+ENTRY_FMT = "<8sBBHHHHIIII"
+TASKS_PER_PACKET = 3
+
+
+def packets(data):
+    """Paquetes de tareas periódicas en la captura, de las tramas de housekeeping
+    (downlink_frames.py)."""
+    header_len = struct.calcsize(HEADER_FMT)
+    entry_len = struct.calcsize(ENTRY_FMT)
+    for frame in downlink_frames.packets(data, PACKET_TYPE):
+        if len(frame) < header_len:
+            continue
+        _, _, _, count, uptime_ms = struct.unpack_from(HEADER_FMT, frame)
+        if count > TASKS_PER_PACKET or len(frame) < header_len + count * entry_len:
+            continue
+        yield uptime_ms, [struct.unpack_from(ENTRY_FMT, frame, header_len + i * entry_len) for i in range(count)]
+
+
+def ms(us):
+    return us / 1000
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captura cruda del enlace de bajada ('-' para stdin)")
+    args = parser.parse_args()
+
+    data = downlink_frames.read_capture(args.capture)
+
+    last = {}
+    last_uptime = 0
+    for uptime_ms, entries in packets(data):
+        last_uptime = max(last_uptime, uptime_ms)
+        for entry in entries:
+            last[entry[0].rstrip(b"\0").decode("ascii")] = entry
+
+    if not last:
+        print("no se encontraron paquetes de tareas periódicas", file=sys.stderr)
+        sys.exit(1)
+
+    print(f"Hasta {last_uptime / 1000:.0f} s de uptime, tiempos en ms\n")
+    print(f"{'Tarea':10s} {'Prio':>4s} {'Período':>8s} {'Plazo':>7s} {'Ciclos':>8s} {'Jitter':>8s} "
+          f"{'Resp.':>8s} {'Peor':>8s} {'Util.':>6s} {'Perdidos':>8s} {'Salteados':>9s}")
+    missed = False
+    for name, e in sorted(last.items(), key=lambda item: (item[1][3], item[0])):
+        _, priority, _, period_ms, deadline_ms, misses, skipped, releases, jitter, mean, worst = e
+        missed = missed or misses > 0
+        note = "   PLAZOS PERDIDOS" if misses else ""
+        print(f"{name:10s} {priority:4d} {period_ms:8d} {deadline_ms:7d} {releases:8d} {ms(jitter):8.2f} "
+              f"{ms(mean):8.2f} {ms(worst):8.2f} {100 * ms(mean) / period_ms:5.1f}% {misses:8d} {skipped:9d}{note}")
+
+    sys.exit(1 if missed else 0)
@@ -0,0 +1,56 @@
+"""Modo STOP del tickless idle a partir de la telemetría de src/power.h (LOW_POWER=1).
+
+Lee una captura cruda del enlace de bajada y muestra el último paquete de consumo: qué
+fracción del tiempo pasó el STM32 en STOP, cuántas veces entró, cuántas lo despertó un pin
+antes de la alarma del RTC y la latencia desde la alarma hasta volver a 72 MHz:
+
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > downlink.bin
+    python3 power_report.py downlink.bin
+
+Sale con código 1 si el modo STOP no está habilitado (el LSE no arrancó).
+"""
+import argparse
+import struct
+import sys
+
+import downlink_frames
+
+PACKET_TYPE = 0x45
+PACKET_FMT = "<BBHIIIIIII"
+
+
+def packets(data):
+    """Paquetes de consumo en la captura, de las tramas de housekeeping (downlink_frames.py)."""
+    size = struct.calcsize(PACKET_FMT)
+    for frame in downlink_frames.packets(data, PACKET_TYPE):
+        if len(frame) < size:
+            continue
+        (_, enabled, _, uptime_ms, stops, early, late, stop_ms, latency_us,
+         latency_max_us) = struct.unpack_from(PACKET_FMT, frame)
+        yield {"enabled": enabled, "uptime_ms": uptime_ms, "stops": stops,
+               "early_wakeups": early, "late_wakeups": late, "stop_ms": stop_ms,
+               "wake_latency_us": latency_us, "wake_latency_max_us": latency_max_us}
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captura cruda del enlace de bajada ('-' para stdin)")
+    args = parser.parse_args()
+
+    data = downlink_frames.read_capture(args.capture)
+    last = None
+    for packet in packets(data):
+        last = packet
+    if last is None:
+        print("no se encontraron paquetes de consumo", file=sys.stderr)
+        sys.exit(1)
+
+    uptime = last["uptime_ms"]
+    print(f"Uptime {uptime / 1000:.0f} s, modo STOP {'habilitado' if last['enabled'] else 'deshabilitado'}")
+    if uptime > 0:
+        print(f"En STOP:            {last['stop_ms'] / 1000:.1f} s ({100 * last['stop_ms'] / uptime:.1f} %)")
+    print(f"Entradas:           {last['stops']}")
+    print(f"Despertadas:        {last['early_wakeups']} por pin, {last['late_wakeups']} tarde")
+    print(f"Latencia de alarma: {last['wake_latency_us']} µs (máx. {last['wake_latency_max_us']} µs)")
+
+    sys.exit(0 if last["enabled"] else 1)
@@ -0,0 +1,85 @@
+"""Recomienda tamaños de stack a partir de la telemetría del monitor de stacks (src/stackmon.h).
+
+Lee una captura cruda del enlace de bajada, busca los paquetes de stack del stream de
+housekeeping y se queda con el peor caso de cada tarea en toda la captura. Para cada
+tarea recomienda el uso máximo medido más un margen, redondeado a 8 palabras:
+
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > downlink.bin
+    python3 stack_report.py downlink.bin
+    python3 stack_report.py downlink.bin --margin 50 --min 96
+
+OBS: el mínimo libre solo cubre los caminos que se ejecutaron durante la captura. Conviene
+capturar con el sistema en su peor carga (todos los comandos, errores de bus, etc.).
+"""
+import argparse
+import struct
+import sys
+
+import downlink_frames
+
+PACKET_TYPE = 0x53
+HEADER_FMT = "<BBBBIB3s"
+ENTRY_FMT = "<8sHH"
+TASKS_PER_PACKET = 8
+WORD = 4
+
+
+def packets(data):
+    """Paquetes de stack en la captura, de las tramas de housekeeping (downlink_frames.py)."""
+    header_len = struct.calcsize(HEADER_FMT)
+    entry_len = struct.calcsize(ENTRY_FMT)
+    for frame in downlink_frames.packets(data, PACKET_TYPE):
+        if len(frame) < header_len:
+            continue
+        _, _, _, count, uptime_ms, low, _ = struct.unpack_from(HEADER_FMT, frame)
+        if count > TASKS_PER_PACKET or len(frame) < header_len + count * entry_len:
+            continue
+        entries = [struct.unpack_from(ENTRY_FMT, frame, header_len + i * entry_len) for i in range(count)]
+        yield uptime_ms, low, entries
+
+
+def recommend(size, min_free, margin, minimum):
+    used = size - min_free
+    words = int(used * (1 + margin / 100) + 0.999)
+    return max(minimum, (words + 7) // 8 * 8)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captura cruda del enlace de bajada ('-' para stdin)")
+    parser.add_argument("--margin", type=float, default=25, help="margen sobre el uso máximo, en %% (25)")
+    parser.add_argument("--min", type=int, default=64, help="tamaño mínimo recomendado, en palabras (64)")
+    args = parser.parse_args()
+
+    data = downlink_frames.read_capture(args.capture)
+
+    tasks = {}          # nombre -> [tamaño, mínimo libre]
+    count = 0
+    last_uptime = 0
+    for uptime_ms, _, entries in packets(data):
+        count += 1
+        last_uptime = max(last_uptime, uptime_ms)
+        for raw_name, size, min_free in entries:
+            name = raw_name.rstrip(b"\0").decode("ascii")
+            task = tasks.setdefault(name, [size, min_free])
+            task[0] = size or task[0]
+            task[1] = min(task[1], min_free)
+
+    if not tasks:
+        print("no se encontraron paquetes del monitor de stacks", file=sys.stderr)
+        sys.exit(1)
+
+    print(f"{count} paquetes, hasta {last_uptime / 1000:.0f} s de uptime\n")
+    print(f"{'Tarea':10s} {'Asignado':>9s} {'Usado':>7s} {'Libre':>7s} {'Recomendado':>12s} {'Ahorro':>8s}")
+    saved = 0
+    for name, (size, min_free) in sorted(tasks.items()):
+        if size == 0:
+            print(f"{name:10s} {'?':>9s} {'?':>7s} {min_free:7d} {'-':>12s} {'-':>8s}   sin tamaño registrado")
+            continue
+        rec = recommend(size, min_free, args.margin, args.min)
+        diff = (size - rec) * WORD
+        saved += diff
+        note = "   AUMENTAR" if rec > size else ""
+        print(f"{name:10s} {size:9d} {size - min_free:7d} {min_free:7d} {rec:12d} {diff:7d}B{note}")
+
+    print(f"\nTamaños en palabras de {WORD} bytes. RAM que se recupera: {saved} bytes")
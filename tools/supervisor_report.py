@@ -0,0 +1,73 @@
+"""Causa del último reset a partir de la telemetría de src/supervisor.h.
+
+Lee una captura cruda del enlace de bajada y muestra el último paquete del supervisor: la
+causa del reset según RCC_CSR, los arranques y reseteos del IWDG desde el último power-on
+y, si el supervisor registró una falla antes del reset, qué tarea fue y en qué estado
+estaba:
+
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > downlink.bin
+    python3 supervisor_report.py downlink.bin
+
+Sale con código 1 si el último arranque fue por el IWDG o con una falla registrada.
+"""
+import argparse
+import struct
+import sys
+
+import downlink_frames
+
+PACKET_TYPE = 0x57
+PACKET_FMT = "<BBBBIIIIIHBB16s"
+CAUSES = ("ninguna", "tarea colgada", "desborde de stack")
+STATES = ("corriendo", "lista", "bloqueada", "suspendida", "borrada", "inválida")
+# RCC_CSR[31:24]
+RESET_FLAGS = ((7, "bajo consumo"), (6, "WWDG"), (5, "IWDG"), (4, "software"),
+               (3, "power-on"), (2, "pin NRST"))
+
+
+def packets(data):
+    """Paquetes del supervisor en la captura, de las tramas de housekeeping
+    (downlink_frames.py)."""
+    size = struct.calcsize(PACKET_FMT)
+    for frame in downlink_frames.packets(data, PACKET_TYPE):
+        if len(frame) < size:
+            continue
+        (_, flags, cause, state, uptime_ms, boots, watchdog_resets, fault_uptime_ms,
+         silent_ms, stack_free, tasks, _, task) = struct.unpack_from(PACKET_FMT, frame)
+        if cause >= len(CAUSES) or state >= len(STATES):
+            continue
+        yield {"flags": flags, "cause": cause, "state": state, "uptime_ms": uptime_ms,
+               "boots": boots, "watchdog_resets": watchdog_resets,
+               "fault_uptime_ms": fault_uptime_ms, "silent_ms": silent_ms,
+               "stack_free": stack_free, "tasks": tasks,
+               "task": task.rstrip(b"\0").decode("ascii", errors="replace")}
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captura cruda del enlace de bajada ('-' para stdin)")
+    args = parser.parse_args()
+
+    data = downlink_frames.read_capture(args.capture)
+    last = None
+    for packet in packets(data):
+        last = packet
+    if last is None:
+        print("no se encontraron paquetes del supervisor", file=sys.stderr)
+        sys.exit(1)
+
+    flags = [name for bit, name in RESET_FLAGS if last["flags"] & (1 << bit)]
+    print(f"Uptime {last['uptime_ms'] / 1000:.0f} s, {last['tasks']} tareas supervisadas")
+    print(f"Reset: {', '.join(flags) or 'sin flags'}")
+    print(f"Arranques desde el power-on: {last['boots']}, por el IWDG: {last['watchdog_resets']}")
+
+    if last["cause"]:
+        print(f"\nFalla registrada antes del reset: {CAUSES[last['cause']]}")
+        print(f"  Tarea:          {last['task']}")
+        print(f"  Uptime:         {last['fault_uptime_ms'] / 1000:.1f} s")
+        if last["cause"] == 1:
+            print(f"  Estado:         {STATES[last['state']]}")
+            print(f"  Sin check-in:   {last['silent_ms']} ms")
+            print(f"  Stack libre:    {last['stack_free']} palabras")
+
+    sys.exit(1 if last["cause"] or last["flags"] & (1 << 5) else 0)
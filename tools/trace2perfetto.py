@@ -0,0 +1,363 @@
+"""Convierte volcados de la traza del kernel (src/trace.h) a JSON de Chrome/Perfetto.
+
+El volcado es lo que sale por USART2 después del comando PILINK_CMD_TRACE_DUMP. La
+captura puede tener varios volcados seguidos y basura entre ellos: se busca el magic
+de cada uno. Cada volcado queda como un proceso en la traza, con una línea por tarea,
+una para las interrupciones y un contador por cola con los mensajes encolados.
+
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > dump.bin
+    python3 trace2perfetto.py dump.bin -e ../src/fiubasat.elf -o trace.json
+
+El JSON se abre en https://ui.perfetto.dev o en chrome://tracing. Con el ELF los
+handles de objetos estáticos y los vectores de interrupción se muestran con el nombre
+del símbolo. La conversión se hace en una pasada y sin guardar los eventos: la
+memoria no depende del tamaño de la captura.
+"""
+import argparse
+import bisect
+import json
+import struct
+import sys
+import zlib
+
+TRACE_MAGIC = b"FTRC"
+TRACE_VERSION = 1
+
+HEADER_FMT = "<IBBBBIII"
+TASK_FMT = "<HBBI16s"
+QUEUE_FMT = "<BBHIHH12s"
+EVENT_FMT = "<IBBH"
+
+(EV_TASK_SWITCH, EV_TASK_READY, EV_TASK_CREATE, EV_TASK_DELETE, EV_TASK_DELAY,
+ EV_QUEUE_CREATE, EV_QUEUE_SEND, EV_QUEUE_RECEIVE, EV_QUEUE_BLOCK_SEND,
+ EV_QUEUE_BLOCK_RECEIVE, EV_QUEUE_SEND_FAILED, EV_QUEUE_RECEIVE_FAILED,
+ EV_NOTIFY, EV_ISR_ENTER, EV_ISR_EXIT, EV_USER) = range(1, 17)
+
+# queueQUEUE_TYPE_* de queue.h
+QUEUE_TYPES = {0: "cola", 1: "mutex", 2: "semáforo contador", 3: "semáforo binario",
+               4: "mutex recursivo"}
+
+# Excepciones del core; las IRQ son 16 + número de IRQ
+EXCEPTIONS = {2: "NMI", 3: "HardFault", 11: "SVCall", 14: "PendSV", 15: "SysTick"}
+
+ISR_TID = 0x10000
+KERNEL_TID = 0
+
+
+class Elf:
+    """Tabla de símbolos y vector de interrupciones de un ELF32 little-endian."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError(f"{path}: no es un ELF32 little-endian")
+
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        sections = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+        names = sections[shstrndx]
+
+        def section_name(section):
+            start = names[4] + section[0]
+            return data[start:data.index(b"\0", start)].decode()
+
+        self.sections = {section_name(s): s for s in sections}
+        self.data = data
+        self.symbols = []   # (dirección, tamaño, nombre), ordenados
+        for section in sections:
+            if section[1] != 2:     # SHT_SYMTAB
+                continue
+            strtab = sections[section[6]]
+            for offset in range(section[4], section[4] + section[5], 16):
+                name, value, size, info, _, shndx = struct.unpack_from("<IIIBBH", data, offset)
+                if info & 0xF not in (1, 2) or shndx == 0:     # STT_OBJECT, STT_FUNC
+                    continue
+                start = strtab[4] + name
+                label = data[start:data.index(b"\0", start)].decode()
+                self.symbols.append((value & ~1, size, label))
+        self.symbols.sort()
+        self.addresses = [s[0] for s in self.symbols]
+
+    def symbol_at(self, address):
+        """Símbolo que contiene address, con el desplazamiento si no es el comienzo."""
+        i = bisect.bisect_right(self.addresses, address) - 1
+        if i < 0:
+            return None
+        start, size, name = self.symbols[i]
+        if address == start:
+            return name
+        if address < start + size:
+            return f"{name}+0x{address - start:x}"
+        return None
+
+    def vector(self, exception):
+        """Nombre del handler de una excepción según la tabla de vectores."""
+        section = self.sections.get(".vectors") or self.sections.get(".isr_vector")
+        if section is None or exception * 4 + 4 > section[5]:
+            return None
+        address, = struct.unpack_from("<I", self.data, section[4] + exception * 4)
+        return self.symbol_at(address & ~1)
+
+
+class Writer:
+    """Escribe el JSON de a un evento por vez."""
+
+    def __init__(self, out):
+        self.out = out
+        self.first = True
+        out.write('{"displayTimeUnit": "ns", "traceEvents": [\n')
+
+    def emit(self, event):
+        if not self.first:
+            self.out.write(",\n")
+        self.first = False
+        self.out.write(json.dumps(event, ensure_ascii=False, separators=(",", ":")))
+
+    def close(self):
+        self.out.write("\n]}\n")
+
+
+class Reader:
+    """Lee el archivo y lleva el CRC de lo leído desde el magic del volcado. Los bytes
+    devueltos con unread() se vuelven a leer antes que los del archivo, que puede ser
+    stdin y no admitir seek()."""
+
+    def __init__(self, f):
+        self.f = f
+        self.crc = 0
+        self.pending = b""
+
+    def raw(self, n):
+        data, self.pending = self.pending[:n], self.pending[n:]
+        while len(data) < n:
+            more = self.f.read(n - len(data))
+            if not more:
+                break
+            data += more
+        return data
+
+    def unread(self, data):
+        self.pending = data + self.pending
+
+    def read(self, n):
+        data = self.raw(n)
+        if len(data) < n:
+            raise EOFError
+        self.crc = zlib.crc32(data, self.crc)
+        return data
+
+    def sync(self):
+        """Avanza hasta el próximo magic. Devuelve los bytes salteados."""
+        window = b""
+        skipped = 0
+        while True:
+            byte = self.raw(1)
+            if not byte:
+                raise EOFError
+            skipped += 1
+            window = (window + byte)[-4:]
+            if window == TRACE_MAGIC:
+                self.crc = zlib.crc32(TRACE_MAGIC)
+                return skipped - len(TRACE_MAGIC)
+
+
+def cstr(raw):
+    return raw.split(b"\0", 1)[0].decode("latin-1")
+
+
+class Dump:
+    """Convierte un volcado. Solo guarda el estado actual de cada línea de tiempo."""
+
+    def __init__(self, writer, elf, pid, cpu_hz):
+        self.writer = writer
+        self.elf = elf
+        self.pid = pid
+        self.cpu_hz = cpu_hz
+        self.tasks = {}         # número -> nombre
+        self.queues = {}        # número -> nombre
+        self.running = None     # Tarea con una rebanada abierta
+        self.isr_stack = []     # Excepciones con rebanada abierta
+        self.last = None        # Último timestamp crudo
+        self.cycles = 0         # Ciclos desde el primer evento, sin vueltas
+
+    def meta(self, name, tid, value):
+        self.writer.emit({"ph": "M", "name": name, "pid": self.pid, "tid": tid, "args": {"name": value}})
+
+    def handle_name(self, handle):
+        if self.elf is None:
+            return None
+        name = self.elf.symbol_at(handle)
+        # Los objetos del heap solo caen dentro del arreglo del heap: no es un nombre útil
+        return None if name is None or name.startswith("ucHeap") else name
+
+    def add_task(self, number, priority, handle, name):
+        name = name or self.handle_name(handle) or f"Tarea {number}"
+        self.tasks[number] = name
+        self.meta("thread_name", number, name)
+        self.writer.emit({"ph": "M", "name": "thread_sort_index", "pid": self.pid, "tid": number,
+                          "args": {"sort_index": -priority}})
+
+    def add_queue(self, number, qtype, handle, length, item_size, name):
+        name = name or self.handle_name(handle) or f"Cola {number}"
+        self.queues[number] = f"{name} ({QUEUE_TYPES.get(qtype, qtype)}, {length}x{item_size} B)"
+
+    def isr_name(self, exception):
+        name = self.elf.vector(exception) if self.elf is not None else None
+        if name is None:
+            name = EXCEPTIONS.get(exception, f"IRQ {exception - 16}")
+        return name
+
+    def task_name(self, number):
+        if number not in self.tasks:
+            self.tasks[number] = f"Tarea {number}"
+            self.meta("thread_name", number, self.tasks[number])
+        return self.tasks[number]
+
+    def queue_name(self, number):
+        return self.queues.get(number, f"Cola {number}")
+
+    def context(self):
+        if self.isr_stack:
+            return ISR_TID
+        return self.running if self.running is not None else KERNEL_TID
+
+    def ts(self, timestamp):
+        if self.last is not None:
+            self.cycles += (timestamp - self.last) & 0xFFFFFFFF
+        self.last = timestamp
+        return self.cycles * 1e6 / self.cpu_hz
+
+    def emit(self, ph, name, ts, tid, **fields):
+        event = {"ph": ph, "name": name, "ts": ts, "pid": self.pid, "tid": tid}
+        event.update(fields)
+        self.writer.emit(event)
+
+    def instant(self, name, ts, args=None):
+        self.emit("i", name, ts, self.context(), s="t", args=args or {})
+
+    def event(self, timestamp, etype, arg8, arg16):
+        ts = self.ts(timestamp)
+
+        if etype == EV_TASK_SWITCH:
+            if self.running is not None:
+                self.emit("E", self.task_name(self.running), ts, self.running)
+            self.running = arg16
+            self.emit("B", self.task_name(arg16), ts, arg16, args={"prioridad": arg8})
+        elif etype == EV_ISR_ENTER:
+            self.isr_stack.append(arg8)
+            self.emit("B", self.isr_name(arg8), ts, ISR_TID)
+        elif etype == EV_ISR_EXIT:
+            if self.isr_stack:
+                self.isr_stack.pop()
+                self.emit("E", self.isr_name(arg8), ts, ISR_TID)
+        elif etype in (EV_QUEUE_SEND, EV_QUEUE_RECEIVE):
+            self.emit("C", self.queue_name(arg8), ts, 0, args={"mensajes": arg16})
+        elif etype == EV_QUEUE_BLOCK_SEND:
+            self.instant(f"Bloqueo: {self.queue_name(arg8)} llena", ts)
+        elif etype == EV_QUEUE_BLOCK_RECEIVE:
+            self.instant(f"Espera: {self.queue_name(arg8)}", ts)
+        elif etype == EV_QUEUE_SEND_FAILED:
+            self.instant(f"Envío fallido: {self.queue_name(arg8)}", ts)
+        elif etype == EV_QUEUE_RECEIVE_FAILED:
+            self.instant(f"Recepción fallida: {self.queue_name(arg8)}", ts)
+        elif etype == EV_QUEUE_CREATE:
+            self.instant(f"Creada: {self.queue_name(arg8)}", ts)
+        elif etype == EV_TASK_READY:
+            self.instant(f"Ready: {self.task_name(arg16)}", ts)
+        elif etype == EV_TASK_CREATE:
+            self.instant(f"Creada: {self.task_name(arg16)}", ts, {"prioridad": arg8})
+        elif etype == EV_TASK_DELETE:
+            self.instant(f"Borrada: {self.task_name(arg16)}", ts)
+        elif etype == EV_TASK_DELAY:
+            self.instant("vTaskDelay", ts, {"ticks": arg16})
+        elif etype == EV_NOTIFY:
+            self.instant(f"Notifica a {self.task_name(arg16)}", ts)
+        elif etype == EV_USER:
+            self.instant(f"Marca {arg8}", ts, {"valor": arg16})
+        else:
+            self.instant(f"Evento desconocido {etype}", ts, {"arg8": arg8, "arg16": arg16})
+
+    def finish(self, crc_ok, truncated=False):
+        """Cierra las rebanadas abiertas en el último timestamp, también si la captura se
+        cortó a mitad del volcado."""
+        ts = self.cycles * 1e6 / self.cpu_hz
+        while self.isr_stack:
+            self.emit("E", self.isr_name(self.isr_stack.pop()), ts, ISR_TID)
+        if self.running is not None:
+            self.emit("E", self.task_name(self.running), ts, self.running)
+            self.running = None
+        if truncated:
+            self.emit("i", "Captura cortada: volcado incompleto", ts, KERNEL_TID, s="p")
+        elif not crc_ok:
+            self.emit("i", "CRC inválido: volcado corrupto", ts, KERNEL_TID, s="p")
+
+
+def convert(f, writer, elf):
+    reader = Reader(f)
+    dumps = 0
+    dump = None             # Volcado a medio leer
+    while True:
+        try:
+            skipped = reader.sync()
+            if skipped:
+                print(f"{skipped} bytes salteados antes del volcado {dumps + 1}", file=sys.stderr)
+
+            header = TRACE_MAGIC + reader.read(struct.calcsize(HEADER_FMT) - 4)
+            _, version, event_size, task_count, queue_count, cpu_hz, event_count, overwritten = \
+                struct.unpack(HEADER_FMT, header)
+            # Un magic dentro de datos que no son un volcado casi nunca pasa estos controles.
+            # Si no los pasa, se sigue buscando desde el byte siguiente al magic: el
+            # encabezado falso puede contener el comienzo del volcado verdadero
+            if version != TRACE_VERSION or event_size != struct.calcsize(EVENT_FMT) or not 10**6 <= cpu_hz <= 10**9:
+                print(f"volcado {dumps + 1}: versión {version} o tamaño de evento {event_size} "
+                      "no soportados, se busca el siguiente", file=sys.stderr)
+                reader.unread(header[1:])
+                continue
+
+            dumps += 1
+            dump = Dump(writer, elf, dumps, cpu_hz)
+            dump.meta("process_name", 0, f"Volcado {dumps}")
+            dump.meta("thread_name", KERNEL_TID, "Kernel / colas")
+            dump.meta("thread_name", ISR_TID, "Interrupciones")
+            for _ in range(task_count):
+                number, priority, _, handle, name = struct.unpack(TASK_FMT, reader.read(struct.calcsize(TASK_FMT)))
+                dump.add_task(number, priority, handle, cstr(name))
+            for _ in range(queue_count):
+                number, qtype, _, handle, length, item_size, name = \
+                    struct.unpack(QUEUE_FMT, reader.read(struct.calcsize(QUEUE_FMT)))
+                dump.add_queue(number, qtype, handle, length, item_size, cstr(name))
+
+            for _ in range(event_count):
+                dump.event(*struct.unpack(EVENT_FMT, reader.read(struct.calcsize(EVENT_FMT))))
+
+            expected = reader.crc
+            crc, = struct.unpack("<I", reader.read(4))
+            dump.finish(crc == expected)
+            dump = None
+            print(f"volcado {dumps}: {task_count} tareas, {queue_count} colas, {event_count} eventos, "
+                  f"{overwritten} pisados{'' if crc == expected else ', CRC INVÁLIDO'}", file=sys.stderr)
+        except EOFError:
+            if dump is not None:
+                dump.finish(False, truncated=True)
+                print(f"volcado {dumps}: la captura termina antes del final del volcado", file=sys.stderr)
+            return dumps
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="captura de la UART ('-' para stdin)")
+    parser.add_argument("-e", "--elf", help="ELF del firmware para resolver nombres")
+    parser.add_argument("-o", "--output", default="-", help="JSON de salida ('-' para stdout)")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf) if args.elf else None
+    source = sys.stdin.buffer if args.dump == "-" else open(args.dump, "rb")
+    out = sys.stdout if args.output == "-" else open(args.output, "w", encoding="utf-8", buffering=1 << 16)
+
+    writer = Writer(out)
+    count = convert(source, writer, elf)
+    writer.close()
+    if count == 0:
+        print("no se encontró ningún volcado", file=sys.stderr)
+        sys.exit(1)